@@ -24,8 +24,33 @@
   - Point your browser to http://{ip-address}/
   - Have fun playing with the Arduino's I/Os!
   
- NOTES: This code uses about 4k of RAM, which means it won't fit
- in the Arduino Uno without a lot of optimizations. Sorry.
+ NOTES: Entry tables and the texts of responses are kept in flash
+ (WOOPSA_ENABLE_FLASH_TABLES). To see the RAM taken by each feature of
+ woopsa-config.h, run Tools/woopsa-ram-report.py --cc avr-gcc
+ --cflags "-mmcu=atmega328p -Os", and disable the ones you don't need.
+ On the Arduino Uno, woopsa-config.h shrinks the buffers of the
+ connection to fit its 2 KB of RAM: requests with long headers (most
+ browsers) get a 400, the full meta document and groups of more than 6
+ values get a 503. Use curl, meta pages and narrow patterns instead.
+ The server does a bounded piece of work per loop (time slicing), so
+ that IoLoop keeps running while a large response is prepared and sent.
+ MaxStepMs shows the longest step so far, write 0 to measure again.
+ With WOOPSA_ENABLE_WRITE_QUEUE, written values are queued and applied
+ at the start of loop(), so interrupts are never disabled while a
+ request is parsed.
+ A group of pins is read in one request with a pattern, for instance
+ http://{ip-address}/woopsa/read/Digital1* or /woopsa/read/AnalogIn*.
+ The meta document can be fetched a page at a time, for instance
+ http://{ip-address}/woopsa/meta?prefix=Analog&offset=0&limit=4.
+ A pin mode and its output change together when both are written in
+ one transaction: POST PinMode3=1&Digital3=1 to http://{ip-address}/woopsa/write
+ AverageAnalogIn0 samples A0 for 2 seconds: POST to
+ http://{ip-address}/woopsa/invoke/AverageAnalogIn0 answers with a job
+ id at once, GET /woopsa/job/{id} gives the average once it is there.
+ Only one client is served at a time. A client that sends its request
+ too slowly gets a 408 (WOOPSA_ENABLE_TIMEOUTS), and an idle one is let
+ go after IDLE_TIMEOUT_MS so that browsers keeping connections open do
+ not hold the others up.
  
 ==================================================================
 */
@@ -34,7 +59,9 @@
 #include <avr/pgmspace.h>
 
 #include "woopsa-server.h"
-#include "html.h"
+// Generated from index.html with:
+//   python ../Tools/woopsa-assets.py -o assets.h index.html
+#include "assets.h"
 
 // Enter a MAC address and IP address for your controller below.
 // The IP address will be dependent on your local network:
@@ -51,10 +78,37 @@ EthernetServer server(80);
 // The struct for holding all woopsa information
 WoopsaServer woopsaServer;
 
+// The client being served, and the state of its connection
+EthernetClient client;
+WoopsaConnection woopsaConnection;
+unsigned long lastActivity;
+#define IDLE_TIMEOUT_MS 1000
+// Bytes written to the Ethernet chip per loop
+#define SEND_CHUNK_SIZE 256
+
 // The properties that will be published over Woopsa
 int AnalogIn0, AnalogIn1, AnalogIn2, AnalogIn3, AnalogIn4, AnalogIn5;
 int Digital0, Digital1, Digital2, Digital3, Digital4, Digital5, Digital6, Digital7, Digital8, Digital9, Digital10, Digital11, Digital12, Digital13;
 int PinMode0, PinMode1, PinMode2, PinMode3, PinMode4, PinMode5, PinMode6, PinMode7, PinMode8, PinMode9, PinMode10, PinMode11, PinMode12, PinMode13;
+float MaxStepMs;
+
+// The job of AverageAnalogIn0 being sampled by IoLoop, NULL when there is none
+#define AVERAGE_DURATION_MS 2000
+WoopsaJob* averageJob = NULL;
+unsigned long averageStart;
+long averageSum;
+int averageCount;
+
+void AverageAnalogIn0(WoopsaJob* job) {
+	if (averageJob != NULL) {
+		WoopsaJobFail(job);
+		return;
+	}
+	averageJob = job;
+	averageStart = millis();
+	averageSum = 0;
+	averageCount = 0;
+}
 
 // These macros publish properties over the Woopsa protocol
 WOOPSA_BEGIN(woopsaEntries)
@@ -92,6 +146,8 @@ WOOPSA_BEGIN(woopsaEntries)
 	WOOPSA_PROPERTY(PinMode11, WOOPSA_TYPE_INTEGER)
 	WOOPSA_PROPERTY(PinMode12, WOOPSA_TYPE_INTEGER)
 	WOOPSA_PROPERTY(PinMode13, WOOPSA_TYPE_INTEGER)
+	WOOPSA_PROPERTY(MaxStepMs, WOOPSA_TYPE_REAL)
+	WOOPSA_METHOD_ASYNC(AverageAnalogIn0, WOOPSA_TYPE_REAL)
 WOOPSA_END;
 
 void IoLoop() {
@@ -103,6 +159,16 @@ void IoLoop() {
 	AnalogIn4 = analogRead(A4);
 	AnalogIn5 = analogRead(A5);
 
+	if (averageJob != NULL) {
+		averageSum += AnalogIn0;
+		averageCount++;
+		if (millis() - averageStart >= AVERAGE_DURATION_MS) {
+			float average = (float)averageSum / averageCount;
+			WoopsaJobComplete(averageJob, &average);
+			averageJob = NULL;
+		}
+	}
+
 	// Auto-generated code, copies I/Os
 	pinMode(0,PinMode0);
 	if (PinMode0 == OUTPUT)
@@ -194,51 +260,67 @@ void IoLoop() {
 }
 
 
-WoopsaBufferSize ServeHTML(WoopsaChar8 path[], WoopsaUInt8 isPost, WoopsaChar8 dataBuffer[], WoopsaBufferSize dataBufferSize) {
-	// Normally, we would write inside the dataBuffer
-	// However, due to the Arduino's extremely limited
-	// RAM (a few kB), we can't write a "huge" 14kB HTML
-	// file. So we just return the length of the HTML
-	// and we will directly write the HTML stored in flash
-	// memory to the TCP stream in the woopsaLoop. See below.
-	return sizeof(HTML)-1;
+// Keeps the duration of the longest step of the server
+void StepHook(WoopsaUInt8 step, WoopsaUInt32 microseconds) {
+	if (microseconds / 1000.0f > MaxStepMs)
+		MaxStepMs = microseconds / 1000.0f;
 }
 
 void WoopsaLoop() {
-	char dataBuffer[2048];
-	int bufferAt = 0;
-	WoopsaBufferSize responseLength;
-	memset(dataBuffer, 0, sizeof(dataBuffer));
-	// Listen for incoming clients
-	EthernetClient client = server.available();
-	if (client) {
-		while (client.connected()) {
-			if (client.available()) {
-				// We _append_ data to our buffer when it is received
-				bufferAt += client.read((unsigned char*)(dataBuffer + bufferAt), sizeof(dataBuffer));
-				
-				// When we get a request from a client, we need
-				// to make sure it's complete before we pass it
-				// to the Woopsa server. This allows us to handle
-				// cases where packets are fragmented.
-				if (WoopsaCheckRequestComplete(&woopsaServer, dataBuffer, sizeof(dataBuffer)) != WOOPSA_REQUEST_COMLETE) {
-					continue;
-				}
+	WoopsaChar8* input;
+	const WoopsaChar8* output;
+	WoopsaBufferSize length, writtenBytes;
+	int readBytes;
+	// Take the next client once the current one is gone
+	if (!client) {
+		client = server.available();
+		if (!client)
+			return;
+		WoopsaConnectionInit(&woopsaConnection, &woopsaServer);
+		lastActivity = millis();
+	}
+
+	// Receive directly in the connection, which keeps partial
+	// requests until they are complete. This allows us to handle
+	// cases where packets are fragmented.
+	input = WoopsaConnectionInput(&woopsaConnection, &length);
+	if (length > 0 && client.available() > 0) {
+		readBytes = client.read((uint8_t*)input, length);
+		if (readBytes > 0) {
+			WoopsaConnectionReceived(&woopsaConnection, readBytes);
+			lastActivity = millis();
+		}
+	}
 
-				if ( WoopsaHandleRequest(&woopsaServer, dataBuffer, sizeof(dataBuffer), dataBuffer, sizeof(dataBuffer), &responseLength) == WOOPSA_OTHER_RESPONSE ) {
-					// This was a non-Woopsa request, serve the HTML page
-					client.print(dataBuffer);
-					// The F() macro specifies the const string is stored
-					// in flash memory
-					client.print(F(HTML));
-				} else {
-					client.print(dataBuffer);
-				}
-				break;
-			}
+	// Do the next piece of work: handle a request, serialize a few
+	// entries of meta, or read the next buffer of the HTML page from
+	// flash memory
+	WoopsaConnectionStep(&woopsaConnection);
+
+	// Send a chunk of the response, the rest goes in the next loops
+	length = WoopsaConnectionPollOutput(&woopsaConnection, &output);
+	if (length > SEND_CHUNK_SIZE)
+		length = SEND_CHUNK_SIZE;
+	if (length > 0) {
+		writtenBytes = client.write((const uint8_t*)output, length);
+		if (writtenBytes > 0) {
+			WoopsaConnectionConsumed(&woopsaConnection, writtenBytes);
+			lastActivity = millis();
 		}
 	}
-	client.stop();
+
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	// A client trickling a request in keeps lastActivity fresh, its
+	// deadline does not move
+	WoopsaServerExpireConnections(&woopsaServer);
+#endif
+
+	// Browsers keep connections open, don't let an idle one
+	// keep the other clients waiting
+	if (WoopsaConnectionIsClosed(&woopsaConnection) || !client.connected() || millis() - lastActivity > IDLE_TIMEOUT_MS) {
+		WoopsaConnectionClose(&woopsaConnection);
+		client.stop();
+	}
 }
 
 void setup() {
@@ -258,9 +340,11 @@ void setup() {
 	
 	// Initialize the woopsa server with a path prefix of 
 	// /woopsa/ and the specified woopsa entries.
-	// The ServeHTML function allows us to serve an HTML
-	// page which you can access
-	WoopsaServerInit(&woopsaServer, "/woopsa/", woopsaEntries, ServeHTML);
+	// The assets contain the HTML page which you can access
+	// on /, gzipped to go faster over the SPI link
+	WoopsaServerInit(&woopsaServer, "/woopsa/", woopsaEntries, NULL);
+	WoopsaServerSetAssets(&woopsaServer, woopsaAssets);
+	WoopsaServerSetStepHook(&woopsaServer, StepHook);
 	
 	Serial.print(F("Woopsa server listening on http://"));
 	Serial.print(Ethernet.localIP());
@@ -271,6 +355,10 @@ void setup() {
 }
 
 void loop() {
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+	// Values written by clients only change here, between two cycles
+	WoopsaApplyPendingWrites(&woopsaServer);
+#endif
 	IoLoop();
 	WoopsaLoop();	 
 }
@@ -0,0 +1,278 @@
+// Generated by woopsa-assets.py from index.html, do not edit.
+#ifndef __ASSETS_H_
+#define __ASSETS_H_
+
+#include "woopsa-server.h"
+
+// index.html, 4200 bytes (21650 uncompressed)
+static const WoopsaUInt8 IndexHtmlAsset[] WOOPSA_PROGMEM = {
+	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xdd, 0x1c, 0x6b, 0x77, 0xdb, 0xb6,
+	0xf5, 0xb3, 0xfd, 0x2b, 0x50, 0x2e, 0xab, 0xa5, 0x55, 0x22, 0x25, 0x3f, 0x92, 0x46, 0x7e, 0xf4,
+	0xa4, 0x49, 0xb7, 0x7a, 0xa7, 0x6d, 0xba, 0x38, 0x5b, 0x77, 0x4e, 0x4e, 0x3e, 0x40, 0x24, 0x64,
+	0x31, 0xa1, 0x48, 0x99, 0x00, 0x2d, 0xbb, 0xa9, 0xfe, 0xfb, 0x2e, 0x5e, 0x24, 0x00, 0x81, 0x8a,
+	0x92, 0xd8, 0x5a, 0x8f, 0xd3, 0x2d, 0x91, 0x81, 0x8b, 0x8b, 0x8b, 0xfb, 0xbe, 0x17, 0x90, 0x4f,
+	0xa6, 0x6c, 0x96, 0x9d, 0xed, 0x9e, 0x4c, 0x09, 0x4e, 0xce, 0x76, 0x11, 0x3a, 0x61, 0x29, 0xcb,
+	0xc8, 0xd9, 0x6f, 0x45, 0x31, 0xa7, 0x18, 0x3d, 0x2b, 0x93, 0x2a, 0xcd, 0x0b, 0x94, 0x90, 0x59,
+	0x71, 0x12, 0xc9, 0x29, 0x0e, 0x94, 0xa5, 0xf9, 0x7b, 0x34, 0x2d, 0xc9, 0xe4, 0x34, 0x98, 0x32,
+	0x36, 0xa7, 0xa3, 0x28, 0x9a, 0xe1, 0x9b, 0x38, 0xc9, 0xc3, 0x71, 0x51, 0x30, 0xca, 0x4a, 0x3c,
+	0xe7, 0x3f, 0xc4, 0xc5, 0x2c, 0xaa, 0x07, 0xa2, 0x83, 0xf0, 0x20, 0x3c, 0x8a, 0x62, 0x4a, 0x9b,
+	0xb1, 0x70, 0x96, 0x02, 0x14, 0xa5, 0x01, 0x2a, 0x49, 0x76, 0x1a, 0x50, 0x76, 0x9b, 0x11, 0x3a,
+	0x25, 0x84, 0x05, 0x62, 0x1b, 0xf1, 0x33, 0xff, 0x14, 0x26, 0xe9, 0x65, 0xca, 0x70, 0xd6, 0x4f,
+	0x8b, 0x3e, 0x65, 0x98, 0x55, 0xf4, 0xc3, 0xee, 0xce, 0xbc, 0xa0, 0x29, 0x4b, 0x8b, 0x7c, 0xc4,
+	0x17, 0x63, 0x96, 0x5e, 0x93, 0xe3, 0xdd, 0x9d, 0x45, 0x9a, 0xb0, 0xe9, 0x08, 0x0d, 0x8f, 0xe6,
+	0x37, 0xf0, 0xd3, 0x94, 0xa4, 0x97, 0x53, 0x56, 0xff, 0xc8, 0x8a, 0xf9, 0x08, 0x1d, 0xf2, 0x8f,
+	0x08, 0x2d, 0xbd, 0x68, 0x47, 0x63, 0x32, 0x29, 0x4a, 0x02, 0xd8, 0xe3, 0x22, 0x67, 0x24, 0x87,
+	0xb5, 0x7b, 0x7b, 0xc7, 0xe6, 0x5e, 0x78, 0x4c, 0x8b, 0xac, 0x62, 0x7c, 0xaf, 0x8c, 0x4c, 0x60,
+	0x7e, 0xa0, 0x11, 0x0f, 0x8c, 0xed, 0x07, 0x83, 0xbf, 0x9a, 0xdb, 0xcb, 0x1f, 0xc7, 0x38, 0x7e,
+	0x7f, 0x59, 0x16, 0x55, 0x9e, 0xf4, 0xe3, 0x22, 0x2b, 0xca, 0x11, 0xfa, 0xcb, 0x64, 0x32, 0x59,
+	0x43, 0x0c, 0x9e, 0x30, 0x52, 0xde, 0x13, 0x2d, 0x45, 0x99, 0x10, 0xa0, 0x60, 0x38, 0xbf, 0x41,
+	0x80, 0x24, 0x4d, 0xd0, 0x5f, 0x9e, 0x0c, 0x06, 0xf5, 0x44, 0xbf, 0xc4, 0x49, 0x0a, 0x14, 0xa0,
+	0xa3, 0x56, 0xca, 0x0f, 0x0e, 0x04, 0xf4, 0x4d, 0x9f, 0x4e, 0x71, 0x52, 0x2c, 0x60, 0x4f, 0xf8,
+	0x0f, 0xf8, 0x8c, 0xca, 0xcb, 0x31, 0xee, 0x0c, 0x7a, 0xe2, 0xbf, 0xf0, 0xa8, 0x8b, 0xd2, 0x9c,
+	0x12, 0x06, 0xb0, 0x71, 0x55, 0x52, 0xbe, 0x74, 0x5e, 0xa4, 0x70, 0x9c, 0x72, 0xcd, 0xb9, 0xe3,
+	0x29, 0x89, 0xdf, 0x93, 0xa4, 0x3e, 0xbf, 0x67, 0xfb, 0x83, 0xc9, 0x41, 0x43, 0xac, 0x1e, 0x1c,
+	0x3c, 0x19, 0x68, 0xac, 0x27, 0x91, 0x52, 0x9e, 0x93, 0x48, 0xaa, 0xf6, 0xc9, 0xb8, 0x48, 0x6e,
+	0xcf, 0x76, 0x77, 0x4e, 0x92, 0xf4, 0x1a, 0xc5, 0x19, 0xa6, 0xf4, 0x34, 0xe0, 0x7c, 0xc5, 0x69,
+	0x4e, 0x4a, 0x50, 0xb7, 0x9d, 0x9d, 0x93, 0xe9, 0xd0, 0xaf, 0xf7, 0x30, 0xce, 0xa7, 0x8d, 0x85,
+	0x65, 0xb1, 0x10, 0x4b, 0x1c, 0x6c, 0x59, 0xff, 0x86, 0xf6, 0x1f, 0x23, 0xd0, 0xa0, 0x59, 0x7f,
+	0x5a, 0x94, 0xe9, 0xef, 0x1c, 0x7f, 0x86, 0xe0, 0x60, 0x9c, 0xfa, 0x39, 0xc2, 0x39, 0xce, 0x8a,
+	0xcb, 0x7e, 0x9a, 0xcf, 0x2b, 0x46, 0x25, 0x02, 0xd8, 0xf5, 0xf0, 0xec, 0x99, 0x18, 0x47, 0x72,
+	0x1c, 0xf6, 0x3b, 0x54, 0x53, 0x06, 0x72, 0x81, 0x53, 0x60, 0x09, 0xce, 0x4e, 0x32, 0x3c, 0x26,
+	0x99, 0xb3, 0xed, 0x3e, 0xe2, 0xa7, 0x29, 0xe1, 0x07, 0x31, 0x1b, 0x9c, 0x3d, 0x1b, 0x9c, 0x44,
+	0xe2, 0xe3, 0x99, 0x87, 0xc8, 0xe1, 0x20, 0xb0, 0x86, 0xe7, 0x65, 0x71, 0x59, 0x12, 0x30, 0x44,
+	0xef, 0x68, 0x7f, 0x8c, 0xcb, 0x00, 0x25, 0x98, 0xe1, 0xfe, 0x42, 0x30, 0xa8, 0x0f, 0x33, 0x73,
+	0x52, 0xb2, 0xdb, 0xd3, 0x40, 0xd2, 0x7e, 0x9e, 0x73, 0x84, 0x11, 0xac, 0xf5, 0xfc, 0x7d, 0x17,
+	0x87, 0x19, 0x6e, 0xf5, 0x30, 0xc3, 0xfb, 0x3d, 0xcc, 0xfe, 0x56, 0x0f, 0xb3, 0xbf, 0xfe, 0x30,
+	0xc6, 0xa7, 0x3b, 0x51, 0xe6, 0xaf, 0xf3, 0x31, 0x9d, 0x1f, 0xdf, 0x99, 0x16, 0x1f, 0x6c, 0x95,
+	0x57, 0x07, 0xf7, 0x2b, 0xf8, 0xc3, 0xad, 0x1e, 0xe6, 0xf0, 0x7e, 0x0f, 0x73, 0xb4, 0xd5, 0xc3,
+	0x1c, 0x6d, 0xa8, 0xc5, 0xcd, 0x87, 0x2f, 0xf7, 0xd7, 0x4d, 0x64, 0x32, 0x15, 0xfc, 0x85, 0x1c,
+	0x45, 0xe7, 0xd1, 0xcb, 0x3b, 0x73, 0xd6, 0x2f, 0xd6, 0x3a, 0x6b, 0xc0, 0x22, 0xcc, 0x4c, 0x8f,
+	0xaf, 0x44, 0xcc, 0x00, 0xb1, 0xdb, 0x39, 0x81, 0x05, 0x3c, 0x70, 0x42, 0x4c, 0x6e, 0x63, 0xa6,
+	0x22, 0x7d, 0x10, 0x44, 0x9a, 0x81, 0xab, 0xbb, 0x3d, 0x85, 0xdd, 0x28, 0xc9, 0x48, 0xcc, 0xac,
+	0xe3, 0x28, 0x82, 0xdb, 0x30, 0xff, 0x9a, 0xe6, 0x3f, 0x17, 0x09, 0xe1, 0x62, 0x2f, 0xe6, 0x3c,
+	0x3b, 0x41, 0xd7, 0x38, 0xab, 0x80, 0x24, 0x18, 0x39, 0xe7, 0xb4, 0x9f, 0x44, 0x72, 0xdc, 0x9d,
+	0x87, 0xc3, 0xbd, 0xac, 0xd8, 0x1a, 0x80, 0x7d, 0x85, 0x00, 0x75, 0xe6, 0x55, 0x96, 0x55, 0xf3,
+	0x6e, 0x03, 0x18, 0x49, 0x3a, 0xef, 0x5a, 0xb3, 0x5f, 0x0c, 0xb7, 0x29, 0x8c, 0xe1, 0xbd, 0x09,
+	0x63, 0xf8, 0x20, 0x84, 0xb1, 0xbf, 0x4d, 0x61, 0xec, 0xdf, 0x9b, 0x30, 0xf6, 0x1f, 0x84, 0x30,
+	0x0e, 0xb6, 0x29, 0x8c, 0x83, 0x7b, 0x13, 0xc6, 0xc1, 0x83, 0x10, 0xc6, 0xe1, 0x36, 0x85, 0x71,
+	0x78, 0x6f, 0xc2, 0x38, 0x7c, 0x10, 0xc2, 0x38, 0xda, 0xa6, 0x30, 0x8e, 0xee, 0x4d, 0x18, 0x47,
+	0x0f, 0x42, 0x18, 0x8f, 0xb7, 0x29, 0x8c, 0xc7, 0xf7, 0x26, 0x8c, 0xc7, 0x7f, 0x0a, 0x61, 0x7c,
+	0x6e, 0x81, 0x38, 0x5f, 0xcc, 0xee, 0xaf, 0x2e, 0x7c, 0xf1, 0x64, 0x9b, 0x22, 0x7e, 0x72, 0x6f,
+	0x22, 0x7e, 0xf2, 0x20, 0xec, 0xed, 0xdb, 0x6d, 0x0a, 0xe3, 0xdb, 0x7b, 0x13, 0xc6, 0xb7, 0x0f,
+	0x42, 0x18, 0x4f, 0xb7, 0x29, 0x8c, 0xa7, 0xf7, 0x26, 0x8c, 0xa7, 0x0f, 0xa3, 0x94, 0x1c, 0x6c,
+	0x37, 0x63, 0x46, 0x49, 0x4a, 0xf1, 0x38, 0x23, 0x09, 0xfa, 0x12, 0xb9, 0x28, 0x1c, 0x1e, 0x01,
+	0xbc, 0x22, 0x94, 0x94, 0xd7, 0x24, 0xd9, 0x02, 0xe7, 0x86, 0xdb, 0x4d, 0x6f, 0x1f, 0x10, 0xe7,
+	0xf6, 0xb7, 0x9b, 0x8b, 0x3e, 0x20, 0xce, 0x1d, 0x6c, 0x37, 0x71, 0xfc, 0xf3, 0x70, 0x6e, 0xa5,
+	0x7f, 0x5a, 0xff, 0x4b, 0xe3, 0x32, 0x9d, 0x33, 0x44, 0xcb, 0x58, 0x5e, 0xf6, 0x8e, 0xa2, 0x28,
+	0x06, 0xf7, 0x1c, 0xbe, 0xbb, 0xaa, 0x48, 0x79, 0x2b, 0xee, 0x78, 0xe5, 0xc7, 0xfe, 0x30, 0x1c,
+	0x0e, 0xc3, 0x03, 0x71, 0xa7, 0xfb, 0x8e, 0x77, 0x7a, 0x23, 0xb9, 0xd4, 0x40, 0x22, 0xd9, 0xc3,
+	0xc8, 0x0d, 0x8b, 0xde, 0xe1, 0x6b, 0x2c, 0x47, 0x79, 0x8e, 0xd8, 0x99, 0x54, 0x79, 0x2c, 0x88,
+	0xef, 0x5c, 0x66, 0xc5, 0x18, 0x67, 0xdd, 0x0f, 0x08, 0x88, 0xb9, 0xc6, 0x25, 0xca, 0x8b, 0x39,
+	0x3a, 0x45, 0xcd, 0x7c, 0x17, 0x7d, 0x58, 0x1e, 0xef, 0xaa, 0xc9, 0x8b, 0x6a, 0x2c, 0x91, 0xf0,
+	0x29, 0x13, 0x2a, 0x9e, 0xe2, 0x3c, 0x27, 0x59, 0x0f, 0xcd, 0x31, 0x9b, 0xf6, 0x50, 0x91, 0x3f,
+	0x87, 0x81, 0x4b, 0xf2, 0x1c, 0x67, 0x19, 0xbf, 0x4d, 0xec, 0x21, 0x5a, 0xc5, 0x31, 0xa1, 0xb4,
+	0x19, 0x98, 0x15, 0x79, 0xca, 0x8a, 0xf2, 0x9c, 0xdf, 0x4d, 0x02, 0x07, 0x61, 0x65, 0x35, 0xce,
+	0x52, 0x3a, 0xd5, 0x03, 0xb0, 0x2f, 0x67, 0x14, 0x9b, 0xa6, 0x34, 0x54, 0xd8, 0x61, 0x47, 0xf5,
+	0xe9, 0xb8, 0x9e, 0xe2, 0xfb, 0xc1, 0x38, 0xff, 0xa7, 0x19, 0xd4, 0xdb, 0xc3, 0x84, 0x4b, 0x09,
+	0xfa, 0xe3, 0x0f, 0x7e, 0x44, 0x01, 0x5b, 0xc3, 0x53, 0xe3, 0x58, 0xe7, 0x09, 0xac, 0xca, 0x21,
+	0x5e, 0xd5, 0x20, 0x0e, 0xa5, 0x30, 0xed, 0x8e, 0x00, 0xce, 0x41, 0x38, 0xd8, 0x17, 0x2b, 0x9c,
+	0x63, 0x70, 0xda, 0x9c, 0x11, 0x09, 0x7d, 0x24, 0xa0, 0x1d, 0xb6, 0x00, 0xb4, 0x3b, 0x62, 0xd0,
+	0x6b, 0x50, 0x5c, 0xe5, 0x25, 0xb9, 0x4c, 0x29, 0x60, 0xb4, 0xc4, 0xe0, 0x2c, 0x56, 0x3c, 0xdc,
+	0x29, 0x09, 0xab, 0xca, 0x5c, 0x33, 0x2f, 0x8c, 0xb3, 0x94, 0xe4, 0x2c, 0x4c, 0xf3, 0xeb, 0xe2,
+	0x3d, 0xe9, 0x48, 0xcc, 0x41, 0x64, 0xca, 0xf6, 0x02, 0x28, 0x4d, 0x63, 0x12, 0xfd, 0xbb, 0xde,
+	0xc6, 0x9c, 0x0d, 0x7a, 0x72, 0x8d, 0x44, 0xbe, 0xb3, 0x63, 0xce, 0x3d, 0x97, 0x7b, 0x8c, 0x9a,
+	0xcd, 0xe4, 0xbf, 0xe7, 0x49, 0xcf, 0x03, 0x7d, 0x9e, 0x8c, 0x90, 0x47, 0x02, 0x12, 0x72, 0xa9,
+	0x56, 0x18, 0xca, 0x5a, 0x12, 0x5a, 0x65, 0x4c, 0x1f, 0x6b, 0x85, 0x7d, 0x9d, 0xae, 0xe2, 0xd3,
+	0xb2, 0x1b, 0x8e, 0xd3, 0x3c, 0xe9, 0x70, 0xdc, 0x5d, 0x31, 0x24, 0x67, 0x96, 0x96, 0xd8, 0xbd,
+	0x2c, 0x8c, 0x35, 0xef, 0xbe, 0x90, 0x75, 0xaf, 0xee, 0x9c, 0x71, 0xbf, 0x2a, 0x87, 0xf6, 0x53,
+	0x9a, 0xbf, 0x1f, 0x49, 0x43, 0x53, 0x33, 0x3f, 0xdb, 0xfa, 0x38, 0x5a, 0x31, 0x2e, 0x8d, 0xc1,
+	0xd6, 0xc4, 0x91, 0xab, 0x9a, 0x1b, 0xf3, 0xdd, 0x6f, 0x35, 0x12, 0xea, 0xb8, 0x45, 0x36, 0x42,
+	0x16, 0x7a, 0x32, 0x9d, 0xa0, 0x0e, 0xd2, 0xac, 0x46, 0x5d, 0x8d, 0x77, 0x27, 0xf6, 0x42, 0x2f,
+	0x3f, 0x47, 0xaa, 0x21, 0xc7, 0xd5, 0xe0, 0xf1, 0x3b, 0xb1, 0xe7, 0xb5, 0x67, 0x31, 0x34, 0x40,
+	0xc8, 0xb8, 0x07, 0x66, 0xc7, 0xd2, 0x49, 0x1a, 0x63, 0x3e, 0xfa, 0xaf, 0x8a, 0x54, 0xe4, 0x22,
+	0xfd, 0x9d, 0x08, 0xdf, 0x56, 0x12, 0xcc, 0x88, 0x63, 0x64, 0xd2, 0x51, 0x89, 0xa5, 0xdc, 0x4f,
+	0x89, 0x0f, 0x96, 0x47, 0x12, 0x8b, 0xa4, 0x47, 0xb2, 0xd6, 0xdb, 0xae, 0xa8, 0x96, 0xba, 0xe9,
+	0x85, 0x56, 0xd8, 0x4d, 0x61, 0xf6, 0xcd, 0xdb, 0x66, 0x2e, 0xe3, 0x27, 0xce, 0x2f, 0x18, 0x2e,
+	0x19, 0xe1, 0x2b, 0x27, 0x38, 0xa3, 0xa4, 0x65, 0xe9, 0x8b, 0x54, 0x9c, 0x13, 0x97, 0xb7, 0x00,
+	0xc8, 0x7d, 0xbb, 0xda, 0x9e, 0xb3, 0x26, 0x16, 0x94, 0xd9, 0x18, 0xc4, 0xb8, 0xa4, 0xea, 0x27,
+	0x4c, 0xd9, 0x2f, 0x06, 0x57, 0x04, 0x95, 0x83, 0x63, 0x2f, 0xfb, 0x5b, 0x43, 0xc5, 0x5d, 0x47,
+	0x08, 0x19, 0xb5, 0xc8, 0xc2, 0xd9, 0x10, 0x46, 0x2c, 0x49, 0x0b, 0x4d, 0x68, 0x8f, 0x4f, 0x1d,
+	0xd3, 0x89, 0x36, 0xab, 0xb4, 0x66, 0xae, 0x63, 0xe3, 0x1b, 0x67, 0x73, 0xc7, 0x30, 0xde, 0x4a,
+	0x62, 0x4c, 0x08, 0xa5, 0xd7, 0xae, 0x85, 0x58, 0x1b, 0x4b, 0x18, 0x4b, 0xe5, 0x37, 0x60, 0x89,
+	0x5c, 0xb5, 0x4a, 0x6d, 0x38, 0xaf, 0xe8, 0xb4, 0xe3, 0x90, 0xa1, 0xa0, 0x85, 0x2d, 0x7e, 0xe5,
+	0xd1, 0xa3, 0xda, 0xde, 0xbd, 0x3a, 0xc6, 0xca, 0x8a, 0xa8, 0x83, 0x2c, 0x70, 0x6a, 0xe9, 0x85,
+	0x63, 0x7a, 0xda, 0x80, 0x95, 0x2f, 0xf5, 0x31, 0x63, 0x69, 0x2b, 0x51, 0x95, 0x7f, 0x54, 0x8d,
+	0xcc, 0xe3, 0xad, 0x28, 0x8f, 0xa9, 0x1a, 0x96, 0x34, 0xf2, 0x84, 0xdc, 0x70, 0xda, 0x57, 0x19,
+	0x94, 0xf2, 0xa9, 0x97, 0x13, 0x9f, 0x10, 0x04, 0x83, 0x56, 0xd1, 0x7c, 0x75, 0x8a, 0xfa, 0x43,
+	0x87, 0x49, 0x16, 0xce, 0x37, 0x2b, 0x6b, 0xde, 0x1a, 0x27, 0xeb, 0xb4, 0xa8, 0x9c, 0x00, 0x5c,
+	0x3d, 0x51, 0xab, 0xeb, 0x85, 0x9f, 0xe6, 0x19, 0x44, 0x1c, 0x1f, 0x92, 0x61, 0xf7, 0xf8, 0x13,
+	0x22, 0x65, 0x0f, 0x6d, 0x40, 0x47, 0xb7, 0x11, 0xe8, 0x06, 0xd1, 0xd4, 0x89, 0xa2, 0x1b, 0x47,
+	0x4f, 0xe9, 0x22, 0x3d, 0x9e, 0x3a, 0xe8, 0x21, 0x15, 0x43, 0x7f, 0xf1, 0xb9, 0xe7, 0x91, 0xdf,
+	0x6b, 0xb7, 0x87, 0x34, 0x8b, 0xad, 0xa6, 0xf3, 0xb5, 0x83, 0x99, 0xb4, 0x11, 0xed, 0x1e, 0xbb,
+	0x3a, 0x5c, 0x59, 0xbe, 0xbd, 0xd1, 0xfa, 0x1e, 0xb2, 0xd1, 0xd5, 0x52, 0x68, 0xfc, 0xab, 0x61,
+	0x3d, 0x5f, 0x14, 0xd6, 0x6a, 0xd7, 0x0d, 0x2c, 0x2e, 0x6f, 0xff, 0x5e, 0x12, 0xa8, 0x0d, 0xf2,
+	0x98, 0xbb, 0xf6, 0xe1, 0x00, 0xfe, 0x1c, 0xa3, 0x28, 0x7a, 0x3d, 0x25, 0x68, 0x52, 0x4f, 0x60,
+	0x86, 0x16, 0xd3, 0x34, 0x9e, 0x22, 0x56, 0xc8, 0x35, 0xbc, 0x2a, 0xcb, 0xa1, 0x46, 0x49, 0xf3,
+	0xcb, 0x1e, 0x4a, 0x73, 0x34, 0x4b, 0x33, 0x30, 0x75, 0x02, 0xa3, 0x09, 0x35, 0x37, 0x70, 0x8d,
+	0xdc, 0x92, 0x73, 0xb6, 0x12, 0x19, 0xb4, 0x5d, 0xa4, 0x93, 0x8e, 0xa8, 0x43, 0x8a, 0x89, 0x0f,
+	0xe8, 0xf4, 0x14, 0x05, 0x15, 0x28, 0xda, 0x24, 0xcd, 0x49, 0x12, 0x34, 0xc6, 0x94, 0xf9, 0x22,
+	0x4d, 0x6b, 0x14, 0xf2, 0x38, 0x99, 0xcd, 0x55, 0xed, 0x37, 0xe7, 0x5c, 0x75, 0x92, 0xe6, 0xcd,
+	0xce, 0x6c, 0xc1, 0xf6, 0xd0, 0x2a, 0x31, 0x23, 0xb4, 0x4a, 0xbc, 0x47, 0xff, 0x4c, 0x3d, 0xa5,
+	0x4d, 0x66, 0x05, 0xb5, 0x26, 0x68, 0x1a, 0xe7, 0x77, 0x2a, 0x62, 0x2b, 0xfc, 0x73, 0x62, 0xe9,
+	0x34, 0x38, 0x62, 0x92, 0x5f, 0x42, 0xb5, 0x83, 0xd2, 0x6f, 0xbe, 0x69, 0x18, 0xa6, 0x8b, 0x37,
+	0x4b, 0x3e, 0xd6, 0xba, 0x37, 0xe9, 0x5b, 0xad, 0x86, 0x52, 0x9d, 0xd7, 0xc7, 0x34, 0xd3, 0x9d,
+	0x5f, 0x38, 0x01, 0xcd, 0xd8, 0x75, 0xe7, 0xb3, 0xb1, 0xd4, 0x55, 0x9a, 0xc5, 0x8a, 0xf0, 0x3f,
+	0xbc, 0x9a, 0x96, 0x7f, 0xd7, 0x66, 0xa3, 0x08, 0xb6, 0xe0, 0x40, 0x23, 0xce, 0xd6, 0xe4, 0x25,
+	0xb5, 0x89, 0x82, 0xd1, 0xad, 0x49, 0x5e, 0x1c, 0x94, 0xf5, 0x86, 0x4b, 0x3b, 0xf3, 0xfc, 0x78,
+	0x84, 0xf3, 0x59, 0x71, 0x38, 0xc1, 0x69, 0x66, 0xb9, 0x1c, 0xb0, 0x41, 0x0a, 0x99, 0xa5, 0x6c,
+	0x5f, 0xf4, 0x10, 0x29, 0xcb, 0xa2, 0xd4, 0x2e, 0x48, 0x1c, 0x51, 0x81, 0x80, 0xb5, 0xe3, 0xe4,
+	0x16, 0x62, 0x2d, 0xcf, 0x18, 0x4f, 0xd1, 0x61, 0x93, 0x21, 0x47, 0xd1, 0x6f, 0x04, 0x4d, 0xf1,
+	0x35, 0x01, 0x50, 0x65, 0xb8, 0xe0, 0x4f, 0xc6, 0x15, 0x14, 0xfb, 0x60, 0xe6, 0xa2, 0xfd, 0x50,
+	0xc2, 0x3c, 0xe5, 0xf7, 0x44, 0x97, 0x05, 0x83, 0x88, 0x8d, 0x8a, 0xaa, 0x4e, 0xe0, 0x0c, 0x6f,
+	0xa6, 0x77, 0xba, 0x24, 0xec, 0x15, 0xa1, 0x73, 0x90, 0x1b, 0xf9, 0x11, 0x36, 0x85, 0xb8, 0x14,
+	0x3c, 0x97, 0xef, 0x9f, 0xfb, 0xaf, 0xc1, 0x6c, 0x83, 0x2e, 0x27, 0x20, 0xc0, 0x73, 0x1e, 0x63,
+	0xc4, 0xd1, 0xa3, 0x77, 0x14, 0x8c, 0xa4, 0x6b, 0xe9, 0x9d, 0x6c, 0xb9, 0xfc, 0x70, 0x13, 0x13,
+	0x1d, 0xa8, 0xff, 0x79, 0xf1, 0xf2, 0x17, 0x28, 0xce, 0x4b, 0x4a, 0x3a, 0xcd, 0x99, 0xe4, 0x36,
+	0xaf, 0xc9, 0x0d, 0xeb, 0x5a, 0xaa, 0xe8, 0x2c, 0x0f, 0xf9, 0xc6, 0x62, 0x5b, 0xf9, 0x3e, 0xf8,
+	0x3c, 0x87, 0xd4, 0x26, 0x4d, 0x3c, 0xf6, 0x58, 0x2f, 0x31, 0xe8, 0xb1, 0xdd, 0x65, 0xa7, 0x1b,
+	0x26, 0x45, 0x4e, 0x3a, 0x2b, 0x21, 0xa9, 0xdd, 0xda, 0x3c, 0x11, 0xb6, 0xc5, 0xe4, 0xfc, 0x51,
+	0x3f, 0x7d, 0x6b, 0xec, 0xde, 0x80, 0x2e, 0xeb, 0x8f, 0x4b, 0x43, 0x53, 0x0c, 0x1d, 0xa7, 0x84,
+	0xbd, 0x4e, 0x67, 0xa4, 0xa8, 0x58, 0xa7, 0x85, 0xdc, 0x76, 0x2d, 0xec, 0xb5, 0x9b, 0x82, 0xb1,
+	0x83, 0x93, 0x4d, 0xda, 0x21, 0xa3, 0x81, 0x5b, 0x12, 0xc8, 0xfd, 0xd1, 0x06, 0x82, 0x31, 0x37,
+	0xa2, 0x3f, 0x15, 0x94, 0x79, 0xe5, 0xb1, 0x8e, 0xea, 0x81, 0xb1, 0x2b, 0xb2, 0xff, 0x38, 0xb5,
+	0x1f, 0xa7, 0xe9, 0x03, 0x5a, 0xf9, 0xb3, 0xbb, 0x19, 0xef, 0xbe, 0x8c, 0x73, 0x1b, 0xf1, 0x4d,
+	0x12, 0xba, 0x2a, 0xdb, 0xe5, 0xae, 0x4a, 0x6f, 0xe1, 0x7f, 0xb2, 0xd9, 0x16, 0x4a, 0xee, 0x3d,
+	0xd7, 0xc5, 0x62, 0x43, 0x70, 0x55, 0x42, 0x4e, 0xff, 0xee, 0x5f, 0xbc, 0xbd, 0xa7, 0xd4, 0x8c,
+	0xeb, 0xe6, 0x23, 0x80, 0x91, 0x83, 0x75, 0x41, 0x46, 0xbd, 0x35, 0x6c, 0x5d, 0x30, 0x72, 0x10,
+	0xe1, 0x5c, 0x74, 0xda, 0x66, 0x14, 0x8c, 0x7a, 0x5e, 0x12, 0xf1, 0xdf, 0x1f, 0x5f, 0x59, 0x14,
+	0xc8, 0xc6, 0x25, 0xed, 0x36, 0xf9, 0x73, 0x0a, 0xc8, 0x4b, 0x09, 0xf6, 0x28, 0xc4, 0xef, 0xf0,
+	0x4d, 0x0d, 0x73, 0x6c, 0x06, 0x5c, 0x0d, 0x66, 0xa7, 0x2e, 0xcd, 0x46, 0x2f, 0xc8, 0x04, 0x28,
+	0x22, 0xc9, 0xc7, 0x37, 0xe4, 0xf6, 0xea, 0xa1, 0x5b, 0xcc, 0x71, 0x8f, 0xda, 0x36, 0x87, 0xb3,
+	0x05, 0xbe, 0xa5, 0x6d, 0xb3, 0x45, 0x5d, 0x38, 0xeb, 0x4f, 0x7f, 0xfc, 0xa1, 0xcb, 0x5f, 0xf7,
+	0x9c, 0x35, 0x1f, 0xa5, 0x79, 0x73, 0x82, 0xd6, 0xf5, 0x88, 0xa4, 0xeb, 0xae, 0xd7, 0x7f, 0x25,
+	0x11, 0xd4, 0x21, 0x48, 0x4f, 0x48, 0x47, 0x54, 0xaf, 0x55, 0x6a, 0xc3, 0xf5, 0x5a, 0x01, 0x5a,
+	0x07, 0x97, 0x15, 0x9b, 0x0b, 0xad, 0x98, 0xcd, 0xc9, 0x32, 0x93, 0x1e, 0x41, 0x26, 0xe7, 0xcd,
+	0x5d, 0x90, 0x29, 0xa2, 0xd6, 0x1a, 0x32, 0x2d, 0x19, 0x7c, 0x3a, 0x99, 0x10, 0xa7, 0xec, 0xdc,
+	0x91, 0x1f, 0xbb, 0x27, 0x24, 0xfb, 0x11, 0x42, 0x3f, 0x6c, 0xc4, 0xd0, 0x8f, 0x1c, 0x44, 0x3a,
+	0x92, 0x76, 0x8e, 0xf3, 0xa1, 0x1a, 0x95, 0xe7, 0xa8, 0x82, 0x4e, 0xcb, 0xe4, 0xd7, 0x9e, 0x56,
+	0x2a, 0xe5, 0x5d, 0x88, 0x45, 0x62, 0x5a, 0x27, 0x18, 0xc7, 0x00, 0x3e, 0x5d, 0x34, 0xe4, 0x86,
+	0xc4, 0x15, 0x23, 0xbe, 0x0a, 0x6e, 0xc7, 0x34, 0x0f, 0xb2, 0x68, 0xbc, 0x87, 0xe3, 0x0d, 0x1c,
+	0xe1, 0x18, 0x52, 0xc6, 0x0c, 0x43, 0x5d, 0x04, 0xb1, 0xff, 0x42, 0x65, 0x3f, 0xef, 0xae, 0x00,
+	0xac, 0x11, 0x2a, 0x7d, 0x21, 0xcd, 0xcc, 0xa8, 0x8c, 0x84, 0x7c, 0x5e, 0xc0, 0x42, 0x18, 0xe6,
+	0xeb, 0xcd, 0xe1, 0xd7, 0x35, 0x26, 0xbe, 0xa6, 0xfe, 0xc1, 0x04, 0x11, 0x1b, 0x70, 0xdf, 0x79,
+	0xa5, 0xfd, 0x12, 0x77, 0xe5, 0x2e, 0x9d, 0x4e, 0x92, 0x26, 0x80, 0x6d, 0x42, 0x85, 0x27, 0x7d,
+	0x3d, 0x2d, 0x8b, 0x45, 0x6e, 0x90, 0xfb, 0x77, 0x69, 0x6e, 0x2e, 0xb9, 0xbe, 0x4d, 0x37, 0x21,
+	0x98, 0x93, 0xf1, 0x43, 0xb3, 0x11, 0xc0, 0x18, 0xdb, 0xba, 0xc4, 0x43, 0xde, 0xd2, 0x71, 0xb2,
+	0x16, 0x5b, 0x95, 0x8d, 0x84, 0xa5, 0xc5, 0x6c, 0x2c, 0x78, 0xc8, 0x59, 0x6a, 0x9d, 0xf6, 0xe0,
+	0xb6, 0xcd, 0xc0, 0xc4, 0xed, 0x35, 0x39, 0x0b, 0xdc, 0x40, 0xed, 0xc1, 0xec, 0xaa, 0xec, 0x3a,
+	0xdc, 0xca, 0x00, 0x9c, 0x25, 0x06, 0x7e, 0x5f, 0x24, 0x72, 0x3a, 0x15, 0x7c, 0xfb, 0x9b, 0x69,
+	0x29, 0x1a, 0x03, 0x6d, 0x21, 0xf1, 0x19, 0xc4, 0x38, 0xc3, 0x04, 0xb4, 0x82, 0xf7, 0x50, 0x45,
+	0x89, 0x58, 0xd8, 0xfd, 0x60, 0xf4, 0xcd, 0xf4, 0x60, 0xed, 0x9e, 0x9a, 0x2e, 0x57, 0xab, 0x91,
+	0x2c, 0x91, 0xc8, 0xb0, 0xd4, 0x02, 0xd5, 0xbf, 0x74, 0x6d, 0xcb, 0x08, 0x98, 0xae, 0x8d, 0x49,
+	0x68, 0xcd, 0x10, 0x4f, 0xbe, 0xa3, 0x8f, 0xa8, 0x5b, 0x43, 0x83, 0xde, 0xd0, 0x6e, 0xbd, 0xd7,
+	0x00, 0x92, 0xe1, 0x50, 0x4a, 0x0d, 0x9a, 0x92, 0x49, 0x4f, 0xbe, 0x19, 0xbc, 0xd5, 0x2e, 0xc1,
+	0xe8, 0x17, 0xed, 0xda, 0x3b, 0xe8, 0xc6, 0x22, 0xb7, 0x65, 0x6d, 0x5a, 0x93, 0x8e, 0x8b, 0x1f,
+	0x72, 0xc6, 0xa1, 0xc6, 0xaf, 0xa8, 0x77, 0x31, 0x37, 0x7c, 0x6b, 0x91, 0x9d, 0x20, 0x1c, 0x32,
+	0xa4, 0x90, 0xd7, 0xd7, 0xe7, 0xaa, 0x5d, 0xb7, 0x17, 0xed, 0x89, 0x0a, 0x45, 0x8c, 0x8b, 0xbd,
+	0x8c, 0x9e, 0x9c, 0xec, 0x25, 0x96, 0xdc, 0x4c, 0xe1, 0x6f, 0x99, 0x99, 0x98, 0xac, 0xb7, 0xe7,
+	0xd1, 0x37, 0x28, 0x88, 0x02, 0x3b, 0x7f, 0x89, 0x22, 0x74, 0x3e, 0x41, 0xb7, 0xbc, 0x84, 0x52,
+	0xdf, 0x55, 0x54, 0x25, 0x16, 0xcf, 0xfe, 0x52, 0xa8, 0x68, 0x10, 0xae, 0x78, 0x40, 0x63, 0x2a,
+	0x69, 0x84, 0xda, 0x8e, 0x88, 0x52, 0x4c, 0x3a, 0x65, 0x58, 0xce, 0x16, 0x05, 0x9a, 0xa4, 0x24,
+	0x4b, 0x68, 0xd8, 0xb4, 0x37, 0x01, 0x49, 0x8e, 0x67, 0x44, 0xa5, 0x1a, 0x3d, 0xe3, 0x36, 0x93,
+	0xd2, 0x45, 0x51, 0xae, 0x5c, 0x41, 0xb6, 0x93, 0x51, 0x41, 0x22, 0x03, 0xa2, 0xc7, 0x39, 0x22,
+	0xb3, 0x31, 0x49, 0x12, 0x28, 0x06, 0xe7, 0x19, 0x66, 0xfc, 0xca, 0x1a, 0x65, 0xe9, 0x7b, 0xc2,
+	0x69, 0x51, 0x18, 0xb0, 0xfc, 0x96, 0x65, 0x0f, 0xa5, 0x0c, 0x0a, 0xb6, 0x7c, 0x8f, 0xa1, 0x31,
+	0x41, 0xfc, 0x2a, 0x9b, 0xb7, 0x82, 0xe6, 0x65, 0xc1, 0xdb, 0x7c, 0x68, 0x56, 0x65, 0x2c, 0x9d,
+	0x67, 0x44, 0x57, 0xa2, 0x94, 0x37, 0x8c, 0x1a, 0x1c, 0x94, 0x53, 0xcd, 0x20, 0xd3, 0x86, 0x1d,
+	0x13, 0x4e, 0x10, 0x9a, 0xe1, 0x5b, 0x04, 0x35, 0x24, 0xa2, 0x05, 0x0c, 0xf2, 0xd2, 0x51, 0xf4,
+	0x92, 0x80, 0xa4, 0x57, 0x64, 0x02, 0xe7, 0x4c, 0x02, 0xe9, 0xc7, 0x38, 0x95, 0x0a, 0xc7, 0x1c,
+	0x5f, 0x02, 0xdf, 0x16, 0x29, 0xa8, 0x05, 0x46, 0x59, 0xc1, 0x50, 0x31, 0x81, 0xb1, 0x12, 0x0c,
+	0x1a, 0x92, 0x58, 0xbd, 0x6d, 0x88, 0x2e, 0x08, 0xe3, 0x3d, 0x29, 0x11, 0xa9, 0x38, 0x85, 0xdc,
+	0xd1, 0xc2, 0xaa, 0x2c, 0xd3, 0xc7, 0x81, 0x6d, 0xae, 0x79, 0x81, 0x8c, 0xf5, 0x22, 0x74, 0x25,
+	0x0c, 0xb1, 0x90, 0xd1, 0x4d, 0xb5, 0x80, 0x04, 0xa1, 0x33, 0x0c, 0x9c, 0xa0, 0x55, 0xc9, 0xd9,
+	0x01, 0xe7, 0xc1, 0x35, 0x92, 0xe6, 0x94, 0x30, 0x27, 0xf2, 0x3c, 0xf8, 0x7f, 0x1f, 0xb3, 0x3e,
+	0xee, 0xf3, 0x53, 0x5a, 0x22, 0x7b, 0x25, 0x61, 0xb5, 0xef, 0x68, 0x6e, 0x48, 0x8c, 0x1e, 0x1d,
+	0x4e, 0x3c, 0x77, 0x1d, 0xb1, 0xff, 0x3a, 0xb6, 0xf1, 0x36, 0x1d, 0xdd, 0x42, 0x86, 0xf2, 0x6a,
+	0x84, 0xf6, 0xfe, 0xf1, 0xc3, 0xeb, 0x3d, 0xd5, 0x30, 0x02, 0xb5, 0x54, 0x3d, 0x27, 0xa5, 0xa0,
+	0x7c, 0x8b, 0x00, 0x3e, 0x18, 0xd7, 0x7f, 0xf2, 0x3b, 0xd4, 0x17, 0x24, 0x4f, 0x46, 0xa6, 0x36,
+	0xaa, 0x72, 0x9e, 0xba, 0x6d, 0x89, 0xa5, 0xea, 0x4e, 0x3a, 0x27, 0x92, 0x93, 0xbe, 0xa8, 0x5d,
+	0x17, 0xbc, 0xf5, 0xe5, 0x1c, 0x1f, 0x95, 0x2d, 0x1a, 0x79, 0xa1, 0x52, 0x5f, 0x56, 0x48, 0x1c,
+	0x1b, 0xb5, 0x3d, 0xec, 0x78, 0x5a, 0xe2, 0x94, 0x12, 0x11, 0xfe, 0x3a, 0x3e, 0x28, 0x8d, 0xdf,
+	0x77, 0x57, 0xb0, 0x28, 0x53, 0x27, 0x65, 0x91, 0x5c, 0xbf, 0x96, 0xf4, 0x7d, 0x2a, 0xf3, 0x7f,
+	0x7d, 0x79, 0xd1, 0xca, 0xfd, 0x3d, 0xb1, 0xd7, 0xde, 0xe7, 0xb2, 0x5f, 0x2d, 0xe0, 0xdc, 0x1b,
+	0xa1, 0x0f, 0x82, 0xbe, 0x91, 0x24, 0x73, 0x79, 0x57, 0x92, 0xe1, 0x46, 0xf2, 0x7f, 0x93, 0x49,
+	0x2d, 0x92, 0x19, 0x11, 0x29, 0xdb, 0x7d, 0xda, 0x01, 0xdf, 0x22, 0xf8, 0x32, 0x41, 0xdc, 0x91,
+	0x21, 0xfc, 0x09, 0x4c, 0x40, 0x76, 0xb9, 0x3d, 0x1c, 0xc7, 0xe5, 0x65, 0x35, 0x03, 0x3e, 0xd0,
+	0x86, 0xf9, 0x3d, 0xe1, 0xbe, 0x8b, 0xaa, 0xbe, 0xcd, 0x57, 0x3f, 0xf2, 0xa4, 0x54, 0x7d, 0x82,
+	0xc2, 0x58, 0x5e, 0x1e, 0x88, 0xf9, 0x1a, 0x07, 0x40, 0x34, 0x9f, 0x8d, 0xe2, 0x39, 0x6e, 0x1e,
+	0xaf, 0xc4, 0xc6, 0xab, 0x15, 0x2b, 0x2f, 0x59, 0xda, 0xcd, 0x82, 0x8d, 0xac, 0x4f, 0x91, 0x33,
+	0xd2, 0x74, 0x7d, 0xae, 0xbd, 0xad, 0xe8, 0x8e, 0x64, 0x97, 0xa3, 0x3d, 0xd2, 0x2a, 0x1b, 0x86,
+	0x35, 0xa3, 0xaf, 0x05, 0x69, 0xe2, 0x19, 0x55, 0xf0, 0x99, 0x8a, 0x63, 0x56, 0x7a, 0x89, 0xa8,
+	0x67, 0x4e, 0x51, 0x10, 0xd4, 0x19, 0x57, 0xec, 0xde, 0xca, 0x19, 0x45, 0x5d, 0x3d, 0x67, 0x74,
+	0x54, 0x05, 0x4e, 0xab, 0x47, 0xfe, 0xff, 0xd1, 0x3b, 0x91, 0x2c, 0x28, 0x16, 0x98, 0x19, 0xb3,
+	0x8e, 0xaa, 0x86, 0xc9, 0x9b, 0xfd, 0x24, 0xc6, 0xb3, 0x9f, 0xec, 0x95, 0x0e, 0xbd, 0xa7, 0x56,
+	0x1b, 0x06, 0x16, 0x3c, 0x33, 0x34, 0x4e, 0xb7, 0x70, 0x3c, 0xb5, 0x43, 0x9d, 0x2a, 0x78, 0x8a,
+	0x1d, 0x79, 0x23, 0x76, 0x25, 0xee, 0xf1, 0x24, 0x54, 0x73, 0xfd, 0xe1, 0x12, 0xf0, 0x06, 0x40,
+	0x42, 0x79, 0x4f, 0x0f, 0x9f, 0x14, 0x90, 0x49, 0x86, 0xcc, 0x71, 0x75, 0x6e, 0xcd, 0x6f, 0x78,
+	0xe4, 0x0a, 0xfd, 0xac, 0xe6, 0x59, 0xac, 0x7f, 0x2f, 0xca, 0x55, 0x28, 0x3f, 0xd7, 0x0f, 0x6e,
+	0x30, 0xff, 0x95, 0x20, 0x7c, 0xfc, 0x57, 0xe3, 0xb9, 0xce, 0x7f, 0xa4, 0xe7, 0xe7, 0xc3, 0x32,
+	0x88, 0x6a, 0x3c, 0x7a, 0x43, 0x85, 0x4a, 0xff, 0x68, 0x17, 0x7f, 0x32, 0x56, 0xec, 0x3a, 0xb5,
+	0xbc, 0xbe, 0xe9, 0x0a, 0xa2, 0x9f, 0x0d, 0xa1, 0x04, 0x3d, 0xf4, 0x41, 0x1f, 0x73, 0x24, 0x7b,
+	0xf2, 0x94, 0x95, 0x90, 0x55, 0xa5, 0x93, 0xdb, 0x8e, 0x79, 0xc4, 0xee, 0xd2, 0x7a, 0x02, 0x61,
+	0x2a, 0xad, 0xaf, 0xd6, 0xe4, 0xf1, 0xdf, 0x57, 0x62, 0x4a, 0xb6, 0xcb, 0x36, 0xbf, 0xaa, 0xd9,
+	0x8d, 0x6b, 0x27, 0x8f, 0xf4, 0x01, 0xc8, 0x23, 0x0e, 0x89, 0x80, 0xcb, 0xc4, 0x2a, 0x5a, 0x1c,
+	0xc8, 0xb0, 0x79, 0x3f, 0x54, 0x5f, 0x26, 0xb4, 0x40, 0x74, 0x6a, 0x9c, 0xaf, 0xe4, 0xb5, 0xaf,
+	0xdd, 0xc0, 0xb1, 0xfc, 0xb9, 0xef, 0xe5, 0x85, 0xef, 0x42, 0x36, 0x6e, 0xbb, 0xa2, 0xb6, 0xfc,
+	0x70, 0xcb, 0x23, 0x22, 0x37, 0x14, 0xae, 0x3c, 0x31, 0xd0, 0xb8, 0xea, 0x76, 0x90, 0x1b, 0x7b,
+	0x64, 0x07, 0xdb, 0xb3, 0xa4, 0xe7, 0xc3, 0xb3, 0x7a, 0x17, 0x2d, 0x75, 0xc7, 0x54, 0x29, 0x55,
+	0x87, 0x1a, 0xed, 0x64, 0xe7, 0x09, 0x8d, 0x9a, 0x51, 0x6d, 0xf3, 0x96, 0x93, 0xad, 0xbc, 0x09,
+	0x85, 0x2d, 0xbd, 0xa4, 0x5b, 0xcd, 0xf7, 0x9a, 0x2e, 0xe5, 0xc8, 0x5a, 0xfa, 0xdb, 0x35, 0x75,
+	0xc7, 0xce, 0x83, 0x12, 0x73, 0xd8, 0x7e, 0xd2, 0xe4, 0xc1, 0x24, 0xae, 0xeb, 0x79, 0x69, 0xe1,
+	0x3e, 0x73, 0xba, 0xb2, 0xdb, 0x02, 0xee, 0x5b, 0xd2, 0xb6, 0x7c, 0xe6, 0xe3, 0xef, 0x72, 0x3e,
+	0xf2, 0x40, 0x45, 0x4e, 0x7d, 0xbf, 0xfa, 0xfa, 0xd3, 0x78, 0x7f, 0x22, 0xef, 0xd0, 0x57, 0x9e,
+	0x9e, 0x9e, 0x42, 0x24, 0xd9, 0xd3, 0x84, 0xed, 0xd5, 0x4d, 0x08, 0x13, 0xa7, 0xb3, 0xc4, 0x14,
+	0x79, 0x9b, 0xda, 0xd5, 0x1c, 0xd2, 0xf8, 0xae, 0x9a, 0x5a, 0x5f, 0xdb, 0xfa, 0x5c, 0xf8, 0x36,
+	0xf3, 0x19, 0xa2, 0xe6, 0xc7, 0xa8, 0xe1, 0x8c, 0x9a, 0x99, 0x6d, 0xf8, 0x40, 0x71, 0xfe, 0x91,
+	0x07, 0x8a, 0x3d, 0xff, 0x6b, 0x96, 0x51, 0xc3, 0x43, 0xa7, 0x51, 0xb6, 0xaa, 0xe5, 0xad, 0x96,
+	0x76, 0xaa, 0x2c, 0xed, 0xeb, 0xaf, 0xd1, 0x57, 0x6b, 0x59, 0x82, 0x6a, 0x1e, 0xaf, 0xd3, 0x2c,
+	0xa3, 0x2f, 0xb8, 0xde, 0x5d, 0x74, 0xf6, 0x07, 0x83, 0x1e, 0xf2, 0x75, 0x71, 0x2c, 0xfd, 0xfb,
+	0x02, 0x9d, 0xfb, 0xde, 0x78, 0x05, 0xb4, 0x99, 0x31, 0x38, 0x6e, 0xff, 0xca, 0x68, 0xe5, 0xf4,
+	0x87, 0x3c, 0x06, 0x9c, 0xc9, 0x58, 0xd0, 0xef, 0xdb, 0xf7, 0xc0, 0x24, 0x23, 0x33, 0x0d, 0x6f,
+	0xbe, 0x37, 0xf0, 0x79, 0x24, 0xdf, 0x0b, 0xaf, 0x4e, 0x7d, 0x69, 0xc8, 0x31, 0x85, 0xa6, 0x72,
+	0xa9, 0x21, 0x57, 0xb3, 0xd4, 0xb0, 0xfb, 0x78, 0xd0, 0x9e, 0x6d, 0xd1, 0x36, 0xbd, 0x8b, 0xef,
+	0x11, 0xac, 0x7e, 0x84, 0xd3, 0x28, 0xbf, 0x6a, 0xa5, 0xa5, 0x46, 0x2b, 0xcd, 0xf7, 0x2e, 0x55,
+	0x15, 0xd9, 0xc6, 0x2d, 0xc3, 0xc6, 0x87, 0x77, 0x25, 0xfc, 0xe9, 0x2f, 0x22, 0xcd, 0xb6, 0x99,
+	0x9d, 0xaa, 0x15, 0xb9, 0x48, 0xf1, 0xd6, 0x5d, 0x44, 0xd8, 0x17, 0x86, 0xbe, 0xdb, 0x83, 0x06,
+	0x67, 0x8d, 0xc4, 0xc8, 0x1e, 0xb9, 0x87, 0xf2, 0x65, 0x98, 0xde, 0x4b, 0x76, 0x67, 0x33, 0xef,
+	0x05, 0xbb, 0x0d, 0x03, 0xfa, 0xe4, 0xd9, 0xc2, 0xd7, 0x28, 0xac, 0x89, 0xf3, 0x94, 0x07, 0xbc,
+	0x33, 0x69, 0xf6, 0x6f, 0xed, 0x7e, 0x9c, 0x73, 0xf9, 0x02, 0xb0, 0x21, 0xe5, 0xef, 0x23, 0x44,
+	0x36, 0xa1, 0x9f, 0x47, 0x3c, 0x03, 0xac, 0xfc, 0xfb, 0xb7, 0xea, 0xb5, 0x10, 0x0a, 0xbe, 0xc7,
+	0x34, 0x8d, 0x11, 0xaf, 0x27, 0xc6, 0xac, 0xc0, 0x1d, 0x1b, 0x25, 0xd4, 0x1b, 0x23, 0x3e, 0x65,
+	0xf5, 0xf7, 0x9c, 0xab, 0xe1, 0x65, 0xb7, 0xb3, 0x00, 0x05, 0x2a, 0x16, 0xdd, 0xe3, 0x1d, 0xfe,
+	0x55, 0x90, 0xcd, 0xbf, 0xc8, 0xf1, 0xa8, 0x93, 0x14, 0xb1, 0x48, 0xe1, 0xba, 0xf2, 0xcd, 0x88,
+	0xeb, 0x47, 0x44, 0x4a, 0xad, 0x7e, 0xbd, 0x9a, 0xd9, 0x5d, 0x96, 0x97, 0xcf, 0x1d, 0xfd, 0x15,
+	0x93, 0xe1, 0xd3, 0xfd, 0x70, 0xf8, 0xf8, 0xdb, 0x70, 0x18, 0x1e, 0x0d, 0x22, 0x79, 0xeb, 0x1f,
+	0xd4, 0x37, 0xd1, 0x9c, 0x56, 0x85, 0xc3, 0xd3, 0x07, 0xd3, 0x8e, 0x6e, 0x57, 0xdf, 0xde, 0xfe,
+	0x7b, 0x9e, 0x60, 0xef, 0x25, 0x92, 0xc6, 0xc1, 0x09, 0x85, 0x44, 0x95, 0x73, 0xe5, 0x91, 0x34,
+	0x9a, 0x10, 0x33, 0x06, 0x9c, 0xf5, 0x7d, 0x7d, 0x27, 0xe8, 0x5a, 0xce, 0x91, 0x0f, 0xcb, 0xc2,
+	0xa7, 0x11, 0xa2, 0x46, 0x32, 0xc5, 0xf4, 0x39, 0xff, 0xc6, 0x4e, 0xc7, 0xfe, 0x4d, 0x47, 0x5d,
+	0xed, 0xa3, 0x34, 0x5c, 0xcc, 0x41, 0xc4, 0xaf, 0xeb, 0x0b, 0x7a, 0x1d, 0xa8, 0x74, 0xff, 0x56,
+	0x23, 0x8d, 0x86, 0x83, 0xfd, 0x83, 0xee, 0x37, 0xc1, 0x5f, 0x03, 0x6d, 0xe3, 0x35, 0x6e, 0x36,
+	0xcb, 0x8c, 0xcd, 0x8f, 0x77, 0xed, 0x87, 0x12, 0xf6, 0x39, 0x58, 0xf3, 0x70, 0xa6, 0xfe, 0x6e,
+	0x52, 0xad, 0xd5, 0x1a, 0x94, 0x23, 0xeb, 0x04, 0xea, 0x77, 0xef, 0x01, 0xb3, 0x0d, 0xec, 0xdf,
+	0x71, 0x9e, 0x8e, 0x84, 0x3b, 0xf6, 0xde, 0x18, 0x68, 0x14, 0x60, 0xf2, 0xab, 0x34, 0xed, 0x7a,
+	0x93, 0xd7, 0xa5, 0x94, 0xd0, 0xa3, 0x4e, 0xf0, 0xc6, 0xc7, 0xe5, 0xb7, 0x41, 0x37, 0x24, 0x38,
+	0x9e, 0xae, 0x84, 0xa1, 0x0d, 0x0f, 0x27, 0x09, 0xd3, 0x80, 0xe0, 0xcb, 0x82, 0x58, 0x44, 0xad,
+	0xa0, 0xe7, 0xb9, 0x4a, 0xd4, 0x7a, 0x20, 0xba, 0x69, 0x9f, 0xa4, 0x08, 0x7e, 0xde, 0x75, 0xbf,
+	0x1b, 0x8e, 0x06, 0xe6, 0x46, 0xd7, 0x86, 0x82, 0x34, 0x75, 0x93, 0xb2, 0x39, 0xe1, 0x99, 0x77,
+	0xb6, 0x4b, 0x2f, 0x17, 0x54, 0x77, 0x63, 0x0a, 0xb5, 0x1f, 0x03, 0xd7, 0xa3, 0x3d, 0x7b, 0x47,
+	0x9b, 0x95, 0xf5, 0x10, 0x85, 0x77, 0x69, 0xe4, 0x9a, 0x7a, 0xda, 0xf9, 0xd2, 0x43, 0x57, 0x78,
+	0x97, 0x63, 0xd3, 0xa9, 0x9c, 0x44, 0xf2, 0x57, 0x33, 0x9e, 0x44, 0xe2, 0x77, 0x91, 0xfe, 0x0f,
+	0x43, 0x9c, 0x30, 0x78, 0x92, 0x54, 0x00, 0x00,
+};
+
+WOOPSA_ASSETS_BEGIN(woopsaAssets)
+	WOOPSA_ASSET_GZIP("/index.html", "text/html", "\"539f9e5012d09b6b\"", IndexHtmlAsset)
+WOOPSA_ASSETS_END
+
+#endif
@@ -1,14 +1,59 @@
 #include "woopsa-server.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
 
+#ifndef WOOPSA_MILLISECONDS
+#ifdef _WIN32
+#include <windows.h>
+#define WOOPSA_MILLISECONDS()	((WoopsaUInt32)GetTickCount())
+#else
+#include <time.h>
+WoopsaUInt32 MonotonicMilliseconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (WoopsaUInt32)now.tv_sec * 1000 + (WoopsaUInt32)(now.tv_nsec / 1000000);
+}
+#define WOOPSA_MILLISECONDS()	MonotonicMilliseconds()
+#endif
+#endif
+
+#if defined(WOOPSA_ENABLE_TIME_SLICING) && !defined(WOOPSA_MICROSECONDS)
+#ifdef _WIN32
+#include <windows.h>
+#define WOOPSA_MICROSECONDS()	((WoopsaUInt32)GetTickCount() * 1000)
+#else
+#include <time.h>
+static WoopsaUInt32 MonotonicMicroseconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (WoopsaUInt32)now.tv_sec * 1000000 + (WoopsaUInt32)(now.tv_nsec / 1000);
+}
+#define WOOPSA_MICROSECONDS()	MonotonicMicroseconds()
+#endif
+#endif
 
+// Constant texts and tables of the server, which are in flash with
+// WOOPSA_ENABLE_FLASH_TABLES: they are only read with FLASH_BYTE, or
+// through the *Text functions and LoadEntry
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+#define FLASH_TEXT(literal)		WOOPSA_FLASH_TEXT(literal)
+#define FLASH_BYTE(address)		WOOPSA_FLASH_READ_BYTE(address)
+#else
+#define FLASH_TEXT(literal)		(literal)
+#define FLASH_BYTE(address)		(*(const WoopsaUInt8*)(address))
+#endif
 
 // Woopsa constants
 #define VERB_META	"meta"
 #define VERB_READ	"read"
 #define VERB_WRITE	"write"
 #define VERB_INVOKE "invoke"
+#define VERB_HISTORY "history"
+#define VERB_EVENTS "events"
+#define VERB_CHANGES "changes"
+#define VERB_JOB "job"
 
 #define TYPE_STRING_NULL            "Null"
 #define TYPE_STRING_LOGICAL			"Logical"
@@ -19,23 +64,20 @@
 #define TYPE_STRING_TEXT            "Text"
 #define TYPE_STRING_LINK            "Link"
 #define TYPE_STRING_RESOURCE_URL    "ResourceUrl"
+#define TYPE_STRING_SIZE 12
 
-typedef struct {
-	WoopsaType	type;
-	WoopsaChar8* string;
-} TypesDictionaryEntry;
-
-TypesDictionaryEntry Types[] = {
-	{ WOOPSA_TYPE_NULL, TYPE_STRING_NULL },
-	{ WOOPSA_TYPE_LOGICAL, TYPE_STRING_LOGICAL },
-	{ WOOPSA_TYPE_INTEGER, TYPE_STRING_INTEGER },
-	{ WOOPSA_TYPE_REAL, TYPE_STRING_REAL },
-	{ WOOPSA_TYPE_TIME_SPAN, TYPE_STRING_TIME_SPAN },
+// Indexed by WoopsaType
+const WoopsaChar8 TypeStrings[][TYPE_STRING_SIZE] WOOPSA_TABLE_PROGMEM = {
+	TYPE_STRING_NULL,
+	TYPE_STRING_LOGICAL,
+	TYPE_STRING_INTEGER,
+	TYPE_STRING_REAL,
+	TYPE_STRING_TIME_SPAN,
 #ifdef WOOPSA_ENABLE_STRINGS
-	{ WOOPSA_TYPE_DATE_TIME, TYPE_STRING_DATE_TIME },
-	{ WOOPSA_TYPE_TEXT, TYPE_STRING_TEXT },
-	{ WOOPSA_TYPE_LINK, TYPE_STRING_LINK },
-	{ WOOPSA_TYPE_RESOURCE_URL, TYPE_STRING_RESOURCE_URL }
+	TYPE_STRING_DATE_TIME,
+	TYPE_STRING_TEXT,
+	TYPE_STRING_LINK,
+	TYPE_STRING_RESOURCE_URL
 #endif
 };
 
@@ -56,24 +98,93 @@ TypesDictionaryEntry Types[] = {
 #define HTTP_CODE_NOT_IMPLEMENTED "501"
 #define HTTP_TEXT_METHOD_NOT_IMPLEMENTED "%s method not implemented"
 
+#define HTTP_CODE_SERVICE_UNAVAILABLE "503"
+#define HTTP_TEXT_SERVICE_UNAVAILABLE "Service unavailable"
+
+#define HTTP_CODE_SWITCHING_PROTOCOLS "101"
+#define HTTP_TEXT_SWITCHING_PROTOCOLS "Switching Protocols"
+
 #define HTTP_CODE_OK "200"
 #define HTTP_TEXT_OK "OK"
 
+#define HTTP_CODE_NOT_MODIFIED "304"
+#define HTTP_TEXT_NOT_MODIFIED "Not Modified"
+
+#define HTTP_CODE_NOT_ACCEPTABLE "406"
+#define HTTP_TEXT_NOT_ACCEPTABLE "Not acceptable"
+
+#define HTTP_CODE_REQUEST_TIMEOUT "408"
+#define HTTP_TEXT_REQUEST_TIMEOUT "Request timeout"
+
 #define HEADER_SEPARATOR "\r\n"
 #define HEADER_VALUE_SEPARATOR ":"
 #define HEADER_CONTENT_LENGTH "content-length"
 #define HEADER_CONTENT_LENGTH_SPACE "        "
 #define HEADER_CONTENT_LENGTH_PADDING 8
 #define HEADER_CONTENT_TYPE "Content-Type: "
-#define EXTRA_HEADERS "Access-Control-Allow-Origin: *" HEADER_SEPARATOR "Connection: close" HEADER_SEPARATOR
+#define HEADER_CONNECTION_CLOSE "Connection: close" HEADER_SEPARATOR
+#define EXTRA_HEADERS "Access-Control-Allow-Origin: *" HEADER_SEPARATOR HEADER_CONNECTION_CLOSE
+#define HEADER_UPGRADE "upgrade"
+#define HEADER_WEBSOCKET_KEY "sec-websocket-key"
+#define HEADER_WEBSOCKET_ACCEPT "Sec-WebSocket-Accept: "
+#define HEADER_ACCEPT_ENCODING "accept-encoding"
+#define HEADER_CONNECTION "connection"
+#define CONNECTION_CLOSE_VALUE "close"
+#define CONNECTION_KEEP_ALIVE_VALUE "keep-alive"
+#define HTTP_VERSION_1_0 "http/1.0"
+#define HEADER_IF_NONE_MATCH "if-none-match"
+#define HEADER_CONTENT_ENCODING_GZIP "Content-Encoding: gzip"
+#define HEADER_ETAG "ETag: "
+#define HEADER_CACHE_REVALIDATE "Cache-Control: no-cache"
+#define HEADER_CONTENT_LENGTH_NAME "Content-Length: "
+#define HEADER_HOST "Host: "
 #define CONTENT_TYPE_JSON "application/json"
 #define CONTENT_TYPE_HTML "text/html"
+#define CONTENT_TYPE_EVENT_STREAM "text/event-stream"
+#define EVENT_STREAM_HEADERS "Cache-Control: no-cache" HEADER_SEPARATOR "Access-Control-Allow-Origin: *" HEADER_SEPARATOR
+
+// WebSocket constants (RFC 6455)
+#define WEBSOCKET_UPGRADE_VALUE "websocket"
+#define WEBSOCKET_UPGRADE_HEADERS "Upgrade: websocket" HEADER_SEPARATOR "Connection: Upgrade" HEADER_SEPARATOR
+#define WEBSOCKET_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define WEBSOCKET_KEY_LENGTH 24
+#define WEBSOCKET_ACCEPT_LENGTH 28
+#define WEBSOCKET_FIN 0x80
+#define WEBSOCKET_MASKED 0x80
+#define WEBSOCKET_OPCODE_MASK 0x0F
+#define WEBSOCKET_LENGTH_MASK 0x7F
+#define WEBSOCKET_LENGTH_16BIT 126
+#define WEBSOCKET_LENGTH_64BIT 127
+#define WEBSOCKET_MIN_HEADER_LENGTH 2
+#define WEBSOCKET_MAX_HEADER_LENGTH 4
+#define WEBSOCKET_MASK_LENGTH 4
+#define WEBSOCKET_MAX_PAYLOAD_LENGTH 0xFFFF
+#define WEBSOCKET_CLOSE_STATUS_LENGTH 2
+#define WEBSOCKET_OPCODE_TEXT 0x1
+#define WEBSOCKET_OPCODE_BINARY 0x2
+#define WEBSOCKET_OPCODE_CLOSE 0x8
+#define WEBSOCKET_OPCODE_PING 0x9
+#define WEBSOCKET_OPCODE_PONG 0xA
+#define SHA1_DIGEST_LENGTH 20
+
+// FNV-1a hash constants
+#define HASH_SEED 2166136261UL
+#define HASH_PRIME 16777619UL
+
+// ETags are a hash in hexadecimal, between quotes
+#define ETAG_LENGTH 10
+#define ETAG_QUOTE '"'
+
+// Static asset constants
+#define ASSET_ENCODING_GZIP "gzip"
+#define ASSET_DIRECTORY_INDEX "index.html"
 
 // POST constants
 #define POST_VALUE_KEY "value"
 #define URLENCODE_KEY_SEPARATOR '&'
 #define URLENCODE_VALUE_SEPARATOR '='
 #define URLENCODE_VALUE_ENCODER '%'
+#define URL_QUERY_SEPARATOR '?'
 
 // Serialization constants
 #define JSON_VALUE_VALUE "{\"Value\":"
@@ -82,6 +193,11 @@ TypesDictionaryEntry Types[] = {
 #define JSON_META_PROPERTIES "{\"Name\":\"Root\",\"Properties\":"
 #define JSON_META_METHODS ",\"Methods\":"
 #define JSON_META_END ",\"Items\":[]}"
+#define JSON_META_TOTAL_COUNT ",\"TotalCount\":"
+#define JSON_META_NAME "{\"Name\":\""
+#define JSON_META_NAMED_PROPERTIES "\",\"Properties\":"
+#define JSON_META_ITEMS ",\"Items\":"
+#define SUBOBJECT_SEPARATOR_CHAR '/'
 #define JSON_PROPERTY_NAME "{\"Name\":\""
 #define JSON_PROPERTY_TYPE "\",\"Type\":\""
 #define JSON_PROPERTY_READONLY "\",\"ReadOnly\":"
@@ -97,44 +213,258 @@ TypesDictionaryEntry Types[] = {
 #define JSON_STRING_DELIMITER "\""
 #define JSON_STRING_DELIMITER_CHAR '"'
 #define JSON_ESCAPE_CHAR '\\'
+#define JSON_HISTORY_TYPE "{\"Type\":\""
+#define JSON_HISTORY_LAST ",\"Last\":"
+#define JSON_HISTORY_MISSED ",\"Missed\":"
+#define JSON_HISTORY_SAMPLES "\",\"Samples\":"
+#define JSON_SAMPLE_SEQUENCE "{\"Sequence\":"
+#define JSON_SAMPLE_TIME ",\"Time\":"
+#define JSON_SAMPLE_VALUE ",\"Value\":"
+#define JSON_CHANGES "{\"Changes\":"
+#define JSON_CHANGE_NAME ",\"Name\":\""
+#define JSON_CHANGE_VALUE "\",\"Value\":"
+#define JSON_CHANGES_RESYNC ",\"Resync\":"
+#define JSON_PUSH_VALUES "{\"Values\":"
+#define JSON_JOB "{\"Job\":"
+#define JSON_JOB_RUNNING ",\"State\":\"Running\"}"
+#define JSON_JOB_FAILED ",\"State\":\"Failed\"}"
+#define JSON_JOB_DONE ",\"State\":\"Done\"}"
+#define JSON_JOB_RESULT ",\"State\":\"Done\",\"Result\":"
+#define JSON_OBJECT_START "{"
+#define JSON_OBJECT_END "}"
+#define JSON_MEMBER_VALUE "\":"
+#define JSON_ERROR "{\"Error\":\""
+#define JSON_TRANSACTION_RESULTS "{\"Results\":{"
+#define JSON_TRANSACTION_APPLIED "},\"Applied\":"
+
+// Patterns of group reads, property names cannot hold the wildcard
+#define PATTERN_WILDCARD "*"
+#define PATTERN_WILDCARD_CHAR '*'
+
+// Query constants
+#define QUERY_SINCE_KEY "since"
+#define QUERY_AFTER_KEY "after"
+#define QUERY_PROPERTIES_KEY "properties"
+#define QUERY_DEADBAND_KEY "deadband"
+#define QUERY_LIST_SEPARATOR ','
+#define QUERY_PREFIX_KEY "prefix"
+#define QUERY_OFFSET_KEY "offset"
+#define QUERY_LIMIT_KEY "limit"
+
+// Event stream constants
+#define EVENT_DATA "data: "
+#define EVENT_VALUE "\",\"Value\":"
+#define EVENT_END "\n\n"
+// Events are sent as text/event-stream messages or as a JSON array
+#define EVENT_FORMAT_STREAM 0
+#define EVENT_FORMAT_JSON 1
+
+// Results of a Woopsa verb
+#define VERB_RESULT_OK 0
+#define VERB_RESULT_NOT_FOUND 1
+#define VERB_RESULT_BAD_REQUEST 2
+#define VERB_RESULT_UNAVAILABLE 3
+
+// Passes of a meta document over the entry table. A cursor that is not
+// serializing anything is META_DONE, as connections start zeroed.
+#define META_DONE 0
+#define META_START 1
+#define META_PROPERTIES 2
+#define META_METHODS 3
+// Only listed by the meta of subobjects
+#define META_ITEMS 4
 
 // Memory-specific constants
-#define MAX_NUMERICAL_VALUE_LENGTH 10
-
-// Gets a Woopsa Property by name
-// Returns a pointer to the WoopsaEntry, or null if not found
-WoopsaEntry* GetPropertyByNameOrNull(WoopsaEntry entries[], WoopsaChar8 name[]) {
-	WoopsaUInt16 i = 0;
-	while (entries[i].name != NULL) {
-		if (WOOPSA_STRING_EQUAL(entries[i].name, name) && entries[i].isMethod == 0)
-			return &entries[i];
-		i++;
+// Room for a 64-bit integer with its sign
+#define MAX_NUMERICAL_VALUE_LENGTH 24
+#define MAX_PARAMETER_LENGTH 16
+// Room kept in the output buffer for one history sample and the closing brackets
+#define HISTORY_SAMPLE_MAX_LENGTH 72
+// Room needed by an event besides the property name and value
+#define EVENT_OVERHEAD_LENGTH 48
+// Room needed by a change besides its name and value, and by the end of
+// the changes response
+#define CHANGE_OVERHEAD_LENGTH 80
+// Room kept after the values of a push for its end, and for the pattern
+#define PUSH_END_LENGTH 24
+#define PUSH_PATTERN_LENGTH 48
+// Room needed by a property of a group read besides its name and value,
+// and the closing brace
+#define GROUP_OVERHEAD_LENGTH 40
+// Room needed by an entry of a meta page besides its name, and by the end
+// of the page
+#define META_ENTRY_OVERHEAD_LENGTH 72
+#define META_PAGE_END_LENGTH 48
+// Room needed by a property of a transaction besides its name and value,
+// and by the end of the response
+#define TRANSACTION_OVERHEAD_LENGTH 64
+
+// Gives access to an entry of a table. When tables are in flash, the
+// entry is copied to copy first.
+// Returns the entry to read from
+const WoopsaEntry* LoadEntry(const WoopsaEntry* entry, WoopsaEntry* copy) {
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+	WOOPSA_FLASH_COPY(copy, entry, sizeof(WoopsaEntry));
+	return copy;
+#else
+	(void)copy;
+	return entry;
+#endif
+}
+
+// Returns 1 if the loaded entry ends its table: the one of WOOPSA_END, or
+// one with a NULL name in tables written by hand
+WoopsaUInt8 IsTableEnd(const WoopsaEntry* entry) {
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+	return entry->name[0] == '\0';
+#else
+	return entry->name == NULL || entry->name[0] == '\0';
+#endif
+}
+
+#ifdef WOOPSA_NAME_INDEX
+// Compares the names of the entries at two positions of the index
+int CompareIndexedNames(WoopsaServer* server, WoopsaUInt16 first, WoopsaUInt16 second) {
+	WoopsaEntry copy, otherCopy;
+	return WOOPSA_STRING_COMPARE(LoadEntry(&server->entries[server->nameIndex[first]], &copy)->name, LoadEntry(&server->entries[server->nameIndex[second]], &otherCopy)->name);
+}
+
+// Moves the entry at position down the heap made of the first length
+// positions of the index, until it comes after both its children
+void SiftDownNameIndex(WoopsaServer* server, WoopsaUInt16 position, WoopsaUInt16 length) {
+	WoopsaUInt32 child;
+	WoopsaIndexEntry moved;
+	for (; (child = 2 * (WoopsaUInt32)position + 1) < length; position = (WoopsaUInt16)child) {
+		if (child + 1 < length && CompareIndexedNames(server, (WoopsaUInt16)(child + 1), (WoopsaUInt16)child) > 0)
+			child++;
+		if (CompareIndexedNames(server, position, (WoopsaUInt16)child) >= 0)
+			return;
+		moved = server->nameIndex[position];
+		server->nameIndex[position] = server->nameIndex[child];
+		server->nameIndex[child] = moved;
 	}
-	return NULL;
 }
 
-#ifdef WOOPSA_ENABLE_METHODS
-// Gets a Woopsa Method by name
-// Returns a pointer to the WoopsaEntry, or null if not found
-WoopsaEntry* GetMethodByNameOrNull(WoopsaEntry entries[], WoopsaChar8 name[]) {
-	WoopsaUInt16 i = 0;
-	while (entries[i].name != NULL) {
-		if (WOOPSA_STRING_EQUAL(entries[i].name, name) && entries[i].isMethod == 1)
-			return &entries[i];
-		i++;
+// Sorts the entries of the table by name into the index. A heap sort
+// takes n log n comparisons for large tables and no memory besides the
+// index. The index is left empty if they do not fit.
+void BuildNameIndex(WoopsaServer* server) {
+	WoopsaEntry copy;
+	WoopsaIndexEntry moved;
+	WoopsaUInt16 i, length = 0;
+	server->nameIndexLength = 0;
+	for (; !IsTableEnd(LoadEntry(&server->entries[length], &copy)); length++) {
+		if (length == WOOPSA_NAME_INDEX_SIZE || (WoopsaIndexEntry)length != length)
+			return;
+		server->nameIndex[length] = (WoopsaIndexEntry)length;
 	}
-	return NULL;
+	for (i = length / 2; i > 0; i--)
+		SiftDownNameIndex(server, (WoopsaUInt16)(i - 1), length);
+	// The largest name of the heap goes after it, which shrinks by one
+	for (i = length; i > 1; i--) {
+		moved = server->nameIndex[0];
+		server->nameIndex[0] = server->nameIndex[i - 1];
+		server->nameIndex[i - 1] = moved;
+		SiftDownNameIndex(server, 0, (WoopsaUInt16)(i - 1));
+	}
+	server->nameIndexLength = length;
 }
+
+// Returns the position in the index of the first entry whose name is
+// name or comes after it. With afterPrefix, of the first entry whose name
+// comes after every name starting with name.
+WoopsaUInt16 FindInNameIndex(WoopsaServer* server, const WoopsaChar8* name, WoopsaUInt8 afterPrefix) {
+	WoopsaEntry copy;
+	WoopsaUInt16 low = 0, high = server->nameIndexLength, middle;
+	WoopsaBufferSize length = WOOPSA_STRING_LENGTH(name);
+	int comparison;
+	while (low < high) {
+		middle = (WoopsaUInt16)((low + high) / 2);
+		if (afterPrefix)
+			comparison = WOOPSA_STRING_N_COMPARE(LoadEntry(&server->entries[server->nameIndex[middle]], &copy)->name, name, length) <= 0;
+		else
+			comparison = WOOPSA_STRING_COMPARE(LoadEntry(&server->entries[server->nameIndex[middle]], &copy)->name, name) < 0;
+		if (comparison)
+			low = (WoopsaUInt16)(middle + 1);
+		else
+			high = middle;
+	}
+	return low;
+}
+#endif
+
+// Gets a Woopsa Property (isMethod 0) or Method (isMethod 1) by name
+// Returns a pointer to the WoopsaEntry in the table, or null if not found
+const WoopsaEntry* GetEntryByNameOrNull(WoopsaServer* server, const WoopsaChar8 name[], WoopsaChar8 isMethod) {
+	const WoopsaEntry* entries = server->entries;
+	WoopsaEntry copy;
+	const WoopsaEntry* woopsaEntry;
+	WoopsaUInt16 i;
+#ifdef WOOPSA_NAME_INDEX
+	if (server->nameIndexLength != 0) {
+		// A property and a method can have the same name
+		for (i = FindInNameIndex(server, name, 0); i < server->nameIndexLength; i++) {
+			woopsaEntry = LoadEntry(&entries[server->nameIndex[i]], &copy);
+			if (!WOOPSA_STRING_EQUAL(woopsaEntry->name, name))
+				break;
+			if ((woopsaEntry->isMethod != 0) == isMethod)
+				return &entries[server->nameIndex[i]];
+		}
+		return NULL;
+	}
 #endif
+	for (i = 0; !IsTableEnd(woopsaEntry = LoadEntry(&entries[i], &copy)); i++)
+		if (WOOPSA_STRING_EQUAL(woopsaEntry->name, name) && (woopsaEntry->isMethod != 0) == isMethod)
+			return &entries[i];
+	return NULL;
+}
+
+#define GetPropertyByNameOrNull(server, name) GetEntryByNameOrNull(server, name, 0)
+#define GetMethodByNameOrNull(server, name) GetEntryByNameOrNull(server, name, 1)
 
 // Gets the type string for a given type
-// Returns a pointer to a string or NULL if not found (why ??)
-TypesDictionaryEntry * GetTypeEntry(WoopsaType type) {
-	WoopsaUInt8 i;
-	for (i = 0; i < sizeof(Types) / sizeof(TypesDictionaryEntry); i++)
-	if (Types[i].type == type)
-		return &Types[i];
+// Returns a constant text, or NULL if not found
+const WoopsaChar8* GetTypeString(WoopsaUInt8 type) {
+	if (type >= sizeof(TypeStrings) / sizeof(TypeStrings[0]))
+		return NULL;
+	return TypeStrings[type];
+}
+
+// Returns the length of a constant text
+WoopsaBufferSize TextLength(const WoopsaChar8* text) {
+	WoopsaBufferSize length = 0;
+	while (FLASH_BYTE(text + length) != '\0')
+		length++;
+	return length;
+}
+
+// Checks whether string starts with a constant text
+WoopsaUInt8 StartsWithText(const WoopsaChar8* string, const WoopsaChar8* text) {
+	for (; FLASH_BYTE(text) != '\0'; string++, text++)
+		if (*string != (WoopsaChar8)FLASH_BYTE(text))
+			return 0;
+	return 1;
+}
+
+// Checks whether string is a constant text
+WoopsaUInt8 EqualsText(const WoopsaChar8* string, const WoopsaChar8* text) {
+	for (; *string == (WoopsaChar8)FLASH_BYTE(text); string++, text++)
+		if (*string == '\0')
+			return 1;
+	return 0;
+}
+
+// Finds the first occurrence of a constant text in string
+// Returns a pointer to it, or NULL if not found
+WoopsaChar8* FindText(const WoopsaChar8* string, const WoopsaChar8* text) {
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+	for (; *string != '\0'; string++)
+		if (StartsWithText(string, text))
+			return (WoopsaChar8*)string;
 	return NULL;
+#else
+	return WOOPSA_STRING_POSITION(string, text);
+#endif
 }
 
 // Finds the string length of the first HTTP header found in searchString
@@ -156,6 +486,66 @@ WoopsaInt16 NextHTTPHeader(const WoopsaChar8* searchString, const WoopsaChar8**
 	return -1;
 }
 
+// Checks whether an HTTP header of headerSize characters is the header
+// with the given name (lowercase constant text)
+// Returns a pointer to the value of the header, or NULL if it's another one
+const WoopsaChar8* HeaderValueOrNull(const WoopsaChar8* header, WoopsaInt16 headerSize, const WoopsaChar8* name) {
+	WoopsaInt16 i;
+	for (i = 0; FLASH_BYTE(name + i) != '\0'; i++)
+		if (i >= headerSize || WOOPSA_CHAR_TO_LOWER(header[i]) != (WoopsaChar8)FLASH_BYTE(name + i))
+			return NULL;
+	if (i >= headerSize || header[i] != HEADER_VALUE_SEPARATOR[0])
+		return NULL;
+	for (i++; i < headerSize && header[i] == ' '; i++);
+	return &header[i];
+}
+
+// Checks whether string starts with prefix (lowercase constant text),
+// ignoring case
+WoopsaUInt8 StartsWithIgnoreCase(const WoopsaChar8* string, const WoopsaChar8* prefix) {
+	for (; FLASH_BYTE(prefix) != '\0'; string++, prefix++)
+		if (WOOPSA_CHAR_TO_LOWER(*string) != (WoopsaChar8)FLASH_BYTE(prefix))
+			return 0;
+	return 1;
+}
+
+// Checks whether the first length characters of value contain token
+// (lowercase constant text), ignoring case
+WoopsaUInt8 ContainsIgnoreCase(const WoopsaChar8* value, WoopsaInt16 length, const WoopsaChar8* token) {
+	WoopsaInt16 i, tokenLength = (WoopsaInt16)TextLength(token);
+	for (i = 0; i + tokenLength <= length; i++)
+		if (StartsWithIgnoreCase(value + i, token))
+			return 1;
+	return 0;
+}
+
+#if defined(WOOPSA_ENABLE_ETAGS) || defined(WOOPSA_ENABLE_STATIC_ASSETS)
+// Checks whether the first length characters of an If-None-Match value
+// contain etag. ETags are compared character by character.
+WoopsaUInt8 ContainsETag(const WoopsaChar8* value, WoopsaInt16 length, const WoopsaChar8* etag) {
+	WoopsaInt16 i, etagLength = (WoopsaInt16)WOOPSA_STRING_LENGTH(etag);
+	for (i = 0; i + etagLength <= length; i++)
+		if (strncmp(value + i, etag, etagLength) == 0)
+			return 1;
+	return 0;
+}
+#endif
+
+// Continues a 32-bit FNV-1a hash over length bytes
+WoopsaUInt32 HashBytes(WoopsaUInt32 hash, const void* data, WoopsaBufferSize length) {
+	const WoopsaUInt8* bytes = (const WoopsaUInt8*)data;
+	while (length-- > 0) {
+		hash ^= *bytes++;
+		hash = (hash * HASH_PRIME) & 0xFFFFFFFFUL;
+	}
+	return hash;
+}
+
+// Hashes a string with 32-bit FNV-1a
+WoopsaUInt32 HashString(const WoopsaChar8* string) {
+	return HashBytes(HASH_SEED, string, WOOPSA_STRING_LENGTH(string));
+}
+
 // Finds the next key/value pair in a URLEncoded string
 // and decodes the actual value. Note: keys are lowercased
 // Returns the length of the *current* key/value pair, or -1 if none found
@@ -221,6 +611,80 @@ WoopsaInt16 NextURLDecodedValue(const WoopsaChar8* searchString, WoopsaChar8* ke
 }
 
 
+WoopsaUInt8 HexDigitValue(WoopsaChar8 digit) {
+	digit = WOOPSA_CHAR_TO_LOWER(digit);
+	if (digit >= '0' && digit <= '9')
+		return digit - '0';
+	if (digit >= 'a' && digit <= 'f')
+		return digit - 'a' + 0xa;
+	return 0;
+}
+
+// Decodes URLEncoded text into decoded, while keeping decoded under
+// decodedLength, up to the end of the key/value pair, or up to the '='
+// after a key. text is moved past the characters decoded.
+// Returns 0 if decoded was too short
+WoopsaUInt8 URLDecode(const WoopsaChar8** text, WoopsaUInt8 isKey, WoopsaChar8* decoded, WoopsaBufferSize decodedLength) {
+	const WoopsaChar8* at = *text;
+	WoopsaBufferSize decodedAt = 0;
+	WoopsaUInt8 complete = 1;
+	while (*at != '\0' && *at != URLENCODE_KEY_SEPARATOR && !(isKey && *at == URLENCODE_VALUE_SEPARATOR)) {
+		if (decodedAt >= decodedLength - 1) {
+			complete = 0;
+			break;
+		}
+		if (*at == URLENCODE_VALUE_ENCODER && at[1] != '\0' && at[2] != '\0') {
+			decoded[decodedAt++] = (WoopsaChar8)(HexDigitValue(at[1]) * 0x10 + HexDigitValue(at[2]));
+			at += 3;
+		} else {
+			decoded[decodedAt++] = (*at == '+') ? ' ' : *at;
+			at++;
+		}
+	}
+	decoded[decodedAt] = '\0';
+	*text = at;
+	return complete;
+}
+
+// Finds the value of key (lowercase constant text) in a URLEncoded string and decodes it
+// into value, while keeping value under valueLength
+// Returns 1 if the key was found, 0 otherwise
+WoopsaUInt8 FindURLDecodedValue(const WoopsaChar8* searchString, const WoopsaChar8* key, WoopsaChar8* value, WoopsaBufferSize valueLength) {
+	const WoopsaChar8 *pair = searchString, *keyAt = NULL;
+	while (*pair != '\0') {
+		keyAt = key;
+		while (FLASH_BYTE(keyAt) != '\0' && WOOPSA_CHAR_TO_LOWER(*pair) == (WoopsaChar8)FLASH_BYTE(keyAt)) {
+			pair++;
+			keyAt++;
+		}
+		if (FLASH_BYTE(keyAt) == '\0' && (*pair == URLENCODE_VALUE_SEPARATOR || *pair == URLENCODE_KEY_SEPARATOR || *pair == '\0')) {
+			if (*pair == URLENCODE_VALUE_SEPARATOR)
+				pair++;
+			URLDecode(&pair, 0, value, valueLength);
+			return 1;
+		}
+		// Skip to the next key/value pair
+		while (*pair != '\0' && *pair != URLENCODE_KEY_SEPARATOR)
+			pair++;
+		if (*pair == URLENCODE_KEY_SEPARATOR)
+			pair++;
+	}
+	return 0;
+}
+
+// Cuts the query string off a path
+// Returns the query string, which is empty if the path has none
+WoopsaChar8* SplitQuery(WoopsaChar8 path[]) {
+	WoopsaBufferSize i;
+	for (i = 0; path[i] != '\0'; i++) {
+		if (path[i] == URL_QUERY_SEPARATOR) {
+			path[i] = '\0';
+			return &path[i + 1];
+		}
+	}
+	return &path[i];
+}
+
 // Appends source to destination, while keeping destination under num length
 // Returns amount of characters actually appended
 WoopsaBufferSize Append(WoopsaChar8 destination[], const WoopsaChar8 source[], WoopsaBufferSize num) {
@@ -235,6 +699,20 @@ WoopsaBufferSize Append(WoopsaChar8 destination[], const WoopsaChar8 source[], W
 	return cnt;
 }
 
+// Appends a constant text to destination, like Append
+// Returns amount of characters actually appended
+WoopsaBufferSize AppendText(WoopsaChar8 destination[], const WoopsaChar8 text[], WoopsaBufferSize num) {
+	WoopsaBufferSize i = 0, cnt = 0;
+	while (destination[i] != '\0')
+		i++;
+	while (FLASH_BYTE(text + cnt) != '\0' && i < num - 1) {
+		destination[i++] = (WoopsaChar8)FLASH_BYTE(text + cnt);
+		cnt++;
+	}
+	destination[i] = '\0';
+	return cnt;
+}
+
 // Appends source to destination, while keeping destination under num length
 // and escaping specified character
 // Returns amount of characters actually appended
@@ -260,6 +738,7 @@ WoopsaBufferSize AppendEscape(WoopsaChar8 destination[], const WoopsaChar8 sourc
 
 // Prepares an HTTP response in the specified outputBuffer
 // Will send the specified HTTP status code and a status string
+// (constant texts, as the content type)
 // Will also add the content
 // This method will basically prepare the entire string that can be
 // send out to the client, including all HTTP headers.
@@ -270,30 +749,37 @@ WoopsaBufferSize PrepareResponse(
 		const WoopsaChar8* httpStatusCode,
 		const WoopsaChar8* httpStatusStr,
 		WoopsaBufferSize* contentLengthPosition,
-		const WoopsaChar8* contentType
+		const WoopsaChar8* contentType,
+		const WoopsaChar8* etag
 		) {
 	WoopsaBufferSize size = 0;
 	outputBuffer[0] = '\0';
 	// HTTP/1.1
-	size = Append(outputBuffer, HTTP_VERSION_STRING " ", outputBufferLength);
+	size = AppendText(outputBuffer, FLASH_TEXT(HTTP_VERSION_STRING " "), outputBufferLength);
 	// 200 OK
-	size += Append(outputBuffer, httpStatusCode, outputBufferLength);
-	size += Append(outputBuffer, " ", outputBufferLength);
-	size += Append(outputBuffer, httpStatusStr, outputBufferLength);
-	size += Append(outputBuffer, HEADER_SEPARATOR, outputBufferLength);
+	size += AppendText(outputBuffer, httpStatusCode, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(" "), outputBufferLength);
+	size += AppendText(outputBuffer, httpStatusStr, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR), outputBufferLength);
 	// Content type
-	size += Append(outputBuffer, HEADER_CONTENT_TYPE, outputBufferLength);
-	size += Append(outputBuffer, contentType, outputBufferLength);
-	size += Append(outputBuffer, HEADER_SEPARATOR, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_CONTENT_TYPE), outputBufferLength);
+	size += AppendText(outputBuffer, contentType, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR), outputBufferLength);
+	// ETag, when the content has one
+	if (etag != NULL) {
+		size += AppendText(outputBuffer, FLASH_TEXT(HEADER_ETAG), outputBufferLength);
+		size += Append(outputBuffer, etag, outputBufferLength);
+		size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR), outputBufferLength);
+	}
 	// Extra headers
-	size += Append(outputBuffer, EXTRA_HEADERS, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(EXTRA_HEADERS), outputBufferLength);
 	// Content-Length:
-	size += Append(outputBuffer, HEADER_CONTENT_LENGTH HEADER_VALUE_SEPARATOR, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_CONTENT_LENGTH HEADER_VALUE_SEPARATOR), outputBufferLength);
 	*contentLengthPosition = size;
 	// We leave a few spaces for the Content-Length
-	size += Append(outputBuffer, HEADER_CONTENT_LENGTH_SPACE, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_CONTENT_LENGTH_SPACE), outputBufferLength);
 	// Final double new lines
-	size += Append(outputBuffer, HEADER_SEPARATOR HEADER_SEPARATOR, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR), outputBufferLength);
 	return size;
 }
 
@@ -312,16 +798,25 @@ WoopsaBufferSize PrepareResponseWithContent(
 		const WoopsaChar8* httpStatusStr,
 		const WoopsaChar8* content) {
 	WoopsaBufferSize len, pos, contentLength;
-	len = PrepareResponse(outputBuffer, outputBufferLength, httpStatusCode, httpStatusStr, &pos, CONTENT_TYPE_JSON);
-	contentLength = WOOPSA_STRING_LENGTH(content);
+	len = PrepareResponse(outputBuffer, outputBufferLength, httpStatusCode, httpStatusStr, &pos, FLASH_TEXT(CONTENT_TYPE_JSON), NULL);
+	contentLength = AppendText(outputBuffer, content, outputBufferLength);
 	SetContentLength(outputBuffer, outputBufferLength, pos, contentLength);
-	len += Append(outputBuffer, content, outputBufferLength);
-	return len;
+	return len + contentLength;
+}
+
+// Prepares a 304 Not Modified response, which has no content
+WoopsaBufferSize PrepareNotModified(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const WoopsaChar8* etag) {
+	WoopsaBufferSize size;
+	outputBuffer[0] = '\0';
+	size = AppendText(outputBuffer, FLASH_TEXT(HTTP_VERSION_STRING " " HTTP_CODE_NOT_MODIFIED " " HTTP_TEXT_NOT_MODIFIED HEADER_SEPARATOR HEADER_ETAG), outputBufferLength);
+	size += Append(outputBuffer, etag, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR EXTRA_HEADERS HEADER_SEPARATOR), outputBufferLength);
+	return size;
 }
 
 // Shortcut to generate an HTTP error. The contents
 // of the response is the error string itself.
-WoopsaBufferSize PrepareError(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaChar8 errorCode[], const WoopsaChar8 errorStr[]) {
+WoopsaBufferSize PrepareError(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const WoopsaChar8 errorCode[], const WoopsaChar8 errorStr[]) {
 	return PrepareResponseWithContent(outputBuffer, outputBufferLength, errorCode, errorStr, errorStr);
 }
 
@@ -332,64 +827,2661 @@ void StringToLower(WoopsaChar8 str[]) {
 	}
 }
 
-WoopsaBufferSize OutputSerializedValue(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaChar8 stringValue[], WoopsaChar8 typeString[], WoopsaChar8 isStringValue) {
-	WoopsaBufferSize contentLength = 0;
-	contentLength += Append(outputBuffer, JSON_VALUE_VALUE, outputBufferLength);
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+// Where a field is, in the instance or in its snapshot
+#define FIELD_DATA(base, woopsaEntry)	((void*)((base) + (size_t)(woopsaEntry)->address.data))
+#endif
+
+// Gets the address holding the value of a property. For computed
+// properties, the getter is only called when the cached value expired.
+void* GetPropertyData(const WoopsaServer* server, const WoopsaEntry* woopsaEntry) {
+#ifdef WOOPSA_ENABLE_ACCESSORS
+	WoopsaAccessor* accessor;
+	WoopsaUInt32 now;
+#endif
+	// The server is only needed by struct tables
+	(void)server;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	if (woopsaEntry->isField)
+		return FIELD_DATA(server->snapshot != NULL ? server->snapshot : server->instance, woopsaEntry);
+#endif
+#ifdef WOOPSA_ENABLE_ACCESSORS
+	if (woopsaEntry->isComputed) {
+		accessor = woopsaEntry->address.accessor;
+		now = WOOPSA_MILLISECONDS();
+		if (!accessor->cacheValid || accessor->cacheTtl == 0 || (WoopsaUInt32)(now - accessor->cachedAt) >= accessor->cacheTtl) {
+			accessor->getter(accessor->value);
+			accessor->cachedAt = now;
+			accessor->cacheValid = 1;
+		}
+		return accessor->value;
+	}
+#endif
+	return woopsaEntry->address.data;
+}
+
+// Appends a decimal integer. The C library is not used, as it cannot
+// format 64-bit integers on some MCUs.
+// Returns amount of characters actually appended
+WoopsaBufferSize AppendInteger(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, uint64_t magnitude, WoopsaUInt8 negative, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaUInt8 i = MAX_NUMERICAL_VALUE_LENGTH - 1;
+	uint32_t digits;
+	numericValueBuffer[i] = '\0';
+	// 64-bit divisions are slow on small MCUs, only use them while needed
+	for (; magnitude > 0xFFFFFFFFUL; magnitude /= 10)
+		numericValueBuffer[--i] = (WoopsaChar8)('0' + magnitude % 10);
+	digits = (uint32_t)magnitude;
+	do {
+		numericValueBuffer[--i] = (WoopsaChar8)('0' + digits % 10);
+		digits /= 10;
+	} while (digits != 0);
+	if (negative)
+		numericValueBuffer[--i] = '-';
+	return Append(outputBuffer, numericValueBuffer + i, outputBufferLength);
+}
+
+// Returns 1 if text only holds spaces
+WoopsaUInt8 IsBlank(const WoopsaChar8* text) {
+	while (*text == ' ')
+		text++;
+	return *text == '\0';
+}
+
+// Decodes a decimal integer, with spaces around it
+// Returns 0 if text is not an integer or its magnitude does not fit in
+// 64 bits
+WoopsaUInt8 ParseInteger(const WoopsaChar8* text, uint64_t* magnitude, WoopsaUInt8* negative) {
+	const WoopsaChar8* digits;
+	WoopsaUInt8 digit;
+	*magnitude = 0;
+	*negative = 0;
+	while (*text == ' ')
+		text++;
+	if (*text == '-' || *text == '+')
+		*negative = *text++ == '-';
+	for (digits = text; *text >= '0' && *text <= '9'; text++) {
+		digit = (WoopsaUInt8)(*text - '0');
+		if (*magnitude > (UINT64_MAX - digit) / 10)
+			return 0;
+		*magnitude = *magnitude * 10 + digit;
+	}
+	return text != digits && IsBlank(text);
+}
+
+// Stores the low size bytes of an integer, signed or not
+void StoreInteger(void* data, WoopsaUInt8 size, uint64_t value) {
+	if (size == 1)
+		*(uint8_t*)data = (uint8_t)value;
+	else if (size == 2)
+		*(uint16_t*)data = (uint16_t)value;
+	else if (size == 4)
+		*(uint32_t*)data = (uint32_t)value;
+	else
+		*(uint64_t*)data = value;
+}
+
+int64_t LoadSigned(const void* data, WoopsaUInt8 size) {
+	if (size == 1)
+		return *(const int8_t*)data;
+	if (size == 2)
+		return *(const int16_t*)data;
+	if (size == 4)
+		return *(const int32_t*)data;
+	return *(const int64_t*)data;
+}
+
+uint64_t LoadUnsigned(const void* data, WoopsaUInt8 size) {
+	if (size == 1)
+		return *(const uint8_t*)data;
+	if (size == 2)
+		return *(const uint16_t*)data;
+	if (size == 4)
+		return *(const uint32_t*)data;
+	return *(const uint64_t*)data;
+}
+
+// Codecs of each storage. They are given the size of the storage, or
+// the room for the text for WOOPSA_STORAGE_TEXT.
+WoopsaBufferSize FormatSigned(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const void* data, WoopsaUInt8 size, WoopsaChar8 numericValueBuffer[]) {
+	int64_t value = LoadSigned(data, size);
+	return AppendInteger(outputBuffer, outputBufferLength, value < 0 ? 0 - (uint64_t)value : (uint64_t)value, value < 0, numericValueBuffer);
+}
+
+WoopsaUInt8 ParseSigned(void* data, WoopsaChar8* text, WoopsaUInt8 size) {
+	uint64_t magnitude, limit = ((uint64_t)1 << (8 * size - 1)) - 1;
+	WoopsaUInt8 negative;
+	// The most negative value has no positive counterpart
+	if (!ParseInteger(text, &magnitude, &negative) || magnitude > limit + negative)
+		return 0;
+	StoreInteger(data, size, negative ? 0 - magnitude : magnitude);
+	return 1;
+}
+
+double SignedToNumber(const void* data, WoopsaUInt8 size) {
+	return (double)LoadSigned(data, size);
+}
+
+WoopsaBufferSize FormatUnsigned(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const void* data, WoopsaUInt8 size, WoopsaChar8 numericValueBuffer[]) {
+	return AppendInteger(outputBuffer, outputBufferLength, LoadUnsigned(data, size), 0, numericValueBuffer);
+}
+
+WoopsaUInt8 ParseUnsigned(void* data, WoopsaChar8* text, WoopsaUInt8 size) {
+	uint64_t magnitude, limit = size == 8 ? UINT64_MAX : ((uint64_t)1 << (8 * size)) - 1;
+	WoopsaUInt8 negative;
+	if (!ParseInteger(text, &magnitude, &negative) || magnitude > limit || (negative && magnitude != 0))
+		return 0;
+	StoreInteger(data, size, magnitude);
+	return 1;
+}
+
+double UnsignedToNumber(const void* data, WoopsaUInt8 size) {
+	return (double)LoadUnsigned(data, size);
+}
+
+// Reals are floats or doubles. Where double is a float (AVR), both
+// storages have the same size and are handled as floats.
+WoopsaBufferSize FormatReal(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const void* data, WoopsaUInt8 size, WoopsaChar8 numericValueBuffer[]) {
+	if (size == sizeof(float))
+		WOOPSA_REAL_TO_STRING(*(const float*)data, numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
+	else
+		WOOPSA_REAL_TO_STRING(*(const double*)data, numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
+	return Append(outputBuffer, numericValueBuffer, outputBufferLength);
+}
+
+WoopsaUInt8 ParseReal(void* data, WoopsaChar8* text, WoopsaUInt8 size) {
+	WoopsaChar8* end;
+	double value;
+	WOOPSA_STRING_TO_REAL(value, text, &end);
+	if (end == text || !IsBlank(end))
+		return 0;
+	if (size == sizeof(float))
+		*(float*)data = (float)value;
+	else
+		*(double*)data = value;
+	return 1;
+}
+
+double RealToNumber(const void* data, WoopsaUInt8 size) {
+	return size == sizeof(float) ? *(const float*)data : *(const double*)data;
+}
+
+WoopsaBufferSize FormatBool(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const void* data, WoopsaUInt8 size, WoopsaChar8 numericValueBuffer[]) {
+	(void)size;
+	(void)numericValueBuffer;
+	return AppendText(outputBuffer, *(const WoopsaUInt8*)data ? FLASH_TEXT(JSON_TRUE) : FLASH_TEXT(JSON_FALSE), outputBufferLength);
+}
+
+// Whatever the case of true or false
+WoopsaUInt8 ParseBool(void* data, WoopsaChar8* text, WoopsaUInt8 size) {
+	(void)size;
+	StringToLower(text);
+	if (EqualsText(text, FLASH_TEXT(JSON_TRUE)))
+		*(WoopsaUInt8*)data = 1;
+	else if (EqualsText(text, FLASH_TEXT(JSON_FALSE)))
+		*(WoopsaUInt8*)data = 0;
+	else
+		return 0;
+	return 1;
+}
+
+double BoolToNumber(const void* data, WoopsaUInt8 size) {
+	(void)size;
+	return *(const WoopsaUInt8*)data ? 1 : 0;
+}
+
 #ifdef WOOPSA_ENABLE_STRINGS
-	if (isStringValue) {
-		contentLength += Append(outputBuffer, JSON_STRING_DELIMITER, outputBufferLength);
-		contentLength += AppendEscape(outputBuffer, stringValue, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
-		contentLength += Append(outputBuffer, JSON_STRING_DELIMITER, outputBufferLength);
-	} else {
+WoopsaBufferSize FormatText(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const void* data, WoopsaUInt8 size, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaBufferSize contentLength = 0;
+	(void)size;
+	(void)numericValueBuffer;
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_STRING_DELIMITER), outputBufferLength);
+	contentLength += AppendEscape(outputBuffer, (const WoopsaChar8*)data, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_STRING_DELIMITER), outputBufferLength);
+	return contentLength;
+}
+
+WoopsaUInt8 ParseText(void* data, WoopsaChar8* text, WoopsaUInt8 size) {
+	if (WOOPSA_STRING_LENGTH(text) >= size)
+		return 0;
+	WOOPSA_STRING_COPY((WoopsaChar8*)data, text);
+	return 1;
+}
 #endif
-		contentLength += Append(outputBuffer, stringValue, outputBufferLength);
+
+typedef struct {
+	// Size of the storage, 0 for texts
+	WoopsaUInt8 size;
+	// Appends the JSON representation of the value at data
+	// Returns amount of characters actually appended
+	WoopsaBufferSize (*format)(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const void* data, WoopsaUInt8 size, WoopsaChar8 numericValueBuffer[]);
+	// Decodes text into data, text can be modified
+	// Returns 0 if text is not a value of the storage
+	WoopsaUInt8 (*parse)(void* data, WoopsaChar8* text, WoopsaUInt8 size);
+	// Returns the value as a number, NULL for texts
+	double (*toNumber)(const void* data, WoopsaUInt8 size);
+} Codec;
+
+// Indexed by WoopsaStorage
+const Codec Codecs[] WOOPSA_TABLE_PROGMEM = {
+	{ 1, FormatBool, ParseBool, BoolToNumber },
+	{ 1, FormatSigned, ParseSigned, SignedToNumber },
+	{ 2, FormatSigned, ParseSigned, SignedToNumber },
+	{ 4, FormatSigned, ParseSigned, SignedToNumber },
+	{ 8, FormatSigned, ParseSigned, SignedToNumber },
+	{ 1, FormatUnsigned, ParseUnsigned, UnsignedToNumber },
+	{ 2, FormatUnsigned, ParseUnsigned, UnsignedToNumber },
+	{ 4, FormatUnsigned, ParseUnsigned, UnsignedToNumber },
+	{ 8, FormatUnsigned, ParseUnsigned, UnsignedToNumber },
+	{ sizeof(float), FormatReal, ParseReal, RealToNumber },
+	{ sizeof(double), FormatReal, ParseReal, RealToNumber },
 #ifdef WOOPSA_ENABLE_STRINGS
-	}
+	{ 0, FormatText, ParseText, NULL }
+#endif
+};
+
+// Gives access to the codec of a storage, copied to copy when tables are
+// in flash
+const Codec* LoadCodec(WoopsaUInt8 storage, Codec* copy) {
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+	WOOPSA_FLASH_COPY(copy, &Codecs[storage], sizeof(Codec));
+	return copy;
+#else
+	(void)copy;
+	return &Codecs[storage];
 #endif
-	contentLength += Append(outputBuffer, JSON_VALUE_TYPE, outputBufferLength);
-	contentLength += Append(outputBuffer, typeString, outputBufferLength);
-	contentLength += Append(outputBuffer, JSON_VALUE_END, outputBufferLength);
+}
+
+// Appends the JSON representation of the value stored at data
+// Returns amount of characters actually appended
+WoopsaBufferSize AppendValue(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaUInt8 storage, const void* data, WoopsaChar8 numericValueBuffer[]) {
+	Codec copy;
+	const Codec* codec = LoadCodec(storage, &copy);
+	return codec->format(outputBuffer, outputBufferLength, data, codec->size, numericValueBuffer);
+}
+
+// Decodes text into data, which has room for size bytes when it is a text
+// Returns 0 if text is not a valid value
+WoopsaUInt8 ParseValue(WoopsaUInt8 storage, void* data, WoopsaChar8* text, WoopsaUInt8 size) {
+	Codec copy;
+	const Codec* codec = LoadCodec(storage, &copy);
+	return codec->parse(data, text, codec->size != 0 ? codec->size : size);
+}
+
+// Appends the value stored at data with its type, as read and write
+// responses carry it
+WoopsaBufferSize OutputValue(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaUInt8 storage, const void* data, const WoopsaChar8* typeString, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaBufferSize contentLength = 0;
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_VALUE_VALUE), outputBufferLength);
+	WOOPSA_LOCK
+		contentLength += AppendValue(outputBuffer, outputBufferLength, storage, data, numericValueBuffer);
+	WOOPSA_UNLOCK
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_VALUE_TYPE), outputBufferLength);
+	contentLength += AppendText(outputBuffer, typeString, outputBufferLength);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_VALUE_END), outputBufferLength);
 	return contentLength;
 }
 
-WoopsaBufferSize OutputProperty(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaEntry* woopsaEntry, TypesDictionaryEntry* typeEntry, WoopsaChar8 numericValueBuffer[]) {
+#ifdef WOOPSA_ENABLE_GROUP_READS
+// Checks whether name matches pattern, in which * stands for any characters
+WoopsaUInt8 MatchesPattern(const WoopsaChar8* name, const WoopsaChar8* pattern) {
+	const WoopsaChar8* afterWildcard = NULL;
+	const WoopsaChar8* resumeName = NULL;
+	while (*name != '\0') {
+		if (*pattern == PATTERN_WILDCARD_CHAR) {
+			afterWildcard = ++pattern;
+			resumeName = name;
+		} else if (*pattern == *name) {
+			pattern++;
+			name++;
+		} else if (afterWildcard != NULL) {
+			// Let the last wildcard take one more character
+			pattern = afterWildcard;
+			name = ++resumeName;
+		} else {
+			return 0;
+		}
+	}
+	while (*pattern == PATTERN_WILDCARD_CHAR)
+		pattern++;
+	return *pattern == '\0';
+}
+
+// Appends the properties whose name matches pattern as one JSON object
+// of values. With the index, only the entries starting like the pattern
+// are visited, in alphabetical order.
+// Returns the length appended, or -1 if they do not fit in the output buffer
+WoopsaBufferSize OutputPropertyGroup(WoopsaServer* server, WoopsaChar8* pattern, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize responseLength, WoopsaChar8 numericValueBuffer[]) {
 	WoopsaBufferSize contentLength = 0;
+	WoopsaChar8* wildcard = FindText(pattern, FLASH_TEXT(PATTERN_WILDCARD));
+	WoopsaUInt16 i = 0, prefixLength = (WoopsaUInt16)(wildcard - pattern), listed = 0;
+	WoopsaEntry entryCopy;
+	const WoopsaEntry* woopsaEntry;
+	if (server->nameIndexLength != 0) {
+		*wildcard = '\0';
+		i = FindInNameIndex(server, pattern, 0);
+		*wildcard = PATTERN_WILDCARD_CHAR;
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_START), outputBufferLength);
+	for (;; i++) {
+		if (server->nameIndexLength != 0) {
+			if (i == server->nameIndexLength)
+				break;
+			woopsaEntry = LoadEntry(&server->entries[server->nameIndex[i]], &entryCopy);
+			if (WOOPSA_STRING_N_COMPARE(woopsaEntry->name, pattern, prefixLength) != 0)
+				break;
+		} else {
+			woopsaEntry = LoadEntry(&server->entries[i], &entryCopy);
+			if (IsTableEnd(woopsaEntry))
+				break;
+		}
+		if (woopsaEntry->isMethod || !MatchesPattern(woopsaEntry->name, pattern))
+			continue;
+		if ((WoopsaBufferSize)(responseLength + contentLength + GROUP_OVERHEAD_LENGTH + WOOPSA_STRING_LENGTH(woopsaEntry->name)
+				+ (woopsaEntry->storage == WOOPSA_STORAGE_TEXT ? 2 * woopsaEntry->size : MAX_NUMERICAL_VALUE_LENGTH)) > outputBufferLength)
+			return -1;
+		if (listed++ != 0)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_STRING_DELIMITER), outputBufferLength);
+		contentLength += AppendEscape(outputBuffer, woopsaEntry->name, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_MEMBER_VALUE), outputBufferLength);
+		contentLength += OutputValue(outputBuffer, outputBufferLength, woopsaEntry->storage, GetPropertyData(server, woopsaEntry), GetTypeString(woopsaEntry->type), numericValueBuffer);
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	return contentLength;
+}
+#endif
+
+#if defined(WOOPSA_ENABLE_ETAGS) || defined(WOOPSA_ENABLE_DIRTY_BITS)
+// Hashes the current value of a property. Hashing the value rather than
+// counting changes catches the writes made by the application itself.
+WoopsaUInt32 HashPropertyValue(const WoopsaServer* server, const WoopsaEntry* woopsaEntry) {
+	void* data = GetPropertyData(server, woopsaEntry);
+	WoopsaUInt32 hash;
+	WOOPSA_LOCK
 #ifdef WOOPSA_ENABLE_STRINGS
-	if (woopsaEntry->type == WOOPSA_TYPE_TEXT
-		|| woopsaEntry->type == WOOPSA_TYPE_LINK
-		|| woopsaEntry->type == WOOPSA_TYPE_RESOURCE_URL
-		|| woopsaEntry->type == WOOPSA_TYPE_DATE_TIME) {
+		if (woopsaEntry->storage == WOOPSA_STORAGE_TEXT)
+			hash = HashString((WoopsaChar8*)data);
+		else
+#endif
+			hash = HashBytes(HASH_SEED, data, woopsaEntry->size);
+	WOOPSA_UNLOCK
+	return hash;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_ETAGS
+// Hashes what the meta document is made of. It only depends on the
+// entries, so it is computed once.
+WoopsaUInt32 HashMeta(const WoopsaEntry entries[]) {
+	WoopsaUInt32 hash = HASH_SEED;
+	WoopsaUInt8 attributes[3];
+	WoopsaEntry copy;
+	const WoopsaEntry* woopsaEntry;
+	for (; !IsTableEnd(woopsaEntry = LoadEntry(entries, &copy)); entries++) {
+		hash = HashBytes(hash, woopsaEntry->name, WOOPSA_STRING_LENGTH(woopsaEntry->name) + 1);
+		attributes[0] = (WoopsaUInt8)woopsaEntry->type;
+		attributes[1] = (WoopsaUInt8)woopsaEntry->readOnly;
+		attributes[2] = (WoopsaUInt8)woopsaEntry->isMethod;
+		hash = HashBytes(hash, attributes, sizeof attributes);
+	}
+	return hash;
+}
+
+// Writes a hash as a quoted ETag
+void FormatETag(WoopsaUInt32 hash, WoopsaChar8 etag[ETAG_LENGTH + 1]) {
+	WoopsaUInt8 i, digit;
+	etag[0] = ETAG_QUOTE;
+	for (i = 0; i < 8; i++) {
+		digit = (WoopsaUInt8)((hash >> (28 - 4 * i)) & 0xF);
+		etag[i + 1] = (WoopsaChar8)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+	}
+	etag[ETAG_LENGTH - 1] = ETAG_QUOTE;
+	etag[ETAG_LENGTH] = '\0';
+}
+
+// Computes the ETag of a GET request on woopsaPath. Only meta and
+// property reads have one.
+// Returns 1 if there is an ETag, 0 otherwise
+WoopsaUInt8 GetETag(WoopsaServer* server, WoopsaChar8* woopsaPath, WoopsaChar8 etag[ETAG_LENGTH + 1]) {
+	const WoopsaEntry* woopsaEntry = NULL;
+	WoopsaEntry entryCopy;
+	if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_META))) {
+		FormatETag(server->metaETag, etag);
+		return 1;
+	} else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_READ))) {
+		if ((woopsaEntry = GetPropertyByNameOrNull(server, &(woopsaPath[sizeof(VERB_READ)]))) == NULL)
+			return 0;
+		FormatETag(HashPropertyValue(server, LoadEntry(woopsaEntry, &entryCopy)), etag);
+		return 1;
+	}
+	return 0;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_HISTORY
+WoopsaHistory* GetHistoryByNameOrNull(WoopsaServer* server, WoopsaChar8 name[]) {
+	WoopsaHistory* history;
+	for (history = server->histories; history != NULL; history = history->next)
+		if (WOOPSA_STRING_EQUAL(history->name, name))
+			return history;
+	return NULL;
+}
+
+// Serializes the samples of a history that are newer than the sequence
+// number (since) or the time (after) given in the query. Samples that
+// do not fit in the output buffer are left for the next request,
+// the client resumes from the "Last" sequence number.
+WoopsaBufferSize OutputHistory(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize responseLength, WoopsaHistory* history, const WoopsaChar8* query, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaBufferSize contentLength = 0;
+	WoopsaChar8 parameter[MAX_PARAMETER_LENGTH];
+	WoopsaHistorySample sample;
+	WoopsaEntry entryCopy;
+	const WoopsaEntry* woopsaEntry = LoadEntry(history->entry, &entryCopy);
+	WoopsaUInt32 since = 0, after = 0, first, last, oldest, sequence, missed = 0;
+	WoopsaUInt8 filterTime = 0, sampleAt = 0;
+	WOOPSA_LOCK
+		first = history->nextSequence - history->count;
+		last = history->nextSequence - 1;
+	WOOPSA_UNLOCK
+	oldest = first;
+	if (FindURLDecodedValue(query, FLASH_TEXT(QUERY_SINCE_KEY), parameter, sizeof(parameter))) {
+		WOOPSA_STRING_TO_UNSIGNED(since, parameter);
+		// Samples between since and the oldest one have been overwritten.
+		// A since in the future comes from before a restart: resend everything.
+		if (since + 1 < oldest)
+			missed = oldest - since - 1;
+		else if (since <= last)
+			first = since + 1;
+	} else if (FindURLDecodedValue(query, FLASH_TEXT(QUERY_AFTER_KEY), parameter, sizeof(parameter))) {
+		WOOPSA_STRING_TO_UNSIGNED(after, parameter);
+		filterTime = 1;
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_HISTORY_TYPE), outputBufferLength);
+	contentLength += AppendText(outputBuffer, GetTypeString(woopsaEntry->type), outputBufferLength);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_HISTORY_SAMPLES JSON_ARRAY_START), outputBufferLength);
+	for (sequence = first; (long)(last - sequence) >= 0; sequence++) {
+		if (responseLength + contentLength + HISTORY_SAMPLE_MAX_LENGTH > outputBufferLength)
+			break;
+		WOOPSA_LOCK
+			// The sample may have been overwritten by a recording in the meantime
+			if (history->nextSequence - sequence > history->count) {
+				WOOPSA_UNLOCK
+				continue;
+			}
+			sample = history->samples[(history->head + history->capacity - (history->nextSequence - sequence)) % history->capacity];
+		WOOPSA_UNLOCK
+		if (filterTime && (long)(sample.timestamp - after) <= 0)
+			continue;
+		if (sampleAt++ != 0)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_SAMPLE_SEQUENCE), outputBufferLength);
+		WOOPSA_UNSIGNED_TO_STRING(sample.sequence, parameter, MAX_PARAMETER_LENGTH);
+		contentLength += Append(outputBuffer, parameter, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_SAMPLE_TIME), outputBufferLength);
+		WOOPSA_UNSIGNED_TO_STRING(sample.timestamp, parameter, MAX_PARAMETER_LENGTH);
+		contentLength += Append(outputBuffer, parameter, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_SAMPLE_VALUE), outputBufferLength);
+		contentLength += AppendValue(outputBuffer, outputBufferLength, woopsaEntry->storage, sample.value.bytes, numericValueBuffer);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_HISTORY_LAST), outputBufferLength);
+	WOOPSA_UNSIGNED_TO_STRING(sequence - 1, parameter, MAX_PARAMETER_LENGTH);
+	contentLength += Append(outputBuffer, parameter, outputBufferLength);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_HISTORY_MISSED), outputBufferLength);
+	WOOPSA_UNSIGNED_TO_STRING(missed, parameter, MAX_PARAMETER_LENGTH);
+	contentLength += Append(outputBuffer, parameter, outputBufferLength);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	return contentLength;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+// Appends the changes of the journal from *sequence to last as a JSON
+// array, as many as fit in the output buffer. With a pattern, only the
+// properties matching it are listed. *sequence is moved past the changes
+// gone through.
+// Returns the number of changes listed, or -1 if a change was overwritten
+// by a recording in the meantime
+WoopsaInt16 OutputJournal(WoopsaServer* server, WoopsaUInt32* sequence, WoopsaUInt32 last, const WoopsaChar8* pattern, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength,
+		WoopsaBufferSize responseLength, WoopsaBufferSize* contentLength, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaChar8 parameter[MAX_PARAMETER_LENGTH];
+	WoopsaJournalRecord record;
+	WoopsaEntry entryCopy;
+	const WoopsaEntry* woopsaEntry;
+	WoopsaInt16 listed = 0;
+	// Patterns are only matched with group reads
+	(void)pattern;
+	*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_START), outputBufferLength);
+	for (; (long)(last - *sequence) >= 0; (*sequence)++) {
 		WOOPSA_LOCK
-			contentLength += OutputSerializedValue(outputBuffer, outputBufferLength, (WoopsaChar8*)woopsaEntry->address.data, typeEntry->string, 1);
+			if (server->journalSequence - *sequence > server->journalCount) {
+				WOOPSA_UNLOCK
+				*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END), outputBufferLength);
+				return -1;
+			}
+			record = server->journal[(server->journalHead + WOOPSA_JOURNAL_SIZE - (server->journalSequence - *sequence)) % WOOPSA_JOURNAL_SIZE];
 		WOOPSA_UNLOCK
-	} else if ( woopsaEntry->type == WOOPSA_TYPE_LOGICAL ){
+		woopsaEntry = LoadEntry(&server->entries[record.entry], &entryCopy);
+#ifdef WOOPSA_ENABLE_GROUP_READS
+		if (pattern != NULL && !MatchesPattern(woopsaEntry->name, pattern))
+			continue;
+#endif
+		if ((WoopsaBufferSize)(responseLength + *contentLength + CHANGE_OVERHEAD_LENGTH + WOOPSA_STRING_LENGTH(woopsaEntry->name)
+				+ (woopsaEntry->storage == WOOPSA_STORAGE_TEXT ? 2 * woopsaEntry->size : MAX_NUMERICAL_VALUE_LENGTH)) > outputBufferLength)
+			break;
+		if (listed++ != 0)
+			*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+		*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_SAMPLE_SEQUENCE), outputBufferLength);
+		WOOPSA_UNSIGNED_TO_STRING(record.sequence, parameter, MAX_PARAMETER_LENGTH);
+		*contentLength += Append(outputBuffer, parameter, outputBufferLength);
+		*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_CHANGE_NAME), outputBufferLength);
+		*contentLength += AppendEscape(outputBuffer, woopsaEntry->name, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
+		*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_CHANGE_VALUE), outputBufferLength);
+		if (woopsaEntry->size <= WOOPSA_JOURNAL_VALUE_SIZE) {
+			*contentLength += AppendValue(outputBuffer, outputBufferLength, woopsaEntry->storage, record.value.bytes, numericValueBuffer);
+		} else {
+			WOOPSA_LOCK
+				*contentLength += AppendValue(outputBuffer, outputBufferLength, woopsaEntry->storage, GetPropertyData(server, woopsaEntry), numericValueBuffer);
+			WOOPSA_UNLOCK
+		}
+		*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	}
+	*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END), outputBufferLength);
+	return listed;
+}
+
+// Serializes the changes of the journal after the sequence number of the
+// query, as many as fit in the output buffer
+WoopsaBufferSize OutputChanges(WoopsaServer* server, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize responseLength, const WoopsaChar8* query, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaBufferSize contentLength = 0;
+	WoopsaChar8 parameter[MAX_PARAMETER_LENGTH];
+	WoopsaUInt32 since, oldest, last, sequence;
+	WoopsaUInt8 resync = 0;
+	WoopsaServerRecordChanges(server);
+	WOOPSA_LOCK
+		oldest = server->journalSequence - server->journalCount;
+		last = server->journalSequence - 1;
+	WOOPSA_UNLOCK
+	since = last;
+	if (FindURLDecodedValue(query, FLASH_TEXT(QUERY_SINCE_KEY), parameter, sizeof(parameter)))
+		WOOPSA_STRING_TO_UNSIGNED(since, parameter);
+	// Changes between since and the oldest one have been overwritten.
+	// A since in the future comes from before a restart.
+	if (since + 1 < oldest || (long)(last - since) < 0) {
+		resync = 1;
+		since = last;
+	}
+	sequence = since + 1;
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_CHANGES), outputBufferLength);
+	if (OutputJournal(server, &sequence, last, NULL, outputBuffer, outputBufferLength, responseLength, &contentLength, numericValueBuffer) < 0) {
+		// Whatever the client missed is older than last
+		resync = 1;
+		sequence = last + 1;
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_HISTORY_LAST), outputBufferLength);
+	WOOPSA_UNSIGNED_TO_STRING(sequence - 1, parameter, MAX_PARAMETER_LENGTH);
+	contentLength += Append(outputBuffer, parameter, outputBufferLength);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_CHANGES_RESYNC), outputBufferLength);
+	contentLength += AppendText(outputBuffer, resync ? FLASH_TEXT(JSON_TRUE) : FLASH_TEXT(JSON_FALSE), outputBufferLength);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	return contentLength;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+// Checks whether a property changed since it was last sent on a stream
+// and remembers its current value if so, or if it is sent anyway
+// Returns 1 if the property must be sent
+WoopsaUInt8 EventStreamPropertyChanged(WoopsaEventStream* eventStream, WoopsaEventStreamProperty* property, const WoopsaEntry* woopsaEntry, void* data, WoopsaUInt8 sendAll) {
+	double number, difference;
+	WoopsaUInt32 hash;
+	Codec copy;
+	const Codec* codec = LoadCodec(woopsaEntry->storage, &copy);
+#ifdef WOOPSA_ENABLE_STRINGS
+	if (woopsaEntry->storage == WOOPSA_STORAGE_TEXT) {
 		WOOPSA_LOCK
-			contentLength += OutputSerializedValue(outputBuffer, outputBufferLength, *(WoopsaChar8*)(woopsaEntry->address.data)?JSON_TRUE:JSON_FALSE, typeEntry->string, 0);
+			hash = HashString((WoopsaChar8*)data);
 		WOOPSA_UNLOCK
-	} else {
+		if (hash == property->lastSent.hash && !sendAll)
+			return 0;
+		property->lastSent.hash = hash;
+		return 1;
+	}
+#endif
+	// 64-bit integers lose their lowest digits, which is fine for a deadband
+	WOOPSA_LOCK
+		number = codec->toNumber(data, codec->size);
+	WOOPSA_UNLOCK
+	difference = number - property->lastSent.number;
+	if (difference < 0)
+		difference = -difference;
+	if ((difference == 0 || difference <= eventStream->deadband) && !sendAll)
+		return 0;
+	property->lastSent.number = number;
+	return 1;
+}
+
+// Appends one event per changed property of the stream, as text/event-stream
+// messages or as a JSON array
+WoopsaBufferSize OutputEvents(const WoopsaServer* server, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize responseLength,
+		WoopsaEventStream* eventStream, WoopsaUInt8 sendAll, WoopsaUInt8 format, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaBufferSize contentLength = 0;
+	WoopsaEventStreamProperty* property;
+	WoopsaEntry entryCopy;
+	const WoopsaEntry* woopsaEntry;
+	void* data;
+	WoopsaUInt8 i = 0, eventAt = 0;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	// Read once, a snapshot taken during the scan is scanned next time
+	WoopsaUInt16 snapshotSequence = server->snapshotSequence;
+	if (eventStream->fieldsOnly && server->snapshot != NULL && eventStream->snapshotSequence == snapshotSequence && !sendAll)
+		i = eventStream->propertyCount;
 #endif
+	if (format == EVENT_FORMAT_JSON)
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_START), outputBufferLength);
+	for (; i < eventStream->propertyCount; i++) {
+		property = &eventStream->properties[i];
+		woopsaEntry = LoadEntry(property->entry, &entryCopy);
+		// Keep the remaining changes for the next poll
+		if ((WoopsaBufferSize)(responseLength + contentLength + EVENT_OVERHEAD_LENGTH + WOOPSA_STRING_LENGTH(woopsaEntry->name) 
+				+ (woopsaEntry->storage == WOOPSA_STORAGE_TEXT ? 2 * woopsaEntry->size : MAX_NUMERICAL_VALUE_LENGTH)) > outputBufferLength)
+			break;
+		data = GetPropertyData(server, woopsaEntry);
+		if (!EventStreamPropertyChanged(eventStream, property, woopsaEntry, data, sendAll))
+			continue;
+		if (format == EVENT_FORMAT_STREAM)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(EVENT_DATA), outputBufferLength);
+		else if (eventAt != 0)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+		eventAt++;
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_PROPERTY_NAME), outputBufferLength);
+		contentLength += AppendEscape(outputBuffer, woopsaEntry->name, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(EVENT_VALUE), outputBufferLength);
 		WOOPSA_LOCK
-		if (woopsaEntry->type == WOOPSA_TYPE_INTEGER)
-			WOOPSA_INTEGER_TO_STRING(*(int*)woopsaEntry->address.data, numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
-		else
-			WOOPSA_REAL_TO_STRING(*(float*)(woopsaEntry->address.data), numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
+			contentLength += AppendValue(outputBuffer, outputBufferLength, woopsaEntry->storage, data, numericValueBuffer);
 		WOOPSA_UNLOCK
-		contentLength += OutputSerializedValue(outputBuffer, outputBufferLength, numericValueBuffer, typeEntry->string, 0);
-#ifdef WOOPSA_ENABLE_STRINGS
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_VALUE_TYPE), outputBufferLength);
+		contentLength += AppendText(outputBuffer, GetTypeString(woopsaEntry->type), outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_VALUE_END), outputBufferLength);
+		if (format == EVENT_FORMAT_STREAM)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(EVENT_END), outputBufferLength);
 	}
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	if (i == eventStream->propertyCount)
+		eventStream->snapshotSequence = snapshotSequence;
 #endif
+	if (format == EVENT_FORMAT_JSON)
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END), outputBufferLength);
 	return contentLength;
 }
 
+// Opens an event stream on the properties listed in the query
+// Returns the index of the stream, or -1 if none is free
+WoopsaInt16 OpenEventStream(WoopsaServer* server, WoopsaChar8* query, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaEventStream* eventStream = NULL;
+	WoopsaChar8 *name, *nameEnd;
+	WoopsaUInt8 i, last = 0;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	WoopsaEntry entryCopy;
+	WoopsaUInt8 j;
+#endif
+	for (i = 0; i < WOOPSA_MAX_EVENT_STREAMS; i++) {
+		if (!server->eventStreams[i].open) {
+			eventStream = &server->eventStreams[i];
+			break;
+		}
+	}
+	if (eventStream == NULL)
+		return -1;
+	eventStream->deadband = 0;
+	eventStream->propertyCount = 0;
+	if (FindURLDecodedValue(query, FLASH_TEXT(QUERY_DEADBAND_KEY), numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH))
+		WOOPSA_STRING_TO_FLOAT(eventStream->deadband, numericValueBuffer);
+	// The property list is decoded in place, the query is not needed afterwards
+	if (!FindURLDecodedValue(query, FLASH_TEXT(QUERY_PROPERTIES_KEY), query, WOOPSA_STRING_LENGTH(query) + 1))
+		return -2;
+	for (name = query; !last && eventStream->propertyCount < WOOPSA_EVENT_STREAM_PROPERTIES; name = nameEnd + 1) {
+		for (nameEnd = name; *nameEnd != '\0' && *nameEnd != QUERY_LIST_SEPARATOR; nameEnd++);
+		last = (*nameEnd == '\0');
+		*nameEnd = '\0';
+		if (*name == '\0')
+			continue;
+		if ((eventStream->properties[eventStream->propertyCount].entry = GetPropertyByNameOrNull(server, name)) == NULL)
+			return -2;
+		eventStream->propertyCount++;
+	}
+	if (eventStream->propertyCount == 0)
+		return -2;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	eventStream->fieldsOnly = 1;
+	for (j = 0; j < eventStream->propertyCount; j++)
+		if (!LoadEntry(eventStream->properties[j].entry, &entryCopy)->isField)
+			eventStream->fieldsOnly = 0;
+#endif
+	eventStream->open = 1;
+	return i;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+#define SHA1_ROTATE(value, bits) ((((value) << (bits)) | (((value) & 0xFFFFFFFFUL) >> (32 - (bits)))) & 0xFFFFFFFFUL)
+
+// Processes one 64-byte block of a SHA-1 computation
+void Sha1Block(WoopsaUInt32 state[5], const WoopsaUInt8 block[64]) {
+	WoopsaUInt32 w[16], a, b, c, d, e, f, k, temp;
+	WoopsaUInt8 i;
+	for (i = 0; i < 16; i++)
+		w[i] = ((WoopsaUInt32)block[i * 4] << 24) | ((WoopsaUInt32)block[i * 4 + 1] << 16) | ((WoopsaUInt32)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+	a = state[0]; b = state[1]; c = state[2]; d = state[3]; e = state[4];
+	for (i = 0; i < 80; i++) {
+		if (i >= 16)
+			w[i & 15] = SHA1_ROTATE(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], 1);
+		if (i < 20) {
+			f = (b & c) | (~b & d);
+			k = 0x5A827999UL;
+		} else if (i < 40) {
+			f = b ^ c ^ d;
+			k = 0x6ED9EBA1UL;
+		} else if (i < 60) {
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8F1BBCDCUL;
+		} else {
+			f = b ^ c ^ d;
+			k = 0xCA62C1D6UL;
+		}
+		temp = (SHA1_ROTATE(a, 5) + (f & 0xFFFFFFFFUL) + e + k + w[i & 15]) & 0xFFFFFFFFUL;
+		e = d; d = c; c = SHA1_ROTATE(b, 30); b = a; a = temp;
+	}
+	state[0] = (state[0] + a) & 0xFFFFFFFFUL;
+	state[1] = (state[1] + b) & 0xFFFFFFFFUL;
+	state[2] = (state[2] + c) & 0xFFFFFFFFUL;
+	state[3] = (state[3] + d) & 0xFFFFFFFFUL;
+	state[4] = (state[4] + e) & 0xFFFFFFFFUL;
+}
+
+// Computes the SHA-1 digest of the concatenation of a string and a
+// constant text
+void Sha1(const WoopsaChar8* first, const WoopsaChar8* second, WoopsaUInt8 digest[SHA1_DIGEST_LENGTH]) {
+	WoopsaUInt32 state[5] = { 0x67452301UL, 0xEFCDAB89UL, 0x98BADCFEUL, 0x10325476UL, 0xC3D2E1F0UL };
+	WoopsaUInt8 block[64];
+	WoopsaUInt32 length = 0;
+	WoopsaUInt8 at = 0, i, byte;
+	const WoopsaChar8* parts[2];
+	const WoopsaChar8* source;
+	parts[0] = first;
+	parts[1] = second;
+	for (i = 0; i < 2; i++) {
+		for (source = parts[i]; (byte = (i == 0) ? (WoopsaUInt8)*source : FLASH_BYTE(source)) != '\0'; source++) {
+			block[at++] = byte;
+			length++;
+			if (at == 64) {
+				Sha1Block(state, block);
+				at = 0;
+			}
+		}
+	}
+	// Padding, then the message length in bits
+	block[at++] = 0x80;
+	if (at > 56) {
+		while (at < 64)
+			block[at++] = 0;
+		Sha1Block(state, block);
+		at = 0;
+	}
+	while (at < 56)
+		block[at++] = 0;
+	length *= 8;
+	block[56] = block[57] = block[58] = block[59] = 0;
+	block[60] = (WoopsaUInt8)(length >> 24);
+	block[61] = (WoopsaUInt8)(length >> 16);
+	block[62] = (WoopsaUInt8)(length >> 8);
+	block[63] = (WoopsaUInt8)length;
+	Sha1Block(state, block);
+	for (i = 0; i < SHA1_DIGEST_LENGTH; i++)
+		digest[i] = (WoopsaUInt8)(state[i / 4] >> (24 - (i % 4) * 8));
+}
+
+// Encodes binary data in base64
+// Returns the length of the encoded string
+WoopsaBufferSize Base64Encode(const WoopsaUInt8* data, WoopsaBufferSize length, WoopsaChar8* encoded) {
+	static const WoopsaChar8 alphabet[] WOOPSA_TABLE_PROGMEM = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	WoopsaBufferSize i, at = 0;
+	WoopsaUInt32 triple;
+	for (i = 0; i < length; i += 3) {
+		triple = (WoopsaUInt32)data[i] << 16;
+		if (i + 1 < length)
+			triple |= (WoopsaUInt32)data[i + 1] << 8;
+		if (i + 2 < length)
+			triple |= data[i + 2];
+		encoded[at++] = (WoopsaChar8)FLASH_BYTE(alphabet + ((triple >> 18) & 0x3F));
+		encoded[at++] = (WoopsaChar8)FLASH_BYTE(alphabet + ((triple >> 12) & 0x3F));
+		encoded[at++] = (i + 1 < length) ? (WoopsaChar8)FLASH_BYTE(alphabet + ((triple >> 6) & 0x3F)) : '=';
+		encoded[at++] = (i + 2 < length) ? (WoopsaChar8)FLASH_BYTE(alphabet + (triple & 0x3F)) : '=';
+	}
+	encoded[at] = '\0';
+	return at;
+}
+
+// Writes the header of an unmasked frame carrying payloadLength bytes
+// Returns the length of the header
+WoopsaBufferSize WriteWebSocketFrameHeader(WoopsaChar8* outputBuffer, WoopsaUInt8 opcode, WoopsaBufferSize payloadLength) {
+	outputBuffer[0] = (WoopsaChar8)(WEBSOCKET_FIN | opcode);
+	if (payloadLength < WEBSOCKET_LENGTH_16BIT) {
+		outputBuffer[1] = (WoopsaChar8)payloadLength;
+		return 2;
+	}
+	outputBuffer[1] = WEBSOCKET_LENGTH_16BIT;
+	outputBuffer[2] = (WoopsaChar8)(payloadLength >> 8);
+	outputBuffer[3] = (WoopsaChar8)payloadLength;
+	return 4;
+}
+
+// Frames the payload written at outputBuffer + WEBSOCKET_MAX_HEADER_LENGTH,
+// moving it right behind the frame header
+// Returns the length of the frame
+WoopsaBufferSize FrameWebSocketPayload(WoopsaChar8* outputBuffer, WoopsaUInt8 opcode, WoopsaBufferSize payloadLength) {
+	WoopsaChar8 header[WEBSOCKET_MAX_HEADER_LENGTH];
+	WoopsaBufferSize headerLength = WriteWebSocketFrameHeader(header, opcode, payloadLength);
+	memmove(outputBuffer + headerLength, outputBuffer + WEBSOCKET_MAX_HEADER_LENGTH, payloadLength);
+	memcpy(outputBuffer, header, headerLength);
+	return headerLength + payloadLength;
+}
+
+// Prepares the 101 response completing a WebSocket handshake
+WoopsaBufferSize PrepareWebSocketHandshake(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const WoopsaChar8* key) {
+	WoopsaUInt8 digest[SHA1_DIGEST_LENGTH];
+	WoopsaChar8 accept[WEBSOCKET_ACCEPT_LENGTH + 1];
+	WoopsaBufferSize size;
+	Sha1(key, FLASH_TEXT(WEBSOCKET_GUID), digest);
+	Base64Encode(digest, SHA1_DIGEST_LENGTH, accept);
+	outputBuffer[0] = '\0';
+	size = AppendText(outputBuffer, FLASH_TEXT(HTTP_VERSION_STRING " " HTTP_CODE_SWITCHING_PROTOCOLS " " HTTP_TEXT_SWITCHING_PROTOCOLS HEADER_SEPARATOR WEBSOCKET_UPGRADE_HEADERS HEADER_WEBSOCKET_ACCEPT), outputBufferLength);
+	size += Append(outputBuffer, accept, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR), outputBufferLength);
+	return size;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+// Returns the asset served at this path, or NULL if there is none.
+// Paths ending with a slash serve their index.html.
+const WoopsaStaticAsset* GetAssetByPathOrNull(const WoopsaStaticAsset* assets, const WoopsaChar8* path) {
+	WoopsaBufferSize length = WOOPSA_STRING_LENGTH(path);
+	for (; assets->path != NULL; assets++) {
+		if (WOOPSA_STRING_EQUAL(assets->path, path))
+			return assets;
+		if (length > 0 && path[length - 1] == '/' && strncmp(assets->path, path, length) == 0
+				&& EqualsText(assets->path + length, FLASH_TEXT(ASSET_DIRECTORY_INDEX)))
+			return assets;
+	}
+	return NULL;
+}
+
+// Prepares the headers of an asset response. The content is not part of
+// it, it is copied from flash by WoopsaStaticAssetRead.
+WoopsaBufferSize PrepareAssetResponse(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const WoopsaStaticAsset* asset, WoopsaUInt8 isNotModified) {
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	WoopsaBufferSize size;
+	outputBuffer[0] = '\0';
+	if (isNotModified)
+		size = AppendText(outputBuffer, FLASH_TEXT(HTTP_VERSION_STRING " " HTTP_CODE_NOT_MODIFIED " " HTTP_TEXT_NOT_MODIFIED HEADER_SEPARATOR), outputBufferLength);
+	else
+		size = AppendText(outputBuffer, FLASH_TEXT(HTTP_VERSION_STRING " " HTTP_CODE_OK " " HTTP_TEXT_OK HEADER_SEPARATOR), outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_CONTENT_TYPE), outputBufferLength);
+	size += Append(outputBuffer, asset->contentType, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR), outputBufferLength);
+	if (asset->isGzipped)
+		size += AppendText(outputBuffer, FLASH_TEXT(HEADER_CONTENT_ENCODING_GZIP HEADER_SEPARATOR), outputBufferLength);
+	// Browsers revalidate on every load, which costs a 304 instead of the asset
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_ETAG), outputBufferLength);
+	size += Append(outputBuffer, asset->etag, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR HEADER_CACHE_REVALIDATE HEADER_SEPARATOR EXTRA_HEADERS), outputBufferLength);
+	if (!isNotModified) {
+		WOOPSA_UNSIGNED_TO_STRING(asset->length, numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
+		size += AppendText(outputBuffer, FLASH_TEXT(HEADER_CONTENT_LENGTH_NAME), outputBufferLength);
+		size += Append(outputBuffer, numericValueBuffer, outputBufferLength);
+		size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR), outputBufferLength);
+	}
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR), outputBufferLength);
+	return size;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+// Decoded writes go to a queue slot that only the server uses until it
+// is published, without taking the lock
+#define WRITE_LOCK
+#define WRITE_UNLOCK
+#define WRITE_QUEUE_MASK (WOOPSA_WRITE_QUEUE_SIZE - 1)
+
+// Returns the slot where the write following the next position ones
+// can be decoded (position 0 for the next write), or NULL if the queue
+// is too full
+WoopsaPendingWrite* ReservePendingWrite(WoopsaServer* server, WoopsaUInt8 position) {
+	WoopsaUInt8 head = (WoopsaUInt8)(server->writeHead + position);
+	if ((WoopsaUInt8)(head - server->writeTail) >= WOOPSA_WRITE_QUEUE_SIZE)
+		return NULL;
+	return &server->pendingWrites[head & WRITE_QUEUE_MASK];
+}
+
+// Hands the next count reserved slots over to WoopsaApplyPendingWrites,
+// which sees all of them at once
+void PublishPendingWrites(WoopsaServer* server, WoopsaUInt8 count) {
+	// The slots must be complete before the consumer can see them
+	WOOPSA_MEMORY_BARRIER();
+	server->writeHead = (WoopsaUInt8)(server->writeHead + count);
+}
+#else
+#define WRITE_LOCK		WOOPSA_LOCK
+#define WRITE_UNLOCK	WOOPSA_UNLOCK
+#endif
+
+#ifdef WOOPSA_ENABLE_DIRTY_BITS
+#define DIRTY_WORD(index)	((index) / WOOPSA_DIRTY_WORD_BITS)
+#define DIRTY_BIT(index)	((WoopsaDirtyWord)1 << ((index) % WOOPSA_DIRTY_WORD_BITS))
+
+// Position of the lowest bit set in a word that is not 0
+#ifdef __GNUC__
+#define LOWEST_BIT(word)	((WoopsaUInt8)__builtin_ctzl(word))
+#else
+#define LOWEST_BIT(word)	LowestBit(word)
+WoopsaUInt8 LowestBit(WoopsaDirtyWord word) {
+	WoopsaUInt8 bit = 0;
+	for (; (word & 0xFF) == 0; word >>= 8)
+		bit += 8;
+	for (; (word & 1) == 0; word >>= 1)
+		bit++;
+	return bit;
+}
+#endif
+
+void SetDirty(WoopsaServer* server, WoopsaUInt16 entryIndex) {
+	if (entryIndex >= WOOPSA_DIRTY_ENTRIES)
+		return;
+	WOOPSA_LOCK
+		server->dirty[DIRTY_WORD(entryIndex)] |= DIRTY_BIT(entryIndex);
+	WOOPSA_UNLOCK
+}
+#endif
+
+#if defined(WOOPSA_ENABLE_DIRTY_BITS) || defined(WOOPSA_ENABLE_WRITE_HOOK)
+// Tells that a client wrote a property, once its new value is stored
+void PropertyWritten(WoopsaServer* server, WoopsaUInt16 entryIndex) {
+#ifdef WOOPSA_ENABLE_DIRTY_BITS
+	SetDirty(server, entryIndex);
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_HOOK
+	if (server->writeHook != NULL)
+		server->writeHook(&server->entries[entryIndex]);
+#endif
+}
+#endif
+
+#if defined(WOOPSA_ENABLE_WRITE_QUEUE) || defined(WOOPSA_ENABLE_TRANSACTIONS)
+// Stores a queued or staged value in its property, or hands it to the
+// setter of a computed property
+void StorePendingWrite(const WoopsaServer* server, const WoopsaEntry* woopsaEntry, const void* value) {
+	void* data = woopsaEntry->address.data;
+	(void)server;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	if (woopsaEntry->isField)
+		data = FIELD_DATA(server->instance, woopsaEntry);
+#endif
+#ifdef WOOPSA_ENABLE_ACCESSORS
+	if (woopsaEntry->isComputed) {
+		woopsaEntry->address.accessor->setter(value);
+		woopsaEntry->address.accessor->cacheValid = 0;
+		return;
+	}
+#endif
+#ifdef WOOPSA_ENABLE_STRINGS
+	if (woopsaEntry->storage == WOOPSA_STORAGE_TEXT) {
+		WOOPSA_STRING_COPY((WoopsaChar8*)data, (const WoopsaChar8*)value);
+		return;
+	}
+#endif
+	memcpy(data, value, woopsaEntry->size);
+}
+#endif
+
+// Appends the meta description of a property or method, without the
+// first nameOffset characters of its name (its subobject)
+// Returns the length appended
+WoopsaBufferSize AppendMetaEntry(WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, const WoopsaEntry* woopsaEntry, WoopsaBufferSize nameOffset) {
+	WoopsaBufferSize contentLength = 0;
+	const WoopsaChar8* typeString = GetTypeString(woopsaEntry->type);
+	if (woopsaEntry->isMethod == 0) {
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_PROPERTY_NAME), outputBufferLength);
+		contentLength += AppendEscape(outputBuffer, woopsaEntry->name + nameOffset, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_PROPERTY_TYPE), outputBufferLength);
+		contentLength += AppendText(outputBuffer, typeString, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_PROPERTY_READONLY), outputBufferLength);
+		contentLength += AppendText(outputBuffer, (woopsaEntry->readOnly == 1) ? FLASH_TEXT(JSON_TRUE) : FLASH_TEXT(JSON_FALSE), outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_PROPERTY_END), outputBufferLength);
+	} else {
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_METHOD_NAME), outputBufferLength);
+		contentLength += AppendEscape(outputBuffer, woopsaEntry->name + nameOffset, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_METHOD_RETURN_TYPE), outputBufferLength);
+		contentLength += AppendText(outputBuffer, typeString, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_METHOD_END), outputBufferLength);
+	}
+	return contentLength;
+}
+
+// Appends the meta document from cursor on, visiting at most count entries
+// of the table (all of them if count is 0): the properties in a first pass,
+// then the methods. Start with cursor->pass set to META_START, the document
+// is complete once it is META_DONE.
+// Returns the length appended
+WoopsaBufferSize OutputMeta(const WoopsaEntry entries[], WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaMetaCursor* cursor, WoopsaUInt16 count) {
+	WoopsaBufferSize contentLength = 0;
+	WoopsaUInt16 visited = 0;
+	const WoopsaEntry* woopsaEntry = NULL;
+	WoopsaEntry entryCopy;
+	if (cursor->pass == META_START) {
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_META_PROPERTIES JSON_ARRAY_START), outputBufferLength);
+		cursor->pass = META_PROPERTIES;
+		cursor->entry = 0;
+		cursor->listed = 0;
+	}
+	for (; cursor->pass != META_DONE && (count == 0 || visited < count); visited++) {
+		woopsaEntry = LoadEntry(&entries[cursor->entry], &entryCopy);
+		if (IsTableEnd(woopsaEntry)) {
+			// End of the table, close the list of this pass
+			if (cursor->pass == META_PROPERTIES) {
+				contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_META_METHODS JSON_ARRAY_START), outputBufferLength);
+				cursor->pass = META_METHODS;
+			} else {
+				contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_META_END), outputBufferLength);
+				cursor->pass = META_DONE;
+			}
+			cursor->entry = 0;
+			cursor->listed = 0;
+			continue;
+		}
+		cursor->entry++;
+		if ((woopsaEntry->isMethod != 0) != (cursor->pass == META_METHODS))
+			continue;
+		if (cursor->listed++ != 0)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+		contentLength += AppendMetaEntry(outputBuffer, outputBufferLength, woopsaEntry, 0);
+	}
+	return contentLength;
+}
+
+#ifdef WOOPSA_ENABLE_PAGED_META
+// Appends the page of the meta document that query asks for: the entries
+// whose name starts with its prefix, in alphabetical order with the index,
+// from its offset on and at most its limit of them. The properties of the
+// page come first, then its methods, then the TotalCount of entries with
+// the prefix. With the index, a prefix is a range of it, found with two
+// binary searches, so only the page is visited.
+// Returns the length appended, or -1 if the page does not fit in the output buffer
+WoopsaBufferSize OutputMetaPage(WoopsaServer* server, WoopsaChar8* query, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize responseLength, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaBufferSize contentLength = 0;
+	WoopsaChar8 parameter[MAX_PARAMETER_LENGTH];
+	WoopsaUInt32 offset = 0, limit = 0xFFFF, first = 0, end = 0, i;
+	WoopsaBufferSize prefixLength;
+	WoopsaUInt16 listed, rank, total = 0;
+	WoopsaUInt8 pass;
+	WoopsaEntry entryCopy;
+	const WoopsaEntry* woopsaEntry;
+	if (FindURLDecodedValue(query, FLASH_TEXT(QUERY_OFFSET_KEY), parameter, sizeof(parameter)))
+		WOOPSA_STRING_TO_UNSIGNED(offset, parameter);
+	if (FindURLDecodedValue(query, FLASH_TEXT(QUERY_LIMIT_KEY), parameter, sizeof(parameter)))
+		WOOPSA_STRING_TO_UNSIGNED(limit, parameter);
+	// The query is not needed afterwards, the prefix is decoded in place
+	if (!FindURLDecodedValue(query, FLASH_TEXT(QUERY_PREFIX_KEY), query, WOOPSA_STRING_LENGTH(query) + 1))
+		query[0] = '\0';
+	prefixLength = WOOPSA_STRING_LENGTH(query);
+	if (server->nameIndexLength != 0) {
+		first = FindInNameIndex(server, query, 0);
+		end = FindInNameIndex(server, query, 1);
+		total = (WoopsaUInt16)(end - first);
+		first += offset < total ? offset : total;
+		if (end - first > limit)
+			end = first + limit;
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_META_PROPERTIES JSON_ARRAY_START), outputBufferLength);
+	for (pass = META_PROPERTIES; pass <= META_METHODS; pass++) {
+		if (pass == META_METHODS)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_META_METHODS JSON_ARRAY_START), outputBufferLength);
+		listed = 0;
+		rank = 0;
+		for (i = first;; i++) {
+			if (server->nameIndexLength != 0) {
+				if (i == end)
+					break;
+				woopsaEntry = LoadEntry(&server->entries[server->nameIndex[i]], &entryCopy);
+			} else {
+				// Without the index, the rank among the entries with the prefix
+				// tells whether an entry is in the page
+				woopsaEntry = LoadEntry(&server->entries[i], &entryCopy);
+				if (IsTableEnd(woopsaEntry))
+					break;
+				if (WOOPSA_STRING_N_COMPARE(woopsaEntry->name, query, prefixLength) != 0 || rank++ < offset || rank - offset > limit)
+					continue;
+			}
+			if ((woopsaEntry->isMethod != 0) != (pass == META_METHODS))
+				continue;
+			if ((WoopsaBufferSize)(responseLength + contentLength + META_ENTRY_OVERHEAD_LENGTH + WOOPSA_STRING_LENGTH(woopsaEntry->name) + META_PAGE_END_LENGTH) > outputBufferLength)
+				return -1;
+			if (listed++ != 0)
+				contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+			contentLength += AppendMetaEntry(outputBuffer, outputBufferLength, woopsaEntry, 0);
+		}
+	}
+	if (server->nameIndexLength == 0)
+		total = rank;
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_META_TOTAL_COUNT), outputBufferLength);
+	contentLength += AppendInteger(outputBuffer, outputBufferLength, total, 0, numericValueBuffer);
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_META_END), outputBufferLength);
+	return contentLength;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_SUBOBJECTS
+// Appends the first length characters of source, escaped for a JSON string
+// Returns the length appended
+WoopsaBufferSize AppendEscapedPart(WoopsaChar8 destination[], const WoopsaChar8 source[], WoopsaBufferSize length, WoopsaBufferSize num) {
+	WoopsaBufferSize i = 0, cnt = 0, extras = 0;
+	while (destination[i] != '\0')
+		i++;
+	while (cnt < length && source[cnt] != '\0' && i < num - 2) {
+		if (source[cnt] == JSON_STRING_DELIMITER_CHAR) {
+			destination[i++] = JSON_ESCAPE_CHAR;
+			extras++;
+		}
+		destination[i++] = source[cnt++];
+	}
+	destination[i] = '\0';
+	return cnt + extras;
+}
+
+// Returns the length of the first part of a name, up to its first
+// separator or its end
+WoopsaBufferSize PartLength(const WoopsaChar8* name) {
+	WoopsaBufferSize length = 0;
+	while (name[length] != '\0' && name[length] != SUBOBJECT_SEPARATOR_CHAR)
+		length++;
+	return length;
+}
+
+// Appends the meta document of the subobject at path, or of Root if path
+// is empty: the properties and methods named path/Name, then in Items the
+// names of its subobjects, those of the entries named path/Item/Name. With
+// the index, the subobject is a range of it, where the entries of an item
+// follow each other; without it, they must follow each other in the table.
+// Returns the length appended, 0 if there is no such subobject, or -1 if
+// its meta does not fit in the output buffer
+WoopsaBufferSize OutputSubobjectMeta(WoopsaServer* server, const WoopsaChar8* path, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize responseLength) {
+	WoopsaBufferSize contentLength = 0, pathLength = WOOPSA_STRING_LENGTH(path), nameStart, nameOffset, partLength, itemLength = 0;
+	WoopsaUInt16 i, first = 0, end = 0, listed;
+	WoopsaUInt8 pass, found = 0;
+	WoopsaEntry entryCopy, itemCopy;
+	const WoopsaEntry *tableEntry, *woopsaEntry, *item = NULL;
+	const WoopsaChar8* name;
+	if (pathLength != 0 && path[pathLength - 1] == SUBOBJECT_SEPARATOR_CHAR)
+		pathLength--;
+	nameOffset = pathLength == 0 ? 0 : pathLength + 1;
+	if (server->nameIndexLength != 0) {
+		first = FindInNameIndex(server, path, 0);
+		end = FindInNameIndex(server, path, 1);
+	}
+	if (pathLength == 0) {
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_META_PROPERTIES JSON_ARRAY_START), outputBufferLength);
+	} else {
+		// The subobject is named by the last part of its path
+		for (nameStart = pathLength; nameStart > 0 && path[nameStart - 1] != SUBOBJECT_SEPARATOR_CHAR; nameStart--);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_META_NAME), outputBufferLength);
+		contentLength += AppendEscapedPart(outputBuffer, &path[nameStart], pathLength - nameStart, outputBufferLength);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_META_NAMED_PROPERTIES JSON_ARRAY_START), outputBufferLength);
+	}
+	for (pass = META_PROPERTIES; pass <= META_ITEMS; pass++) {
+		if (pass == META_METHODS)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_META_METHODS JSON_ARRAY_START), outputBufferLength);
+		else if (pass == META_ITEMS)
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_META_ITEMS JSON_ARRAY_START), outputBufferLength);
+		listed = 0;
+		for (i = first;; i++) {
+			if (server->nameIndexLength != 0) {
+				if (i == end)
+					break;
+				tableEntry = &server->entries[server->nameIndex[i]];
+			} else {
+				tableEntry = &server->entries[i];
+			}
+			woopsaEntry = LoadEntry(tableEntry, &entryCopy);
+			if (IsTableEnd(woopsaEntry))
+				break;
+			name = woopsaEntry->name;
+			if (pathLength != 0 && (WOOPSA_STRING_N_COMPARE(name, path, pathLength) != 0 || name[pathLength] != SUBOBJECT_SEPARATOR_CHAR))
+				continue;
+			partLength = PartLength(name + nameOffset);
+			if ((name[nameOffset + partLength] == SUBOBJECT_SEPARATOR_CHAR) != (pass == META_ITEMS))
+				continue;
+			if (pass != META_ITEMS && (woopsaEntry->isMethod != 0) != (pass == META_METHODS))
+				continue;
+			found = 1;
+			if (pass == META_ITEMS) {
+				// An item is listed once, for the first of its entries
+				if (item != NULL && partLength == itemLength && WOOPSA_STRING_N_COMPARE(LoadEntry(item, &itemCopy)->name + nameOffset, name + nameOffset, partLength) == 0)
+					continue;
+				item = tableEntry;
+				itemLength = partLength;
+			}
+			if ((WoopsaBufferSize)(responseLength + contentLength + META_ENTRY_OVERHEAD_LENGTH + WOOPSA_STRING_LENGTH(name) + META_PAGE_END_LENGTH) > outputBufferLength)
+				return -1;
+			if (listed++ != 0)
+				contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+			if (pass == META_ITEMS) {
+				contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_STRING_DELIMITER), outputBufferLength);
+				contentLength += AppendEscapedPart(outputBuffer, name + nameOffset, partLength, outputBufferLength);
+				contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_STRING_DELIMITER), outputBufferLength);
+			} else {
+				contentLength += AppendMetaEntry(outputBuffer, outputBufferLength, woopsaEntry, nameOffset);
+			}
+		}
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_END JSON_OBJECT_END), outputBufferLength);
+	return (found || pathLength == 0) ? contentLength : 0;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_METHODS
+// What a method returned, until it is serialized
+typedef union {
+	int integer;
+	float real;
+	WoopsaUInt8 logical;
+	const WoopsaChar8* text;
+} MethodResult;
+
+// Calls a method that returns a value. Logical methods return an int.
+// Returns the storage of the value in result, texts are at result->text
+WoopsaUInt8 InvokeMethod(const WoopsaEntry* woopsaEntry, MethodResult* result) {
+	if (woopsaEntry->type == WOOPSA_TYPE_INTEGER) {
+		result->integer = (*(ptrMethodRetInteger)woopsaEntry->address.function)();
+		return WOOPSA_INTEGER_STORAGE(sizeof(int), WOOPSA_STORAGE_INT8);
+	}
+	if (woopsaEntry->type == WOOPSA_TYPE_LOGICAL) {
+		result->logical = (*(ptrMethodRetInteger)woopsaEntry->address.function)() != 0;
+		return WOOPSA_STORAGE_BOOL;
+	}
+	if (woopsaEntry->type == WOOPSA_TYPE_REAL || woopsaEntry->type == WOOPSA_TYPE_TIME_SPAN) {
+		result->real = (*(ptrMethodRetReal)woopsaEntry->address.function)();
+		return WOOPSA_STORAGE_FLOAT;
+	}
+	result->text = (*(ptrMethodRetString)woopsaEntry->address.function)();
+	return WOOPSA_STORAGE_TEXT;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+// Takes a free job slot for a call of an asynchronous method, or the slot
+// of a result nobody asked for in WOOPSA_JOB_KEEP_MS
+// Returns NULL if they are all taken
+WoopsaJob* StartJob(WoopsaServer* server, const WoopsaEntry* woopsaEntry) {
+	WoopsaJob* job = NULL;
+	WoopsaUInt32 now = WOOPSA_MILLISECONDS();
+	WoopsaUInt8 i, state;
+	for (i = 0; i < WOOPSA_MAX_JOBS && job == NULL; i++) {
+		WOOPSA_LOCK
+			state = server->jobs[i].state;
+		WOOPSA_UNLOCK
+		if (state == WOOPSA_JOB_FREE || (state != WOOPSA_JOB_RUNNING && now - server->jobs[i].finishedAt > WOOPSA_JOB_KEEP_MS))
+			job = &server->jobs[i];
+	}
+	if (job == NULL)
+		return NULL;
+	job->id = server->nextJobId;
+	server->nextJobId = (server->nextJobId == 0xFFFF) ? 1 : server->nextJobId + 1;
+	job->type = woopsaEntry->type;
+	job->state = WOOPSA_JOB_RUNNING;
+	server->startedJob = job->id;
+	return job;
+}
+
+// Returns the job of this id, or NULL if there is none
+WoopsaJob* GetJobOrNull(WoopsaServer* server, WoopsaUInt32 id) {
+	WoopsaUInt8 i;
+	for (i = 0; i < WOOPSA_MAX_JOBS; i++)
+		if (server->jobs[i].state != WOOPSA_JOB_FREE && server->jobs[i].id == id)
+			return &server->jobs[i];
+	return NULL;
+}
+
+// Appends the state of a job, with its result once it finished. The
+// result is only sent once, the job is then freed.
+// Returns the length appended
+WoopsaBufferSize OutputJob(WoopsaJob* job, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaChar8 numericValueBuffer[]) {
+	WoopsaBufferSize contentLength = 0;
+	WoopsaUInt8 state;
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_JOB), outputBufferLength);
+	WOOPSA_UNSIGNED_TO_STRING(job->id, numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
+	contentLength += Append(outputBuffer, numericValueBuffer, outputBufferLength);
+	WOOPSA_LOCK
+		state = job->state;
+	WOOPSA_UNLOCK
+	if (state == WOOPSA_JOB_RUNNING)
+		return contentLength + AppendText(outputBuffer, FLASH_TEXT(JSON_JOB_RUNNING), outputBufferLength);
+	if (state == WOOPSA_JOB_FAILED) {
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_JOB_FAILED), outputBufferLength);
+	} else if (job->type == WOOPSA_TYPE_NULL) {
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_JOB_DONE), outputBufferLength);
+	} else {
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_JOB_RESULT), outputBufferLength);
+		contentLength += OutputValue(outputBuffer, outputBufferLength, job->storage, job->result.bytes, GetTypeString(job->type), numericValueBuffer);
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	}
+	job->state = WOOPSA_JOB_FREE;
+	return contentLength;
+}
+
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+// Frames the result of the job of a WebSocket once it finished, and
+// forgets the job then (or when it is gone)
+// Returns the length of the frame, 0 while the job runs
+WoopsaBufferSize WebSocketPollJob(WoopsaServer* server, WoopsaUInt16* jobId, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength) {
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	WoopsaChar8* payload = outputBuffer + WEBSOCKET_MAX_HEADER_LENGTH;
+	WoopsaBufferSize payloadBufferLength = outputBufferLength - WEBSOCKET_MAX_HEADER_LENGTH;
+	WoopsaJob* job = GetJobOrNull(server, *jobId);
+	WoopsaUInt8 state = WOOPSA_JOB_FREE;
+	if (job != NULL) {
+		WOOPSA_LOCK
+			state = job->state;
+		WOOPSA_UNLOCK
+	}
+	if (state == WOOPSA_JOB_RUNNING)
+		return 0;
+	*jobId = 0;
+	if (job == NULL)
+		return 0;
+	if (payloadBufferLength > WEBSOCKET_MAX_PAYLOAD_LENGTH)
+		payloadBufferLength = WEBSOCKET_MAX_PAYLOAD_LENGTH;
+	payload[0] = '\0';
+	return FrameWebSocketPayload(outputBuffer, WEBSOCKET_OPCODE_TEXT, OutputJob(job, payload, payloadBufferLength, numericValueBuffer));
+}
+#endif
+#endif
+
+#ifdef WOOPSA_ENABLE_TRANSACTIONS
+// A value decoded by a transaction, until it is stored
+typedef struct {
+	const WoopsaEntry* entry;
+	union {
+		WoopsaUInt8 bytes[8];
+		double alignment;
+		// Texts stay where they were decoded, in the server buffer
+		const WoopsaChar8* text;
+	} value;
+} TransactionWrite;
+
+#define TransactionValue(write, woopsaEntry) \
+	((woopsaEntry)->storage == WOOPSA_STORAGE_TEXT ? (const void*)(write)->value.text : (const void*)(write)->value.bytes)
+
+// Writes the properties of content, URLEncoded name=value pairs, as one
+// transaction: every value is decoded and checked before any is stored.
+// Appends the value decoded for each property, or its error, then
+// whether they were applied.
+// Returns one of the VERB_RESULT_ codes
+WoopsaUInt8 HandleTransaction(WoopsaServer* server, const WoopsaChar8* content, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength,
+		WoopsaBufferSize responseLength, WoopsaBufferSize* contentLength, WoopsaChar8 numericValueBuffer[]) {
+	TransactionWrite writes[WOOPSA_TRANSACTION_SIZE];
+	WoopsaChar8* buffer = server->buffer;
+	WoopsaChar8 *name, *value;
+	WoopsaBufferSize position = 0;
+	WoopsaUInt8 count = 0, listed = 0, failed = 0, valid, size, i;
+	const WoopsaEntry* woopsaEntry;
+	WoopsaEntry entryCopy;
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+	WoopsaPendingWrite* pendingWrite;
+#endif
+	*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_TRANSACTION_RESULTS), outputBufferLength);
+	while (*content != '\0') {
+		// Each name, then its value, is decoded into the buffer where the
+		// path was. The content may be further in the buffer (WebSockets),
+		// decoding never gets ahead of it. Only texts are kept there.
+		name = &buffer[position];
+		if (!URLDecode(&content, 1, name, sizeof(WoopsaBuffer) - position) || *content++ != URLENCODE_VALUE_SEPARATOR)
+			return VERB_RESULT_BAD_REQUEST;
+		value = name + WOOPSA_STRING_LENGTH(name) + 1;
+		if (value >= buffer + sizeof(WoopsaBuffer) || !URLDecode(&content, 0, value, buffer + sizeof(WoopsaBuffer) - value))
+			return VERB_RESULT_BAD_REQUEST;
+		if (*content == URLENCODE_KEY_SEPARATOR)
+			content++;
+		if ((WoopsaBufferSize)(responseLength + *contentLength + TRANSACTION_OVERHEAD_LENGTH + WOOPSA_STRING_LENGTH(name)
+				+ 2 * WOOPSA_STRING_LENGTH(value) + MAX_NUMERICAL_VALUE_LENGTH) > outputBufferLength)
+			return VERB_RESULT_BAD_REQUEST;
+		if (listed++ != 0)
+			*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ARRAY_DELIMITER), outputBufferLength);
+		*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_STRING_DELIMITER), outputBufferLength);
+		*contentLength += AppendEscape(outputBuffer, name, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
+		*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_MEMBER_VALUE), outputBufferLength);
+		if ((writes[count].entry = GetPropertyByNameOrNull(server, name)) == NULL) {
+			*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ERROR HTTP_TEXT_NOT_FOUND JSON_STRING_DELIMITER JSON_OBJECT_END), outputBufferLength);
+			failed = 1;
+			continue;
+		}
+		woopsaEntry = LoadEntry(writes[count].entry, &entryCopy);
+		// Texts must leave room for their NUL
+		size = woopsaEntry->size;
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		if (size > WOOPSA_WRITE_VALUE_SIZE)
+			size = WOOPSA_WRITE_VALUE_SIZE;
+#endif
+		if (woopsaEntry->storage == WOOPSA_STORAGE_TEXT) {
+			valid = WOOPSA_STRING_LENGTH(value) < size;
+			writes[count].value.text = value;
+			position = (WoopsaBufferSize)(value - buffer) + WOOPSA_STRING_LENGTH(value) + 1;
+		} else {
+			valid = ParseValue(woopsaEntry->storage, writes[count].value.bytes, value, size);
+		}
+		if (woopsaEntry->readOnly)
+			valid = 0;
+#ifdef WOOPSA_ENABLE_ACCESSORS
+		if (woopsaEntry->isComputed && woopsaEntry->address.accessor->setter == NULL)
+			valid = 0;
+#endif
+		if (!valid) {
+			*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_ERROR HTTP_TEXT_BAD_REQUEST JSON_STRING_DELIMITER JSON_OBJECT_END), outputBufferLength);
+			failed = 1;
+			continue;
+		}
+		*contentLength += OutputValue(outputBuffer, outputBufferLength, woopsaEntry->storage, TransactionValue(&writes[count], woopsaEntry), GetTypeString(woopsaEntry->type), numericValueBuffer);
+		if (++count == WOOPSA_TRANSACTION_SIZE && *content != '\0')
+			return VERB_RESULT_BAD_REQUEST;
+	}
+	if (failed == 0) {
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		// The whole transaction is published at once, or not at all
+		if (count != 0 && ReservePendingWrite(server, (WoopsaUInt8)(count - 1)) == NULL)
+			return VERB_RESULT_UNAVAILABLE;
+		for (i = 0; i < count; i++) {
+			woopsaEntry = LoadEntry(writes[i].entry, &entryCopy);
+			pendingWrite = ReservePendingWrite(server, i);
+			pendingWrite->entry = (WoopsaUInt16)(writes[i].entry - server->entries);
+			if (woopsaEntry->storage == WOOPSA_STORAGE_TEXT)
+				WOOPSA_STRING_COPY((WoopsaChar8*)pendingWrite->value.bytes, writes[i].value.text);
+			else
+				memcpy(pendingWrite->value.bytes, writes[i].value.bytes, woopsaEntry->size);
+		}
+		PublishPendingWrites(server, count);
+#else
+		// Setters of computed properties are called with the lock held
+		WOOPSA_LOCK
+			for (i = 0; i < count; i++) {
+				woopsaEntry = LoadEntry(writes[i].entry, &entryCopy);
+				StorePendingWrite(server, woopsaEntry, TransactionValue(&writes[i], woopsaEntry));
+			}
+		WOOPSA_UNLOCK
+#if defined(WOOPSA_ENABLE_DIRTY_BITS) || defined(WOOPSA_ENABLE_WRITE_HOOK)
+		for (i = 0; i < count; i++)
+			PropertyWritten(server, (WoopsaUInt16)(writes[i].entry - server->entries));
+#endif
+#endif
+	}
+	*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_TRANSACTION_APPLIED), outputBufferLength);
+	*contentLength += AppendText(outputBuffer, failed == 0 ? FLASH_TEXT(JSON_TRUE) : FLASH_TEXT(JSON_FALSE), outputBufferLength);
+	*contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	return VERB_RESULT_OK;
+}
+#endif
+
+// Handles a Woopsa verb and appends its JSON result to outputBuffer, which
+// already holds responseLength characters. woopsaPath is the requested path
+// without the prefix and must be in the server buffer. content is the POST
+// data, URLEncoded for HTTP requests or the raw value for WebSocket messages.
+// Returns one of the VERB_RESULT_ codes
+WoopsaUInt8 HandleVerb(WoopsaServer* server, WoopsaUInt8 isPost, WoopsaChar8* woopsaPath, const WoopsaChar8* content, WoopsaUInt8 isContentEncoded,
+		WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize responseLength, WoopsaBufferSize* contentLength) {
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	WoopsaBufferSize i = 0;
+	const WoopsaEntry* woopsaEntry = NULL;
+	WoopsaEntry entryCopy;
+	const WoopsaChar8* typeString = NULL;
+	WoopsaChar8* buffer = server->buffer;
+	void* data = NULL;
+#ifndef WOOPSA_ENABLE_SUBOBJECTS
+	WoopsaMetaCursor cursor;
+#endif
+	WoopsaUInt8 size = 0, valid = 0;
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+	WoopsaPendingWrite* pendingWrite = NULL;
+#endif
+#if defined(WOOPSA_ENABLE_WRITE_QUEUE) || defined(WOOPSA_ENABLE_DIRTY_BITS) || defined(WOOPSA_ENABLE_WRITE_HOOK)
+	WoopsaUInt16 entryIndex = 0;
+#endif
+#if defined(WOOPSA_ENABLE_HISTORY) || defined(WOOPSA_ENABLE_CHANGE_JOURNAL)
+	WoopsaChar8* query = NULL;
+#endif
+#ifdef WOOPSA_ENABLE_HISTORY
+	WoopsaHistory* history = NULL;
+#endif
+#ifdef WOOPSA_ENABLE_METHODS
+	MethodResult result;
+	WoopsaUInt8 storage = 0;
+#endif
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+	WoopsaJob* job = NULL;
+	WoopsaUInt32 jobId = 0;
+#endif
+#ifdef WOOPSA_ENABLE_GROUP_READS
+	WoopsaBufferSize groupLength = 0;
+#endif
+#ifdef WOOPSA_ENABLE_PAGED_META
+	WoopsaBufferSize pageLength = 0;
+#endif
+#ifdef WOOPSA_ENABLE_SUBOBJECTS
+	WoopsaBufferSize subobjectLength = 0;
+#endif
+	// Only the verbs that check the space left need responseLength
+	(void)responseLength;
+	memset(numericValueBuffer, 0, MAX_NUMERICAL_VALUE_LENGTH);
+	*contentLength = 0;
+#ifdef WOOPSA_ENABLE_PAGED_META
+	if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_META)) && isPost == 0 && woopsaPath[sizeof(VERB_META) - 1] == URL_QUERY_SEPARATOR) {
+		// Paged meta - Output the entries the query asks for
+		// Like group reads, pages too large for the output are a lack of room
+		if ((pageLength = OutputMetaPage(server, &woopsaPath[sizeof(VERB_META)], outputBuffer, outputBufferLength, responseLength, numericValueBuffer)) < 0)
+			return VERB_RESULT_UNAVAILABLE;
+		*contentLength += pageLength;
+	} else
+#endif
+#ifdef WOOPSA_ENABLE_SUBOBJECTS
+	if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_META)) && isPost == 0) {
+		// Meta of Root, or of the subobject after meta/
+		woopsaPath = woopsaPath[sizeof(VERB_META) - 1] == SUBOBJECT_SEPARATOR_CHAR ? &woopsaPath[sizeof(VERB_META)] : &woopsaPath[sizeof(VERB_META) - 1];
+		if ((subobjectLength = OutputSubobjectMeta(server, woopsaPath, outputBuffer, outputBufferLength, responseLength)) < 0)
+			return VERB_RESULT_UNAVAILABLE;
+		if (subobjectLength == 0)
+			return VERB_RESULT_NOT_FOUND;
+		*contentLength += subobjectLength;
+	}
+#else
+	if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_META)) && isPost == 0) {
+		// Output the serialized response
+		cursor.pass = META_START;
+		*contentLength += OutputMeta(server->entries, outputBuffer, outputBufferLength, &cursor, 0);
+		// A document that filled the output was cut
+		if (responseLength + *contentLength >= outputBufferLength - 1)
+			return VERB_RESULT_UNAVAILABLE;
+	}
+#endif
+#ifdef WOOPSA_ENABLE_GROUP_READS
+	else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_READ)) && isPost == 0 && FindText(woopsaPath, FLASH_TEXT(PATTERN_WILDCARD)) != NULL) {
+		// Group read - Output every property matching the pattern
+		woopsaPath = &(woopsaPath[sizeof(VERB_READ)]);
+		// Like the other requests the server lacks room for
+		if ((groupLength = OutputPropertyGroup(server, woopsaPath, outputBuffer, outputBufferLength, responseLength, numericValueBuffer)) < 0)
+			return VERB_RESULT_UNAVAILABLE;
+		*contentLength += groupLength;
+	}
+#endif
+	else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_READ)) && isPost == 0) {
+		// Read request - Get the property for this read
+		woopsaPath = &(woopsaPath[sizeof(VERB_READ)]);
+		if ((woopsaEntry = GetPropertyByNameOrNull(server, woopsaPath)) == NULL)
+			return VERB_RESULT_NOT_FOUND;
+		woopsaEntry = LoadEntry(woopsaEntry, &entryCopy);
+		typeString = GetTypeString(woopsaEntry->type);
+		// Output the serialized response
+		*contentLength += OutputValue(outputBuffer, outputBufferLength, woopsaEntry->storage, GetPropertyData(server, woopsaEntry), typeString, numericValueBuffer);
+	}
+#ifdef WOOPSA_ENABLE_TRANSACTIONS
+	else if (EqualsText(woopsaPath, FLASH_TEXT(VERB_WRITE)) && isPost == 1) {
+		// Transaction - Write the properties of the content together
+		if (content == NULL)
+			return VERB_RESULT_BAD_REQUEST;
+		return HandleTransaction(server, content, outputBuffer, outputBufferLength, responseLength, contentLength, numericValueBuffer);
+	}
+#endif
+	else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_WRITE)) && isPost == 1) {
+		// Write request - Get the property for this write
+		woopsaPath = &(woopsaPath[sizeof(VERB_WRITE)]);
+		if ((woopsaEntry = GetPropertyByNameOrNull(server, woopsaPath)) == NULL)
+			return VERB_RESULT_NOT_FOUND;
+#if defined(WOOPSA_ENABLE_WRITE_QUEUE) || defined(WOOPSA_ENABLE_DIRTY_BITS) || defined(WOOPSA_ENABLE_WRITE_HOOK)
+		entryIndex = (WoopsaUInt16)(woopsaEntry - server->entries);
+#endif
+		woopsaEntry = LoadEntry(woopsaEntry, &entryCopy);
+		typeString = GetTypeString(woopsaEntry->type);
+		// Decode the value into the buffer, the path is not needed anymore
+		if (content == NULL)
+			return VERB_RESULT_BAD_REQUEST;
+		if (isContentEncoded) {
+			if (!FindURLDecodedValue(content, FLASH_TEXT(POST_VALUE_KEY), buffer, sizeof(WoopsaBuffer)))
+				return VERB_RESULT_BAD_REQUEST;
+		} else {
+			// The raw value may already be in the buffer, behind the path
+			i = WOOPSA_STRING_LENGTH(content);
+			if (i >= (WoopsaBufferSize)sizeof(WoopsaBuffer))
+				return VERB_RESULT_BAD_REQUEST;
+			memmove(buffer, content, i + 1);
+		}
+		// Computed properties decode into their accessor's value, which is
+		// then handed to the setter
+		data = woopsaEntry->address.data;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+		// Fields are written to the instance, never to the snapshot
+		if (woopsaEntry->isField)
+			data = FIELD_DATA(server->instance, woopsaEntry);
+#endif
+#ifdef WOOPSA_ENABLE_ACCESSORS
+		if (woopsaEntry->isComputed) {
+			if (woopsaEntry->address.accessor->setter == NULL)
+				return VERB_RESULT_BAD_REQUEST;
+			data = woopsaEntry->address.accessor->value;
+		}
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		// Decode into a free slot of the queue instead, nobody else uses it
+		if ((pendingWrite = ReservePendingWrite(server, 0)) == NULL)
+			return VERB_RESULT_UNAVAILABLE;
+		data = pendingWrite->value.bytes;
+#endif
+		// Write the value. Texts must leave room for their NUL.
+		size = woopsaEntry->size;
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		if (size > WOOPSA_WRITE_VALUE_SIZE)
+			size = WOOPSA_WRITE_VALUE_SIZE;
+#endif
+		WRITE_LOCK
+			valid = ParseValue(woopsaEntry->storage, data, buffer, size);
+		WRITE_UNLOCK
+		if (!valid)
+			return VERB_RESULT_BAD_REQUEST;
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		// Echo the queued value, the property only changes once it is applied
+		*contentLength += OutputValue(outputBuffer, outputBufferLength, woopsaEntry->storage, data, typeString, numericValueBuffer);
+		pendingWrite->entry = entryIndex;
+		PublishPendingWrites(server, 1);
+#else
+#ifdef WOOPSA_ENABLE_ACCESSORS
+		if (woopsaEntry->isComputed) {
+			woopsaEntry->address.accessor->setter(data);
+			// The echoed value must come from the getter
+			woopsaEntry->address.accessor->cacheValid = 0;
+		}
+#endif
+#if defined(WOOPSA_ENABLE_DIRTY_BITS) || defined(WOOPSA_ENABLE_WRITE_HOOK)
+		PropertyWritten(server, entryIndex);
+#endif
+		// Output the serialized response, the value written rather than
+		// the snapshot for fields
+		*contentLength += OutputValue(outputBuffer, outputBufferLength, woopsaEntry->storage, woopsaEntry->isComputed ? GetPropertyData(server, woopsaEntry) : data, typeString, numericValueBuffer);
+#endif
+	} 
+#ifdef WOOPSA_ENABLE_HISTORY
+	else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_HISTORY)) && isPost == 0)
+	{
+		// History request - Get the history of this property
+		woopsaPath = &(woopsaPath[sizeof(VERB_HISTORY)]);
+		query = SplitQuery(woopsaPath);
+		if ((history = GetHistoryByNameOrNull(server, woopsaPath)) == NULL)
+			return VERB_RESULT_NOT_FOUND;
+		// Output the serialized samples
+		*contentLength += OutputHistory(outputBuffer, outputBufferLength, responseLength, history, query, numericValueBuffer);
+	}
+#endif
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+	else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_CHANGES)) && isPost == 0)
+	{
+		// Changes request - Get the changes after a sequence number
+		query = SplitQuery(woopsaPath);
+		*contentLength += OutputChanges(server, outputBuffer, outputBufferLength, responseLength, query, numericValueBuffer);
+	}
+#endif
+#ifdef WOOPSA_ENABLE_METHODS
+	else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_INVOKE)) && isPost == 1) 
+	{
+		// Invoke request - Get the method for this invoke
+		woopsaPath = &(woopsaPath[sizeof(VERB_INVOKE)]);
+		if ((woopsaEntry = GetMethodByNameOrNull(server, woopsaPath)) == NULL)
+			return VERB_RESULT_NOT_FOUND;
+		woopsaEntry = LoadEntry(woopsaEntry, &entryCopy);
+		typeString = GetTypeString(woopsaEntry->type);
+		// Invoke the method
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+		if (woopsaEntry->isMethod == WOOPSA_ASYNC_METHOD) {
+			// The method only starts the job, the client comes back for its result
+			if ((job = StartJob(server, woopsaEntry)) == NULL)
+				return VERB_RESULT_UNAVAILABLE;
+			(*(ptrMethodAsync)woopsaEntry->address.function)(job);
+			*contentLength += OutputJob(job, outputBuffer, outputBufferLength, numericValueBuffer);
+		} else
+#endif
+		if (woopsaEntry->type == WOOPSA_TYPE_NULL) {
+			(*(ptrMethodVoid)woopsaEntry->address.function)();
+		} else {
+			WOOPSA_LOCK
+				storage = InvokeMethod(woopsaEntry, &result);
+			WOOPSA_UNLOCK
+			*contentLength += OutputValue(outputBuffer, outputBufferLength, storage, storage == WOOPSA_STORAGE_TEXT ? (const void*)result.text : &result, typeString, numericValueBuffer);
+		}
+	} 
+#endif
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+	else if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_JOB)) && isPost == 0) {
+		// Job request - Output the state of the job, and its result once it finished
+		WOOPSA_STRING_TO_UNSIGNED(jobId, &woopsaPath[sizeof(VERB_JOB)]);
+		if ((job = GetJobOrNull(server, jobId)) == NULL)
+			return VERB_RESULT_NOT_FOUND;
+		*contentLength += OutputJob(job, outputBuffer, outputBufferLength, numericValueBuffer);
+	}
+#endif
+	else 
+	{
+		// Invalid request
+		return VERB_RESULT_NOT_FOUND;
+	}
+	return VERB_RESULT_OK;
+}
+
+#ifdef WOOPSA_ENABLE_CONNECTIONS
+// Server of the event stream, meta document and WebSocket frames of a
+// connection, which can be mounted on the connection's server
+#ifdef WOOPSA_ENABLE_MOUNTS
+#define CONNECTION_SERVER(connection) ((connection)->mounted)
+#else
+#define CONNECTION_SERVER(connection) ((connection)->server)
+#endif
+
+// Returns the length of the first request in input, headers and content,
+// 0 if it was not entirely received yet, or -1 if it will never fit in
+// the input of a connection
+WoopsaBufferSize RequestLength(const WoopsaChar8* input, WoopsaBufferSize inputLength) {
+	const WoopsaChar8* header = NULL;
+	const WoopsaChar8* currentHeader = NULL;
+	const WoopsaChar8* headerValue = NULL;
+	const WoopsaChar8* headersEnd = FindText(input, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR));
+	WoopsaBufferSize requestLength = 0;
+	WoopsaUInt32 contentLength = 0;
+	WoopsaInt16 headerSize = 0;
+	if (headersEnd == NULL)
+		return inputLength < WOOPSA_CONNECTION_INPUT_SIZE ? 0 : -1;
+	requestLength = (WoopsaBufferSize)(headersEnd - input) + WOOPSA_STRING_LENGTH(HEADER_SEPARATOR HEADER_SEPARATOR);
+	// Skip the request line, then look for the length of the content
+	NextHTTPHeader(input, &header);
+	for (currentHeader = header; currentHeader < headersEnd && (headerSize = NextHTTPHeader(currentHeader, &header)) > 0; currentHeader = header)
+		if ((headerValue = HeaderValueOrNull(currentHeader, headerSize, FLASH_TEXT(HEADER_CONTENT_LENGTH))) != NULL)
+			WOOPSA_STRING_TO_UNSIGNED(contentLength, headerValue);
+	if (contentLength > (WoopsaUInt32)(WOOPSA_CONNECTION_INPUT_SIZE - requestLength))
+		return -1;
+	requestLength += contentLength;
+	return requestLength <= inputLength ? requestLength : 0;
+}
+
+// Checks whether the connection stays open after the response to this
+// request: by default with HTTP/1.1, on demand with HTTP/1.0
+WoopsaUInt8 RequestKeepsAlive(const WoopsaChar8* request) {
+	const WoopsaChar8* header = NULL;
+	const WoopsaChar8* currentHeader = NULL;
+	const WoopsaChar8* headerValue = NULL;
+	WoopsaInt16 headerSize = NextHTTPHeader(request, &header);
+	WoopsaInt16 versionLength = (WoopsaInt16)WOOPSA_STRING_LENGTH(HTTP_VERSION_1_0);
+	WoopsaUInt8 keepAlive = !(headerSize >= versionLength && StartsWithIgnoreCase(request + headerSize - versionLength, FLASH_TEXT(HTTP_VERSION_1_0)));
+	for (currentHeader = header; headerSize != -1 && (headerSize = NextHTTPHeader(currentHeader, &header)) > 0; currentHeader = header) {
+		if ((headerValue = HeaderValueOrNull(currentHeader, headerSize, FLASH_TEXT(HEADER_CONNECTION))) != NULL) {
+			if (ContainsIgnoreCase(headerValue, (WoopsaInt16)(currentHeader + headerSize - headerValue), FLASH_TEXT(CONNECTION_CLOSE_VALUE)))
+				keepAlive = 0;
+			else if (ContainsIgnoreCase(headerValue, (WoopsaInt16)(currentHeader + headerSize - headerValue), FLASH_TEXT(CONNECTION_KEEP_ALIVE_VALUE)))
+				keepAlive = 1;
+		}
+	}
+	return keepAlive;
+}
+
+// Removes the Connection: close header of a response, so that the client
+// keeps the connection open as HTTP/1.1 does by default
+// Returns the new length of the response
+WoopsaBufferSize KeepResponseAlive(WoopsaChar8* response, WoopsaBufferSize responseLength) {
+	WoopsaChar8* header = FindText(response, FLASH_TEXT(HEADER_CONNECTION_CLOSE));
+	WoopsaChar8* headersEnd = FindText(response, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR));
+	WoopsaBufferSize headerLength = WOOPSA_STRING_LENGTH(HEADER_CONNECTION_CLOSE);
+	if (header == NULL || headersEnd == NULL || header > headersEnd)
+		return responseLength;
+	memmove(header, header + headerLength, responseLength - (header - response) - headerLength);
+	return responseLength - headerLength;
+}
+
+// Handles the received requests (or WebSocket frames) one by one, as long
+// as the response to the previous one was entirely sent. With time slicing,
+// only the first one is handled.
+void HandleConnectionInput(WoopsaConnection* connection) {
+	WoopsaBufferSize requestLength = 0, responseLength = 0;
+	WoopsaChar8 requestEnd;
+	WoopsaUInt8 result = WOOPSA_SUCCESS;
+	while (connection->state < WOOPSA_CONNECTION_CLOSING && connection->outputLength == 0 && connection->inputLength > 0) {
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+		if (connection->asset != NULL)
+			return;
+#endif
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+		// An event stream response never ends, nothing can follow it
+		if (connection->hasEventStream && connection->state == WOOPSA_CONNECTION_HTTP)
+			return;
+#endif
+		responseLength = 0;
+		result = WOOPSA_SUCCESS;
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+		if (connection->state == WOOPSA_CONNECTION_WEBSOCKET) {
+			result = WoopsaWebSocketHandleFrame(CONNECTION_SERVER(connection), connection->input, connection->inputLength, &requestLength,
+				connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, &responseLength);
+			if (result == WOOPSA_CLIENT_REQUEST_ERROR || result == WOOPSA_OTHER_ERROR) {
+				connection->state = WOOPSA_CONNECTION_CLOSED;
+				return;
+			}
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+			// The result of a job the frame started is sent once it is there
+			if (CONNECTION_SERVER(connection)->startedJob != 0)
+				connection->job = CONNECTION_SERVER(connection)->startedJob;
+#endif
+			// Wait for the rest of the frame
+			if (requestLength == 0)
+				return;
+			if (result == WOOPSA_WEBSOCKET_CLOSED)
+				connection->state = WOOPSA_CONNECTION_CLOSING;
+		} else
+#endif
+		{
+			requestLength = RequestLength(connection->input, connection->inputLength);
+			if (requestLength == 0)
+				return;
+			if (requestLength < 0) {
+				// Answer and close, the rest of the request cannot be received
+				responseLength = PrepareError(connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, FLASH_TEXT(HTTP_CODE_BAD_REQUEST), FLASH_TEXT(HTTP_TEXT_BAD_REQUEST));
+				requestLength = connection->inputLength;
+				connection->state = WOOPSA_CONNECTION_CLOSING;
+			} else {
+				// Pipelined requests follow this one, hide them while it is handled
+				requestEnd = connection->input[requestLength];
+				connection->input[requestLength] = '\0';
+				connection->keepAlive = RequestKeepsAlive(connection->input);
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+				connection->server->metaCursor = &connection->meta;
+#endif
+				result = WoopsaHandleRequest(connection->server, connection->input, requestLength, connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, &responseLength);
+#ifdef WOOPSA_ENABLE_MOUNTS
+				connection->mounted = connection->server->routedServer;
+#endif
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+				connection->server->metaCursor = NULL;
+#ifdef WOOPSA_ENABLE_MOUNTS
+				connection->server->routedServer->metaCursor = NULL;
+#endif
+#endif
+				connection->input[requestLength] = requestEnd;
+				if (result == WOOPSA_WEBSOCKET) {
+					connection->state = WOOPSA_CONNECTION_WEBSOCKET;
+				} else if (responseLength == 0) {
+					connection->state = WOOPSA_CONNECTION_CLOSED;
+					return;
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+				} else if (connection->meta.pass != META_DONE) {
+					// Nothing is sent until the next steps complete the document
+					responseLength = 0;
+#endif
+				} else if (result != WOOPSA_EVENT_STREAM) {
+					if (connection->keepAlive)
+						responseLength = KeepResponseAlive(connection->output, responseLength);
+					else
+						connection->state = WOOPSA_CONNECTION_CLOSING;
+				}
+			}
+		}
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+		if (result == WOOPSA_EVENT_STREAM) {
+			// A WebSocket can subscribe again, which replaces its stream
+			if (connection->hasEventStream)
+				WoopsaEventStreamClose(CONNECTION_SERVER(connection), connection->eventStream);
+			connection->hasEventStream = 1;
+			connection->eventStream = CONNECTION_SERVER(connection)->openedEventStream;
+		}
+#endif
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+		if (result == WOOPSA_STATIC_ASSET) {
+			connection->asset = connection->server->servedAsset;
+			connection->assetOffset = 0;
+		}
+#endif
+		connection->outputLength = responseLength;
+		connection->outputSent = 0;
+		// Forget the handled request
+		connection->inputLength -= requestLength;
+		memmove(connection->input, connection->input + requestLength, connection->inputLength + 1);
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+		break;
+#endif
+	}
+}
+
+// Moves on once the output was entirely sent
+void ConnectionOutputSent(WoopsaConnection* connection) {
+	connection->outputLength = 0;
+	connection->outputSent = 0;
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	// The next chunk of the asset is read by ProduceConnectionOutput
+	if (connection->asset != NULL)
+		return;
+#endif
+	if (connection->state == WOOPSA_CONNECTION_CLOSING)
+		connection->state = WOOPSA_CONNECTION_CLOSED;
+#ifndef WOOPSA_ENABLE_TIME_SLICING
+	else
+		HandleConnectionInput(connection);
+#endif
+}
+
+// Produces the next output once the previous one was sent: the next
+// chunk of an asset, or the changes of an event stream
+// Returns 1 if there is something to send
+WoopsaUInt8 ProduceConnectionOutput(WoopsaConnection* connection) {
+	if (connection->outputSent != connection->outputLength || connection->state == WOOPSA_CONNECTION_CLOSED)
+		return 0;
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	if (connection->asset != NULL) {
+		connection->outputLength = WoopsaStaticAssetRead(connection->asset, connection->assetOffset, connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE);
+		connection->outputSent = 0;
+		connection->assetOffset += connection->outputLength;
+		if (connection->outputLength == 0) {
+			connection->asset = NULL;
+			ConnectionOutputSent(connection);
+		}
+	}
+#endif
+#if defined(WOOPSA_ENABLE_ASYNC_METHODS) && defined(WOOPSA_ENABLE_WEBSOCKETS)
+	if (connection->outputSent == connection->outputLength && connection->job != 0 && connection->state == WOOPSA_CONNECTION_WEBSOCKET) {
+		connection->outputLength = WebSocketPollJob(CONNECTION_SERVER(connection), &connection->job, connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE);
+		connection->outputSent = 0;
+	}
+#endif
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	if (connection->outputSent == connection->outputLength && connection->hasEventStream && connection->state < WOOPSA_CONNECTION_CLOSING) {
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+		if (connection->state == WOOPSA_CONNECTION_WEBSOCKET)
+			WoopsaWebSocketPollEvents(CONNECTION_SERVER(connection), connection->eventStream, connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, &connection->outputLength);
+		else
+#endif
+			WoopsaEventStreamPoll(CONNECTION_SERVER(connection), connection->eventStream, connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, &connection->outputLength);
+		connection->outputSent = 0;
+	}
+#endif
+	return connection->outputSent != connection->outputLength;
+}
+
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+// Serializes the next entries of a meta response. Once the document is
+// complete, its length is set and the response can be sent.
+void ContinueMetaResponse(WoopsaConnection* connection) {
+	WoopsaMetaCursor* meta = &connection->meta;
+	WoopsaBufferSize responseLength = 0;
+	meta->contentLength += OutputMeta(CONNECTION_SERVER(connection)->entries, connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, meta, WOOPSA_STEP_ENTRIES);
+	if (meta->pass != META_DONE)
+		return;
+	responseLength = meta->headersLength + meta->contentLength;
+	// A document that filled the output was cut: it is refused like the
+	// other responses the connection lacks room for, paged meta still fits
+	if (responseLength >= WOOPSA_CONNECTION_OUTPUT_SIZE - 1)
+		responseLength = PrepareError(connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, FLASH_TEXT(HTTP_CODE_SERVICE_UNAVAILABLE), FLASH_TEXT(HTTP_TEXT_SERVICE_UNAVAILABLE));
+	else
+		SetContentLength(connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, meta->contentLengthPosition, meta->contentLength);
+	if (connection->keepAlive)
+		responseLength = KeepResponseAlive(connection->output, responseLength);
+	else
+		connection->state = WOOPSA_CONNECTION_CLOSING;
+	connection->outputLength = responseLength;
+	connection->outputSent = 0;
+}
+#endif
+#endif
+
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+#define TIMER_CONNECTION(timer) ((WoopsaConnection*)((WoopsaChar8*)(timer) - offsetof(WoopsaConnection, timer)))
+
+// Puts the timer in the slot of the first tick at which it expired
+void ArmTimer(WoopsaTimerWheel* wheel, WoopsaTimer* timer, WoopsaUInt32 duration) {
+	WoopsaTimer** slot;
+	timer->armedAt = WOOPSA_MILLISECONDS();
+	timer->duration = duration;
+	slot = &wheel->slots[(wheel->tick + (timer->armedAt - wheel->tickStart + duration + WOOPSA_TIMER_TICK_MS - 1) / WOOPSA_TIMER_TICK_MS) & (WOOPSA_TIMER_SLOTS - 1)];
+	timer->next = *slot;
+	if (timer->next != NULL)
+		timer->next->link = &timer->next;
+	timer->link = slot;
+	*slot = timer;
+}
+
+void CancelTimer(WoopsaTimer* timer) {
+	if (timer->link == NULL)
+		return;
+	*timer->link = timer->next;
+	if (timer->next != NULL)
+		timer->next->link = timer->link;
+	timer->link = NULL;
+}
+
+// The deadline a connection has in its state: a request must arrive in
+// time once it started, and a client must keep reading what is sent
+WoopsaUInt8 ConnectionDeadline(const WoopsaConnection* connection) {
+	if (connection->expired)
+		return WOOPSA_DEADLINE_NONE;
+	// A closed connection may still have its last response to send, in
+	// buffers of the application
+	if (connection->outputSent != connection->outputLength || connection->state == WOOPSA_CONNECTION_CLOSED)
+		return WOOPSA_DEADLINE_IDLE;
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+	if (connection->meta.pass != META_DONE)
+		return WOOPSA_DEADLINE_NONE;
+#endif
+	if (connection->state == WOOPSA_CONNECTION_CLOSING)
+		return WOOPSA_DEADLINE_NONE;
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+	// WebSocket clients may stay silent, but not in the middle of a frame
+	if (connection->state == WOOPSA_CONNECTION_WEBSOCKET)
+		return connection->inputLength != 0 ? WOOPSA_DEADLINE_BODY : WOOPSA_DEADLINE_NONE;
+#endif
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	if (connection->hasEventStream)
+		return WOOPSA_DEADLINE_NONE;
+#endif
+	if (connection->inputLength == 0)
+		return WOOPSA_DEADLINE_IDLE;
+	return FindText(connection->input, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR)) == NULL ? WOOPSA_DEADLINE_HEADER : WOOPSA_DEADLINE_BODY;
+}
+
+// Arms the timer of the connection again when its deadline changed, or
+// when an idle connection made progress
+void UpdateDeadline(WoopsaConnection* connection, WoopsaUInt8 progress) {
+	WoopsaUInt8 deadline = ConnectionDeadline(connection);
+	if (deadline == connection->deadline && !(progress && deadline == WOOPSA_DEADLINE_IDLE))
+		return;
+	CancelTimer(&connection->timer);
+	connection->deadline = deadline;
+	if (deadline == WOOPSA_DEADLINE_HEADER)
+		ArmTimer(&connection->server->timers, &connection->timer, WOOPSA_HEADER_TIMEOUT_MS);
+	else if (deadline == WOOPSA_DEADLINE_BODY)
+		ArmTimer(&connection->server->timers, &connection->timer, WOOPSA_BODY_TIMEOUT_MS);
+	else if (deadline == WOOPSA_DEADLINE_IDLE)
+		ArmTimer(&connection->server->timers, &connection->timer, WOOPSA_IDLE_TIMEOUT_MS);
+}
+
+// A client too slow to send its request is told so, the others are
+// closed without a word
+void ConnectionTimedOut(WoopsaConnection* connection) {
+	if (connection->state == WOOPSA_CONNECTION_HTTP && connection->deadline != WOOPSA_DEADLINE_IDLE) {
+		connection->outputLength = PrepareError(connection->output, WOOPSA_CONNECTION_OUTPUT_SIZE, FLASH_TEXT(HTTP_CODE_REQUEST_TIMEOUT), FLASH_TEXT(HTTP_TEXT_REQUEST_TIMEOUT));
+		connection->outputSent = 0;
+		connection->inputLength = 0;
+		connection->input[0] = '\0';
+		connection->state = WOOPSA_CONNECTION_CLOSING;
+		// The 408 must still be read in time
+		connection->deadline = WOOPSA_DEADLINE_NONE;
+		UpdateDeadline(connection, 0);
+	} else {
+		connection->state = WOOPSA_CONNECTION_CLOSED;
+		connection->expired = 1;
+		connection->deadline = WOOPSA_DEADLINE_NONE;
+	}
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_PUSH
+// Prepares the request line and headers of a push, with room left for
+// its Content-Length
+// Returns the length of the prepared string
+WoopsaBufferSize PreparePushRequest(const WoopsaPush* push, WoopsaChar8* outputBuffer, const WoopsaBufferSize outputBufferLength, WoopsaBufferSize* contentLengthPosition) {
+	WoopsaBufferSize size = 0;
+	outputBuffer[0] = '\0';
+	size += AppendText(outputBuffer, FLASH_TEXT(HTTP_METHOD_POST " "), outputBufferLength);
+	size += Append(outputBuffer, push->path, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(" " HTTP_VERSION_STRING HEADER_SEPARATOR HEADER_HOST), outputBufferLength);
+	size += Append(outputBuffer, push->host, outputBufferLength);
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_SEPARATOR HEADER_CONTENT_TYPE CONTENT_TYPE_JSON HEADER_SEPARATOR HEADER_CONTENT_LENGTH_NAME), outputBufferLength);
+	*contentLengthPosition = size;
+	size += AppendText(outputBuffer, FLASH_TEXT(HEADER_CONTENT_LENGTH_SPACE HEADER_SEPARATOR HEADER_SEPARATOR), outputBufferLength);
+	return size;
+}
+
+// Delays the next push after a failure. The delay doubles with every
+// failure, and a part of it depends on the clock so that a fleet of
+// devices does not retry all at once when the collector is back.
+void PushFailed(WoopsaPush* push, WoopsaUInt32 now) {
+	if (push->backoffMs < push->retryMs)
+		push->backoffMs = push->retryMs;
+	push->dueAt = now + push->backoffMs / 2 + now % (push->backoffMs / 2 + 1);
+	push->backoffMs = push->backoffMs > push->maxRetryMs / 2 ? push->maxRetryMs : push->backoffMs * 2;
+	if (push->failures != 0xFFFF)
+		push->failures++;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_MOUNTS
+// Adds the prefix of a mount to the trie, with the nodes it does not
+// share with the prefixes already there
+// Returns 0 if the prefix is already mounted or the trie is full
+WoopsaUInt8 AddMountPrefix(WoopsaServer* server, const WoopsaChar8* prefix, WoopsaUInt8 mount) {
+	WoopsaMountNode* nodes = server->mountNodes;
+	WoopsaUInt8 node = 0, child = 0;
+	for (; *prefix != '\0'; prefix++) {
+		for (child = nodes[node].child; child != 0 && nodes[child].character != *prefix; child = nodes[child].sibling);
+		if (child == 0) {
+			if (server->mountNodeCount == WOOPSA_MOUNT_NODES)
+				return 0;
+			child = server->mountNodeCount++;
+			nodes[child].character = *prefix;
+			nodes[child].child = 0;
+			nodes[child].sibling = nodes[node].child;
+			nodes[child].mount = WOOPSA_NO_MOUNT;
+			nodes[node].child = child;
+		}
+		node = child;
+	}
+	if (nodes[node].mount != WOOPSA_NO_MOUNT)
+		return 0;
+	nodes[node].mount = mount;
+	return 1;
+}
+
+// Follows the path down the trie, as far as it matches a prefix
+// Returns the server mounted with the longest prefix of the path, or
+// NULL if there is none
+WoopsaServer* RouteRequest(WoopsaServer* server, const WoopsaChar8* path) {
+	const WoopsaMountNode* nodes = server->mountNodes;
+	WoopsaUInt8 node = 0, mount = nodes[0].mount;
+	for (; *path != '\0'; path++) {
+		for (node = nodes[node].child; node != 0 && nodes[node].character != *path; node = nodes[node].sibling);
+		if (node == 0)
+			break;
+		if (nodes[node].mount != WOOPSA_NO_MOUNT)
+			mount = nodes[node].mount;
+	}
+	return mount == WOOPSA_NO_MOUNT ? NULL : server->mounts[mount];
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+//                   BEGIN PUBLIC WOOPSA IMPLEMENTATION                      //
 ///////////////////////////////////////////////////////////////////////////////
-//                   BEGIN PUBLIC WOOPSA IMPLEMENTATION                      //
-///////////////////////////////////////////////////////////////////////////////
 
-void WoopsaServerInit(WoopsaServer* server, const WoopsaChar8* prefix, WoopsaEntry entries[], WoopsaRequestHandler requestHandler) {
-	server->pathPrefix = prefix;
-	server->entries = entries;
-	server->requestHandler = requestHandler;
+void WoopsaServerInit(WoopsaServer* server, const WoopsaChar8* prefix, const WoopsaEntry entries[], WoopsaRequestHandler requestHandler) {
+	server->pathPrefix = prefix;
+	server->entries = entries;
+	server->requestHandler = requestHandler;
+#ifdef WOOPSA_ENABLE_ETAGS
+	server->metaETag = HashMeta(entries);
+#endif
+#ifdef WOOPSA_NAME_INDEX
+	BuildNameIndex(server);
+#endif
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	server->assets = NULL;
+	server->servedAsset = NULL;
+#endif
+#ifdef WOOPSA_ENABLE_HISTORY
+	server->histories = NULL;
+#endif
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	memset(server->eventStreams, 0, sizeof(server->eventStreams));
+	server->openedEventStream = 0;
+#endif
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+	server->metaCursor = NULL;
+	server->stepHook = NULL;
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+	server->writeHead = 0;
+	server->writeTail = 0;
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_HOOK
+	server->writeHook = NULL;
+#endif
+#ifdef WOOPSA_ENABLE_DIRTY_BITS
+	memset(server->dirty, 0, sizeof(server->dirty));
+#endif
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+	server->journalHead = 0;
+	server->journalCount = 0;
+	// 0 is left to clients that saw no change yet
+	server->journalSequence = 1;
+#endif
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	server->instance = NULL;
+	server->snapshot = NULL;
+	server->instanceSize = 0;
+	server->snapshotSequence = 0;
+#endif
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+	memset(server->jobs, 0, sizeof(server->jobs));
+	server->nextJobId = 1;
+	server->startedJob = 0;
+#endif
+#ifdef WOOPSA_ENABLE_MOUNTS
+	server->mountCount = 0;
+	server->mountNodeCount = 1;
+	server->mountNodes[0].child = 0;
+	server->mountNodes[0].mount = WOOPSA_NO_MOUNT;
+	server->routedServer = server;
+	// The server's own entries are its first mount
+	WoopsaServerMount(server, server);
+#endif
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	memset(&server->timers, 0, sizeof(server->timers));
+	server->timers.tickStart = WOOPSA_MILLISECONDS();
+#endif
+}
+
+void WoopsaServerRefreshTable(WoopsaServer* server) {
+	(void)server;
+#ifdef WOOPSA_ENABLE_ETAGS
+	server->metaETag = HashMeta(server->entries);
+#endif
+#ifdef WOOPSA_NAME_INDEX
+	BuildNameIndex(server);
+#endif
+}
+
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+void WoopsaJobComplete(WoopsaJob* job, const void* value) {
+	WoopsaUInt8 logical;
+	if (job->type == WOOPSA_TYPE_INTEGER) {
+		WoopsaJobCompleteStored(job, WOOPSA_INTEGER_STORAGE(sizeof(int), WOOPSA_STORAGE_INT8), value);
+	} else if (job->type == WOOPSA_TYPE_LOGICAL) {
+		logical = *(const int*)value != 0;
+		WoopsaJobCompleteStored(job, WOOPSA_STORAGE_BOOL, &logical);
+	} else if (job->type == WOOPSA_TYPE_REAL || job->type == WOOPSA_TYPE_TIME_SPAN) {
+		WoopsaJobCompleteStored(job, WOOPSA_STORAGE_FLOAT, value);
+	} else {
+		WoopsaJobCompleteStored(job, WOOPSA_STORAGE_TEXT, value);
+	}
+}
+
+void WoopsaJobCompleteStored(WoopsaJob* job, WoopsaUInt8 storage, const void* value) {
+	Codec copy;
+	WOOPSA_LOCK
+		// Texts are cut, other values have the size of their storage
+		if (job->type != WOOPSA_TYPE_NULL && storage == WOOPSA_STORAGE_TEXT) {
+			WOOPSA_STRING_N_COPY((WoopsaChar8*)job->result.bytes, (const WoopsaChar8*)value, WOOPSA_JOB_TEXT_SIZE - 1);
+			job->result.bytes[WOOPSA_JOB_TEXT_SIZE - 1] = '\0';
+		} else if (job->type != WOOPSA_TYPE_NULL) {
+			memcpy(job->result.bytes, value, LoadCodec(storage, &copy)->size);
+		}
+		job->storage = storage;
+		job->finishedAt = WOOPSA_MILLISECONDS();
+		job->state = WOOPSA_JOB_DONE;
+	WOOPSA_UNLOCK
+}
+
+void WoopsaJobFail(WoopsaJob* job) {
+	WOOPSA_LOCK
+		job->finishedAt = WOOPSA_MILLISECONDS();
+		job->state = WOOPSA_JOB_FAILED;
+	WOOPSA_UNLOCK
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_MOUNTS
+WoopsaUInt8 WoopsaServerMount(WoopsaServer* server, WoopsaServer* mounted) {
+	if (server->mountCount == WOOPSA_MAX_MOUNTS || !AddMountPrefix(server, mounted->pathPrefix, server->mountCount))
+		return WOOPSA_OTHER_ERROR;
+	server->mounts[server->mountCount++] = mounted;
+	return WOOPSA_SUCCESS;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+WoopsaUInt8 WoopsaApplyPendingWrites(WoopsaServer* server) {
+	const WoopsaEntry* woopsaEntry;
+	WoopsaEntry entryCopy;
+	WoopsaPendingWrite* pendingWrite;
+	WoopsaUInt8 tail = server->writeTail, applied = 0;
+#ifdef WOOPSA_ENABLE_MOUNTS
+	WoopsaUInt8 i;
+#endif
+	while (tail != server->writeHead) {
+		// Don't read the slot before seeing it published
+		WOOPSA_MEMORY_BARRIER();
+		pendingWrite = &server->pendingWrites[tail & WRITE_QUEUE_MASK];
+		woopsaEntry = LoadEntry(&server->entries[pendingWrite->entry], &entryCopy);
+		StorePendingWrite(server, woopsaEntry, pendingWrite->value.bytes);
+#if defined(WOOPSA_ENABLE_DIRTY_BITS) || defined(WOOPSA_ENABLE_WRITE_HOOK)
+		PropertyWritten(server, pendingWrite->entry);
+#endif
+		// The slot is given back once it was read
+		WOOPSA_MEMORY_BARRIER();
+		server->writeTail = ++tail;
+		applied++;
+	}
+#ifdef WOOPSA_ENABLE_MOUNTS
+	// Requests routed to a mounted server are queued in its own queue,
+	// the first mount is this server
+	for (i = 1; i < server->mountCount; i++)
+		applied += WoopsaApplyPendingWrites(server->mounts[i]);
+#endif
+	return applied;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_WRITE_HOOK
+void WoopsaServerSetWriteHook(WoopsaServer* server, WoopsaWriteHook hook) {
+	server->writeHook = hook;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_DIRTY_BITS
+void WoopsaMarkChanged(WoopsaServer* server, const WoopsaEntry* entry) {
+	SetDirty(server, (WoopsaUInt16)(entry - server->entries));
+}
+
+WoopsaUInt16 WoopsaServerDetectChanges(WoopsaServer* server, WoopsaUInt32 hashes[]) {
+	const WoopsaEntry* woopsaEntry;
+	WoopsaEntry entryCopy;
+	WoopsaUInt32 hash;
+	WoopsaUInt16 i, marked = 0;
+	for (i = 0; i < WOOPSA_DIRTY_ENTRIES; i++) {
+		woopsaEntry = LoadEntry(&server->entries[i], &entryCopy);
+		if (IsTableEnd(woopsaEntry))
+			break;
+		if (woopsaEntry->isMethod)
+			continue;
+		hash = HashPropertyValue(server, woopsaEntry);
+		if (hash != hashes[i]) {
+			hashes[i] = hash;
+			SetDirty(server, i);
+			marked++;
+		}
+	}
+	return marked;
+}
+
+WoopsaInt16 WoopsaServerNextChanged(WoopsaServer* server, WoopsaUInt16 from) {
+	WoopsaUInt16 word = DIRTY_WORD(from), entryIndex;
+	WoopsaDirtyWord bits;
+	if (from >= WOOPSA_DIRTY_ENTRIES)
+		return -1;
+	// The bits before from are left for later
+	bits = server->dirty[word] & ~(DIRTY_BIT(from) - 1);
+	while (bits == 0) {
+		if (++word == WOOPSA_DIRTY_WORDS)
+			return -1;
+		bits = server->dirty[word];
+	}
+	entryIndex = (WoopsaUInt16)(word * WOOPSA_DIRTY_WORD_BITS + LOWEST_BIT(bits));
+	WOOPSA_LOCK
+		server->dirty[word] &= ~DIRTY_BIT(entryIndex);
+	WOOPSA_UNLOCK
+	return (WoopsaInt16)entryIndex;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+void WoopsaServerRecordChanges(WoopsaServer* server) {
+	WoopsaJournalRecord* record;
+	WoopsaEntry entryCopy;
+	const WoopsaEntry* woopsaEntry;
+	void* data;
+	WoopsaInt16 entryIndex;
+	for (entryIndex = WoopsaServerNextChanged(server, 0); entryIndex != -1; entryIndex = WoopsaServerNextChanged(server, (WoopsaUInt16)(entryIndex + 1))) {
+		woopsaEntry = LoadEntry(&server->entries[entryIndex], &entryCopy);
+		if (woopsaEntry->isMethod)
+			continue;
+		data = GetPropertyData(server, woopsaEntry);
+		WOOPSA_LOCK
+			record = &server->journal[server->journalHead];
+			// Larger values are read again when the journal is sent
+			if (woopsaEntry->size <= WOOPSA_JOURNAL_VALUE_SIZE)
+				memcpy(record->value.bytes, data, woopsaEntry->size);
+			record->entry = (WoopsaUInt16)entryIndex;
+			record->sequence = server->journalSequence++;
+			server->journalHead = (server->journalHead + 1) % WOOPSA_JOURNAL_SIZE;
+			if (server->journalCount < WOOPSA_JOURNAL_SIZE)
+				server->journalCount++;
+		WOOPSA_UNLOCK
+	}
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_PUSH
+void WoopsaPushInit(WoopsaPush* push, const WoopsaChar8* host, const WoopsaChar8* path, const WoopsaChar8* pattern, WoopsaUInt32 intervalMs) {
+	memset(push, 0, sizeof(WoopsaPush));
+	push->host = host;
+	push->path = path;
+	push->pattern = pattern;
+	push->intervalMs = intervalMs;
+	push->retryMs = WOOPSA_PUSH_RETRY_MS;
+	push->maxRetryMs = WOOPSA_PUSH_MAX_RETRY_MS;
+	push->dueAt = WOOPSA_MILLISECONDS();
+}
+
+WoopsaBufferSize WoopsaPushPrepare(WoopsaServer* server, WoopsaPush* push, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength) {
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	// The group read marks the end of the pattern's prefix for a moment
+	WoopsaChar8 pattern[PUSH_PATTERN_LENGTH];
+	WoopsaBufferSize size, contentLengthPosition, contentLength = 0, groupLength;
+	WoopsaUInt32 now = WOOPSA_MILLISECONDS();
+	WoopsaUInt8 snapshot = 1;
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+	WoopsaChar8 parameter[MAX_PARAMETER_LENGTH];
+	WoopsaUInt32 oldest, last = 0, sequence;
+	WoopsaInt16 listed;
+#endif
+	if (push->inFlight || (long)(now - push->dueAt) < 0)
+		return 0;
+	if (WOOPSA_STRING_LENGTH(push->pattern) >= PUSH_PATTERN_LENGTH) {
+		PushFailed(push, now);
+		return 0;
+	}
+	WOOPSA_STRING_COPY(pattern, push->pattern);
+	memset(numericValueBuffer, 0, MAX_NUMERICAL_VALUE_LENGTH);
+	size = PreparePushRequest(push, outputBuffer, outputBufferLength, &contentLengthPosition);
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+	if (push->changesOnly) {
+		WoopsaServerRecordChanges(server);
+		WOOPSA_LOCK
+			oldest = server->journalSequence - server->journalCount;
+			last = server->journalSequence - 1;
+		WOOPSA_UNLOCK
+		sequence = push->pushedSequence + 1;
+		if (push->synced && sequence >= oldest && (long)(last - push->pushedSequence) >= 0) {
+			// Nothing to push until a change is recorded
+			if (sequence > last)
+				return 0;
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_CHANGES), outputBufferLength);
+			listed = OutputJournal(server, &sequence, last, pattern, outputBuffer, outputBufferLength, size + PUSH_END_LENGTH, &contentLength, numericValueBuffer);
+			if (listed == 0 && sequence > last) {
+				// None of the changes is pushed
+				push->pushedSequence = last;
+				return 0;
+			}
+			if (listed <= 0) {
+				// A snapshot next time if changes were lost, and a buffer too
+				// small for a single change is a failure
+				if (listed < 0)
+					push->synced = 0;
+				PushFailed(push, now);
+				return 0;
+			}
+			push->sentSequence = sequence - 1;
+			push->morePending = sequence <= last;
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_HISTORY_LAST), outputBufferLength);
+			WOOPSA_UNSIGNED_TO_STRING(push->sentSequence, parameter, MAX_PARAMETER_LENGTH);
+			contentLength += Append(outputBuffer, parameter, outputBufferLength);
+			snapshot = 0;
+		}
+	}
+#endif
+	if (snapshot) {
+		// Every property matching the pattern
+		contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_PUSH_VALUES), outputBufferLength);
+		if ((groupLength = OutputPropertyGroup(server, pattern, outputBuffer, outputBufferLength, size + contentLength + PUSH_END_LENGTH, numericValueBuffer)) < 0) {
+			PushFailed(push, now);
+			return 0;
+		}
+		contentLength += groupLength;
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+		if (push->changesOnly) {
+			// The snapshot holds every change recorded so far
+			push->sentSequence = last;
+			push->morePending = 0;
+			contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_HISTORY_LAST), outputBufferLength);
+			WOOPSA_UNSIGNED_TO_STRING(last, parameter, MAX_PARAMETER_LENGTH);
+			contentLength += Append(outputBuffer, parameter, outputBufferLength);
+		}
+#endif
+	}
+	contentLength += AppendText(outputBuffer, FLASH_TEXT(JSON_OBJECT_END), outputBufferLength);
+	SetContentLength(outputBuffer, outputBufferLength, contentLengthPosition, contentLength);
+	push->inFlight = 1;
+	push->dueAt = now + push->intervalMs;
+	return size + contentLength;
+}
+
+void WoopsaPushResponse(WoopsaPush* push, const WoopsaChar8* response, WoopsaBufferSize length) {
+	WoopsaUInt32 now = WOOPSA_MILLISECONDS();
+	if (!push->inFlight)
+		return;
+	push->inFlight = 0;
+	// HTTP/1.1 2xx
+	if (response == NULL || length < (WoopsaBufferSize)sizeof(HTTP_VERSION_STRING " 200") - 1 || response[sizeof(HTTP_VERSION_STRING)] != '2') {
+		PushFailed(push, now);
+		return;
+	}
+	push->failures = 0;
+	push->backoffMs = 0;
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+	if (!push->changesOnly)
+		return;
+	push->pushedSequence = push->sentSequence;
+	// Reset Content: the collector wants a snapshot
+	push->synced = response[sizeof(HTTP_VERSION_STRING) + 1] != '0' || response[sizeof(HTTP_VERSION_STRING) + 2] != '5';
+	// The changes that did not fit are pushed right away
+	if (push->morePending || !push->synced)
+		push->dueAt = now;
+#endif
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+void WoopsaServerSetInstance(WoopsaServer* server, void* instance, void* snapshot, WoopsaUInt16 size) {
+	WOOPSA_LOCK
+		server->instance = (WoopsaUInt8*)instance;
+		server->snapshot = (WoopsaUInt8*)snapshot;
+		server->instanceSize = size;
+		if (snapshot != NULL)
+			memcpy(snapshot, instance, size);
+		server->snapshotSequence++;
+	WOOPSA_UNLOCK
+}
+
+WoopsaUInt8 WoopsaServerTakeSnapshot(WoopsaServer* server) {
+	WoopsaUInt8 changed = 0;
+#ifdef WOOPSA_ENABLE_MOUNTS
+	WoopsaUInt8 i;
+	// The first mount is this server
+	for (i = 1; i < server->mountCount; i++)
+		changed |= WoopsaServerTakeSnapshot(server->mounts[i]);
+#endif
+	if (server->snapshot == NULL)
+		return changed;
+	WOOPSA_LOCK
+		if (memcmp(server->snapshot, server->instance, server->instanceSize) != 0) {
+			memcpy(server->snapshot, server->instance, server->instanceSize);
+			server->snapshotSequence++;
+			changed = 1;
+		}
+	WOOPSA_UNLOCK
+	return changed;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_HISTORY
+WoopsaUInt8 WoopsaServerAddHistory(WoopsaServer* server, WoopsaHistory* history) {
+	const WoopsaEntry* tableEntry = GetPropertyByNameOrNull(server, history->name);
+	const WoopsaEntry* woopsaEntry;
+	WoopsaEntry entryCopy;
+	if (tableEntry == NULL)
+		return WOOPSA_OTHER_ERROR;
+	woopsaEntry = LoadEntry(tableEntry, &entryCopy);
+	if (woopsaEntry->size > WOOPSA_HISTORY_VALUE_SIZE)
+		return WOOPSA_OTHER_ERROR;
+#ifdef WOOPSA_ENABLE_STRINGS
+	if (woopsaEntry->storage == WOOPSA_STORAGE_TEXT)
+		return WOOPSA_OTHER_ERROR;
+#endif
+	history->entry = tableEntry;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	history->server = server;
+#endif
+	history->next = server->histories;
+	server->histories = history;
+	return WOOPSA_SUCCESS;
+}
+
+void WoopsaHistoryRecord(WoopsaHistory* history) {
+	WoopsaHistorySample* sample;
+	WoopsaEntry entryCopy;
+	const WoopsaEntry* woopsaEntry;
+	void* data;
+	if (history->entry == NULL)
+		return;
+	woopsaEntry = LoadEntry(history->entry, &entryCopy);
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	data = GetPropertyData(history->server, woopsaEntry);
+#else
+	data = GetPropertyData(NULL, woopsaEntry);
+#endif
+	WOOPSA_LOCK
+		sample = &history->samples[history->head];
+		memcpy(sample->value.bytes, data, woopsaEntry->size);
+		sample->timestamp = WOOPSA_MILLISECONDS();
+		sample->sequence = history->nextSequence++;
+		history->head = (history->head + 1) % history->capacity;
+		if (history->count < history->capacity)
+			history->count++;
+	WOOPSA_UNLOCK
+}
+
+void WoopsaServerRecordHistories(WoopsaServer* server) {
+	WoopsaHistory* history;
+	for (history = server->histories; history != NULL; history = history->next)
+		WoopsaHistoryRecord(history);
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+WoopsaUInt8 WoopsaEventStreamPoll(WoopsaServer* server, WoopsaUInt8 stream, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength) {
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	*responseLength = 0;
+	if (stream >= WOOPSA_MAX_EVENT_STREAMS || !server->eventStreams[stream].open)
+		return WOOPSA_OTHER_ERROR;
+	outputBuffer[0] = '\0';
+	*responseLength = OutputEvents(server, outputBuffer, outputBufferLength, 0, &server->eventStreams[stream], 0, EVENT_FORMAT_STREAM, numericValueBuffer);
+	return WOOPSA_SUCCESS;
+}
+
+void WoopsaEventStreamClose(WoopsaServer* server, WoopsaUInt8 stream) {
+	if (stream < WOOPSA_MAX_EVENT_STREAMS)
+		server->eventStreams[stream].open = 0;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+void WoopsaServerSetAssets(WoopsaServer* server, const WoopsaStaticAsset assets[]) {
+	server->assets = assets;
+}
+
+WoopsaBufferSize WoopsaStaticAssetRead(const WoopsaStaticAsset* asset, WoopsaUInt32 offset, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength) {
+	WoopsaBufferSize length;
+	if (offset >= asset->length)
+		return 0;
+	length = (WoopsaBufferSize)(asset->length - offset);
+	if (length > outputBufferLength)
+		length = outputBufferLength;
+	WOOPSA_FLASH_COPY(outputBuffer, asset->data + offset, length);
+	return length;
 }
+#endif
 
 WoopsaUInt8 WoopsaCheckRequestComplete(WoopsaServer* server, WoopsaChar8* inputBuffer, WoopsaUInt16 inputBufferLength) {
 	WoopsaUInt8 contentLengthLength = 0;
@@ -403,7 +3495,7 @@ WoopsaUInt8 WoopsaCheckRequestComplete(WoopsaServer* server, WoopsaChar8* inputB
 		WOOPSA_STRING_N_COPY(buffer, header, headerSize); 
 		StringToLower(buffer);
 		// Is there a "Content-Length" header?
-		if (WOOPSA_STRING_POSITION(buffer, HEADER_CONTENT_LENGTH) == buffer) {
+		if (StartsWithText(buffer, FLASH_TEXT(HEADER_CONTENT_LENGTH))) {
 			// Yes, find the content-length
 			for (i = 0; buffer[i] != '\r'; i++) {
 				if (contentLengthPosition == NULL && buffer[i] == ':') {
@@ -421,15 +3513,15 @@ WoopsaUInt8 WoopsaCheckRequestComplete(WoopsaServer* server, WoopsaChar8* inputB
 	}
 	if (contentLength == 0) {
 		// If there is no content and we have the terminator, all done.
-		if (WOOPSA_STRING_POSITION(inputBuffer, HEADER_SEPARATOR HEADER_SEPARATOR))
+		if (FindText(inputBuffer, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR)))
 			return WOOPSA_REQUEST_COMLETE;
 		else
 			return WOOPSA_REQUEST_MORE_DATA_NEEDED;
 	} else {
 		// Otherwise it's a bit more technical, we have to make sure all
 		// the content is there
-		contentPosition = WOOPSA_STRING_POSITION(inputBuffer, HEADER_SEPARATOR HEADER_SEPARATOR) + WOOPSA_STRING_LENGTH(HEADER_SEPARATOR HEADER_SEPARATOR);
-		if (WOOPSA_STRING_LENGTH(contentPosition) == contentLength)
+		contentPosition = FindText(inputBuffer, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR)) + WOOPSA_STRING_LENGTH(HEADER_SEPARATOR HEADER_SEPARATOR);
+		if ((WoopsaBufferSize)WOOPSA_STRING_LENGTH(contentPosition) == contentLength)
 			return WOOPSA_REQUEST_COMLETE;
 		else
 			return WOOPSA_REQUEST_MORE_DATA_NEEDED;
@@ -437,52 +3529,134 @@ WoopsaUInt8 WoopsaCheckRequestComplete(WoopsaServer* server, WoopsaChar8* inputB
 }
 
 WoopsaUInt8 WoopsaHandleRequest(WoopsaServer* server, const WoopsaChar8* inputBuffer, WoopsaBufferSize inputBufferLength, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength) {
-	WoopsaChar8* header = NULL;
+	const WoopsaChar8* header = NULL;
+	const WoopsaChar8* currentHeader = NULL;
 	WoopsaChar8* woopsaPath = NULL;
-	WoopsaChar8* requestContent = NULL;
-	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	const WoopsaChar8* requestContent = NULL;
 	WoopsaBufferSize contentLengthPosition = 0;
 	WoopsaBufferSize contentLength = 0, i = 0, pos = 0;
-	WoopsaUInt8 isPost = 0, valueFound = 0, entryAt = 0;
-	WoopsaBufferSize headerSize = 0, keypairSize = 0;
-	WoopsaEntry* woopsaEntry = NULL;
-	TypesDictionaryEntry* typeEntry = NULL;
+	WoopsaUInt8 isPost = 0, result = 0;
+	WoopsaInt16 headerSize = 0;
 	WoopsaChar8* buffer = server->buffer;
-	// Zero-out the buffers
+	const WoopsaChar8* responseETag = NULL;
+#if defined(WOOPSA_ENABLE_ETAGS) || defined(WOOPSA_ENABLE_STATIC_ASSETS) || defined(WOOPSA_ENABLE_WEBSOCKETS)
+	const WoopsaChar8* headerValue = NULL;
+#endif
+#if defined(WOOPSA_ENABLE_ETAGS) || defined(WOOPSA_ENABLE_STATIC_ASSETS)
+	const WoopsaChar8* ifNoneMatch = NULL;
+	WoopsaInt16 ifNoneMatchLength = 0;
+#endif
+#ifdef WOOPSA_ENABLE_ETAGS
+	WoopsaChar8 etag[ETAG_LENGTH + 1];
+#endif
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	WoopsaInt16 eventStream = 0;
+#endif
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+	WoopsaUInt8 isWebSocketUpgrade = 0;
+	WoopsaChar8 webSocketKey[WEBSOCKET_KEY_LENGTH + 1];
+#endif
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	const WoopsaStaticAsset* asset = NULL;
+	WoopsaUInt8 acceptsGzip = 0;
+#endif
+#ifdef WOOPSA_ENABLE_MOUNTS
+	WoopsaServer* mounted = NULL;
+#endif
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+	webSocketKey[0] = '\0';
+#endif
+#ifdef WOOPSA_ENABLE_MOUNTS
+	server->routedServer = server;
+#endif
+	// Zero-out the buffer
 	memset(buffer, 0, sizeof(WoopsaBuffer));
-	memset(numericValueBuffer, 0, MAX_NUMERICAL_VALUE_LENGTH);
 	// Parse the first header (GET/POST)
 	headerSize = NextHTTPHeader(inputBuffer, &header);
 	if (headerSize == -1)
 		return WOOPSA_CLIENT_REQUEST_ERROR;
 	// Copy the HTTP method in the buffer and check if POST
-	for (i = 0; i < headerSize && i < sizeof(WoopsaBuffer); i++) {
+	for (i = 0; i < headerSize && i < (WoopsaBufferSize)sizeof(WoopsaBuffer); i++) {
 		if (inputBuffer[i] == ' ') {
 			pos = i + 1;
 			break;
 		}
 		buffer[i] = inputBuffer[i];
 	}
-	if (WOOPSA_STRING_EQUAL(buffer, "POST"))
+	if (EqualsText(buffer, FLASH_TEXT(HTTP_METHOD_POST)))
 		isPost = 1;
 	// Extract the requested path into the buffer
-	for (i = 0; (i < headerSize - pos) && i < sizeof(WoopsaBuffer); i++) {
+	for (i = 0; (i < headerSize - pos) && i < (WoopsaBufferSize)sizeof(WoopsaBuffer) - 1; i++) {
 		if (inputBuffer[pos + i] == ' ')
 			break;
 		buffer[i] = inputBuffer[pos + i];
 	}
-	// Extract all headers (but do nothing with them)
-	while ((headerSize = NextHTTPHeader(header, &header)) != -1 && header < inputBuffer + inputBufferLength) {
-		// Do some work on the headers. We don't need to really do anything now actually
+	buffer[i] = '\0';
+	// Extract the headers we need
+	for (currentHeader = header; (headerSize = NextHTTPHeader(currentHeader, &header)) != -1 && header < inputBuffer + inputBufferLength; currentHeader = header) {
+#if defined(WOOPSA_ENABLE_ETAGS) || defined(WOOPSA_ENABLE_STATIC_ASSETS)
+		if ((headerValue = HeaderValueOrNull(currentHeader, headerSize, FLASH_TEXT(HEADER_IF_NONE_MATCH))) != NULL) {
+			ifNoneMatch = headerValue;
+			ifNoneMatchLength = (WoopsaInt16)(currentHeader + headerSize - headerValue);
+			continue;
+		}
+#endif
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+		if ((headerValue = HeaderValueOrNull(currentHeader, headerSize, FLASH_TEXT(HEADER_ACCEPT_ENCODING))) != NULL) {
+			acceptsGzip = ContainsIgnoreCase(headerValue, (WoopsaInt16)(currentHeader + headerSize - headerValue), FLASH_TEXT(ASSET_ENCODING_GZIP));
+			continue;
+		}
+#endif
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+		if ((headerValue = HeaderValueOrNull(currentHeader, headerSize, FLASH_TEXT(HEADER_UPGRADE))) != NULL) {
+			isWebSocketUpgrade = StartsWithIgnoreCase(headerValue, FLASH_TEXT(WEBSOCKET_UPGRADE_VALUE));
+		} else if ((headerValue = HeaderValueOrNull(currentHeader, headerSize, FLASH_TEXT(HEADER_WEBSOCKET_KEY))) != NULL) {
+			for (i = 0; i < WEBSOCKET_KEY_LENGTH && headerValue + i < currentHeader + headerSize; i++)
+				webSocketKey[i] = headerValue[i];
+			webSocketKey[i] = '\0';
+		}
+#endif
 	}
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	// Static assets take precedence over the request handler
+	if (server->assets != NULL && isPost == 0 && (asset = GetAssetByPathOrNull(server->assets, buffer)) != NULL) {
+		if (asset->isGzipped && !acceptsGzip) {
+			*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_NOT_ACCEPTABLE), FLASH_TEXT(HTTP_TEXT_NOT_ACCEPTABLE));
+			return WOOPSA_CLIENT_REQUEST_ERROR;
+		}
+		if (ifNoneMatch != NULL && ContainsETag(ifNoneMatch, ifNoneMatchLength, asset->etag)) {
+			*responseLength = PrepareAssetResponse(outputBuffer, outputBufferLength, asset, 1);
+			return WOOPSA_SUCCESS;
+		}
+		server->servedAsset = asset;
+		*responseLength = PrepareAssetResponse(outputBuffer, outputBufferLength, asset, 0);
+		return WOOPSA_STATIC_ASSET;
+	}
+#endif
+#ifdef WOOPSA_ENABLE_MOUNTS
+	// The mounted server with the longest prefix handles the rest, in its
+	// own buffer where the verbs decode their values
+	if ((mounted = RouteRequest(server, buffer)) != NULL && mounted != server) {
+		memcpy(mounted->buffer, buffer, sizeof(WoopsaBuffer));
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+		mounted->metaCursor = server->metaCursor;
+#endif
+		server->routedServer = mounted;
+		server = mounted;
+		buffer = server->buffer;
+	}
+	if (mounted == NULL) {
+#else
 	// Check if the path is a Woopsa path
 	if ((WOOPSA_STRING_POSITION(buffer, server->pathPrefix)) != buffer) {
+#endif
 		// It's not, so we try to handle it with the handleRequest func pointer
 		if (server->requestHandler != NULL) {
-			*responseLength = PrepareResponse(outputBuffer, outputBufferLength, HTTP_CODE_OK, HTTP_TEXT_OK, &contentLengthPosition, CONTENT_TYPE_HTML);
+			*responseLength = PrepareResponse(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_OK), FLASH_TEXT(HTTP_TEXT_OK), &contentLengthPosition, FLASH_TEXT(CONTENT_TYPE_HTML), NULL);
 			contentLength = server->requestHandler(buffer, isPost, outputBuffer + *responseLength, outputBufferLength - *responseLength);
 			if (contentLength == 0) {
-				*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_NOT_FOUND, HTTP_TEXT_NOT_FOUND);
+				*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_NOT_FOUND), FLASH_TEXT(HTTP_TEXT_NOT_FOUND));
 				return WOOPSA_CLIENT_REQUEST_ERROR;
 			} else {
 				SetContentLength(outputBuffer, outputBufferLength, contentLengthPosition, contentLength);
@@ -491,168 +3665,81 @@ WoopsaUInt8 WoopsaHandleRequest(WoopsaServer* server, const WoopsaChar8* inputBu
 			}
 		} else {
 			// This request does not start with the prefix, return 404
-			*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_NOT_FOUND, HTTP_TEXT_NOT_FOUND);
+			*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_NOT_FOUND), FLASH_TEXT(HTTP_TEXT_NOT_FOUND));
 			return WOOPSA_CLIENT_REQUEST_ERROR;
 		}
 	}
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+	// Any Woopsa path can be upgraded to a WebSocket
+	if (isWebSocketUpgrade && webSocketKey[0] != '\0' && isPost == 0) {
+		*responseLength = PrepareWebSocketHandshake(outputBuffer, outputBufferLength, webSocketKey);
+		return WOOPSA_WEBSOCKET;
+	}
+#endif
 	// Remove the Woopsa prefix and handle each Woopsa verb
 	woopsaPath = &(buffer[WOOPSA_STRING_LENGTH(server->pathPrefix)]);
-	if (WOOPSA_STRING_POSITION(woopsaPath, VERB_META) == woopsaPath && isPost == 0) {
-		// Meta request, start the HTTP response
-		*responseLength = PrepareResponse(outputBuffer, outputBufferLength, HTTP_CODE_OK, HTTP_TEXT_OK, &contentLengthPosition, CONTENT_TYPE_JSON);
-		// Output the serialized response
-		contentLength += Append(outputBuffer, JSON_META_PROPERTIES JSON_ARRAY_START, outputBufferLength);
-		for(i = 0; server->entries[i].name != NULL; i++) {
-			woopsaEntry = &server->entries[i];
-			if (woopsaEntry->isMethod)
-				continue;
-			if ( entryAt != 0 )
-				contentLength += Append(outputBuffer, JSON_ARRAY_DELIMITER, outputBufferLength);
-			entryAt++;
-			typeEntry = GetTypeEntry(woopsaEntry->type);
-			contentLength += Append(outputBuffer, JSON_PROPERTY_NAME, outputBufferLength);
-			contentLength += AppendEscape(outputBuffer, woopsaEntry->name, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
-			contentLength += Append(outputBuffer, JSON_PROPERTY_TYPE, outputBufferLength);
-			contentLength += Append(outputBuffer, typeEntry->string, outputBufferLength);
-			contentLength += Append(outputBuffer, JSON_PROPERTY_READONLY, outputBufferLength);
-			contentLength += Append(outputBuffer, (woopsaEntry->readOnly == 1) ? JSON_TRUE : JSON_FALSE, outputBufferLength);
-			contentLength += Append(outputBuffer, JSON_PROPERTY_END, outputBufferLength);
-		}
-		contentLength += Append(outputBuffer, JSON_ARRAY_END JSON_META_METHODS JSON_ARRAY_START, outputBufferLength);
-#ifdef WOOPSA_ENABLE_METHODS
-		entryAt = 0;
-		for (i = 0; server->entries[i].name != NULL; i++) {
-			woopsaEntry = &server->entries[i];
-			if (!woopsaEntry->isMethod)
-				continue;
-			if (entryAt != 0)
-				contentLength += Append(outputBuffer, JSON_ARRAY_DELIMITER, outputBufferLength);
-			entryAt++;
-			typeEntry = GetTypeEntry(woopsaEntry->type);
-			contentLength += Append(outputBuffer, JSON_METHOD_NAME, outputBufferLength);
-			contentLength += AppendEscape(outputBuffer, woopsaEntry->name, JSON_STRING_DELIMITER_CHAR, JSON_ESCAPE_CHAR, outputBufferLength);
-			contentLength += Append(outputBuffer, JSON_METHOD_RETURN_TYPE, outputBufferLength);
-			contentLength += Append(outputBuffer, typeEntry->string, outputBufferLength);
-			contentLength += Append(outputBuffer, JSON_METHOD_END, outputBufferLength);
-		}
-#endif
-		contentLength += Append(outputBuffer, JSON_ARRAY_END JSON_META_END, outputBufferLength);
-	} else if (WOOPSA_STRING_POSITION(woopsaPath, VERB_READ) == woopsaPath && isPost == 0) {
-		// Read request - Get the property for this read
-		buffer[0] = '\0';
-		woopsaPath = &(woopsaPath[sizeof(VERB_READ)]);
-		if ((woopsaEntry = GetPropertyByNameOrNull(server->entries, woopsaPath)) == NULL) {
-			*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_NOT_FOUND, HTTP_TEXT_NOT_FOUND);
-			return WOOPSA_CLIENT_REQUEST_ERROR;
-		}
-		typeEntry = GetTypeEntry(woopsaEntry->type);
-		// Start the HTTP response
-		*responseLength = PrepareResponse(outputBuffer, outputBufferLength, HTTP_CODE_OK, HTTP_TEXT_OK, &contentLengthPosition, CONTENT_TYPE_JSON);
-		// Output the serialized response
-		contentLength += OutputProperty(outputBuffer, outputBufferLength, woopsaEntry, typeEntry, numericValueBuffer);
-	} else if (WOOPSA_STRING_POSITION(woopsaPath, VERB_WRITE) == woopsaPath && isPost == 1) {
-		// Write request - Get the property for this write
-		buffer[0] = '\0';
-		woopsaPath = &(woopsaPath[sizeof(VERB_WRITE)]);
-		if ((woopsaEntry = GetPropertyByNameOrNull(server->entries, woopsaPath)) == NULL) {
-			*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_NOT_FOUND, HTTP_TEXT_NOT_FOUND);
-			return WOOPSA_CLIENT_REQUEST_ERROR;
-		}
-		typeEntry = GetTypeEntry(woopsaEntry->type);
-		// Decode POST data
-		requestContent = WOOPSA_STRING_POSITION(inputBuffer, "\r\n\r\n");
-		requestContent = &requestContent[4];
-		// Cheating here - using the numericValueBuffer to store the key (10 chars should be enough)
-		while ((keypairSize = NextURLDecodedValue(&requestContent[keypairSize], numericValueBuffer, buffer)) != -1) {
-			if (WOOPSA_STRING_EQUAL(numericValueBuffer, POST_VALUE_KEY)) {
-				valueFound = 1;
-			}
-		}
-		if (!valueFound) {
-			*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_BAD_REQUEST, HTTP_TEXT_BAD_REQUEST);
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	if (StartsWithText(woopsaPath, FLASH_TEXT(VERB_EVENTS)) && isPost == 0) {
+		// Event stream request - Find a free stream for these properties
+		if ((eventStream = OpenEventStream(server, SplitQuery(woopsaPath), numericValueBuffer)) == -1) {
+			*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_SERVICE_UNAVAILABLE), FLASH_TEXT(HTTP_TEXT_SERVICE_UNAVAILABLE));
+			return WOOPSA_OTHER_ERROR;
+		} else if (eventStream < 0) {
+			*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_NOT_FOUND), FLASH_TEXT(HTTP_TEXT_NOT_FOUND));
 			return WOOPSA_CLIENT_REQUEST_ERROR;
 		}
-		// Write the value
-		if (woopsaEntry->type == WOOPSA_TYPE_INTEGER) {
-			WOOPSA_LOCK
-				WOOPSA_STRING_TO_INTEGER(*(int*)woopsaEntry->address.data, buffer);
-			WOOPSA_UNLOCK
-		} else if (woopsaEntry->type == WOOPSA_TYPE_REAL || woopsaEntry->type == WOOPSA_TYPE_TIME_SPAN) {
-			WOOPSA_LOCK
-				WOOPSA_STRING_TO_FLOAT(*(float*)woopsaEntry->address.data, buffer);
-			WOOPSA_UNLOCK
-		} 
-		else if (woopsaEntry->type == WOOPSA_TYPE_LOGICAL) {
-			StringToLower(buffer);
-			WOOPSA_LOCK
-			if (WOOPSA_STRING_EQUAL(buffer, JSON_TRUE))
-				*(char*)woopsaEntry->address.data = 1;
-			else
-				*(char*)woopsaEntry->address.data = 0;
-			WOOPSA_UNLOCK
-		}
-#ifdef WOOPSA_ENABLE_STRINGS
-		else 
-		{
-			if (woopsaEntry->size > WOOPSA_STRING_LENGTH(buffer)) {
-				WOOPSA_LOCK
-					WOOPSA_STRING_COPY((char*)woopsaEntry->address.data, buffer);
-				WOOPSA_UNLOCK
-			} else {
-				*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_BAD_REQUEST, HTTP_TEXT_BAD_REQUEST);
-				return WOOPSA_CLIENT_REQUEST_ERROR;
-			}
-		}
+		server->openedEventStream = (WoopsaUInt8)eventStream;
+		// The response has no length, events follow as long as the connection is open
+		outputBuffer[0] = '\0';
+		*responseLength = AppendText(outputBuffer, FLASH_TEXT(HTTP_VERSION_STRING " " HTTP_CODE_OK " " HTTP_TEXT_OK HEADER_SEPARATOR HEADER_CONTENT_TYPE CONTENT_TYPE_EVENT_STREAM HEADER_SEPARATOR EVENT_STREAM_HEADERS HEADER_SEPARATOR), outputBufferLength);
+		// Start with the current value of every property
+		*responseLength += OutputEvents(server, outputBuffer, outputBufferLength, *responseLength, &server->eventStreams[eventStream], 1, EVENT_FORMAT_STREAM, numericValueBuffer);
+		return WOOPSA_EVENT_STREAM;
+	}
 #endif
-		// Start the HTTP response
-		*responseLength = PrepareResponse(outputBuffer, outputBufferLength, HTTP_CODE_OK, HTTP_TEXT_OK, &contentLengthPosition, CONTENT_TYPE_JSON);
-		// Output the serialized response
-		contentLength += OutputProperty(outputBuffer, outputBufferLength, woopsaEntry, typeEntry, numericValueBuffer);
-	} 
-#ifdef WOOPSA_ENABLE_METHODS
-	else if (WOOPSA_STRING_POSITION(woopsaPath, VERB_INVOKE) == woopsaPath && isPost == 1) 
-	{
-		// Write request - Get the property for this write
-		buffer[0] = '\0';
-		woopsaPath = &(woopsaPath[sizeof(VERB_INVOKE)]);
-		if ((woopsaEntry = GetMethodByNameOrNull(server->entries, woopsaPath)) == NULL) {
-			*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_NOT_FOUND, HTTP_TEXT_NOT_FOUND);
-			return WOOPSA_CLIENT_REQUEST_ERROR;
-		}
-		typeEntry = GetTypeEntry(woopsaEntry->type);
-		// Start the HTTP response
-		*responseLength = PrepareResponse(outputBuffer, outputBufferLength, HTTP_CODE_OK, HTTP_TEXT_OK, &contentLengthPosition, CONTENT_TYPE_JSON);
-		// Invoke the method
-		if (woopsaEntry->type == WOOPSA_TYPE_NULL) {
-			(*(ptrMethodVoid)woopsaEntry->address.function)();
-			contentLength = 0;
-		} else {
-			if (woopsaEntry->type == WOOPSA_TYPE_TEXT
-				|| woopsaEntry->type == WOOPSA_TYPE_LINK
-				|| woopsaEntry->type == WOOPSA_TYPE_RESOURCE_URL
-				|| woopsaEntry->type == WOOPSA_TYPE_DATE_TIME) {
-				WOOPSA_LOCK
-					contentLength += OutputSerializedValue(outputBuffer, outputBufferLength, (*(ptrMethodRetString)woopsaEntry->address.function)(), typeEntry->string, 1);
-				WOOPSA_UNLOCK
-			} else {
-				if (woopsaEntry->type == WOOPSA_TYPE_INTEGER) {
-					WOOPSA_LOCK
-						WOOPSA_INTEGER_TO_STRING((*(ptrMethodRetInteger)woopsaEntry->address.function)(), numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
-					WOOPSA_UNLOCK
-				} else {
-					WOOPSA_LOCK
-						WOOPSA_REAL_TO_STRING((*(ptrMethodRetReal)woopsaEntry->address.function)(), numericValueBuffer, MAX_NUMERICAL_VALUE_LENGTH);
-					WOOPSA_UNLOCK
-				}
-				contentLength += OutputSerializedValue(outputBuffer, outputBufferLength, numericValueBuffer, typeEntry->string, 0);
-			}
+#ifdef WOOPSA_ENABLE_ETAGS
+	// Don't send meta or values again if the client already has them
+	if (isPost == 0 && GetETag(server, woopsaPath, etag)) {
+		if (ifNoneMatch != NULL && ContainsETag(ifNoneMatch, ifNoneMatchLength, etag)) {
+			*responseLength = PrepareNotModified(outputBuffer, outputBufferLength, etag);
+			return WOOPSA_SUCCESS;
 		}
-	} 
+		responseETag = etag;
+	}
 #endif
-	else 
-	{
-		// Invalid request
-		*responseLength = PrepareError(outputBuffer, outputBufferLength, HTTP_CODE_NOT_FOUND, HTTP_TEXT_NOT_FOUND);
+	// Find the POST data
+	if (isPost) {
+		requestContent = FindText(inputBuffer, FLASH_TEXT(HEADER_SEPARATOR HEADER_SEPARATOR));
+		if (requestContent != NULL)
+			requestContent += WOOPSA_STRING_LENGTH(HEADER_SEPARATOR HEADER_SEPARATOR);
+	}
+	// Start the HTTP response, then output the serialized result
+	*responseLength = PrepareResponse(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_OK), FLASH_TEXT(HTTP_TEXT_OK), &contentLengthPosition, FLASH_TEXT(CONTENT_TYPE_JSON), responseETag);
+#if defined(WOOPSA_ENABLE_TIME_SLICING) && !defined(WOOPSA_ENABLE_SUBOBJECTS)
+	// The connection serializes the entries in its next steps, pages of
+	// meta are bounded by the output buffer and answered at once, as are
+	// the metas of subobjects
+	if (server->metaCursor != NULL && StartsWithText(woopsaPath, FLASH_TEXT(VERB_META)) && isPost == 0
+#ifdef WOOPSA_ENABLE_PAGED_META
+			&& woopsaPath[sizeof(VERB_META) - 1] != URL_QUERY_SEPARATOR
+#endif
+			) {
+		server->metaCursor->pass = META_START;
+		server->metaCursor->contentLengthPosition = contentLengthPosition;
+		server->metaCursor->headersLength = *responseLength;
+		server->metaCursor->contentLength = 0;
+		return WOOPSA_SUCCESS;
+	}
+#endif
+	result = HandleVerb(server, isPost, woopsaPath, requestContent, 1, outputBuffer, outputBufferLength, *responseLength, &contentLength);
+	if (result == VERB_RESULT_BAD_REQUEST) {
+		*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_BAD_REQUEST), FLASH_TEXT(HTTP_TEXT_BAD_REQUEST));
+		return WOOPSA_CLIENT_REQUEST_ERROR;
+	} else if (result == VERB_RESULT_UNAVAILABLE) {
+		*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_SERVICE_UNAVAILABLE), FLASH_TEXT(HTTP_TEXT_SERVICE_UNAVAILABLE));
+		return WOOPSA_OTHER_ERROR;
+	} else if (result != VERB_RESULT_OK) {
+		*responseLength = PrepareError(outputBuffer, outputBufferLength, FLASH_TEXT(HTTP_CODE_NOT_FOUND), FLASH_TEXT(HTTP_TEXT_NOT_FOUND));
 		return WOOPSA_CLIENT_REQUEST_ERROR;
 	}
 	// Re-inject the content-length into the HTTP headers
@@ -660,3 +3747,271 @@ WoopsaUInt8 WoopsaHandleRequest(WoopsaServer* server, const WoopsaChar8* inputBu
 	*responseLength += contentLength;
 	return WOOPSA_SUCCESS;
 }
+
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+WoopsaUInt8 WoopsaWebSocketHandleFrame(WoopsaServer* server, const WoopsaChar8* inputBuffer, WoopsaBufferSize inputBufferLength, WoopsaBufferSize* consumed,
+		WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength) {
+	const WoopsaUInt8* frame = (const WoopsaUInt8*)inputBuffer;
+	const WoopsaUInt8* mask = NULL;
+	WoopsaChar8* buffer = server->buffer;
+	WoopsaChar8* value = NULL;
+	WoopsaChar8* payload = outputBuffer + WEBSOCKET_MAX_HEADER_LENGTH;
+	WoopsaBufferSize payloadLength = 0, headerLength = WEBSOCKET_MIN_HEADER_LENGTH, contentLength = 0, i = 0;
+	WoopsaBufferSize payloadBufferLength = outputBufferLength - WEBSOCKET_MAX_HEADER_LENGTH;
+	WoopsaUInt8 opcode = 0, isPost = 0, result = VERB_RESULT_OK;
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	WoopsaInt16 eventStream = 0;
+#endif
+	*consumed = 0;
+	*responseLength = 0;
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+	server->startedJob = 0;
+#endif
+	if (inputBufferLength < WEBSOCKET_MIN_HEADER_LENGTH)
+		return WOOPSA_SUCCESS;
+	// Clients must mask their frames. Fragmented and 64-bit long
+	// messages are not supported: they would not fit in our buffers anyway.
+	if (!(frame[0] & WEBSOCKET_FIN) || !(frame[1] & WEBSOCKET_MASKED))
+		return WOOPSA_CLIENT_REQUEST_ERROR;
+	opcode = frame[0] & WEBSOCKET_OPCODE_MASK;
+	payloadLength = frame[1] & WEBSOCKET_LENGTH_MASK;
+	if (payloadLength == WEBSOCKET_LENGTH_64BIT) {
+		return WOOPSA_CLIENT_REQUEST_ERROR;
+	} else if (payloadLength == WEBSOCKET_LENGTH_16BIT) {
+		if (inputBufferLength < WEBSOCKET_MAX_HEADER_LENGTH)
+			return WOOPSA_SUCCESS;
+		payloadLength = ((WoopsaBufferSize)frame[2] << 8) | frame[3];
+		headerLength = WEBSOCKET_MAX_HEADER_LENGTH;
+	}
+	if (payloadLength >= (WoopsaBufferSize)sizeof(WoopsaBuffer))
+		return WOOPSA_CLIENT_REQUEST_ERROR;
+	if (inputBufferLength < headerLength + WEBSOCKET_MASK_LENGTH + payloadLength)
+		return WOOPSA_SUCCESS;
+	*consumed = headerLength + WEBSOCKET_MASK_LENGTH + payloadLength;
+	// Unmask the payload into the server buffer
+	mask = frame + headerLength;
+	for (i = 0; i < payloadLength; i++)
+		buffer[i] = (WoopsaChar8)(frame[headerLength + WEBSOCKET_MASK_LENGTH + i] ^ mask[i % WEBSOCKET_MASK_LENGTH]);
+	buffer[payloadLength] = '\0';
+	if (opcode == WEBSOCKET_OPCODE_PING || opcode == WEBSOCKET_OPCODE_CLOSE) {
+		// Answer with the same payload (the status code for close frames)
+		if (opcode == WEBSOCKET_OPCODE_CLOSE && payloadLength > WEBSOCKET_CLOSE_STATUS_LENGTH)
+			payloadLength = WEBSOCKET_CLOSE_STATUS_LENGTH;
+		if (payloadLength + WEBSOCKET_MIN_HEADER_LENGTH > outputBufferLength)
+			return WOOPSA_OTHER_ERROR;
+		*responseLength = WriteWebSocketFrameHeader(outputBuffer, opcode == WEBSOCKET_OPCODE_PING ? WEBSOCKET_OPCODE_PONG : WEBSOCKET_OPCODE_CLOSE, payloadLength);
+		memcpy(outputBuffer + *responseLength, buffer, payloadLength);
+		*responseLength += payloadLength;
+		return opcode == WEBSOCKET_OPCODE_CLOSE ? WOOPSA_WEBSOCKET_CLOSED : WOOPSA_SUCCESS;
+	} else if (opcode == WEBSOCKET_OPCODE_PONG) {
+		return WOOPSA_SUCCESS;
+	} else if (opcode != WEBSOCKET_OPCODE_TEXT && opcode != WEBSOCKET_OPCODE_BINARY) {
+		return WOOPSA_CLIENT_REQUEST_ERROR;
+	}
+	// Frames longer than this cannot be encoded with a 16-bit length
+	if (payloadBufferLength > WEBSOCKET_MAX_PAYLOAD_LENGTH)
+		payloadBufferLength = WEBSOCKET_MAX_PAYLOAD_LENGTH;
+	payload[0] = '\0';
+	// A message is a Woopsa path, followed by a space and the value for writes
+	for (value = buffer; *value != '\0' && *value != ' '; value++);
+	if (*value == ' ')
+		*value++ = '\0';
+	isPost = (StartsWithText(buffer, FLASH_TEXT(VERB_WRITE)) || StartsWithText(buffer, FLASH_TEXT(VERB_INVOKE)));
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	if (StartsWithText(buffer, FLASH_TEXT(VERB_EVENTS))) {
+		// Subscribe this WebSocket to the changes of a few properties
+		if ((eventStream = OpenEventStream(server, SplitQuery(buffer), numericValueBuffer)) >= 0) {
+			server->openedEventStream = (WoopsaUInt8)eventStream;
+			contentLength = OutputEvents(server, payload, payloadBufferLength, 0, &server->eventStreams[eventStream], 1, EVENT_FORMAT_JSON, numericValueBuffer);
+			*responseLength = FrameWebSocketPayload(outputBuffer, WEBSOCKET_OPCODE_TEXT, contentLength);
+			return WOOPSA_EVENT_STREAM;
+		}
+		result = (eventStream == -1) ? VERB_RESULT_UNAVAILABLE : VERB_RESULT_NOT_FOUND;
+	} else
+#endif
+	result = HandleVerb(server, isPost, buffer, value, 0, payload, payloadBufferLength, 0, &contentLength);
+	if (result != VERB_RESULT_OK) {
+		payload[0] = '\0';
+		contentLength = AppendText(payload, FLASH_TEXT(JSON_ERROR), payloadBufferLength);
+		if (result == VERB_RESULT_BAD_REQUEST)
+			contentLength += AppendText(payload, FLASH_TEXT(HTTP_TEXT_BAD_REQUEST), payloadBufferLength);
+		else if (result == VERB_RESULT_UNAVAILABLE)
+			contentLength += AppendText(payload, FLASH_TEXT(HTTP_TEXT_SERVICE_UNAVAILABLE), payloadBufferLength);
+		else
+			contentLength += AppendText(payload, FLASH_TEXT(HTTP_TEXT_NOT_FOUND), payloadBufferLength);
+		contentLength += AppendText(payload, FLASH_TEXT(JSON_STRING_DELIMITER JSON_OBJECT_END), payloadBufferLength);
+	}
+	*responseLength = FrameWebSocketPayload(outputBuffer, WEBSOCKET_OPCODE_TEXT, contentLength);
+	return WOOPSA_SUCCESS;
+}
+
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+WoopsaUInt8 WoopsaWebSocketPollEvents(WoopsaServer* server, WoopsaUInt8 stream, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength) {
+	WoopsaChar8 numericValueBuffer[MAX_NUMERICAL_VALUE_LENGTH];
+	WoopsaChar8* payload = outputBuffer + WEBSOCKET_MAX_HEADER_LENGTH;
+	WoopsaBufferSize contentLength = 0, payloadBufferLength = outputBufferLength - WEBSOCKET_MAX_HEADER_LENGTH;
+	*responseLength = 0;
+	if (stream >= WOOPSA_MAX_EVENT_STREAMS || !server->eventStreams[stream].open)
+		return WOOPSA_OTHER_ERROR;
+	if (payloadBufferLength > WEBSOCKET_MAX_PAYLOAD_LENGTH)
+		payloadBufferLength = WEBSOCKET_MAX_PAYLOAD_LENGTH;
+	payload[0] = '\0';
+	contentLength = OutputEvents(server, payload, payloadBufferLength, 0, &server->eventStreams[stream], 0, EVENT_FORMAT_JSON, numericValueBuffer);
+	// Nothing changed, nothing to send
+	if (contentLength > (WoopsaBufferSize)WOOPSA_STRING_LENGTH(JSON_ARRAY_START JSON_ARRAY_END))
+		*responseLength = FrameWebSocketPayload(outputBuffer, WEBSOCKET_OPCODE_TEXT, contentLength);
+	return WOOPSA_SUCCESS;
+}
+#endif
+#endif
+
+#ifdef WOOPSA_ENABLE_CONNECTIONS
+void WoopsaConnectionInit(WoopsaConnection* connection, WoopsaServer* server) {
+	memset(connection, 0, sizeof(WoopsaConnection));
+	connection->server = server;
+#ifdef WOOPSA_ENABLE_MOUNTS
+	connection->mounted = server;
+#endif
+	connection->state = WOOPSA_CONNECTION_HTTP;
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	UpdateDeadline(connection, 0);
+#endif
+}
+
+WoopsaChar8* WoopsaConnectionInput(WoopsaConnection* connection, WoopsaBufferSize* space) {
+	*space = WOOPSA_CONNECTION_INPUT_SIZE - connection->inputLength;
+	return connection->input + connection->inputLength;
+}
+
+void WoopsaConnectionReceived(WoopsaConnection* connection, WoopsaBufferSize length) {
+	if (connection->state >= WOOPSA_CONNECTION_CLOSING)
+		return;
+	connection->inputLength += length;
+	connection->input[connection->inputLength] = '\0';
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	// Event stream clients have nothing to say
+	if (connection->hasEventStream && connection->state == WOOPSA_CONNECTION_HTTP) {
+		connection->inputLength = 0;
+		return;
+	}
+#endif
+#ifndef WOOPSA_ENABLE_TIME_SLICING
+	HandleConnectionInput(connection);
+#endif
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	UpdateDeadline(connection, 0);
+#endif
+}
+
+WoopsaBufferSize WoopsaConnectionFeed(WoopsaConnection* connection, const WoopsaChar8* data, WoopsaBufferSize length) {
+	WoopsaBufferSize space;
+	WoopsaChar8* input = WoopsaConnectionInput(connection, &space);
+	if (length > space)
+		length = space;
+	memcpy(input, data, length);
+	WoopsaConnectionReceived(connection, length);
+	return length;
+}
+
+WoopsaBufferSize WoopsaConnectionPollOutput(WoopsaConnection* connection, const WoopsaChar8** output) {
+#ifndef WOOPSA_ENABLE_TIME_SLICING
+	ProduceConnectionOutput(connection);
+#endif
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	UpdateDeadline(connection, 0);
+#endif
+	*output = connection->output + connection->outputSent;
+	return connection->outputLength - connection->outputSent;
+}
+
+void WoopsaConnectionConsumed(WoopsaConnection* connection, WoopsaBufferSize length) {
+	connection->outputSent += length;
+	if (connection->outputSent >= connection->outputLength)
+		ConnectionOutputSent(connection);
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	UpdateDeadline(connection, length != 0);
+#endif
+}
+
+WoopsaUInt8 WoopsaConnectionIsClosed(WoopsaConnection* connection) {
+	return connection->state == WOOPSA_CONNECTION_CLOSED;
+}
+
+void WoopsaConnectionClose(WoopsaConnection* connection) {
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	if (connection->hasEventStream)
+		WoopsaEventStreamClose(CONNECTION_SERVER(connection), connection->eventStream);
+	connection->hasEventStream = 0;
+#endif
+	connection->state = WOOPSA_CONNECTION_CLOSED;
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	CancelTimer(&connection->timer);
+	connection->deadline = WOOPSA_DEADLINE_NONE;
+#endif
+}
+
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+WoopsaUInt8 WoopsaConnectionStep(WoopsaConnection* connection) {
+	WoopsaServer* server = connection->server;
+	WoopsaBufferSize inputLength = connection->inputLength;
+	WoopsaUInt8 state = connection->state, step = 0;
+	WoopsaUInt32 start = 0;
+	if (server->stepHook != NULL)
+		start = WOOPSA_MICROSECONDS();
+	if (connection->meta.pass != META_DONE) {
+		ContinueMetaResponse(connection);
+		step = WOOPSA_STEP_META;
+	} else if (ProduceConnectionOutput(connection)) {
+		step = WOOPSA_STEP_OUTPUT;
+	} else if (connection->outputLength == 0) {
+		HandleConnectionInput(connection);
+		// Handled requests and frames are removed from the input
+		if (connection->inputLength != inputLength || connection->state != state)
+			step = WOOPSA_STEP_REQUEST;
+	}
+	if (step != 0 && server->stepHook != NULL)
+		server->stepHook(step, WOOPSA_MICROSECONDS() - start);
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	UpdateDeadline(connection, step != 0);
+#endif
+	return step;
+}
+
+void WoopsaServerSetStepHook(WoopsaServer* server, WoopsaStepHook hook) {
+	server->stepHook = hook;
+}
+#endif
+
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+WoopsaUInt8 WoopsaConnectionExpired(WoopsaConnection* connection) {
+	return connection->expired;
+}
+
+void WoopsaServerExpireConnections(WoopsaServer* server) {
+	WoopsaTimerWheel* wheel = &server->timers;
+	WoopsaTimer* timer, * next;
+	WoopsaUInt32 now = WOOPSA_MILLISECONDS();
+	WoopsaUInt8 ticks;
+	// Once around the wheel is enough to find every expired timer
+	for (ticks = 0; now - wheel->tickStart >= WOOPSA_TIMER_TICK_MS && ticks < WOOPSA_TIMER_SLOTS; ticks++) {
+		wheel->tick = (wheel->tick + 1) & (WOOPSA_TIMER_SLOTS - 1);
+		wheel->tickStart += WOOPSA_TIMER_TICK_MS;
+		for (timer = wheel->slots[wheel->tick]; timer != NULL; timer = next) {
+			next = timer->next;
+			// Timers armed again by ConnectionTimedOut are after now
+			if (now - timer->armedAt >= timer->duration && now - timer->armedAt < 0x80000000UL) {
+				CancelTimer(timer);
+				ConnectionTimedOut(TIMER_CONNECTION(timer));
+			}
+		}
+	}
+	// After a long pause, the ticks beyond one turn still move the wheel,
+	// so that the tick stays the one of tickStart for ArmTimer
+	if (now - wheel->tickStart >= WOOPSA_TIMER_TICK_MS) {
+		wheel->tick = (wheel->tick + (now - wheel->tickStart) / WOOPSA_TIMER_TICK_MS) & (WOOPSA_TIMER_SLOTS - 1);
+		wheel->tickStart = now - (now - wheel->tickStart) % WOOPSA_TIMER_TICK_MS;
+	}
+}
+#endif
+#endif
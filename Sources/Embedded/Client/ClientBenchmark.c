@@ -0,0 +1,247 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "woopsa-client.h"
+#include "woopsa-host-server.h"
+
+// Loopback benchmark of the client against the host server, run by a
+// child process: latency of synchronous reads and writes, throughput of
+// pipelined reads, batch reads and transactions.
+//   gcc -O2 -I../Server -I../HostServer -DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_TRANSACTIONS -o ClientBenchmark ClientBenchmark.c woopsa-client.c ../HostServer/woopsa-host-server.c ../Server/woopsa-server.c
+//   ./ClientBenchmark [-d depth] [-b batch] [-t seconds] [-p port]
+
+#define DEFAULT_DEPTH 16
+#define DEFAULT_BATCH 8
+#define DEFAULT_SECONDS 2
+#define DEFAULT_PORT 8002
+#define VALUE_SIZE 32
+
+float Temperature = 24.2f;
+float Humidity = 61.5f;
+float Pressure = 1013.2f;
+int Altitude = 430;
+int Counter = 0;
+char IsRaining = 1;
+char City[20] = "Geneva";
+float Sensitivity = 0.5f;
+
+WOOPSA_BEGIN(woopsaEntries)
+WOOPSA_PROPERTY_READONLY(Temperature, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY_READONLY(Humidity, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY_READONLY(Pressure, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(Altitude, WOOPSA_TYPE_INTEGER)
+WOOPSA_PROPERTY(Counter, WOOPSA_TYPE_INTEGER)
+WOOPSA_PROPERTY(IsRaining, WOOPSA_TYPE_LOGICAL)
+WOOPSA_PROPERTY(City, WOOPSA_TYPE_TEXT)
+WOOPSA_PROPERTY(Sensitivity, WOOPSA_TYPE_REAL)
+WOOPSA_END;
+
+const char* const names[] = { "Temperature", "Humidity", "Pressure", "Altitude", "Counter", "IsRaining", "City", "Sensitivity" };
+#define NAME_COUNT (int)(sizeof(names) / sizeof(names[0]))
+
+typedef struct {
+	long calls;
+	double totalLatency;
+	double maxLatency;
+	int errors;
+} Results;
+
+WoopsaHost host;
+
+void StopHost(int signalNumber) {
+	host.stop = 1;
+}
+
+double Now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Serves until SIGTERM, after telling the parent through ready whether
+// the server could be opened (0, or the error)
+void RunServer(WoopsaUInt16 port, int ready) {
+	WoopsaServer server;
+	WoopsaHostOptions options;
+	int error = 0;
+	WoopsaHostOptionsInit(&options);
+	options.port = port;
+	WoopsaServerInit(&server, "/woopsa/", woopsaEntries, NULL);
+	if (WoopsaHostOpen(&host, &server, &options) != 0)
+		error = errno != 0 ? errno : EINVAL;
+	signal(SIGTERM, StopHost);
+	if (write(ready, &error, sizeof(error)) != sizeof(error) || error != 0)
+		exit(1);
+	WoopsaHostRun(&host);
+	WoopsaHostClose(&host);
+	exit(0);
+}
+
+void AddCall(Results* results, double start, int failed) {
+	double latency = Now() - start;
+	results->calls++;
+	results->totalLatency += latency;
+	if (latency > results->maxLatency)
+		results->maxLatency = latency;
+	if (failed)
+		results->errors++;
+}
+
+void PrintResults(const char* name, const Results* results, double seconds, int valuesPerCall) {
+	printf("%-22s %12.0f %12.0f %12.3f %12.3f %8d\n", name, results->calls / seconds, results->calls * valuesPerCall / seconds,
+		results->calls > 0 ? results->totalLatency / results->calls * 1000 : 0, results->maxLatency * 1000, results->errors);
+}
+
+void SynchronousReads(WoopsaClient* client, double seconds, Results* results) {
+	char value[VALUE_SIZE];
+	double start, end = Now() + seconds;
+	int i;
+	for (i = 0; (start = Now()) < end; i++)
+		AddCall(results, start, WoopsaClientRead(client, names[i % NAME_COUNT], value, sizeof(value)) == -1);
+}
+
+void SynchronousWrites(WoopsaClient* client, double seconds, Results* results) {
+	char value[VALUE_SIZE];
+	double start, end = Now() + seconds;
+	int i;
+	for (i = 0; (start = Now()) < end; i++) {
+		snprintf(value, sizeof(value), "%d", i);
+		AddCall(results, start, WoopsaClientWrite(client, "Counter", value) != 0);
+	}
+}
+
+// Keeps depth reads in flight with the non-blocking API, the latency
+// being the time each one waited for its response
+void PipelinedReads(WoopsaClient* client, int depth, double seconds, Results* results) {
+	WoopsaClientResponse response;
+	struct pollfd pollSocket;
+	double sentAt[WOOPSA_CLIENT_MAX_REQUESTS];
+	double end = Now() + seconds;
+	int sent = 0, answered = 0, result;
+	while (Now() < end || answered < sent) {
+		while (Now() < end && sent - answered < depth && WoopsaClientRequestRead(client, names[sent % NAME_COUNT]) == 0)
+			sentAt[sent++ % WOOPSA_CLIENT_MAX_REQUESTS] = Now();
+		while ((result = WoopsaClientPoll(client, &response)) == 1)
+			AddCall(results, sentAt[answered++ % WOOPSA_CLIENT_MAX_REQUESTS], response.status != 200);
+		if (result == -1) {
+			results->errors += sent - answered;
+			return;
+		}
+		if (answered == sent)
+			continue;
+		pollSocket.fd = client->socket;
+		pollSocket.events = POLLIN | (WoopsaClientWantsToSend(client) ? POLLOUT : 0);
+		poll(&pollSocket, 1, client->timeoutMs);
+	}
+}
+
+void BatchReads(WoopsaClient* client, int batch, double seconds, Results* results) {
+	const char* batchNames[WOOPSA_CLIENT_MAX_REQUESTS];
+	WoopsaClientValue values[WOOPSA_CLIENT_MAX_REQUESTS];
+	char texts[WOOPSA_CLIENT_MAX_REQUESTS][VALUE_SIZE];
+	double start, end = Now() + seconds;
+	int i;
+	for (i = 0; i < batch; i++) {
+		batchNames[i] = names[i % NAME_COUNT];
+		values[i].text = texts[i];
+		values[i].size = VALUE_SIZE;
+	}
+	while ((start = Now()) < end)
+		AddCall(results, start, WoopsaClientReadBatch(client, batchNames, batch, values) != batch);
+}
+
+void Transactions(WoopsaClient* client, double seconds, Results* results) {
+	const char* const transactionNames[] = { "Altitude", "Counter", "Sensitivity" };
+	const char* transactionValues[] = { "1200", NULL, "0.75" };
+	char value[VALUE_SIZE];
+	double start, end = Now() + seconds;
+	int i;
+	for (i = 0; (start = Now()) < end; i++) {
+		snprintf(value, sizeof(value), "%d", i);
+		transactionValues[1] = value;
+		AddCall(results, start, WoopsaClientWriteBatch(client, transactionNames, transactionValues, 3) != 0);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	int depth = DEFAULT_DEPTH, batch = DEFAULT_BATCH, option, ready[2], error = 0;
+	double seconds = DEFAULT_SECONDS;
+	WoopsaUInt16 port = DEFAULT_PORT;
+	WoopsaClient* client;
+	Results results;
+	pid_t server;
+
+	while ((option = getopt(argc, argv, "d:b:t:p:")) != -1) {
+		switch (option) {
+		case 'd':
+			depth = atoi(optarg);
+			break;
+		case 'b':
+			batch = atoi(optarg);
+			break;
+		case 't':
+			seconds = atof(optarg);
+			break;
+		case 'p':
+			port = (WoopsaUInt16)atoi(optarg);
+			break;
+		default:
+			printf("Usage: %s [-d depth] [-b batch] [-t seconds] [-p port]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (depth < 1 || depth > WOOPSA_CLIENT_MAX_REQUESTS || batch < 1 || batch > WOOPSA_CLIENT_MAX_REQUESTS) {
+		printf("Between 1 and %d requests can be in flight\n", WOOPSA_CLIENT_MAX_REQUESTS);
+		return 1;
+	}
+	client = (WoopsaClient*)malloc(sizeof(WoopsaClient));
+	if (client == NULL || pipe(ready) != 0)
+		return 1;
+
+	fflush(stdout);
+	server = fork();
+	if (server == 0) {
+		close(ready[0]);
+		RunServer(port, ready[1]);
+	}
+	close(ready[1]);
+	if (read(ready[0], &error, sizeof(error)) != sizeof(error))
+		error = EIO;
+	close(ready[0]);
+	if (error != 0 || WoopsaClientOpen(client, "127.0.0.1", port, "/woopsa/") != 0) {
+		printf("Could not reach the server: %s\n", strerror(error != 0 ? error : errno));
+		kill(server, SIGTERM);
+		return 1;
+	}
+
+	printf("%.1f s per test, depth %d, batches of %d reads\n", seconds, depth, batch);
+	printf("%-22s %12s %12s %12s %12s %8s\n", "test", "calls/s", "values/s", "mean ms", "max ms", "errors");
+	memset(&results, 0, sizeof(results));
+	SynchronousReads(client, seconds, &results);
+	PrintResults("synchronous reads", &results, seconds, 1);
+	memset(&results, 0, sizeof(results));
+	SynchronousWrites(client, seconds, &results);
+	PrintResults("synchronous writes", &results, seconds, 1);
+	memset(&results, 0, sizeof(results));
+	PipelinedReads(client, depth, seconds, &results);
+	PrintResults("pipelined reads", &results, seconds, 1);
+	memset(&results, 0, sizeof(results));
+	BatchReads(client, batch, seconds, &results);
+	PrintResults("batch reads", &results, seconds, batch);
+	memset(&results, 0, sizeof(results));
+	Transactions(client, seconds, &results);
+	PrintResults("transactions", &results, seconds, 3);
+
+	WoopsaClientClose(client);
+	free(client);
+	kill(server, SIGTERM);
+	waitpid(server, NULL, 0);
+	return 0;
+}
@@ -0,0 +1,92 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "woopsa-client.h"
+
+// Reads, writes and invokes the entries of the demo server (DemoServer.c
+// or HostDemoServer.c), first one by one, then in batches.
+//   gcc -O2 -I../Server -o ClientDemo ClientDemo.c woopsa-client.c
+//   ./ClientDemo [-h host] [-p port]
+
+#define WOOPSA_HOST "localhost"
+#define WOOPSA_PORT 8000
+#define VALUE_SIZE 64
+
+const char* const TypeNames[] = { "Null", "Logical", "Integer", "Real", "TimeSpan", "DateTime", "Text", "Link", "ResourceUrl" };
+
+const char* const readNames[] = { "Temperature", "IsRaining", "Altitude", "Sensitivity", "City", "TimeSinceLastRain" };
+#define READ_COUNT (sizeof(readNames) / sizeof(readNames[0]))
+
+const char* const writeNames[] = { "Altitude", "City" };
+const char* const writeValues[] = { "1200", "Saint-Moritz" };
+
+int main(int argc, char* argv[]) {
+	WoopsaClient client;
+	WoopsaClientResponse response;
+	WoopsaClientValue values[READ_COUNT];
+	char texts[READ_COUNT][VALUE_SIZE];
+	char value[VALUE_SIZE];
+	const char* host = WOOPSA_HOST;
+	WoopsaUInt16 port = WOOPSA_PORT;
+	int option, type, i;
+
+	while ((option = getopt(argc, argv, "h:p:")) != -1) {
+		switch (option) {
+		case 'h':
+			host = optarg;
+			break;
+		case 'p':
+			port = (WoopsaUInt16)atoi(optarg);
+			break;
+		default:
+			printf("Usage: %s [-h host] [-p port]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (WoopsaClientOpen(&client, host, port, "/woopsa/") != 0) {
+		perror("Error connecting to the server");
+		return 1;
+	}
+
+	// One request at a time
+	if ((type = WoopsaClientRead(&client, "Temperature", value, sizeof(value))) == -1)
+		perror("Error reading Temperature");
+	else
+		printf("Temperature = %s (%s)\n", value, TypeNames[type]);
+	if (WoopsaClientWrite(&client, "Sensitivity", "0.75") != 0)
+		perror("Error writing Sensitivity");
+	if ((type = WoopsaClientInvoke(&client, "GetWeather", NULL, value, sizeof(value))) == -1)
+		perror("Error invoking GetWeather");
+	else
+		printf("GetWeather() = %s\n", value);
+	if (WoopsaClientRead(&client, "Unknown", value, sizeof(value)) == -1 && errno == ENOENT)
+		printf("Unknown is not found\n");
+	if (WoopsaClientMeta(&client, NULL, &response) == 0)
+		printf("Meta: %.*s\n", response.bodyLength, response.body);
+
+	// Both written together, when the server enables transactions
+	if (WoopsaClientWriteBatch(&client, writeNames, writeValues, 2) != 0)
+		perror("Error writing Altitude and City");
+
+	// All read in one round trip
+	for (i = 0; i < (int)READ_COUNT; i++) {
+		values[i].text = texts[i];
+		values[i].size = VALUE_SIZE;
+	}
+	if (WoopsaClientReadBatch(&client, readNames, READ_COUNT, values) == -1) {
+		perror("Error reading the properties");
+	} else {
+		for (i = 0; i < (int)READ_COUNT; i++) {
+			if (values[i].type == -1)
+				printf("%s: error %d\n", readNames[i], values[i].status);
+			else
+				printf("%s = %s (%s)\n", readNames[i], values[i].text, TypeNames[values[i].type]);
+		}
+	}
+
+	WoopsaClientClose(&client);
+	return 0;
+}
@@ -0,0 +1,757 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "woopsa-client.h"
+
+#define DEFAULT_TIMEOUT_MS 5000
+#define NO_SOCKET -1
+
+#define VERB_META "meta"
+#define VERB_READ "read"
+#define VERB_WRITE "write"
+#define VERB_INVOKE "invoke"
+#define POST_VALUE_KEY "value="
+// Names of subobjects and group read patterns are left as they are
+#define PATH_KEPT_CHARACTERS "/*"
+
+#define HTTP_VERSION_STRING " HTTP/1.1\r\nHost: "
+#define HEADER_SEPARATOR "\r\n"
+#define HEADERS_END "\r\n\r\n"
+#define HEADER_FORM_CONTENT "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: "
+// Content lengths are written right-aligned in this many characters
+#define CONTENT_LENGTH_WIDTH 8
+#define HEADER_CONTENT_LENGTH "content-length:"
+#define HEADER_CONNECTION "connection:"
+#define CONNECTION_CLOSE_VALUE "close"
+#define HTTP_STATUS_OFFSET 9
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_BAD_REQUEST 400
+#define HTTP_STATUS_NOT_FOUND 404
+#define HTTP_STATUS_SERVICE_UNAVAILABLE 503
+
+#define JSON_VALUE "\"Value\":"
+#define JSON_TYPE "\"Type\":\""
+#define JSON_APPLIED "\"Applied\":true"
+
+// Indexed by WoopsaType, as the server names them
+static const char* const TypeStrings[] = {
+	"Null",
+	"Logical",
+	"Integer",
+	"Real",
+	"TimeSpan",
+	"DateTime",
+	"Text",
+	"Link",
+	"ResourceUrl"
+};
+
+int StatusToErrno(int status) {
+	switch (status) {
+	case HTTP_STATUS_NOT_FOUND:
+		return ENOENT;
+	case HTTP_STATUS_BAD_REQUEST:
+		return EINVAL;
+	case HTTP_STATUS_SERVICE_UNAVAILABLE:
+		return EAGAIN;
+	default:
+		return EPROTO;
+	}
+}
+
+int MillisecondsSince(const struct timespec* start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int)((now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000);
+}
+
+// Opens a non-blocking socket to the server. Unless wait is set, the
+// connection completes in the background and its errors show up on the
+// first send or receive.
+// Returns 0, or -1 with errno set
+int Connect(WoopsaClient* client, int wait) {
+	int enable = 1, error = 0;
+	socklen_t errorLength = sizeof(error);
+	struct pollfd pollSocket;
+	client->socket = socket(client->address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (client->socket == NO_SOCKET)
+		return -1;
+	// Requests are small and waited for, do not let Nagle delay them
+	setsockopt(client->socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+	if (connect(client->socket, (struct sockaddr*)&client->address, client->addressLength) == 0 || (errno == EINPROGRESS && !wait))
+		return 0;
+	if (errno == EINPROGRESS) {
+		pollSocket.fd = client->socket;
+		pollSocket.events = POLLOUT;
+		if (poll(&pollSocket, 1, client->timeoutMs) == 0)
+			error = ETIMEDOUT;
+		else if (getsockopt(client->socket, SOL_SOCKET, SO_ERROR, &error, &errorLength) != 0)
+			error = errno;
+		if (error == 0)
+			return 0;
+	} else {
+		error = errno;
+	}
+	close(client->socket);
+	client->socket = NO_SOCKET;
+	errno = error;
+	return -1;
+}
+
+// Opens a new connection and sends the requests without a response on it
+// again, except the POSTs sent entirely: the server may have applied
+// them, they are taken out of the send buffer and fail
+void Reconnect(WoopsaClient* client) {
+	int i, request, length, offset = client->sendStart;
+	if (client->socket != NO_SOCKET)
+		close(client->socket);
+	client->socket = NO_SOCKET;
+	for (i = 0; i < client->requestCount; i++) {
+		request = (client->firstRequest + i) % WOOPSA_CLIENT_MAX_REQUESTS;
+		length = client->requestLengths[request];
+		if (client->requestPosts[request] && offset + length <= client->sendOffset) {
+			memmove(client->send + offset, client->send + offset + length, client->sendLength - offset - length);
+			client->sendLength -= length;
+			client->sendOffset -= length;
+			client->requestLengths[request] = 0;
+		} else {
+			offset += length;
+		}
+	}
+	client->sendOffset = client->sendStart;
+	client->receiveStart = 0;
+	client->receiveLength = 0;
+	client->closing = 0;
+	// A failed connection is noticed when sending
+	Connect(client, 0);
+}
+
+// Forgets the requests waiting for their response, and the connection
+// they were sent on
+void DropRequests(WoopsaClient* client) {
+	if (client->socket != NO_SOCKET)
+		close(client->socket);
+	client->socket = NO_SOCKET;
+	client->sendStart = 0;
+	client->sendOffset = 0;
+	client->sendLength = 0;
+	client->firstRequest = 0;
+	client->requestCount = 0;
+	client->receiveStart = 0;
+	client->receiveLength = 0;
+	client->closing = 0;
+	client->reconnects = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Requests                                                                  //
+///////////////////////////////////////////////////////////////////////////////
+
+// The request being queued is written from client->sendLength to *length,
+// and only kept by QueueRequest once it fits
+// Returns 0, or -1 if it does not fit in the send buffer
+int AppendBytes(WoopsaClient* client, int* length, const char* bytes, int bytesLength) {
+	if (*length + bytesLength > WOOPSA_CLIENT_SEND_SIZE)
+		return -1;
+	memcpy(client->send + *length, bytes, bytesLength);
+	*length += bytesLength;
+	return 0;
+}
+
+int AppendString(WoopsaClient* client, int* length, const char* text) {
+	return AppendBytes(client, length, text, (int)strlen(text));
+}
+
+// Appends text with everything but unreserved characters and the
+// characters of kept percent-encoded
+int AppendURLEncoded(WoopsaClient* client, int* length, const char* text, const char* kept) {
+	static const char hexDigits[] = "0123456789ABCDEF";
+	unsigned char c;
+	for (; *text != '\0'; text++) {
+		c = (unsigned char)*text;
+		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' || c == '~' || strchr(kept, c) != NULL) {
+			if (*length >= WOOPSA_CLIENT_SEND_SIZE)
+				return -1;
+			client->send[(*length)++] = (char)c;
+		} else {
+			if (*length + 3 > WOOPSA_CLIENT_SEND_SIZE)
+				return -1;
+			client->send[(*length)++] = '%';
+			client->send[(*length)++] = hexDigits[c >> 4];
+			client->send[(*length)++] = hexDigits[c & 0x0F];
+		}
+	}
+	return 0;
+}
+
+// Appends the request line and headers of a request. A POST gets a blank
+// content length, filled in by QueueRequest.
+// Returns 0, or -1 if it does not fit in the send buffer
+int AppendHeaders(WoopsaClient* client, int* length, int isPost, const char* verb, const char* name, const char* query, int* contentLengthPosition) {
+	if (AppendString(client, length, isPost ? "POST " : "GET ")
+			|| AppendString(client, length, client->pathPrefix)
+			|| AppendString(client, length, verb))
+		return -1;
+	if (name != NULL && (AppendBytes(client, length, "/", 1) || AppendURLEncoded(client, length, name, PATH_KEPT_CHARACTERS)))
+		return -1;
+	if (query != NULL && (AppendBytes(client, length, "?", 1) || AppendString(client, length, query)))
+		return -1;
+	if (AppendString(client, length, HTTP_VERSION_STRING)
+			|| AppendString(client, length, client->host)
+			|| AppendString(client, length, HEADER_SEPARATOR))
+		return -1;
+	if (isPost) {
+		if (AppendString(client, length, HEADER_FORM_CONTENT))
+			return -1;
+		*contentLengthPosition = *length;
+		if (AppendString(client, length, "        " HEADER_SEPARATOR))
+			return -1;
+	}
+	return AppendString(client, length, HEADER_SEPARATOR);
+}
+
+// Appends the name=value pairs of a transaction
+int AppendPairs(WoopsaClient* client, int* length, const char* const names[], const char* const values[], int count) {
+	int i;
+	for (i = 0; i < count; i++) {
+		if ((i > 0 && AppendBytes(client, length, "&", 1))
+				|| AppendURLEncoded(client, length, names[i], "")
+				|| AppendBytes(client, length, "=", 1)
+				|| AppendURLEncoded(client, length, values[i], ""))
+			return -1;
+	}
+	return 0;
+}
+
+// Writes a request after the ones waiting, the content being contentKey
+// followed by content (URLEncoded if encodeContent is set), or count pairs
+// Returns 0, or -1 with errno set to ENOBUFS if it does not fit
+int QueueRequest(WoopsaClient* client, int isPost, const char* verb, const char* name, const char* query, const char* contentKey, const char* content, int encodeContent, const char* const names[], const char* const values[], int count) {
+	char contentLength[CONTENT_LENGTH_WIDTH + 1];
+	int length, contentLengthPosition = 0, contentStart;
+	if (client->requestCount == WOOPSA_CLIENT_MAX_REQUESTS) {
+		errno = ENOBUFS;
+		return -1;
+	}
+	for (;;) {
+		length = client->sendLength;
+		if (AppendHeaders(client, &length, isPost, verb, name, query, &contentLengthPosition) == 0
+				&& (contentKey == NULL || AppendString(client, &length, contentKey) == 0)
+				&& (content == NULL || (encodeContent ? AppendURLEncoded(client, &length, content, "") : AppendString(client, &length, content)) == 0)
+				&& AppendPairs(client, &length, names, values, count) == 0)
+			break;
+		if (client->sendStart == 0) {
+			errno = ENOBUFS;
+			return -1;
+		}
+		// Make room by moving the requests waiting to the start of the buffer
+		memmove(client->send, client->send + client->sendStart, client->sendLength - client->sendStart);
+		client->sendOffset -= client->sendStart;
+		client->sendLength -= client->sendStart;
+		client->sendStart = 0;
+	}
+	if (isPost) {
+		contentStart = contentLengthPosition + CONTENT_LENGTH_WIDTH + 2 * (int)strlen(HEADER_SEPARATOR);
+		snprintf(contentLength, sizeof(contentLength), "%*d", CONTENT_LENGTH_WIDTH, length - contentStart);
+		memcpy(client->send + contentLengthPosition, contentLength, CONTENT_LENGTH_WIDTH);
+	}
+	client->requestLengths[(client->firstRequest + client->requestCount) % WOOPSA_CLIENT_MAX_REQUESTS] = length - client->sendLength;
+	client->requestPosts[(client->firstRequest + client->requestCount) % WOOPSA_CLIENT_MAX_REQUESTS] = (WoopsaUInt8)isPost;
+	client->requestCount++;
+	client->sendLength = length;
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Responses                                                                 //
+///////////////////////////////////////////////////////////////////////////////
+
+// Finds the value of a header in the headers of a response
+// Returns the value, or NULL if the header is not there
+const char* FindHeaderValue(const char* headers, int headersLength, const char* header) {
+	const char* line = headers;
+	const char* end = headers + headersLength;
+	int headerLength = (int)strlen(header);
+	while (line < end) {
+		if (end - line > headerLength && strncasecmp(line, header, headerLength) == 0) {
+			line += headerLength;
+			while (line < end && *line == ' ')
+				line++;
+			return line;
+		}
+		line = memmem(line, end - line, HEADER_SEPARATOR, strlen(HEADER_SEPARATOR));
+		if (line == NULL)
+			return NULL;
+		line += strlen(HEADER_SEPARATOR);
+	}
+	return NULL;
+}
+
+// Parses the response at the start of the received bytes, in place
+// Returns 1 if it was entirely received, 0 if not yet, or -1 with errno
+// set if it is not a valid response
+int ParseResponse(WoopsaClient* client, WoopsaClientResponse* response, int* responseLength) {
+	const char* start = client->receive + client->receiveStart;
+	int available = client->receiveLength - client->receiveStart;
+	const char *headersEnd, *value;
+	int headersLength, contentLength = 0;
+	headersEnd = memmem(start, available, HEADERS_END, strlen(HEADERS_END));
+	if (headersEnd == NULL)
+		return 0;
+	headersLength = (int)(headersEnd - start) + (int)strlen(HEADERS_END);
+	if (headersLength < HTTP_STATUS_OFFSET + 3 || strncmp(start, "HTTP/1.", 7) != 0) {
+		errno = EPROTO;
+		return -1;
+	}
+	value = FindHeaderValue(start, headersLength, HEADER_CONTENT_LENGTH);
+	if (value != NULL)
+		contentLength = atoi(value);
+	if (contentLength < 0 || headersLength + contentLength > WOOPSA_CLIENT_RECEIVE_SIZE) {
+		errno = EMSGSIZE;
+		return -1;
+	}
+	if (headersLength + contentLength > available)
+		return 0;
+	value = FindHeaderValue(start, headersLength, HEADER_CONNECTION);
+	if (value != NULL && strncasecmp(value, CONNECTION_CLOSE_VALUE, strlen(CONNECTION_CLOSE_VALUE)) == 0)
+		client->closing = 1;
+	response->status = atoi(start + HTTP_STATUS_OFFSET);
+	response->body = start + headersLength;
+	response->bodyLength = contentLength;
+	*responseLength = headersLength + contentLength;
+	return 1;
+}
+
+// Sends what the socket takes of the queued requests
+// Returns 0, or -1 with errno set if the connection failed
+int SendRequests(WoopsaClient* client) {
+	ssize_t sent;
+	while (client->sendOffset < client->sendLength) {
+		sent = send(client->socket, client->send + client->sendOffset, client->sendLength - client->sendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (sent < 0)
+			return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+		client->sendOffset += (int)sent;
+	}
+	return 0;
+}
+
+// Receives what arrived, after the bytes waiting to be handed
+// Returns 1 if bytes arrived, 0 if none did, or -1 with errno set if
+// the connection failed or was closed
+int ReceiveResponses(WoopsaClient* client) {
+	ssize_t received;
+	int pending = client->receiveLength - client->receiveStart;
+	// Responses are parsed in place: only move the bytes when the buffer
+	// has no room left
+	if (client->receiveLength == WOOPSA_CLIENT_RECEIVE_SIZE && client->receiveStart > 0) {
+		memmove(client->receive, client->receive + client->receiveStart, pending);
+		client->receiveStart = 0;
+		client->receiveLength = pending;
+	}
+	if (client->receiveLength == WOOPSA_CLIENT_RECEIVE_SIZE) {
+		errno = EMSGSIZE;
+		return -1;
+	}
+	received = recv(client->socket, client->receive + client->receiveLength, WOOPSA_CLIENT_RECEIVE_SIZE - client->receiveLength, MSG_DONTWAIT);
+	if (received < 0)
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+	if (received == 0) {
+		errno = ECONNRESET;
+		return -1;
+	}
+	client->receiveLength += (int)received;
+	return 1;
+}
+
+// Forgets the oldest request, answered or failed
+void TakeRequest(WoopsaClient* client) {
+	client->sendStart += client->requestLengths[client->firstRequest];
+	if (client->sendOffset < client->sendStart)
+		client->sendOffset = client->sendStart;
+	client->firstRequest = (client->firstRequest + 1) % WOOPSA_CLIENT_MAX_REQUESTS;
+	client->requestCount--;
+	if (client->requestCount == 0) {
+		client->sendStart = 0;
+		client->sendOffset = 0;
+		client->sendLength = 0;
+	}
+}
+
+// Takes the response of the oldest request
+void HandResponse(WoopsaClient* client, int responseLength) {
+	client->receiveStart += responseLength;
+	TakeRequest(client);
+	client->reconnects = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Public API implementation                                                 //
+///////////////////////////////////////////////////////////////////////////////
+
+int WoopsaClientOpen(WoopsaClient* client, const char* host, WoopsaUInt16 port, const char* pathPrefix) {
+	struct addrinfo hints, *addresses;
+	char portText[8];
+	int error;
+	memset(client, 0, sizeof(WoopsaClient));
+	client->socket = NO_SOCKET;
+	client->timeoutMs = DEFAULT_TIMEOUT_MS;
+	if (strlen(pathPrefix) >= sizeof(client->pathPrefix)
+			|| snprintf(client->host, sizeof(client->host), port == 80 ? "%s" : "%s:%u", host, (unsigned)port) >= (int)sizeof(client->host)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	strcpy(client->pathPrefix, pathPrefix);
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	snprintf(portText, sizeof(portText), "%u", (unsigned)port);
+	error = getaddrinfo(host, portText, &hints, &addresses);
+	if (error != 0) {
+		errno = error == EAI_SYSTEM ? errno : EHOSTUNREACH;
+		return -1;
+	}
+	memcpy(&client->address, addresses->ai_addr, addresses->ai_addrlen);
+	client->addressLength = addresses->ai_addrlen;
+	freeaddrinfo(addresses);
+	return Connect(client, 1);
+}
+
+void WoopsaClientClose(WoopsaClient* client) {
+	DropRequests(client);
+}
+
+int WoopsaClientRequestRead(WoopsaClient* client, const char* name) {
+	return QueueRequest(client, 0, VERB_READ, name, NULL, NULL, NULL, 0, NULL, NULL, 0);
+}
+
+int WoopsaClientRequestWrite(WoopsaClient* client, const char* name, const char* value) {
+	return QueueRequest(client, 1, VERB_WRITE, name, NULL, POST_VALUE_KEY, value, 1, NULL, NULL, 0);
+}
+
+int WoopsaClientRequestInvoke(WoopsaClient* client, const char* name, const char* arguments) {
+	return QueueRequest(client, 1, VERB_INVOKE, name, NULL, NULL, arguments, 0, NULL, NULL, 0);
+}
+
+int WoopsaClientRequestMeta(WoopsaClient* client, const char* query) {
+	return QueueRequest(client, 0, VERB_META, NULL, query, NULL, NULL, 0, NULL, NULL, 0);
+}
+
+int WoopsaClientRequestTransaction(WoopsaClient* client, const char* const names[], const char* const values[], int count) {
+	return QueueRequest(client, 1, VERB_WRITE, NULL, NULL, NULL, NULL, 0, names, values, count);
+}
+
+int WoopsaClientPoll(WoopsaClient* client, WoopsaClientResponse* response) {
+	int responseLength, result;
+	if (client->requestCount == 0)
+		return 0;
+	// The server closes the connection after its last response, the
+	// reads sent after it are sent again
+	if (client->socket == NO_SOCKET || (client->closing && client->receiveStart == client->receiveLength))
+		Reconnect(client);
+	for (;;) {
+		if (client->requestLengths[client->firstRequest] == 0) {
+			// A POST lost with its connection, the next ones still wait
+			TakeRequest(client);
+			errno = ECONNRESET;
+			return -1;
+		}
+		result = ParseResponse(client, response, &responseLength);
+		if (result == 1) {
+			HandResponse(client, responseLength);
+			return 1;
+		}
+		if (result == 0 && !client->closing) {
+			if (SendRequests(client) == 0 && (result = ReceiveResponses(client)) >= 0) {
+				if (result == 0)
+					return 0;
+				continue;
+			}
+		}
+		// The connection failed or was closed: try again once on a new one
+		if (result == -1 && errno != ECONNRESET && errno != EPIPE && errno != ECONNREFUSED)
+			break;
+		if (client->reconnects > 0) {
+			if (result != -1)
+				errno = ECONNRESET;
+			break;
+		}
+		client->reconnects++;
+		Reconnect(client);
+	}
+	result = errno;
+	DropRequests(client);
+	errno = result;
+	return -1;
+}
+
+int WoopsaClientPending(const WoopsaClient* client) {
+	return client->requestCount;
+}
+
+int WoopsaClientWantsToSend(const WoopsaClient* client) {
+	return client->socket != NO_SOCKET && client->sendOffset < client->sendLength;
+}
+
+int WoopsaClientParseValue(const WoopsaClientResponse* response, WoopsaChar8* value, int valueSize) {
+	const char* at = memmem(response->body, response->bodyLength, JSON_VALUE, strlen(JSON_VALUE));
+	const char* end = response->body + response->bodyLength;
+	unsigned int codePoint;
+	int length = 0, type;
+	if (at == NULL) {
+		errno = EPROTO;
+		return -1;
+	}
+	at += strlen(JSON_VALUE);
+	if (at < end && *at == '"') {
+		// A JSON string, unescaped into value
+		for (at++; at < end && *at != '"'; at++) {
+			if (length + 4 >= valueSize) {
+				errno = ENOBUFS;
+				return -1;
+			}
+			if (*at != '\\' || at + 1 >= end) {
+				value[length++] = *at;
+				continue;
+			}
+			switch (*++at) {
+			case 'b': value[length++] = '\b'; break;
+			case 'f': value[length++] = '\f'; break;
+			case 'n': value[length++] = '\n'; break;
+			case 'r': value[length++] = '\r'; break;
+			case 't': value[length++] = '\t'; break;
+			case 'u':
+				if (at + 4 >= end || sscanf(at + 1, "%4x", &codePoint) != 1) {
+					errno = EPROTO;
+					return -1;
+				}
+				at += 4;
+				// Encoded in UTF-8, surrogate pairs are kept as they are
+				if (codePoint < 0x80) {
+					value[length++] = (char)codePoint;
+				} else if (codePoint < 0x800) {
+					value[length++] = (char)(0xC0 | (codePoint >> 6));
+					value[length++] = (char)(0x80 | (codePoint & 0x3F));
+				} else {
+					value[length++] = (char)(0xE0 | (codePoint >> 12));
+					value[length++] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					value[length++] = (char)(0x80 | (codePoint & 0x3F));
+				}
+				break;
+			case '"':
+			case '\\':
+			case '/':
+				value[length++] = *at;
+				break;
+			default:
+				// Not a JSON escape: the server only escapes quotes, keep it
+				value[length++] = '\\';
+				value[length++] = *at;
+				break;
+			}
+		}
+		at++;
+	} else {
+		// A number, true, false or null
+		for (; at < end && *at != ',' && *at != '}'; at++) {
+			if (length + 1 >= valueSize) {
+				errno = ENOBUFS;
+				return -1;
+			}
+			value[length++] = *at;
+		}
+	}
+	value[length] = '\0';
+	if (at >= end || (at = memmem(at, end - at, JSON_TYPE, strlen(JSON_TYPE))) == NULL) {
+		errno = EPROTO;
+		return -1;
+	}
+	at += strlen(JSON_TYPE);
+	end = memchr(at, '"', end - at);
+	if (end == NULL || (type = WoopsaClientParseType(at, (int)(end - at))) == -1) {
+		errno = EPROTO;
+		return -1;
+	}
+	return type;
+}
+
+int WoopsaClientParseType(const WoopsaChar8* name, int nameLength) {
+	int type;
+	for (type = 0; type < (int)(sizeof(TypeStrings) / sizeof(TypeStrings[0])); type++)
+		if ((int)strlen(TypeStrings[type]) == nameLength && strncmp(name, TypeStrings[type], nameLength) == 0)
+			return type;
+	return -1;
+}
+
+int WoopsaClientParseGroup(const WoopsaClientResponse* response, int* offset, WoopsaChar8* name, int nameSize, WoopsaChar8* value, int valueSize) {
+	const char* at = response->body + *offset;
+	const char* end = response->body + response->bodyLength;
+	const char* nameEnd;
+	WoopsaClientResponse member;
+	int inString = 0;
+	if (at < end && (*at == '{' || *at == ','))
+		at++;
+	if (at >= end || *at != '"') {
+		errno = at < end && *at == '}' ? ENOENT : EPROTO;
+		return -1;
+	}
+	at++;
+	nameEnd = memchr(at, '"', end - at);
+	if (nameEnd == NULL || nameEnd + 2 >= end || nameEnd[1] != ':' || nameEnd[2] != '{') {
+		errno = EPROTO;
+		return -1;
+	}
+	if (nameEnd - at >= nameSize) {
+		errno = ENOBUFS;
+		return -1;
+	}
+	memcpy(name, at, nameEnd - at);
+	name[nameEnd - at] = '\0';
+	// The member is the object of the value, up to its closing brace
+	member.status = response->status;
+	member.body = nameEnd + 2;
+	for (at = member.body; at < end && (inString || *at != '}'); at++) {
+		if (inString && *at == '\\')
+			at++;
+		else if (*at == '"')
+			inString = !inString;
+	}
+	if (at >= end) {
+		errno = EPROTO;
+		return -1;
+	}
+	member.bodyLength = (int)(at + 1 - member.body);
+	*offset = (int)(at + 1 - response->body);
+	return WoopsaClientParseValue(&member, value, valueSize);
+}
+
+int WoopsaClientWait(WoopsaClient* client, WoopsaClientResponse* response) {
+	struct timespec start;
+	struct pollfd pollSocket;
+	int result, remaining;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (;;) {
+		result = WoopsaClientPoll(client, response);
+		if (result != 0)
+			return result == 1 ? 0 : -1;
+		if (client->requestCount == 0) {
+			errno = EINVAL;
+			return -1;
+		}
+		remaining = client->timeoutMs - MillisecondsSince(&start);
+		pollSocket.fd = client->socket;
+		pollSocket.events = POLLIN | (WoopsaClientWantsToSend(client) ? POLLOUT : 0);
+		if (remaining <= 0 || (poll(&pollSocket, 1, remaining) < 0 && errno != EINTR))
+			break;
+	}
+	// The response would come as the one of the next request
+	result = remaining <= 0 ? ETIMEDOUT : errno;
+	DropRequests(client);
+	errno = result;
+	return -1;
+}
+
+// Waits for the response of the only request waiting
+// Returns 0 if its status is 200 OK, or -1 with errno set
+int WaitForOk(WoopsaClient* client, WoopsaClientResponse* response) {
+	if (WoopsaClientWait(client, response) != 0)
+		return -1;
+	if (response->status != HTTP_STATUS_OK) {
+		errno = StatusToErrno(response->status);
+		return -1;
+	}
+	return 0;
+}
+
+int WoopsaClientRead(WoopsaClient* client, const char* name, WoopsaChar8* value, int valueSize) {
+	WoopsaClientResponse response;
+	if (client->requestCount > 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (WoopsaClientRequestRead(client, name) != 0 || WaitForOk(client, &response) != 0)
+		return -1;
+	return WoopsaClientParseValue(&response, value, valueSize);
+}
+
+int WoopsaClientWrite(WoopsaClient* client, const char* name, const char* value) {
+	WoopsaClientResponse response;
+	if (client->requestCount > 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (WoopsaClientRequestWrite(client, name, value) != 0)
+		return -1;
+	return WaitForOk(client, &response);
+}
+
+int WoopsaClientInvoke(WoopsaClient* client, const char* name, const char* arguments, WoopsaChar8* value, int valueSize) {
+	WoopsaClientResponse response;
+	if (client->requestCount > 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (WoopsaClientRequestInvoke(client, name, arguments) != 0 || WaitForOk(client, &response) != 0)
+		return -1;
+	return WoopsaClientParseValue(&response, value, valueSize);
+}
+
+int WoopsaClientMeta(WoopsaClient* client, const char* query, WoopsaClientResponse* response) {
+	if (client->requestCount > 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (WoopsaClientRequestMeta(client, query) != 0)
+		return -1;
+	return WaitForOk(client, response);
+}
+
+int WoopsaClientReadBatch(WoopsaClient* client, const char* const names[], int count, WoopsaClientValue values[]) {
+	WoopsaClientResponse response;
+	int queued = 0, answered = 0, read = 0;
+	if (client->requestCount > 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	while (answered < count) {
+		// Keep as many requests in flight as the send buffer takes
+		while (queued < count && WoopsaClientRequestRead(client, names[queued]) == 0)
+			queued++;
+		if (queued == answered)
+			return -1;
+		if (WoopsaClientWait(client, &response) != 0)
+			return -1;
+		values[answered].status = response.status;
+		values[answered].type = -1;
+		if (response.status == HTTP_STATUS_OK)
+			values[answered].type = WoopsaClientParseValue(&response, values[answered].text, values[answered].size);
+		if (values[answered].type != -1)
+			read++;
+		answered++;
+	}
+	return read;
+}
+
+int WoopsaClientWriteBatch(WoopsaClient* client, const char* const names[], const char* const values[], int count) {
+	WoopsaClientResponse response;
+	if (client->requestCount > 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (WoopsaClientRequestTransaction(client, names, values, count) != 0 || WaitForOk(client, &response) != 0)
+		return -1;
+	if (memmem(response.body, response.bodyLength, JSON_APPLIED, strlen(JSON_APPLIED)) == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
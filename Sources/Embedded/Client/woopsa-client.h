@@ -0,0 +1,179 @@
+#ifndef __WOOPSA_CLIENT_H_
+#define __WOOPSA_CLIENT_H_
+
+// Woopsa client for Linux hosts (gateways, controllers) reading and
+// writing the properties of peers running the embedded server. Requests
+// go over one persistent connection and can be pipelined: the
+// non-blocking API queues them and hands the responses back in order,
+// the synchronous API is built on top of it. Responses are parsed where
+// they were received, values are decoded straight into the caller's
+// buffers. Build it along the embedded server's header, for example:
+//   gcc -O2 -I../Server ClientDemo.c woopsa-client.c
+
+#include <sys/socket.h>
+#include "woopsa-server.h"
+
+// Requests waiting for their response, and their bytes. A request is
+// kept until its response arrives, to send it again on a new connection
+// if the server closed the previous one. Writes, invokes and transactions
+// are not sent again once sent: they fail instead.
+#ifndef WOOPSA_CLIENT_SEND_SIZE
+#define WOOPSA_CLIENT_SEND_SIZE 8192
+#endif
+#ifndef WOOPSA_CLIENT_MAX_REQUESTS
+#define WOOPSA_CLIENT_MAX_REQUESTS 128
+#endif
+// Received bytes, it must hold the largest response (meta for instance)
+#ifndef WOOPSA_CLIENT_RECEIVE_SIZE
+#define WOOPSA_CLIENT_RECEIVE_SIZE 16384
+#endif
+#define WOOPSA_CLIENT_HOST_SIZE 64
+#define WOOPSA_CLIENT_PREFIX_SIZE 32
+
+typedef struct {
+	// HTTP status code, 200 on success
+	int status;
+	// The content of the response, in the receive buffer of the client.
+	// It is not NUL-terminated, and only valid until the next call.
+	const WoopsaChar8* body;
+	int bodyLength;
+} WoopsaClientResponse;
+
+// A value of a batch read, decoded into text
+typedef struct {
+	WoopsaChar8* text;
+	int size;
+	// WOOPSA_TYPE_ of the value, or -1 if it was not read
+	int type;
+	// HTTP status code of its response
+	int status;
+} WoopsaClientValue;
+
+typedef struct {
+	// -1 while not connected
+	int socket;
+	struct sockaddr_storage address;
+	socklen_t addressLength;
+	WoopsaChar8 host[WOOPSA_CLIENT_HOST_SIZE];
+	WoopsaChar8 pathPrefix[WOOPSA_CLIENT_PREFIX_SIZE];
+	// How long synchronous calls wait for a response, 5 s by default
+	int timeoutMs;
+	// Requests from sendStart on wait for their response, those before
+	// sendOffset are sent
+	WoopsaChar8 send[WOOPSA_CLIENT_SEND_SIZE];
+	int sendStart;
+	int sendOffset;
+	int sendLength;
+	// Lengths of the requests waiting for their response, oldest first,
+	// 0 for the POSTs lost with their connection, and whether they are POSTs
+	int requestLengths[WOOPSA_CLIENT_MAX_REQUESTS];
+	WoopsaUInt8 requestPosts[WOOPSA_CLIENT_MAX_REQUESTS];
+	int firstRequest;
+	int requestCount;
+	// Received bytes: the response returned by the last call ends at
+	// receiveStart, the next ones follow up to receiveLength
+	WoopsaChar8 receive[WOOPSA_CLIENT_RECEIVE_SIZE];
+	int receiveStart;
+	int receiveLength;
+	// The server closes the connection after the last response
+	WoopsaUInt8 closing;
+	// Connections opened since the last response
+	WoopsaUInt8 reconnects;
+} WoopsaClient;
+
+// Connects to a server, for example host "192.168.1.10", port 80 and
+// prefix "/woopsa/". The connection is kept open and opened again when
+// the server closes it.
+// Returns 0, or -1 with errno set
+int WoopsaClientOpen(WoopsaClient* client, const char* host, WoopsaUInt16 port, const char* pathPrefix);
+
+// Closes the connection, requests waiting for their response are dropped
+void WoopsaClientClose(WoopsaClient* client);
+
+///////////////////////////////////////////////////////////////////////////////
+// Non-blocking API                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+// Queue a request, which is sent by the next call to WoopsaClientPoll.
+// Names and values are URLEncoded by the client, query and arguments
+// (name=value pairs) must already be. Read names can be patterns.
+// Return 0, or -1 with errno set to ENOBUFS if too many requests wait
+int WoopsaClientRequestRead(WoopsaClient* client, const char* name);
+int WoopsaClientRequestWrite(WoopsaClient* client, const char* name, const char* value);
+int WoopsaClientRequestInvoke(WoopsaClient* client, const char* name, const char* arguments);
+// query such as "prefix=Digital&limit=10" for a paged meta, or NULL
+int WoopsaClientRequestMeta(WoopsaClient* client, const char* query);
+// Writes the properties together, the server must enable transactions
+int WoopsaClientRequestTransaction(WoopsaClient* client, const char* const names[], const char* const values[], int count);
+
+// Sends the queued requests and receives what arrived, without waiting.
+// Responses come in the order of the requests. When the server closes
+// the connection, the reads and metas without a response are sent once
+// more on a new one. The writes, invokes and transactions that were sent
+// may have been applied: they are not sent again and fail in their turn,
+// with ECONNRESET, the requests after them still waiting.
+// Returns 1 with the next response, 0 if it did not arrive yet, or -1
+// with errno set (the requests waiting are dropped then, except after a
+// POST that failed alone: WoopsaClientPending tells)
+int WoopsaClientPoll(WoopsaClient* client, WoopsaClientResponse* response);
+
+// Returns the number of requests waiting for their response
+int WoopsaClientPending(const WoopsaClient* client);
+
+// Returns 1 if queued bytes could not be sent yet: poll the socket
+// for POLLOUT as well as POLLIN then
+int WoopsaClientWantsToSend(const WoopsaClient* client);
+
+// Decodes the value of a read or invoke response into value
+// Returns its WOOPSA_TYPE_, or -1 with errno set to ENOBUFS if value
+// is too small, or to EPROTO if the response holds no value
+int WoopsaClientParseValue(const WoopsaClientResponse* response, WoopsaChar8* value, int valueSize);
+
+// Returns the WOOPSA_TYPE_ of a type name of the meta (Real for instance),
+// or -1 if it is unknown
+int WoopsaClientParseType(const WoopsaChar8* name, int nameLength);
+
+// Decodes the next value of a group read response (read/Digital* for
+// instance) into name and value, from *offset in the content, which
+// starts at 0 and is moved past the value
+// Returns its WOOPSA_TYPE_, or -1 with errno set to ENOENT after the last
+// value, or as WoopsaClientParseValue
+int WoopsaClientParseGroup(const WoopsaClientResponse* response, int* offset, WoopsaChar8* name, int nameSize, WoopsaChar8* value, int valueSize);
+
+///////////////////////////////////////////////////////////////////////////////
+// Synchronous API                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// They wait for the response of their own request, none of the
+// non-blocking API may be waiting (errno is EBUSY otherwise). Error
+// responses set errno: ENOENT for 404, EINVAL for 400, EAGAIN for 503.
+
+// Waits at most client->timeoutMs for the next response
+// Returns 0, or -1 with errno set (ETIMEDOUT when it did not arrive)
+int WoopsaClientWait(WoopsaClient* client, WoopsaClientResponse* response);
+
+// Returns the WOOPSA_TYPE_ of the value read, or -1 with errno set
+int WoopsaClientRead(WoopsaClient* client, const char* name, WoopsaChar8* value, int valueSize);
+
+// Returns 0, or -1 with errno set
+int WoopsaClientWrite(WoopsaClient* client, const char* name, const char* value);
+
+// Returns the WOOPSA_TYPE_ of the value returned, or -1 with errno set
+int WoopsaClientInvoke(WoopsaClient* client, const char* name, const char* arguments, WoopsaChar8* value, int valueSize);
+
+// The JSON meta document is left in response
+// Returns 0, or -1 with errno set
+int WoopsaClientMeta(WoopsaClient* client, const char* query, WoopsaClientResponse* response);
+
+// Reads count properties with pipelined requests, in one round trip
+// when they fit in the send buffer
+// Returns the number of values read, or -1 with errno set if the
+// connection failed
+int WoopsaClientReadBatch(WoopsaClient* client, const char* const names[], int count, WoopsaClientValue values[]);
+
+// Writes count properties as one transaction
+// Returns 0 once they were all written, or -1 with errno set (EINVAL
+// if the server rejected one of them, none was written then)
+int WoopsaClientWriteBatch(WoopsaClient* client, const char* const names[], const char* const values[], int count);
+
+#endif
@@ -6,25 +6,31 @@
 /* See http://stackoverflow.com/questions/12765743/getaddrinfo-on-win32 */
 #ifndef _WIN32_WINNT
 #define _WIN32_WINNT 0x0501  /* Windows XP. */
-#define CHECK_SOCKET(socket) \
-	(!(socket == INVALID_SOCKET))
-#define EXIT_ERROR() \
-	exit(WSAGetLastError())
 #endif
 #include <winsock2.h>
 #include <Ws2tcpip.h>
+#define CHECK_SOCKET(socket) \
+	(!(socket == INVALID_SOCKET))
+#define SOCKET_ERROR_CODE() \
+	WSAGetLastError()
+typedef int socklen_t;
 #else
 /* Assume that any non-Windows platform uses POSIX-style sockets instead. */
 #include <errno.h>
 #include <sys/socket.h>
+#include <sys/select.h>
 #include <arpa/inet.h>
 #include <netdb.h>  /* Needed for getaddrinfo() and freeaddrinfo() */
 #include <unistd.h> /* Needed for close() */
+typedef int SOCKET;
+#define SOCKET_ERROR -1
 #define CHECK_SOCKET(socket) \
 	(!(socket < 0))
-#define EXIT_ERROR() \
-	exit(errno)
+#define SOCKET_ERROR_CODE() \
+	errno
 #endif
+#define EXIT_ERROR() \
+	exit(SOCKET_ERROR_CODE())
 
 int sockInit(void) {
 #ifdef _WIN32
@@ -57,6 +63,10 @@ int sockClose(SOCKET sock) {
 	return status;
 }
 
+// The demo builds with the default woopsa-config.h. The features it shows
+// besides are enabled on the command line, for instance:
+//   gcc -I../Server -DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_ACCESSORS -DWOOPSA_ENABLE_STRUCT_TABLES -DWOOPSA_ENABLE_MOUNTS -o DemoServer DemoServer.c ../Server/woopsa-server.c
+
 float Temperature = 24.2f;
 char IsRaining = 1;
 int Altitude = 430;
@@ -64,6 +74,30 @@ float Sensitivity = 0.5f;
 char City[20] = "Geneva";
 float TimeSinceLastRain = 11;
 
+#ifdef WOOPSA_ENABLE_ACCESSORS
+// Computed property: the getter only runs when a client reads it,
+// and at most once per second
+float TemperatureFahrenheit;
+void GetTemperatureFahrenheit(void* value) {
+	*(float*)value = Temperature * 9.0f / 5.0f + 32.0f;
+}
+WOOPSA_ACCESSOR(TemperatureFahrenheit, GetTemperatureFahrenheit, NULL, 1000)
+#endif
+
+
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+// Process data kept in a struct: the field list declares the struct and
+// its entries. The same entries would serve any other Station.
+#define STATION_FIELDS(X) \
+	X(float, WindSpeed, , WOOPSA_TYPE_REAL) \
+	X(int, WindDirection, , WOOPSA_TYPE_INTEGER)
+#define STATION_MEMBER(ctype, field, array, type) ctype field array;
+#define STATION_ENTRY(ctype, field, array, type) WOOPSA_FIELD(Station, field, type)
+typedef struct { STATION_FIELDS(STATION_MEMBER) } Station;
+Station station = { 12.5f, 270 };
+// Copy of the station read by clients, refreshed between requests
+Station stationSnapshot;
+#endif
 
 char weatherBuffer[20];
 char* GetWeather() {
@@ -78,29 +112,179 @@ WOOPSA_PROPERTY(Altitude, WOOPSA_TYPE_INTEGER)
 WOOPSA_PROPERTY(Sensitivity, WOOPSA_TYPE_REAL)
 WOOPSA_PROPERTY(City, WOOPSA_TYPE_TEXT)
 WOOPSA_PROPERTY(TimeSinceLastRain, WOOPSA_TYPE_TIME_SPAN)
+#ifdef WOOPSA_ENABLE_ACCESSORS
+WOOPSA_PROPERTY_COMPUTED_READONLY(TemperatureFahrenheit, WOOPSA_TYPE_REAL)
+#endif
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+STATION_FIELDS(STATION_ENTRY)
+#endif
 WOOPSA_METHOD(GetWeather, WOOPSA_TYPE_TEXT)
 WOOPSA_END;
 
+#ifdef WOOPSA_ENABLE_MOUNTS
+// Diagnostics have a table and server of their own, mounted under
+// /woopsa/diagnostics/ on the same port
+int ClientCount = 0;
+
+WOOPSA_BEGIN(diagnosticEntries)
+WOOPSA_PROPERTY_READONLY(ClientCount, WOOPSA_TYPE_INTEGER)
+WOOPSA_END;
+#endif
+
 #define WOOPSA_PORT 8000
 #define BUFFER_SIZE 1024
+// How long to wait for requests before the event streams are polled
+#define POLL_INTERVAL_MS 100
 
 
 WoopsaBufferSize ServeHTML(WoopsaChar8 path[], WoopsaUInt8 isPost, WoopsaChar8 dataBuffer[], WoopsaBufferSize dataBufferSize) {
 	strcpy(dataBuffer, "Hello world!");
-	return (WoopsaBufferSize)strlen("Hellow world!");
+	return (WoopsaBufferSize)strlen(dataBuffer);
 }
 
+#ifdef WOOPSA_ENABLE_CONNECTIONS
+// Sends everything the connection has to send
+// Returns 0, or SOCKET_ERROR if the client went away
+int SendOutput(SOCKET clientSock, WoopsaConnection* connection) {
+	const WoopsaChar8* output;
+	WoopsaBufferSize length;
+	int sentBytes;
+	int working = 1;
+	while (working) {
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+		// Nothing else runs here, the connection works until it is idle
+		working = WoopsaConnectionStep(connection) != 0;
+#else
+		working = 0;
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		// The properties are only used by this thread, written values can
+		// be stored right away
+		WoopsaApplyPendingWrites(connection->server);
+#endif
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+		WoopsaServerTakeSnapshot(connection->server);
+#endif
+		while ((length = WoopsaConnectionPollOutput(connection, &output)) > 0) {
+			sentBytes = send(clientSock, output, (int)length, 0);
+			if (sentBytes == SOCKET_ERROR)
+				return SOCKET_ERROR;
+			WoopsaConnectionConsumed(connection, sentBytes);
+			working = 1;
+		}
+	}
+	return 0;
+}
+
+// Serves one client until either side closes the connection
+void ServeClient(SOCKET clientSock, WoopsaServer* server) {
+	WoopsaConnection connection;
+	WoopsaChar8* input;
+	WoopsaBufferSize space;
+	fd_set readSet;
+	struct timeval timeout;
+	int readBytes;
+
+	WoopsaConnectionInit(&connection, server);
+	while (SendOutput(clientSock, &connection) == 0 && !WoopsaConnectionIsClosed(&connection)) {
+		// Wait a little for requests, then poll the event streams
+		FD_ZERO(&readSet);
+		FD_SET(clientSock, &readSet);
+		timeout.tv_sec = 0;
+		timeout.tv_usec = POLL_INTERVAL_MS * 1000;
+		if (select((int)clientSock + 1, &readSet, NULL, NULL, &timeout) <= 0) {
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+			// A client holding the only connection without finishing its
+			// request gets a 408, a silent one is closed
+			WoopsaServerExpireConnections(server);
+#endif
+			continue;
+		}
+
+		// Receive directly in the connection, which keeps partial requests
+		// until they are complete
+		input = WoopsaConnectionInput(&connection, &space);
+		if (space == 0)
+			continue;
+		readBytes = recv(clientSock, input, (int)space, 0);
+
+		if (readBytes == SOCKET_ERROR) {
+			printf("Error %d\n", SOCKET_ERROR_CODE());
+			break;
+		}
+
+		if (readBytes == 0) {
+			printf("Finished\n");
+			break;
+		}
+
+		WoopsaConnectionReceived(&connection, readBytes);
+	}
+	WoopsaConnectionClose(&connection);
+	sockClose(clientSock);
+}
+#else
+// Serves one client until either side closes the connection. Without
+// WOOPSA_ENABLE_CONNECTIONS, the request is gathered in a buffer until
+// it is complete, then handled at once.
+void ServeClient(SOCKET clientSock, WoopsaServer* server) {
+	char buffer[BUFFER_SIZE];
+	char response[BUFFER_SIZE];
+	int receivedBytes = 0, readBytes;
+	WoopsaBufferSize responseLength;
+
+	while (1) {
+		readBytes = recv(clientSock, buffer + receivedBytes, sizeof(buffer) - 1 - receivedBytes, 0);
+
+		if (readBytes == SOCKET_ERROR) {
+			printf("Error %d\n", SOCKET_ERROR_CODE());
+			break;
+		}
+
+		if (readBytes == 0) {
+			printf("Finished\n");
+			break;
+		}
+
+		receivedBytes += readBytes;
+		buffer[receivedBytes] = '\0';
+		if (WoopsaCheckRequestComplete(server, buffer, (WoopsaUInt16)receivedBytes) != WOOPSA_REQUEST_COMLETE) {
+			// If the request is not complete, more data needs to be
+			// added to the buffer, as long as there is room for it
+			if (receivedBytes == sizeof(buffer) - 1)
+				break;
+			continue;
+		}
+
+		responseLength = 0;
+		WoopsaHandleRequest(server, buffer, receivedBytes, response, sizeof(response), &responseLength);
+		if (responseLength > 0) {
+			send(clientSock, response, (int)responseLength, 0);
+		}
+		receivedBytes = 0;
+	}
+	sockClose(clientSock);
+}
+#endif
+
 int main(int argc, char * argv[]) {
 	SOCKET sock, clientSock;
 	struct sockaddr_in addr;
 	struct sockaddr clientAddr;
-	char buffer[BUFFER_SIZE];
-	int clientAddrSize = 0, readBytes = 0;
+	socklen_t clientAddrSize = 0;
 	WoopsaServer server;
-	WoopsaBufferSize responseLength;
+#ifdef WOOPSA_ENABLE_MOUNTS
+	WoopsaServer diagnostics;
+#endif
 
-	memset(buffer, 0, sizeof(buffer));
 	WoopsaServerInit(&server, "/woopsa/", woopsaEntries, ServeHTML);
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	WoopsaServerSetInstance(&server, &station, &stationSnapshot, sizeof(Station));
+#endif
+#ifdef WOOPSA_ENABLE_MOUNTS
+	WoopsaServerInit(&diagnostics, "/woopsa/diagnostics/", diagnosticEntries, NULL);
+	WoopsaServerMount(&server, &diagnostics);
+#endif
 
 	printf("Woopsa C library v0.1 demo server.\n");
 
@@ -135,31 +319,10 @@ int main(int argc, char * argv[]) {
 			EXIT_ERROR();
 		}
 
-		while (1) {
-			readBytes = recv(clientSock, buffer + readBytes, sizeof(buffer), 0);
-
-			if (readBytes == SOCKET_ERROR) {
-				printf("Error %d", WSAGetLastError());
-				break;
-			}
-
-			if (readBytes == 0) {
-				printf("Finished\n");
-				break;
-			}
-
-			if (WoopsaCheckRequestComplete(&server, buffer, sizeof(buffer)) != WOOPSA_REQUEST_COMLETE) {
-				// If the request is not complete, it means more data needs 
-				// to be -added- to the buffer
-				continue;
-			}
-
-			if (WoopsaHandleRequest(&server, buffer, sizeof(buffer), buffer, sizeof(buffer), &responseLength) >= WOOPSA_SUCCESS) {
-				send(clientSock, buffer, responseLength, 0);
-			}
-			readBytes = 0;
-			memset(buffer, 0, sizeof(buffer));
-		}
+#ifdef WOOPSA_ENABLE_MOUNTS
+		ClientCount++;
+#endif
+		ServeClient(clientSock, &server);
 	}
 
 	if (sockClose(sock) != 0) {
@@ -175,4 +338,4 @@ int main(int argc, char * argv[]) {
 	getchar();
 
 	return 0;
-}
\ No newline at end of file
+}
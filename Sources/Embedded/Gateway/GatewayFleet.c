@@ -0,0 +1,145 @@
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "woopsa-host-server.h"
+
+// A fleet of simulated devices to try the gateway with, one process per
+// device, each serving on its own port of the loopback. It prints the
+// configuration of GatewayServer on its output, and stops its devices on
+// SIGINT or SIGTERM. RequestCount tells how many requests a device got.
+//   FLAGS="-DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_TIME_SLICING -DWOOPSA_ENABLE_GROUP_READS"
+//   gcc -O2 -I../Server -I../HostServer $FLAGS -o GatewayFleet GatewayFleet.c ../HostServer/woopsa-host-server.c ../Server/woopsa-server.c -lm
+//   ./GatewayFleet [-n devices] [-p firstPort] > fleet.conf
+
+#define DEFAULT_DEVICES 80
+#define MAX_DEVICES 256
+#define DEFAULT_FIRST_PORT 9000
+// A device has few sockets, like an MCU
+#define DEVICE_MAX_CONNECTIONS 4
+#define DEVICE_POLL_INTERVAL_MS 100
+
+float Temperature = 20.0f;
+float Pressure = 1013.2f;
+char Running = 1;
+float Setpoint = 21.5f;
+char Mode[16] = "Auto";
+int Counter = 0;
+int RequestCount = 0;
+
+WOOPSA_BEGIN(woopsaEntries)
+WOOPSA_PROPERTY_READONLY(Temperature, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY_READONLY(Pressure, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(Running, WOOPSA_TYPE_LOGICAL)
+WOOPSA_PROPERTY(Setpoint, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(Mode, WOOPSA_TYPE_TEXT)
+WOOPSA_PROPERTY_READONLY(Counter, WOOPSA_TYPE_INTEGER)
+WOOPSA_PROPERTY_READONLY(RequestCount, WOOPSA_TYPE_INTEGER)
+WOOPSA_END;
+
+WoopsaHost host;
+pid_t devices[MAX_DEVICES];
+int deviceCount = 0;
+int deviceIndex;
+
+void StopDevice(int signalNumber) {
+	host.stop = 1;
+}
+
+void StopFleet(int signalNumber) {
+	int i;
+	for (i = 0; i < deviceCount; i++)
+		kill(devices[i], SIGTERM);
+}
+
+void CountRequests(WoopsaUInt8 step, WoopsaUInt32 microseconds) {
+	if (step == WOOPSA_STEP_REQUEST)
+		RequestCount++;
+}
+
+// The temperature follows the setpoint while running, with some noise
+// that differs from one device to the other
+void Simulate(void) {
+	struct timespec now;
+	double seconds;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	seconds = now.tv_sec + now.tv_nsec / 1e9;
+	if (Running)
+		Temperature += (Setpoint - Temperature) * 0.01f;
+	else
+		Temperature += (15.0f - Temperature) * 0.01f;
+	Temperature += 0.05f * (float)sin(seconds + deviceIndex);
+	Pressure = 1013.2f + 2.0f * (float)sin(seconds / 60 + deviceIndex);
+	if (Running)
+		Counter++;
+}
+
+void RunDevice(WoopsaUInt16 port) {
+	WoopsaServer server;
+	WoopsaHostOptions options;
+	WoopsaHostOptionsInit(&options);
+	options.port = port;
+	options.maxConnections = DEVICE_MAX_CONNECTIONS;
+	options.pollIntervalMs = DEVICE_POLL_INTERVAL_MS;
+	options.tick = Simulate;
+	WoopsaServerInit(&server, "/woopsa/", woopsaEntries, NULL);
+	WoopsaServerSetStepHook(&server, CountRequests);
+	signal(SIGINT, SIG_IGN);
+	signal(SIGTERM, StopDevice);
+	if (WoopsaHostOpen(&host, &server, &options) != 0) {
+		fprintf(stderr, "Error opening device %d on port %d: %s\n", deviceIndex, port, strerror(errno));
+		exit(1);
+	}
+	WoopsaHostRun(&host);
+	WoopsaHostClose(&host);
+	exit(0);
+}
+
+int main(int argc, char* argv[]) {
+	int count = DEFAULT_DEVICES, firstPort = DEFAULT_FIRST_PORT, option;
+	pid_t device;
+
+	while ((option = getopt(argc, argv, "n:p:")) != -1) {
+		switch (option) {
+		case 'n':
+			count = atoi(optarg);
+			break;
+		case 'p':
+			firstPort = atoi(optarg);
+			break;
+		default:
+			printf("Usage: %s [-n devices] [-p firstPort]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (count < 1 || count > MAX_DEVICES) {
+		printf("Between 1 and %d devices can be simulated\n", MAX_DEVICES);
+		return 1;
+	}
+
+	signal(SIGINT, StopFleet);
+	signal(SIGTERM, StopFleet);
+	for (deviceIndex = 0; deviceIndex < count; deviceIndex++) {
+		fflush(stdout);
+		device = fork();
+		if (device == 0)
+			RunDevice((WoopsaUInt16)(firstPort + deviceIndex));
+		if (device == -1) {
+			perror("Error starting a device");
+			break;
+		}
+		devices[deviceCount++] = device;
+		printf("Device%02d 127.0.0.1 %d\n", deviceIndex, firstPort + deviceIndex);
+	}
+	fflush(stdout);
+
+	// Until the devices stopped
+	while (wait(NULL) > 0 || errno == EINTR)
+		;
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "woopsa-gateway.h"
+#include "woopsa-host-server.h"
+
+// Serves the devices listed in a configuration file, one line per device:
+//   name host port [intervalMs]
+// Lines starting with # are comments. GatewayFleet prints such lines for
+// its simulated devices:
+//   ./GatewayFleet -n 80 -p 9000 > fleet.conf &
+//   ./GatewayServer -f fleet.conf [-p port] [-i intervalMs] [-w discoveryWaitMs]
+// Build it as explained in woopsa-gateway.h.
+
+#define WOOPSA_PORT 8000
+#define DEFAULT_INTERVAL_MS 1000
+#define DEFAULT_DISCOVERY_WAIT_MS 10000
+// The gateway is polled this often, its devices when they are due
+#define GATEWAY_POLL_INTERVAL_MS 10
+#define LINE_SIZE 256
+
+WoopsaGateway gateway;
+WoopsaServer server;
+WoopsaHost host;
+
+void Stop(int signalNumber) {
+	host.stop = 1;
+}
+
+void ForwardWrite(const WoopsaEntry* entry) {
+	WoopsaGatewayForwardWrite(&gateway, entry);
+}
+
+void PollDevices(void) {
+	if (WoopsaGatewayPoll(&gateway) > 0)
+		WoopsaServerRefreshTable(&server);
+}
+
+// Returns the number of devices added, or -1 with errno set
+int ReadDevices(const char* path, int defaultIntervalMs) {
+	char line[LINE_SIZE], name[LINE_SIZE], address[LINE_SIZE];
+	int port, intervalMs, fields, count = 0;
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return -1;
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (line[0] == '#')
+			continue;
+		fields = sscanf(line, "%255s %255s %d %d", name, address, &port, &intervalMs);
+		if (fields <= 0)
+			continue;
+		if (fields < 3) {
+			fclose(file);
+			errno = EINVAL;
+			return -1;
+		}
+		if (WoopsaGatewayAddDevice(&gateway, name, address, (WoopsaUInt16)port, fields == 4 ? intervalMs : defaultIntervalMs) != 0) {
+			fclose(file);
+			return -1;
+		}
+		count++;
+	}
+	fclose(file);
+	return count;
+}
+
+int main(int argc, char* argv[]) {
+	WoopsaHostOptions options;
+	const char* path = NULL;
+	int intervalMs = DEFAULT_INTERVAL_MS, waitMs = DEFAULT_DISCOVERY_WAIT_MS, option, count, discovered;
+
+	WoopsaHostOptionsInit(&options);
+	options.port = WOOPSA_PORT;
+	while ((option = getopt(argc, argv, "f:p:i:w:")) != -1) {
+		switch (option) {
+		case 'f':
+			path = optarg;
+			break;
+		case 'p':
+			options.port = (WoopsaUInt16)atoi(optarg);
+			break;
+		case 'i':
+			intervalMs = atoi(optarg);
+			break;
+		case 'w':
+			waitMs = atoi(optarg);
+			break;
+		default:
+			path = NULL;
+			break;
+		}
+	}
+	if (path == NULL) {
+		printf("Usage: %s -f devices.conf [-p port] [-i intervalMs] [-w discoveryWaitMs]\n", argv[0]);
+		return 1;
+	}
+
+	WoopsaGatewayInit(&gateway);
+	if ((count = ReadDevices(path, intervalMs)) == -1) {
+		perror("Error reading the devices");
+		return 1;
+	}
+	if ((discovered = WoopsaGatewayDiscover(&gateway, waitMs)) == -1) {
+		perror("Error discovering the devices");
+		return 1;
+	}
+	printf("%d of %d devices discovered, %d entries\n", discovered, count, gateway.entryCount);
+
+	WoopsaServerInit(&server, "/woopsa/", WoopsaGatewayEntries(&gateway), NULL);
+	WoopsaServerSetWriteHook(&server, ForwardWrite);
+	options.pollIntervalMs = GATEWAY_POLL_INTERVAL_MS;
+	options.tick = PollDevices;
+	if (WoopsaHostOpen(&host, &server, &options) != 0) {
+		perror("Error opening the server");
+		return 1;
+	}
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+	printf("Gateway listening on port %d with %s\n", options.port, WoopsaHostBackendName(host.backend));
+	fflush(stdout);
+
+	if (WoopsaHostRun(&host) != 0)
+		perror("Error serving clients");
+	WoopsaHostClose(&host);
+	WoopsaGatewayClose(&gateway);
+	return 0;
+}
@@ -0,0 +1,612 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "woopsa-gateway.h"
+
+#define ONLINE_NAME "Online"
+#define NAME_SEPARATOR "/"
+#define GROUP_READ_PATTERN "*"
+// Devices that cannot send their meta at once send it by pages, smaller
+// ones for devices that answer 503 to them
+#define META_PAGE_QUERY "offset=%d&limit=%d"
+#define META_PAGE_SIZE 16
+#define DISCOVERY_RETRY_MS 1000
+// Names of properties sent by group reads, relative to their device
+#define PROPERTY_NAME_SIZE 128
+
+#define JSON_PROPERTIES "\"Properties\":["
+#define JSON_NAME "\"Name\":\""
+#define JSON_TYPE "\"Type\":\""
+#define JSON_READONLY_TRUE "\"ReadOnly\":true"
+#define JSON_TOTAL_COUNT "\"TotalCount\":"
+
+#define REQUEST_GROUP_READ 0
+#define REQUEST_READ 1
+#define REQUEST_WRITE 2
+
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_NOT_FOUND 404
+
+int64_t NowMs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Discovery                                                                 //
+///////////////////////////////////////////////////////////////////////////////
+
+// Finds a JSON text member (such as "Name":") in the object of the meta
+// between at and end
+// Returns the text, with its length in textLength, or NULL
+const char* FindMember(const char* at, const char* end, const char* member, int* textLength) {
+	const char* textEnd;
+	at = memmem(at, end - at, member, strlen(member));
+	if (at == NULL)
+		return NULL;
+	at += strlen(member);
+	textEnd = memchr(at, '"', end - at);
+	if (textEnd == NULL)
+		return NULL;
+	*textLength = (int)(textEnd - at);
+	return at;
+}
+
+// Adds the properties listed in a meta document to the device
+// Returns 0, or -1 with errno set
+int AddMetaProperties(WoopsaGatewayDevice* device, const WoopsaClientResponse* meta) {
+	const char* end = meta->body + meta->bodyLength;
+	const char *at, *objectEnd, *name, *type;
+	WoopsaGatewayProperty* properties;
+	int nameLength, typeLength, typeIndex;
+	at = memmem(meta->body, meta->bodyLength, JSON_PROPERTIES, strlen(JSON_PROPERTIES));
+	if (at == NULL) {
+		errno = EPROTO;
+		return -1;
+	}
+	// Names of properties have no braces
+	for (at += strlen(JSON_PROPERTIES); at < end && *at == '{'; at = objectEnd + 1) {
+		objectEnd = memchr(at, '}', end - at);
+		if (objectEnd == NULL || objectEnd + 1 >= end) {
+			errno = EPROTO;
+			return -1;
+		}
+		name = FindMember(at, objectEnd, JSON_NAME, &nameLength);
+		type = FindMember(at, objectEnd, JSON_TYPE, &typeLength);
+		if (name == NULL || type == NULL) {
+			errno = EPROTO;
+			return -1;
+		}
+		if (objectEnd[1] == ',')
+			objectEnd++;
+		// Null properties have no value to cache
+		typeIndex = WoopsaClientParseType(type, typeLength);
+		if (typeIndex <= WOOPSA_TYPE_NULL)
+			continue;
+		properties = (WoopsaGatewayProperty*)realloc(device->properties, (device->propertyCount + 1) * sizeof(WoopsaGatewayProperty));
+		if (properties == NULL)
+			return -1;
+		device->properties = properties;
+		properties[device->propertyCount].name = strndup(name, nameLength);
+		if (properties[device->propertyCount].name == NULL)
+			return -1;
+		properties[device->propertyCount].type = (WoopsaUInt8)typeIndex;
+		properties[device->propertyCount].readOnly = memmem(at, objectEnd - at, JSON_READONLY_TRUE, strlen(JSON_READONLY_TRUE)) != NULL;
+		device->propertyCount++;
+	}
+	return 0;
+}
+
+void FreeProperties(WoopsaGatewayDevice* device) {
+	int i;
+	for (i = 0; i < device->propertyCount; i++)
+		free(device->properties[i].name);
+	free(device->properties);
+	device->properties = NULL;
+	device->propertyCount = 0;
+}
+
+// Reads the meta of a device, at once or page by page
+// Returns 0, or -1 with errno set
+int DiscoverDevice(WoopsaGatewayDevice* device) {
+	WoopsaClientResponse meta;
+	const char* totalCount;
+	char query[48];
+	int offset, total, pageSize = META_PAGE_SIZE;
+	if (WoopsaClientMeta(device->client, NULL, &meta) == 0)
+		return AddMetaProperties(device, &meta);
+	// Devices answer 503 when their whole meta does not fit in their buffer
+	if (errno != EINVAL && errno != EPROTO && errno != EAGAIN)
+		return -1;
+	FreeProperties(device);
+	for (offset = 0, total = 1; offset < total; offset += pageSize) {
+		snprintf(query, sizeof(query), META_PAGE_QUERY, offset, pageSize);
+		while (WoopsaClientMeta(device->client, query, &meta) != 0) {
+			if (errno != EAGAIN || pageSize == 1)
+				return -1;
+			pageSize /= 2;
+			snprintf(query, sizeof(query), META_PAGE_QUERY, offset, pageSize);
+		}
+		if (AddMetaProperties(device, &meta) != 0)
+			return -1;
+		totalCount = memmem(meta.body, meta.bodyLength, JSON_TOTAL_COUNT, strlen(JSON_TOTAL_COUNT));
+		if (totalCount == NULL) {
+			errno = EPROTO;
+			return -1;
+		}
+		total = atoi(totalCount + strlen(JSON_TOTAL_COUNT));
+	}
+	return 0;
+}
+
+// Describes the entry of a cached property of this type
+void DescribeEntry(WoopsaEntry* entry, WoopsaGatewayValue* value, WoopsaUInt8 type, WoopsaUInt8 readOnly) {
+	entry->address.data = value;
+	entry->type = type;
+	entry->readOnly = readOnly;
+	switch (type) {
+	case WOOPSA_TYPE_LOGICAL:
+		entry->storage = WOOPSA_STORAGE_BOOL;
+		entry->size = sizeof(WoopsaUInt8);
+		break;
+	case WOOPSA_TYPE_INTEGER:
+		entry->storage = WOOPSA_STORAGE_INT64;
+		entry->size = sizeof(int64_t);
+		break;
+	case WOOPSA_TYPE_REAL:
+	case WOOPSA_TYPE_TIME_SPAN:
+		entry->storage = WOOPSA_STORAGE_DOUBLE;
+		entry->size = sizeof(double);
+		break;
+	default:
+		entry->storage = WOOPSA_STORAGE_TEXT;
+		entry->size = WOOPSA_GATEWAY_TEXT_SIZE;
+		break;
+	}
+}
+
+// Builds the table of the devices and their cache, with room for
+// spareCount more entries at its end
+// Returns 0, or -1 with errno set
+int BuildTable(WoopsaGateway* gateway, int spareCount) {
+	WoopsaGatewayDevice* device;
+	WoopsaEntry* entry;
+	WoopsaChar8* name;
+	size_t namesSize = 0;
+	int count = 0, i, j;
+	for (i = 0; i < gateway->deviceCount; i++) {
+		device = &gateway->devices[i];
+		count += 1 + device->propertyCount;
+		namesSize += strlen(device->name) + sizeof(NAME_SEPARATOR ONLINE_NAME);
+		for (j = 0; j < device->propertyCount; j++)
+			namesSize += strlen(device->name) + sizeof(NAME_SEPARATOR) + strlen(device->properties[j].name);
+	}
+	// The table ends with an entry without name
+	gateway->entries = (WoopsaEntry*)calloc(count + spareCount + 1, sizeof(WoopsaEntry));
+	gateway->values = (WoopsaGatewayValue*)calloc(count + spareCount, sizeof(WoopsaGatewayValue));
+	gateway->entryDevices = (WoopsaUInt16*)calloc(count + spareCount, sizeof(WoopsaUInt16));
+	gateway->writesPending = (WoopsaUInt8*)calloc(count + spareCount, sizeof(WoopsaUInt8));
+	gateway->names = (WoopsaChar8*)malloc(namesSize + 1);
+	if (gateway->entries == NULL || gateway->values == NULL || gateway->entryDevices == NULL || gateway->writesPending == NULL || gateway->names == NULL)
+		return -1;
+	gateway->entryCount = count;
+	gateway->entryCapacity = count + spareCount;
+	gateway->lateEntry = count;
+	entry = gateway->entries;
+	name = gateway->names;
+	for (i = 0; i < gateway->deviceCount; i++) {
+		device = &gateway->devices[i];
+		device->firstEntry = (int)(entry - gateway->entries);
+		device->firstProperty = device->firstEntry + 1;
+		for (j = -1; j < device->propertyCount; j++, entry++) {
+			gateway->entryDevices[entry - gateway->entries] = (WoopsaUInt16)i;
+			entry->name = name;
+			name += sprintf(name, "%s" NAME_SEPARATOR "%s", device->name, j == -1 ? ONLINE_NAME : device->properties[j].name) + 1;
+			if (j == -1)
+				DescribeEntry(entry, &gateway->values[entry - gateway->entries], WOOPSA_TYPE_LOGICAL, 1);
+			else
+				DescribeEntry(entry, &gateway->values[entry - gateway->entries], device->properties[j].type, device->properties[j].readOnly);
+		}
+	}
+	*name = '\0';
+	entry->name = name;
+	return 0;
+}
+
+// Publishes the properties of a device discovered after the table was
+// built in its spare entries, the end of the table moving after them. The
+// entries already there stay where they are, as the server points to them.
+// Returns 0, or -1 with errno set to ENOBUFS if they do not fit
+int PublishDevice(WoopsaGateway* gateway, WoopsaGatewayDevice* device) {
+	const WoopsaChar8* end = gateway->entries[gateway->entryCount].name;
+	WoopsaEntry* entry;
+	char* name;
+	int j;
+	if (gateway->entryCount + device->propertyCount > gateway->entryCapacity) {
+		errno = ENOBUFS;
+		return -1;
+	}
+	for (j = 0; j < device->propertyCount; j++) {
+		entry = &gateway->entries[gateway->entryCount + j];
+		if (asprintf(&name, "%s" NAME_SEPARATOR "%s", device->name, device->properties[j].name) == -1) {
+			for (; j > 0; j--)
+				free((char*)gateway->entries[gateway->entryCount + j - 1].name);
+			gateway->entries[gateway->entryCount].name = end;
+			errno = ENOMEM;
+			return -1;
+		}
+		entry->name = name;
+		gateway->entryDevices[entry - gateway->entries] = (WoopsaUInt16)(device - gateway->devices);
+		DescribeEntry(entry, &gateway->values[entry - gateway->entries], device->properties[j].type, device->properties[j].readOnly);
+	}
+	gateway->entries[gateway->entryCount + device->propertyCount].name = end;
+	device->firstProperty = gateway->entryCount;
+	gateway->entryCount += device->propertyCount;
+	return 0;
+}
+
+// Connects to a device and reads its meta
+// Returns 0, or -1 with errno set
+int TryDevice(WoopsaGateway* gateway, WoopsaGatewayDevice* device) {
+	WoopsaClient* client = (WoopsaClient*)malloc(sizeof(WoopsaClient));
+	if (client == NULL)
+		return -1;
+	if (WoopsaClientOpen(client, device->host, device->port, "/woopsa/") == 0) {
+		client->timeoutMs = gateway->timeoutMs;
+		device->client = client;
+		if (DiscoverDevice(device) == 0)
+			return 0;
+		WoopsaClientClose(client);
+		FreeProperties(device);
+		device->client = NULL;
+	}
+	free(client);
+	return -1;
+}
+
+// Tries the next device that did not answer yet. Only one is tried per
+// call, as it waits for it.
+// Returns 1 if it was discovered and its properties added to the table,
+// 0 otherwise
+int RetryDiscovery(WoopsaGateway* gateway) {
+	WoopsaGatewayDevice* device;
+	int i;
+	for (i = 0; i < gateway->deviceCount; i++) {
+		device = &gateway->devices[(gateway->nextRetry + i) % gateway->deviceCount];
+		if (device->client != NULL)
+			continue;
+		gateway->nextRetry = (int)(device - gateway->devices) + 1;
+		if (TryDevice(gateway, device) != 0)
+			return 0;
+		device->polledAt = 0;
+		if (PublishDevice(gateway, device) == 0)
+			return 1;
+		// Without room for its properties, it only publishes Online
+		FreeProperties(device);
+		return 0;
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Polling                                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+// Stores a value sent by a device in the cache, unless a client wrote
+// the property since it was read
+void StoreValue(WoopsaGateway* gateway, int entryIndex, const char* value) {
+	const WoopsaEntry* entry = &gateway->entries[entryIndex];
+	WoopsaGatewayValue* cached = &gateway->values[entryIndex];
+	if (gateway->writesPending[entryIndex] > 0)
+		return;
+	switch (entry->storage) {
+	case WOOPSA_STORAGE_BOOL:
+		cached->logical = strcmp(value, "true") == 0;
+		break;
+	case WOOPSA_STORAGE_INT64:
+		cached->integer = strtoll(value, NULL, 10);
+		break;
+	case WOOPSA_STORAGE_DOUBLE:
+		cached->real = strtod(value, NULL);
+		break;
+	default:
+		snprintf(cached->text, sizeof(cached->text), "%s", value);
+		break;
+	}
+}
+
+// Finds the entry of a property of the device, starting from the one
+// after hint: group reads usually list them in the same order
+// Returns the entry, or -1
+int FindProperty(const WoopsaGateway* gateway, const WoopsaGatewayDevice* device, const char* name, int hint) {
+	size_t prefixLength = strlen(device->name) + strlen(NAME_SEPARATOR);
+	int first = device->firstProperty, count = device->propertyCount, i, entry;
+	for (i = 0; i < count; i++) {
+		// The hint can be before the device's properties
+		entry = first + ((hint + 1 - first + i) % count + count) % count;
+		if (strcmp(gateway->entries[entry].name + prefixLength, name) == 0)
+			return entry;
+	}
+	return -1;
+}
+
+void PushRequest(WoopsaGatewayDevice* device, WoopsaUInt8 kind, int entry) {
+	WoopsaGatewayRequest* request = &device->requests[(device->firstRequest + device->requestCount) % WOOPSA_CLIENT_MAX_REQUESTS];
+	request->kind = kind;
+	request->entry = entry;
+	device->requestCount++;
+}
+
+// Queues the reads of the poll that fit in the client
+void QueueReads(WoopsaGatewayDevice* device) {
+	int entry;
+	while (device->nextRead < device->propertyCount) {
+		entry = device->firstProperty + device->nextRead;
+		if (WoopsaClientRequestRead(device->client, device->properties[device->nextRead].name) != 0)
+			break;
+		PushRequest(device, REQUEST_READ, entry);
+		device->nextRead++;
+		device->readsPending++;
+	}
+}
+
+void StartPoll(WoopsaGatewayDevice* device, int64_t now) {
+	device->polledAt = now;
+	device->nextRead = 0;
+	device->readsPending = 0;
+	if (device->groupReads) {
+		if (WoopsaClientRequestRead(device->client, GROUP_READ_PATTERN) != 0)
+			return;
+		PushRequest(device, REQUEST_GROUP_READ, -1);
+		device->nextRead = device->propertyCount;
+		device->readsPending = 1;
+	} else {
+		QueueReads(device);
+	}
+}
+
+// The device is offline: its requests are dropped, and it is polled
+// again after its interval
+void FailDevice(WoopsaGateway* gateway, WoopsaGatewayDevice* device) {
+	WoopsaGatewayRequest* request;
+	WoopsaClientClose(device->client);
+	for (; device->requestCount > 0; device->requestCount--) {
+		request = &device->requests[device->firstRequest];
+		if (request->kind == REQUEST_WRITE)
+			gateway->writesPending[request->entry]--;
+		device->firstRequest = (device->firstRequest + 1) % WOOPSA_CLIENT_MAX_REQUESTS;
+	}
+	device->nextRead = device->propertyCount;
+	device->readsPending = 0;
+	device->failures++;
+	device->polledAt = NowMs();
+	gateway->values[device->firstEntry].logical = 0;
+}
+
+// A write sent on a connection lost before its response: the device may
+// or may not have applied it, its value is read again
+void FailWrite(WoopsaGateway* gateway, WoopsaGatewayDevice* device) {
+	gateway->writesPending[device->requests[device->firstRequest].entry]--;
+	device->firstRequest = (device->firstRequest + 1) % WOOPSA_CLIENT_MAX_REQUESTS;
+	device->requestCount--;
+	if (device->readsPending == 0)
+		device->polledAt = 0;
+}
+
+void HandleGroupRead(WoopsaGateway* gateway, WoopsaGatewayDevice* device, const WoopsaClientResponse* response) {
+	char name[PROPERTY_NAME_SIZE];
+	char value[WOOPSA_GATEWAY_TEXT_SIZE];
+	int offset = 0, previousOffset, entry = device->firstProperty - 1, found;
+	if (response->status != HTTP_STATUS_OK) {
+		// Devices without group reads look for a property named "*".
+		// Other errors, such as a group too large for the device (503),
+		// only make this poll read the properties one by one.
+		if (response->status == HTTP_STATUS_NOT_FOUND)
+			device->groupReads = 0;
+		device->nextRead = 0;
+		QueueReads(device);
+		return;
+	}
+	// Values too long for the cache are skipped
+	for (;;) {
+		previousOffset = offset;
+		if (WoopsaClientParseGroup(response, &offset, name, sizeof(name), value, sizeof(value)) != -1) {
+			// A property the gateway does not know keeps the hint
+			found = FindProperty(gateway, device, name, entry);
+			if (found != -1) {
+				entry = found;
+				StoreValue(gateway, entry, value);
+			}
+		} else if (errno != ENOBUFS || offset == previousOffset) {
+			break;
+		}
+	}
+}
+
+void HandleResponse(WoopsaGateway* gateway, WoopsaGatewayDevice* device, const WoopsaClientResponse* response) {
+	WoopsaGatewayRequest request = device->requests[device->firstRequest];
+	char value[WOOPSA_GATEWAY_TEXT_SIZE];
+	device->firstRequest = (device->firstRequest + 1) % WOOPSA_CLIENT_MAX_REQUESTS;
+	device->requestCount--;
+	switch (request.kind) {
+	case REQUEST_GROUP_READ:
+		HandleGroupRead(gateway, device, response);
+		device->readsPending--;
+		break;
+	case REQUEST_READ:
+		if (response->status == HTTP_STATUS_OK && WoopsaClientParseValue(response, value, sizeof(value)) != -1)
+			StoreValue(gateway, request.entry, value);
+		device->readsPending--;
+		QueueReads(device);
+		break;
+	case REQUEST_WRITE:
+		gateway->writesPending[request.entry]--;
+		// A refused value is replaced by the device's one on the next poll
+		if (response->status != HTTP_STATUS_OK)
+			device->polledAt = 0;
+		return;
+	}
+	if (device->readsPending == 0 && device->nextRead == device->propertyCount) {
+		device->polls++;
+		gateway->values[device->firstEntry].logical = 1;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                   BEGIN PUBLIC WOOPSA GATEWAY IMPLEMENTATION              //
+///////////////////////////////////////////////////////////////////////////////
+
+void WoopsaGatewayInit(WoopsaGateway* gateway) {
+	memset(gateway, 0, sizeof(WoopsaGateway));
+	gateway->timeoutMs = WOOPSA_GATEWAY_DEFAULT_TIMEOUT_MS;
+}
+
+int WoopsaGatewayAddDevice(WoopsaGateway* gateway, const char* name, const char* host, WoopsaUInt16 port, int intervalMs) {
+	WoopsaGatewayDevice* device = &gateway->devices[gateway->deviceCount];
+	if (gateway->deviceCount == WOOPSA_GATEWAY_MAX_DEVICES || gateway->entries != NULL) {
+		errno = ENOBUFS;
+		return -1;
+	}
+	if (strlen(name) >= sizeof(device->name) || strlen(host) >= sizeof(device->host)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	memset(device, 0, sizeof(WoopsaGatewayDevice));
+	strcpy(device->name, name);
+	strcpy(device->host, host);
+	device->port = port;
+	device->intervalMs = intervalMs;
+	device->groupReads = 1;
+	gateway->deviceCount++;
+	return 0;
+}
+
+int WoopsaGatewayDiscover(WoopsaGateway* gateway, int waitMs) {
+	WoopsaGatewayDevice* device;
+	int64_t start = NowMs();
+	int discovered = 0, i;
+	for (;;) {
+		for (i = 0; i < gateway->deviceCount; i++) {
+			device = &gateway->devices[i];
+			if (device->client != NULL)
+				continue;
+			if (TryDevice(gateway, device) == 0)
+				discovered++;
+			else if (errno == ENOMEM)
+				return -1;
+		}
+		if (discovered == gateway->deviceCount || NowMs() - start >= waitMs)
+			break;
+		usleep(DISCOVERY_RETRY_MS * 1000);
+	}
+	// The devices that did not answer take their entries from the spare
+	// ones once they do
+	if (BuildTable(gateway, discovered < gateway->deviceCount ? WOOPSA_GATEWAY_SPARE_ENTRIES : 0) != 0)
+		return -1;
+	gateway->retriedAt = NowMs();
+	return discovered;
+}
+
+const WoopsaEntry* WoopsaGatewayEntries(const WoopsaGateway* gateway) {
+	return gateway->entries;
+}
+
+int WoopsaGatewayPoll(WoopsaGateway* gateway) {
+	WoopsaGatewayDevice* device;
+	WoopsaClientResponse response;
+	int64_t now = NowMs();
+	int i, result, discovered = 0;
+	if (now - gateway->retriedAt >= DISCOVERY_RETRY_MS) {
+		discovered = RetryDiscovery(gateway);
+		gateway->retriedAt = now = NowMs();
+	}
+	for (i = 0; i < gateway->deviceCount; i++) {
+		device = &gateway->devices[i];
+		if (device->client == NULL)
+			continue;
+		if (device->readsPending > 0 && now - device->polledAt >= gateway->timeoutMs)
+			FailDevice(gateway, device);
+		else if (device->readsPending == 0 && now - device->polledAt >= device->intervalMs)
+			StartPoll(device, now);
+		if (device->requestCount == 0)
+			continue;
+		// Sends the requests, and takes the responses that arrived. The
+		// client fails the writes lost with a connection alone.
+		for (;;) {
+			while ((result = WoopsaClientPoll(device->client, &response)) == 1)
+				HandleResponse(gateway, device, &response);
+			if (result == 0)
+				break;
+			if (errno != ECONNRESET || device->requests[device->firstRequest].kind != REQUEST_WRITE
+					|| WoopsaClientPending(device->client) != device->requestCount - 1) {
+				FailDevice(gateway, device);
+				break;
+			}
+			FailWrite(gateway, device);
+		}
+	}
+	return discovered;
+}
+
+void WoopsaGatewayForwardWrite(WoopsaGateway* gateway, const WoopsaEntry* entry) {
+	int entryIndex = (int)(entry - gateway->entries);
+	WoopsaGatewayDevice* device = &gateway->devices[gateway->entryDevices[entryIndex]];
+	const WoopsaGatewayValue* cached = &gateway->values[entryIndex];
+	const char* name = entry->name + strlen(device->name) + strlen(NAME_SEPARATOR);
+	char value[WOOPSA_GATEWAY_TEXT_SIZE];
+	if (device->client == NULL || gateway->writesPending[entryIndex] == UINT8_MAX)
+		return;
+	switch (entry->storage) {
+	case WOOPSA_STORAGE_BOOL:
+		strcpy(value, cached->logical ? "true" : "false");
+		break;
+	case WOOPSA_STORAGE_INT64:
+		snprintf(value, sizeof(value), "%" PRId64, cached->integer);
+		break;
+	case WOOPSA_STORAGE_DOUBLE:
+		snprintf(value, sizeof(value), "%.17g", cached->real);
+		break;
+	default:
+		strcpy(value, cached->text);
+		break;
+	}
+	if (WoopsaClientRequestWrite(device->client, name, value) != 0) {
+		// The cache gets the device's value back on the next poll
+		device->polledAt = 0;
+		return;
+	}
+	PushRequest(device, REQUEST_WRITE, entryIndex);
+	gateway->writesPending[entryIndex]++;
+}
+
+void WoopsaGatewayClose(WoopsaGateway* gateway) {
+	WoopsaGatewayDevice* device;
+	int i;
+	for (i = 0; i < gateway->deviceCount; i++) {
+		device = &gateway->devices[i];
+		if (device->client != NULL) {
+			WoopsaClientClose(device->client);
+			free(device->client);
+			device->client = NULL;
+		}
+		FreeProperties(device);
+	}
+	for (i = gateway->lateEntry; i < gateway->entryCount; i++)
+		free((char*)gateway->entries[i].name);
+	free(gateway->entries);
+	free(gateway->values);
+	free(gateway->entryDevices);
+	free(gateway->writesPending);
+	free(gateway->names);
+	gateway->entries = NULL;
+	gateway->values = NULL;
+	gateway->entryDevices = NULL;
+	gateway->writesPending = NULL;
+	gateway->names = NULL;
+}
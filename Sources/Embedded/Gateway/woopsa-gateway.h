@@ -0,0 +1,151 @@
+#ifndef __WOOPSA_GATEWAY_H_
+#define __WOOPSA_GATEWAY_H_
+
+// Caching gateway in front of many embedded Woopsa servers. Each device is
+// polled once per interval, with one group read when it has them, and the
+// values are cached in one entry table where every device is a subobject
+// (Boiler1/Temperature, described by meta/Boiler1). The gateway's clients, their event streams and
+// subscriptions are served from the cache, so the load of the devices does
+// not depend on the number of clients. Writes are passed on to the devices.
+// Serve the table with the host server, with the features the clients of
+// the gateway use and larger sizes than an MCU's:
+//   FEATURES="-DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_TIMEOUTS -DWOOPSA_ENABLE_WRITE_HOOK -DWOOPSA_ENABLE_SUBOBJECTS -DWOOPSA_ENABLE_GROUP_READS -DWOOPSA_ENABLE_PAGED_META -DWOOPSA_ENABLE_EVENT_STREAMS -DWOOPSA_ENABLE_WEBSOCKETS"
+//   FLAGS="$FEATURES -DWOOPSA_NAME_INDEX_SIZE=4096 -DWOOPSA_MAX_EVENT_STREAMS=64 -DWOOPSA_CONNECTION_OUTPUT_SIZE=65536"
+//   gcc -O2 $FLAGS -I../Server -I../Client -I../HostServer -o GatewayServer GatewayServer.c woopsa-gateway.c ../Client/woopsa-client.c ../HostServer/woopsa-host-server.c ../Server/woopsa-server.c
+
+#include <stdint.h>
+#include "woopsa-client.h"
+
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+#error "The gateway builds its entry table at run time, it cannot be in flash"
+#endif
+#ifndef WOOPSA_ENABLE_WRITE_HOOK
+#error "The gateway needs WOOPSA_ENABLE_WRITE_HOOK in woopsa-config.h to pass writes on"
+#endif
+#ifndef WOOPSA_ENABLE_SUBOBJECTS
+#error "The gateway needs WOOPSA_ENABLE_SUBOBJECTS in woopsa-config.h to publish its devices"
+#endif
+
+#ifndef WOOPSA_GATEWAY_MAX_DEVICES
+#define WOOPSA_GATEWAY_MAX_DEVICES 256
+#endif
+// Entries kept at the end of the table, when devices did not answer the
+// discovery, for their properties once they do
+#ifndef WOOPSA_GATEWAY_SPARE_ENTRIES
+#define WOOPSA_GATEWAY_SPARE_ENTRIES 1024
+#endif
+// Cached texts are truncated to this size
+#ifndef WOOPSA_GATEWAY_TEXT_SIZE
+#define WOOPSA_GATEWAY_TEXT_SIZE 64
+#endif
+#define WOOPSA_GATEWAY_NAME_SIZE 32
+// How long a device has to answer, 2 s by default
+#define WOOPSA_GATEWAY_DEFAULT_TIMEOUT_MS 2000
+
+// The cached value of a property
+typedef union {
+	WoopsaUInt8 logical;
+	int64_t integer;
+	double real;
+	WoopsaChar8 text[WOOPSA_GATEWAY_TEXT_SIZE];
+} WoopsaGatewayValue;
+
+// A property found in the meta of a device
+typedef struct {
+	WoopsaChar8* name;
+	WoopsaUInt8 type;
+	WoopsaUInt8 readOnly;
+} WoopsaGatewayProperty;
+
+// What a response of a device answers
+typedef struct {
+	WoopsaUInt8 kind;
+	// Entry of the property read or written
+	int entry;
+} WoopsaGatewayRequest;
+
+typedef struct {
+	WoopsaChar8 name[WOOPSA_GATEWAY_NAME_SIZE];
+	WoopsaChar8 host[WOOPSA_CLIENT_HOST_SIZE];
+	WoopsaUInt16 port;
+	int intervalMs;
+	// NULL until the device was discovered
+	WoopsaClient* client;
+	WoopsaGatewayProperty* properties;
+	int propertyCount;
+	// Its entries in the table: Online, then its properties, which are in
+	// the spare entries for the devices discovered after the table was built
+	int firstEntry;
+	int firstProperty;
+	// Devices without group reads are read one property after the other,
+	// as are the polls whose group read failed
+	WoopsaUInt8 groupReads;
+	// Requests waiting for their response, oldest first
+	WoopsaGatewayRequest requests[WOOPSA_CLIENT_MAX_REQUESTS];
+	int firstRequest;
+	int requestCount;
+	// Reads of the current poll: the next property to read, and the
+	// reads waiting for their response
+	int nextRead;
+	int readsPending;
+	// When the current or last poll started, in milliseconds
+	int64_t polledAt;
+	WoopsaUInt32 polls;
+	WoopsaUInt32 failures;
+} WoopsaGatewayDevice;
+
+typedef struct {
+	WoopsaGatewayDevice devices[WOOPSA_GATEWAY_MAX_DEVICES];
+	int deviceCount;
+	int timeoutMs;
+	// The table published by the server, and the cache it points to
+	WoopsaEntry* entries;
+	WoopsaGatewayValue* values;
+	// For each entry, its device, and the writes on their way to it
+	WoopsaUInt16* entryDevices;
+	WoopsaUInt8* writesPending;
+	int entryCount;
+	// Entries of the table, spare ones included
+	int entryCapacity;
+	WoopsaChar8* names;
+	// From this entry on, the names are allocated one by one
+	int lateEntry;
+	// The devices that did not answer are tried again one after the other
+	int nextRetry;
+	int64_t retriedAt;
+} WoopsaGateway;
+
+void WoopsaGatewayInit(WoopsaGateway* gateway);
+
+// Adds a device, which is published under name and polled every
+// intervalMs milliseconds
+// Returns 0, or -1 with errno set
+int WoopsaGatewayAddDevice(WoopsaGateway* gateway, const char* name, const char* host, WoopsaUInt16 port, int intervalMs);
+
+// Connects to the devices and reads their meta, trying again those that
+// do not answer for waitMs milliseconds, then builds the entry table.
+// Devices that did not answer only publish their Online property until
+// WoopsaGatewayPoll discovers them.
+// Returns the number of devices discovered, or -1 with errno set
+int WoopsaGatewayDiscover(WoopsaGateway* gateway, int waitMs);
+
+// The table to publish with WoopsaServerInit, once discovered
+const WoopsaEntry* WoopsaGatewayEntries(const WoopsaGateway* gateway);
+
+// Polls the devices that are due, and caches the values they sent since
+// the last call. It never waits for them: call it often, from the tick of
+// the host server for instance. Every second, it also tries one of the
+// devices that were not discovered, which waits for it, and adds its
+// properties to the table.
+// Returns the number of devices discovered: call WoopsaServerRefreshTable
+// then
+int WoopsaGatewayPoll(WoopsaGateway* gateway);
+
+// Passes the value written by a client on to its device, to be called
+// by the write hook of the server
+void WoopsaGatewayForwardWrite(WoopsaGateway* gateway, const WoopsaEntry* entry);
+
+// Closes the connections and frees the table
+void WoopsaGatewayClose(WoopsaGateway* gateway);
+
+#endif
@@ -0,0 +1,110 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "woopsa-coroutine-server.h"
+
+// The demo server of DemoServer.c on the coroutine layer. The weather is
+// simulated by a coroutine of its own, and AverageTemperature is a method
+// written as a coroutine: it samples the temperature for two seconds
+// without holding up the other clients.
+//   FLAGS="-DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_TIMEOUTS -DWOOPSA_ENABLE_ASYNC_METHODS"
+//   gcc -O2 -I../Server $FLAGS -c ../Server/woopsa-server.c
+//   g++ -std=c++20 -O2 -I../Server $FLAGS -o CoroutineDemoServer CoroutineDemoServer.cpp woopsa-coroutine-server.cpp woopsa-server.o
+//   ./CoroutineDemoServer [-p port] [-c maxConnections]
+// POST /woopsa/invoke/AverageTemperature answers with a job id, and
+// GET /woopsa/job/{id} gives the average once it is there.
+
+#define WOOPSA_PORT 8000
+#define SIMULATION_INTERVAL_MS 100
+#define AVERAGE_SAMPLES 20
+
+float Temperature = 24.2f;
+char IsRaining = 1;
+int Altitude = 430;
+float Sensitivity = 0.5f;
+char City[20] = "Geneva";
+float TimeSinceLastRain = 11;
+
+WoopsaLoop loop;
+
+char weatherBuffer[20];
+char* GetWeather() {
+	sprintf(weatherBuffer, IsRaining ? "rainy" : "sunny");
+	return weatherBuffer;
+}
+
+WoopsaTask<float> AverageTemperature() {
+	float sum = 0;
+	int i;
+	for (i = 0; i < AVERAGE_SAMPLES; i++) {
+		sum += Temperature;
+		co_await loop.Sleep(SIMULATION_INTERVAL_MS);
+	}
+	co_return sum / AVERAGE_SAMPLES;
+}
+
+WOOPSA_BEGIN(woopsaEntries)
+WOOPSA_PROPERTY_READONLY(Temperature, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(IsRaining, WOOPSA_TYPE_LOGICAL)
+WOOPSA_PROPERTY(Altitude, WOOPSA_TYPE_INTEGER)
+WOOPSA_PROPERTY(Sensitivity, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(City, WOOPSA_TYPE_TEXT)
+WOOPSA_PROPERTY(TimeSinceLastRain, WOOPSA_TYPE_TIME_SPAN)
+WOOPSA_METHOD(GetWeather, WOOPSA_TYPE_TEXT)
+WOOPSA_METHOD_COROUTINE(AverageTemperature, WOOPSA_TYPE_REAL)
+WOOPSA_END;
+
+// The temperature drifts around 24 degrees
+WoopsaTask<> Simulate() {
+	int ticks = 0;
+	for (;;) {
+		co_await loop.Sleep(SIMULATION_INTERVAL_MS);
+		Temperature = 24.2f + 0.5f * (float)sin(ticks++ / 50.0);
+		TimeSinceLastRain += SIMULATION_INTERVAL_MS / 1000.0f;
+	}
+}
+
+void Stop(int signalNumber) {
+	loop.stop = 1;
+}
+
+int main(int argc, char* argv[]) {
+	WoopsaServer server;
+	WoopsaUInt16 port = WOOPSA_PORT;
+	int maxConnections = 0, option;
+
+	while ((option = getopt(argc, argv, "p:c:")) != -1) {
+		switch (option) {
+		case 'p':
+			port = (WoopsaUInt16)atoi(optarg);
+			break;
+		case 'c':
+			maxConnections = atoi(optarg);
+			break;
+		default:
+			printf("Usage: %s [-p port] [-c maxConnections]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	WoopsaServerInit(&server, "/woopsa/", woopsaEntries, NULL);
+	WoopsaCoroutineServer coroutineServer(loop, &server);
+	if (maxConnections > 0)
+		coroutineServer.maxConnections = maxConnections;
+	if (loop.Open() != 0 || coroutineServer.Listen(port) != 0) {
+		perror("Error opening the server");
+		return 1;
+	}
+	loop.Spawn(Simulate());
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+	printf("Server listening on port %d with coroutines\n", port);
+	fflush(stdout);
+
+	if (loop.Run() != 0)
+		perror("Error serving clients");
+	return 0;
+}
@@ -0,0 +1,271 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "woopsa-host-server.h"
+
+// Loopback benchmark of the host server backends: a child process serves
+// the same load with epoll, then with io_uring, while this process keeps
+// depth pipelined reads in flight on every connection.
+//   gcc -O2 -I../Server -DWOOPSA_ENABLE_CONNECTIONS -o HostBenchmark HostBenchmark.c woopsa-host-server.c ../Server/woopsa-server.c
+//   ./HostBenchmark [-c connections] [-d depth] [-t seconds] [-p port]
+
+#define DEFAULT_CONNECTIONS 64
+#define DEFAULT_DEPTH 8
+#define DEFAULT_SECONDS 5
+#define DEFAULT_PORT 8001
+#define MAX_DEPTH 64
+#define RECEIVE_SIZE 65536
+#define EPOLL_EVENTS 256
+#define REQUEST "GET /woopsa/read/Temperature HTTP/1.1\r\nHost: localhost\r\n\r\n"
+#define CONTENT_LENGTH "content-length:"
+#define HEADERS_END "\r\n\r\n"
+
+float Temperature = 24.2f;
+int Altitude = 430;
+char City[20] = "Geneva";
+
+WOOPSA_BEGIN(woopsaEntries)
+WOOPSA_PROPERTY_READONLY(Temperature, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(Altitude, WOOPSA_TYPE_INTEGER)
+WOOPSA_PROPERTY(City, WOOPSA_TYPE_TEXT)
+WOOPSA_END;
+
+typedef struct {
+	int socket;
+	char received[RECEIVE_SIZE];
+	size_t receivedLength;
+	// When the requests in flight were sent, oldest first
+	double sentAt[MAX_DEPTH];
+	int first;
+	int inFlight;
+} Client;
+
+typedef struct {
+	long responses;
+	double totalLatency;
+	double maxLatency;
+	int errors;
+} Results;
+
+WoopsaHost host;
+
+void StopHost(int signalNumber) {
+	host.stop = 1;
+}
+
+double Now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Serves until SIGTERM, after telling the parent through ready whether
+// the backend could be opened (0, or the error)
+void RunServer(WoopsaUInt8 backend, WoopsaUInt16 port, int maxConnections, int ready) {
+	WoopsaServer server;
+	WoopsaHostOptions options;
+	int error = 0;
+	WoopsaHostOptionsInit(&options);
+	options.port = port;
+	options.backend = backend;
+	options.maxConnections = maxConnections;
+	WoopsaServerInit(&server, "/woopsa/", woopsaEntries, NULL);
+	// Lets io_uring send from registered buffers
+	signal(SIGPIPE, SIG_IGN);
+	if (WoopsaHostOpen(&host, &server, &options) != 0)
+		error = errno != 0 ? errno : EINVAL;
+	signal(SIGTERM, StopHost);
+	if (write(ready, &error, sizeof(error)) != sizeof(error) || error != 0)
+		exit(1);
+	WoopsaHostRun(&host);
+	WoopsaHostClose(&host);
+	exit(0);
+}
+
+int SendRequests(Client* client, int count) {
+	static char requests[MAX_DEPTH * sizeof(REQUEST)];
+	double now = Now();
+	int i;
+	for (i = 0; i < count; i++) {
+		memcpy(requests + i * (sizeof(REQUEST) - 1), REQUEST, sizeof(REQUEST) - 1);
+		client->sentAt[(client->first + client->inFlight + i) % MAX_DEPTH] = now;
+	}
+	client->inFlight += count;
+	// Blocking sockets: a few requests always fit in the socket buffer
+	return send(client->socket, requests, count * (sizeof(REQUEST) - 1), MSG_NOSIGNAL) < 0 ? -1 : 0;
+}
+
+// Counts the complete responses in the received bytes, and sends as many
+// requests to keep depth of them in flight
+// Returns 0, or -1 on a broken response or connection
+int HandleResponses(Client* client, int depth, Results* results, double now) {
+	char *headersEnd, *contentLength;
+	size_t responseLength, offset = 0;
+	int completed = 0;
+	double latency;
+	while ((headersEnd = memmem(client->received + offset, client->receivedLength - offset, HEADERS_END, strlen(HEADERS_END))) != NULL) {
+		*headersEnd = '\0';
+		contentLength = strcasestr(client->received + offset, CONTENT_LENGTH);
+		*headersEnd = '\r';
+		if (contentLength == NULL || client->inFlight == 0)
+			return -1;
+		responseLength = headersEnd + strlen(HEADERS_END) - (client->received + offset) + strtol(contentLength + strlen(CONTENT_LENGTH), NULL, 10);
+		if (offset + responseLength > client->receivedLength)
+			break;
+		offset += responseLength;
+		latency = now - client->sentAt[client->first];
+		client->first = (client->first + 1) % MAX_DEPTH;
+		client->inFlight--;
+		results->responses++;
+		results->totalLatency += latency;
+		if (latency > results->maxLatency)
+			results->maxLatency = latency;
+		completed++;
+	}
+	client->receivedLength -= offset;
+	memmove(client->received, client->received + offset, client->receivedLength);
+	return completed > 0 ? SendRequests(client, depth - client->inFlight) : 0;
+}
+
+int ConnectClient(Client* client, WoopsaUInt16 port) {
+	struct sockaddr_in address;
+	int one = 1;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+	client->socket = socket(AF_INET, SOCK_STREAM, 0);
+	client->receivedLength = 0;
+	client->first = 0;
+	client->inFlight = 0;
+	if (client->socket < 0 || connect(client->socket, (struct sockaddr*)&address, sizeof(address)) != 0)
+		return -1;
+	setsockopt(client->socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	return 0;
+}
+
+// Keeps every connection busy for the given time
+int RunLoad(WoopsaUInt16 port, Client* clients, int connections, int depth, double seconds, Results* results) {
+	struct epoll_event event, events[EPOLL_EVENTS];
+	double end;
+	ssize_t readBytes;
+	Client* client;
+	int epoll, count, i;
+
+	memset(results, 0, sizeof(Results));
+	epoll = epoll_create1(0);
+	for (i = 0; i < connections; i++) {
+		if (ConnectClient(&clients[i], port) != 0)
+			return -1;
+		event.events = EPOLLIN;
+		event.data.ptr = &clients[i];
+		epoll_ctl(epoll, EPOLL_CTL_ADD, clients[i].socket, &event);
+		SendRequests(&clients[i], depth);
+	}
+
+	end = Now() + seconds;
+	while (Now() < end) {
+		count = epoll_wait(epoll, events, EPOLL_EVENTS, 100);
+		for (i = 0; i < count; i++) {
+			client = (Client*)events[i].data.ptr;
+			readBytes = recv(client->socket, client->received + client->receivedLength, RECEIVE_SIZE - client->receivedLength, MSG_DONTWAIT);
+			if (readBytes < 0 && errno == EAGAIN)
+				continue;
+			if (readBytes > 0)
+				client->receivedLength += readBytes;
+			if (readBytes <= 0 || HandleResponses(client, depth, results, Now()) != 0) {
+				// The connection is not used anymore
+				results->errors++;
+				epoll_ctl(epoll, EPOLL_CTL_DEL, client->socket, NULL);
+			}
+		}
+	}
+
+	for (i = 0; i < connections; i++)
+		close(clients[i].socket);
+	close(epoll);
+	return 0;
+}
+
+void Benchmark(WoopsaUInt8 backend, WoopsaUInt16 port, Client* clients, int connections, int depth, double seconds) {
+	Results results;
+	int ready[2], error = 0;
+	pid_t server;
+
+	if (pipe(ready) != 0)
+		return;
+	fflush(stdout);
+	server = fork();
+	if (server == 0) {
+		close(ready[0]);
+		RunServer(backend, port, connections + 1, ready[1]);
+	}
+	close(ready[1]);
+	if (read(ready[0], &error, sizeof(error)) != sizeof(error))
+		error = EIO;
+	close(ready[0]);
+
+	if (error != 0) {
+		printf("%-10s unavailable: %s\n", WoopsaHostBackendName(backend), strerror(error));
+	} else if (RunLoad(port, clients, connections, depth, seconds, &results) != 0) {
+		printf("%-10s could not connect: %s\n", WoopsaHostBackendName(backend), strerror(errno));
+	} else {
+		printf("%-10s %12.0f %12.3f %12.3f %8d\n", WoopsaHostBackendName(backend), results.responses / seconds,
+			results.responses > 0 ? results.totalLatency / results.responses * 1000 : 0, results.maxLatency * 1000, results.errors);
+	}
+	kill(server, SIGTERM);
+	waitpid(server, NULL, 0);
+}
+
+int main(int argc, char* argv[]) {
+	int connections = DEFAULT_CONNECTIONS, depth = DEFAULT_DEPTH, option;
+	double seconds = DEFAULT_SECONDS;
+	WoopsaUInt16 port = DEFAULT_PORT;
+	Client* clients;
+
+	while ((option = getopt(argc, argv, "c:d:t:p:")) != -1) {
+		switch (option) {
+		case 'c':
+			connections = atoi(optarg);
+			break;
+		case 'd':
+			depth = atoi(optarg);
+			break;
+		case 't':
+			seconds = atof(optarg);
+			break;
+		case 'p':
+			port = (WoopsaUInt16)atoi(optarg);
+			break;
+		default:
+			printf("Usage: %s [-c connections] [-d depth] [-t seconds] [-p port]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (depth < 1 || depth > MAX_DEPTH || connections < 1) {
+		printf("Between 1 and %d requests can be in flight per connection\n", MAX_DEPTH);
+		return 1;
+	}
+	clients = (Client*)calloc(connections, sizeof(Client));
+	if (clients == NULL)
+		return 1;
+
+	printf("%d connections, %d requests in flight each, %.1f s per backend\n", connections, depth, seconds);
+	printf("%-10s %12s %12s %12s %8s\n", "backend", "requests/s", "mean ms", "max ms", "errors");
+	Benchmark(WOOPSA_HOST_BACKEND_EPOLL, port, clients, connections, depth, seconds);
+	Benchmark(WOOPSA_HOST_BACKEND_IO_URING, port, clients, connections, depth, seconds);
+	free(clients);
+	return 0;
+}
@@ -0,0 +1,91 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "woopsa-host-server.h"
+
+// The demo server of DemoServer.c, serving many clients at once on Linux.
+//   gcc -O2 -I../Server -DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_TIMEOUTS -DWOOPSA_ENABLE_TRANSACTIONS -o HostDemoServer HostDemoServer.c woopsa-host-server.c ../Server/woopsa-server.c
+//   ./HostDemoServer [-p port] [-b auto|epoll|io_uring] [-c maxConnections] [-a maxConnectionsPerAddress]
+
+float Temperature = 24.2f;
+char IsRaining = 1;
+int Altitude = 430;
+float Sensitivity = 0.5f;
+char City[20] = "Geneva";
+float TimeSinceLastRain = 11;
+
+char weatherBuffer[20];
+char* GetWeather() {
+	sprintf(weatherBuffer, "sunny");
+	return weatherBuffer;
+}
+
+WOOPSA_BEGIN(woopsaEntries)
+WOOPSA_PROPERTY_READONLY(Temperature, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(IsRaining, WOOPSA_TYPE_LOGICAL)
+WOOPSA_PROPERTY(Altitude, WOOPSA_TYPE_INTEGER)
+WOOPSA_PROPERTY(Sensitivity, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(City, WOOPSA_TYPE_TEXT)
+WOOPSA_PROPERTY(TimeSinceLastRain, WOOPSA_TYPE_TIME_SPAN)
+WOOPSA_METHOD(GetWeather, WOOPSA_TYPE_TEXT)
+WOOPSA_END;
+
+#define WOOPSA_PORT 8000
+
+WoopsaHost host;
+
+void Stop(int signalNumber) {
+	host.stop = 1;
+}
+
+WoopsaUInt8 ParseBackend(const char* name) {
+	if (strcmp(name, "epoll") == 0)
+		return WOOPSA_HOST_BACKEND_EPOLL;
+	if (strcmp(name, "io_uring") == 0)
+		return WOOPSA_HOST_BACKEND_IO_URING;
+	return WOOPSA_HOST_BACKEND_AUTO;
+}
+
+int main(int argc, char* argv[]) {
+	WoopsaServer server;
+	WoopsaHostOptions options;
+	int option;
+
+	WoopsaHostOptionsInit(&options);
+	options.port = WOOPSA_PORT;
+	while ((option = getopt(argc, argv, "p:b:c:a:")) != -1) {
+		switch (option) {
+		case 'p':
+			options.port = (WoopsaUInt16)atoi(optarg);
+			break;
+		case 'b':
+			options.backend = ParseBackend(optarg);
+			break;
+		case 'c':
+			options.maxConnections = atoi(optarg);
+			break;
+		case 'a':
+			options.maxConnectionsPerAddress = atoi(optarg);
+			break;
+		default:
+			printf("Usage: %s [-p port] [-b auto|epoll|io_uring] [-c maxConnections] [-a maxConnectionsPerAddress]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	WoopsaServerInit(&server, "/woopsa/", woopsaEntries, NULL);
+	if (WoopsaHostOpen(&host, &server, &options) != 0) {
+		perror("Error opening the server");
+		return 1;
+	}
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+	printf("Server listening on port %d with %s\n", options.port, WoopsaHostBackendName(host.backend));
+
+	if (WoopsaHostRun(&host) != 0)
+		perror("Error serving clients");
+	WoopsaHostClose(&host);
+	return 0;
+}
@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "woopsa-coroutine-server.h"
+
+#define EPOLL_EVENTS 256
+#define LISTEN_BACKLOG SOMAXCONN
+// Sent to the clients over maxConnections, as by the host server
+#define REJECT_RESPONSE "HTTP/1.1 503 Service unavailable\r\nContent-Length: 0\r\nConnection: close\r\nRetry-After: 1\r\n\r\n"
+
+///////////////////////////////////////////////////////////////////////////////
+// Loop                                                                      //
+///////////////////////////////////////////////////////////////////////////////
+
+static long long NowMs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+WoopsaLoop::~WoopsaLoop() {
+	if (epoll >= 0)
+		close(epoll);
+}
+
+int WoopsaLoop::Open() {
+	epoll = epoll_create1(EPOLL_CLOEXEC);
+	return epoll < 0 ? -1 : 0;
+}
+
+WoopsaDetached WoopsaLoop::Detach(WoopsaTask<> task) {
+	co_await task;
+}
+
+void WoopsaLoop::Spawn(WoopsaTask<> task) {
+	Detach(std::move(task));
+}
+
+WoopsaLoop::ReadyAwaiter WoopsaLoop::Ready(int socket, WoopsaUInt32 events, int timeoutMs) {
+	return ReadyAwaiter(*this, socket, events, timeoutMs);
+}
+
+WoopsaLoop::ReadyAwaiter WoopsaLoop::Sleep(int milliseconds) {
+	return ReadyAwaiter(*this, -1, 0, milliseconds);
+}
+
+WoopsaLoop::ReadyAwaiter WoopsaLoop::Yield() {
+	return ReadyAwaiter(*this, -1, 0, 0);
+}
+
+// Registers the coroutine of awaiter with epoll and the timers. Sockets
+// are armed one shot at a time, so that the events of a socket nobody
+// waits for are not reported again and again.
+void WoopsaLoop::Wait(ReadyAwaiter* awaiter) {
+	struct epoll_event event;
+	awaiter->ready = false;
+	if (awaiter->socket < 0 && awaiter->timeoutMs == 0) {
+		resumable.push_back(awaiter->handle);
+		return;
+	}
+	if (awaiter->socket >= 0) {
+		if ((size_t)awaiter->socket >= waiting.size()) {
+			waiting.resize(awaiter->socket + 1, nullptr);
+			registered.resize(awaiter->socket + 1, 0);
+		}
+		waiting[awaiter->socket] = awaiter;
+		event.events = awaiter->events | EPOLLONESHOT;
+		event.data.fd = awaiter->socket;
+		if (epoll_ctl(epoll, registered[awaiter->socket] ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, awaiter->socket, &event) != 0) {
+			// Let the operation find out what is wrong with the socket
+			waiting[awaiter->socket] = nullptr;
+			awaiter->ready = true;
+			resumable.push_back(awaiter->handle);
+			return;
+		}
+		registered[awaiter->socket] = 1;
+	}
+	if (awaiter->timeoutMs >= 0) {
+		awaiter->timer = timers.emplace(NowMs() + awaiter->timeoutMs, awaiter);
+		awaiter->hasTimer = true;
+	}
+}
+
+// Resumes the coroutine of awaiter, which no longer waits for anything
+void WoopsaLoop::Wake(ReadyAwaiter* awaiter, bool ready) {
+	if (awaiter->socket >= 0)
+		waiting[awaiter->socket] = nullptr;
+	if (awaiter->hasTimer)
+		timers.erase(awaiter->timer);
+	awaiter->hasTimer = false;
+	awaiter->ready = ready;
+	awaiter->handle.resume();
+}
+
+void WoopsaLoop::Forget(int socket) {
+	if (socket < 0 || (size_t)socket >= registered.size() || !registered[socket])
+		return;
+	epoll_ctl(epoll, EPOLL_CTL_DEL, socket, NULL);
+	registered[socket] = 0;
+	waiting[socket] = nullptr;
+}
+
+int WoopsaLoop::Run() {
+	struct epoll_event events[EPOLL_EVENTS];
+	std::vector<std::coroutine_handle<>> resuming;
+	ReadyAwaiter* awaiter;
+	long long now;
+	int count, timeoutMs, i;
+	while (!stop) {
+		// Coroutines that yielded, they may yield again for the next pass
+		resuming.swap(resumable);
+		for (std::coroutine_handle<> handle : resuming)
+			handle.resume();
+		resuming.clear();
+		if (stop)
+			break;
+		timeoutMs = -1;
+		if (!resumable.empty())
+			timeoutMs = 0;
+		else if (!timers.empty())
+			timeoutMs = (int)std::max(0LL, timers.begin()->first - NowMs());
+		count = epoll_wait(epoll, events, EPOLL_EVENTS, timeoutMs);
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		for (i = 0; i < count; i++) {
+			// The socket can have been forgotten by a coroutine resumed before
+			if ((size_t)events[i].data.fd < waiting.size() && (awaiter = waiting[events[i].data.fd]) != nullptr)
+				Wake(awaiter, true);
+		}
+		now = NowMs();
+		while (!timers.empty() && timers.begin()->first <= now)
+			Wake(timers.begin()->second, false);
+	}
+	return 0;
+}
+
+// The operations try the system call first, and only wait when it
+// would block. The socket can still turn out not to be ready after a
+// wait, in which case they wait again.
+
+WoopsaTask<int> WoopsaLoop::Accept(int listenSocket) {
+	int client;
+	for (;;) {
+		client = accept4(listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (client >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+			co_return client;
+		co_await Ready(listenSocket, EPOLLIN);
+	}
+}
+
+WoopsaTask<int> WoopsaLoop::Connect(int socket, const struct sockaddr* address, socklen_t addressLength, int timeoutMs) {
+	int error = 0;
+	socklen_t errorLength = sizeof(error);
+	if (connect(socket, address, addressLength) == 0)
+		co_return 0;
+	if (errno != EINPROGRESS)
+		co_return -1;
+	if (!co_await Ready(socket, EPOLLOUT, timeoutMs)) {
+		errno = ETIMEDOUT;
+		co_return -1;
+	}
+	getsockopt(socket, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+	if (error != 0) {
+		errno = error;
+		co_return -1;
+	}
+	co_return 0;
+}
+
+WoopsaTask<ssize_t> WoopsaLoop::Receive(int socket, void* buffer, size_t length, int timeoutMs) {
+	ssize_t readBytes;
+	for (;;) {
+		readBytes = recv(socket, buffer, length, MSG_DONTWAIT);
+		if (readBytes >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+			co_return readBytes;
+		if (!co_await Ready(socket, EPOLLIN, timeoutMs)) {
+			errno = ETIMEDOUT;
+			co_return -1;
+		}
+	}
+}
+
+WoopsaTask<ssize_t> WoopsaLoop::Send(int socket, const void* data, size_t length, int timeoutMs) {
+	size_t sent = 0;
+	ssize_t sentBytes;
+	while (sent < length) {
+		sentBytes = send(socket, (const char*)data + sent, length - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (sentBytes >= 0) {
+			sent += sentBytes;
+			continue;
+		}
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			co_return -1;
+		if (!co_await Ready(socket, EPOLLOUT, timeoutMs)) {
+			errno = ETIMEDOUT;
+			co_return -1;
+		}
+	}
+	co_return (ssize_t)length;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Server                                                                    //
+///////////////////////////////////////////////////////////////////////////////
+
+int WoopsaCoroutineServer::Listen(WoopsaUInt16 port) {
+	struct sockaddr_in address;
+	int one = 1;
+	listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenSocket < 0)
+		return -1;
+	setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if (bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, LISTEN_BACKLOG) != 0) {
+		close(listenSocket);
+		listenSocket = -1;
+		return -1;
+	}
+	loop.Spawn(AcceptClients());
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	loop.Spawn(ExpireConnections());
+#endif
+	return 0;
+}
+
+WoopsaTask<> WoopsaCoroutineServer::AcceptClients() {
+	int client, one = 1;
+	for (;;) {
+		client = co_await loop.Accept(listenSocket);
+		if (client < 0) {
+			// Out of descriptors, for instance: let some clients go first
+			co_await loop.Sleep(pollIntervalMs);
+			continue;
+		}
+		if (connectionCount >= maxConnections) {
+			send(client, REJECT_RESPONSE, sizeof(REJECT_RESPONSE) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+			close(client);
+			continue;
+		}
+		// Responses are written at once, there is no point in delaying them
+		setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		connectionCount++;
+		loop.Spawn(Serve(client));
+	}
+}
+
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+// Expired connections are answered or closed by their coroutine, which
+// sees it within pollIntervalMs
+WoopsaTask<> WoopsaCoroutineServer::ExpireConnections() {
+	for (;;) {
+		co_await loop.Sleep(WOOPSA_TIMER_TICK_MS);
+		WoopsaServerExpireConnections(server);
+	}
+}
+#endif
+
+// Handles what the connection received and sends its responses, until
+// it has nothing more to do for now. Without time slicing, requests are
+// handled as soon as they are received.
+// Returns false if the client went away
+WoopsaTask<bool> WoopsaCoroutineServer::Flush(WoopsaConnection& connection, int socket) {
+	const WoopsaChar8* output;
+	WoopsaBufferSize length;
+	bool progress = true;
+	int sendTimeoutMs = -1;
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	// A client that takes nothing for that long is not waited for
+	sendTimeoutMs = WOOPSA_IDLE_TIMEOUT_MS;
+#endif
+	while (progress) {
+		progress = false;
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+		if (WoopsaConnectionStep(&connection) != 0) {
+			progress = true;
+			co_await loop.Yield();
+		}
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		// The properties are only used by the loop's thread, so the next
+		// request can already read what the previous one wrote
+		WoopsaApplyPendingWrites(connection.server);
+#endif
+		if ((length = WoopsaConnectionPollOutput(&connection, &output)) > 0) {
+			if (co_await loop.Send(socket, output, length, sendTimeoutMs) < 0)
+				co_return false;
+			// Consuming the response lets the next pipelined request be handled
+			WoopsaConnectionConsumed(&connection, length);
+			progress = true;
+		}
+	}
+	co_return true;
+}
+
+// The life of a client connection, received bytes going straight into
+// the input of the connection
+WoopsaTask<> WoopsaCoroutineServer::Serve(int socket) {
+	WoopsaConnection connection;
+	WoopsaChar8* input;
+	WoopsaBufferSize space;
+	ssize_t readBytes;
+	WoopsaConnectionInit(&connection, server);
+	while (co_await Flush(connection, socket) && !WoopsaConnectionIsClosed(&connection)) {
+		input = WoopsaConnectionInput(&connection, &space);
+		if (space == 0) {
+			// Wait for the connection to make room
+			co_await loop.Sleep(pollIntervalMs);
+			continue;
+		}
+		// Event streams and WebSocket jobs produce output without receiving
+		// anything, they are polled when nothing is received for a while
+		readBytes = co_await loop.Receive(socket, input, space, pollIntervalMs);
+		if (readBytes < 0 && errno == ETIMEDOUT)
+			continue;
+		if (readBytes <= 0)
+			break;
+		WoopsaConnectionReceived(&connection, (WoopsaBufferSize)readBytes);
+	}
+	WoopsaConnectionClose(&connection);
+	loop.Forget(socket);
+	close(socket);
+	connectionCount--;
+}
@@ -0,0 +1,277 @@
+#ifndef __WOOPSA_COROUTINE_SERVER_H_
+#define __WOOPSA_COROUTINE_SERVER_H_
+
+// C++20 layer for Linux hosts written in C++: an epoll loop running
+// coroutines, where every client connection is a coroutine instead of a
+// thread, and methods can be coroutines that co_await I/O while the other
+// clients are served. Requests are still handled by WoopsaConnection.
+// Build the embedded server as C, with the same features, for example:
+//   FLAGS="-DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_TIMEOUTS -DWOOPSA_ENABLE_ASYNC_METHODS"
+//   gcc -O2 -I../Server $FLAGS -c ../Server/woopsa-server.c
+//   g++ -std=c++20 -O2 -I../Server $FLAGS CoroutineDemoServer.cpp woopsa-coroutine-server.cpp woopsa-server.o
+
+#if !defined(__cplusplus) || __cplusplus < 202002L
+#error "woopsa-coroutine-server.h needs C++20"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <map>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include "woopsa-server.h"
+
+#ifndef WOOPSA_ENABLE_CONNECTIONS
+#error "The coroutine server needs WOOPSA_ENABLE_CONNECTIONS in woopsa-config.h"
+#endif
+
+// What a coroutine returns, kept until the coroutine awaiting it resumes
+template<typename T> struct WoopsaTaskResult {
+	std::optional<T> value;
+	void return_value(T result) { value.emplace(std::move(result)); }
+	T Take() { return std::move(*value); }
+};
+
+template<> struct WoopsaTaskResult<void> {
+	void return_void() {}
+	void Take() {}
+};
+
+// A coroutine that starts when it is awaited, and resumes the coroutine
+// awaiting it once it returns. Woopsa does not use exceptions, one thrown
+// by a coroutine terminates the program.
+template<typename T = void> class WoopsaTask {
+public:
+	struct promise_type : WoopsaTaskResult<T> {
+		std::coroutine_handle<> caller;
+		WoopsaTask get_return_object() { return WoopsaTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		struct FinalAwaiter {
+			bool await_ready() noexcept { return false; }
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept { return handle.promise().caller; }
+			void await_resume() noexcept {}
+		};
+		FinalAwaiter final_suspend() noexcept { return {}; }
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	WoopsaTask(WoopsaTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+	WoopsaTask(const WoopsaTask&) = delete;
+	WoopsaTask& operator=(const WoopsaTask&) = delete;
+	~WoopsaTask() {
+		if (handle)
+			handle.destroy();
+	}
+
+	bool await_ready() const noexcept { return false; }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+		handle.promise().caller = caller;
+		return handle;
+	}
+	T await_resume() { return handle.promise().Take(); }
+
+private:
+	explicit WoopsaTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+	std::coroutine_handle<promise_type> handle;
+};
+
+// A coroutine that runs on its own as soon as it is called, and frees
+// itself when it returns
+struct WoopsaDetached {
+	struct promise_type {
+		WoopsaDetached get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+// Runs coroutines on one thread: they are resumed when the socket they
+// wait for is ready, or when their time is up. Sockets must be
+// non-blocking. The operations return like the system calls they wrap,
+// -1 with errno set on errors, and ETIMEDOUT once timeoutMs elapsed
+// (-1 waits as long as needed).
+class WoopsaLoop {
+public:
+	// Set it (from a signal handler for instance) to return from Run
+	volatile int stop = 0;
+
+	WoopsaLoop() = default;
+	WoopsaLoop(const WoopsaLoop&) = delete;
+	WoopsaLoop& operator=(const WoopsaLoop&) = delete;
+	~WoopsaLoop();
+
+	// Returns 0, or -1 with errno set
+	int Open();
+
+	// Resumes the coroutines until stop is set. The ones still waiting
+	// then are left as they are, the loop is meant to run as long as
+	// the process.
+	// Returns 0, or -1 with errno set
+	int Run();
+
+	// Runs task until its first co_await, then along the others
+	void Spawn(WoopsaTask<> task);
+
+	// Resumes once the socket has the epoll events (EPOLLIN, EPOLLOUT)
+	// Returns false if timeoutMs elapsed first
+	class ReadyAwaiter;
+	ReadyAwaiter Ready(int socket, WoopsaUInt32 events, int timeoutMs = -1);
+
+	// Resumes after milliseconds
+	ReadyAwaiter Sleep(int milliseconds);
+
+	// Lets the other coroutines run before resuming
+	ReadyAwaiter Yield();
+
+	// Returns the socket of the next client of a listening socket
+	WoopsaTask<int> Accept(int listenSocket);
+
+	// Connects a socket, for methods talking to other devices
+	// Returns 0, or -1 with errno set
+	WoopsaTask<int> Connect(int socket, const struct sockaddr* address, socklen_t addressLength, int timeoutMs = -1);
+
+	// Returns the number of bytes received, 0 once the peer closed
+	WoopsaTask<ssize_t> Receive(int socket, void* buffer, size_t length, int timeoutMs = -1);
+
+	// Sends all the bytes, or fails
+	// Returns length, or -1 with errno set
+	WoopsaTask<ssize_t> Send(int socket, const void* data, size_t length, int timeoutMs = -1);
+
+	// Must be called before a socket that was awaited is closed
+	void Forget(int socket);
+
+private:
+	typedef std::multimap<long long, ReadyAwaiter*> Timers;
+
+	void Wait(ReadyAwaiter* awaiter);
+	void Wake(ReadyAwaiter* awaiter, bool ready);
+	static WoopsaDetached Detach(WoopsaTask<> task);
+
+	int epoll = -1;
+	// The coroutine waiting for each socket, by descriptor
+	std::vector<ReadyAwaiter*> waiting;
+	// Whether the socket was added to epoll
+	std::vector<WoopsaUInt8> registered;
+	Timers timers;
+	// Coroutines to resume on the next pass
+	std::vector<std::coroutine_handle<>> resumable;
+};
+
+class WoopsaLoop::ReadyAwaiter {
+public:
+	ReadyAwaiter(WoopsaLoop& loop, int socket, WoopsaUInt32 events, int timeoutMs) :
+		loop(loop), socket(socket), events(events), timeoutMs(timeoutMs) {}
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) {
+		this->handle = handle;
+		loop.Wait(this);
+	}
+	bool await_resume() const noexcept { return ready; }
+
+private:
+	friend class WoopsaLoop;
+	WoopsaLoop& loop;
+	// -1 to only wait for the time
+	int socket;
+	WoopsaUInt32 events;
+	// 0 resumes on the next pass of the loop
+	int timeoutMs;
+	bool ready = false;
+	bool hasTimer = false;
+	WoopsaLoop::Timers::iterator timer;
+	std::coroutine_handle<> handle;
+};
+
+// Serves the clients of a WoopsaServer with a coroutine per connection.
+// A connection with a long response (meta serialized a few entries at a
+// time with WOOPSA_ENABLE_TIME_SLICING) yields between steps, so the
+// others are not held up.
+class WoopsaCoroutineServer {
+public:
+	// Clients served at the same time, the next ones are answered 503 and closed
+	int maxConnections = 256;
+	// How often idle connections look for events and finished jobs
+	int pollIntervalMs = 100;
+
+	WoopsaCoroutineServer(WoopsaLoop& loop, WoopsaServer* server) : loop(loop), server(server) {}
+	WoopsaCoroutineServer(const WoopsaCoroutineServer&) = delete;
+	WoopsaCoroutineServer& operator=(const WoopsaCoroutineServer&) = delete;
+
+	// Listens on port, clients are accepted once the loop runs
+	// Returns 0, or -1 with errno set
+	int Listen(WoopsaUInt16 port);
+
+	int ConnectionCount() const { return connectionCount; }
+
+private:
+	WoopsaTask<> AcceptClients();
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	WoopsaTask<> ExpireConnections();
+#endif
+	WoopsaTask<> Serve(int socket);
+	WoopsaTask<bool> Flush(WoopsaConnection& connection, int socket);
+
+	WoopsaLoop& loop;
+	WoopsaServer* server;
+	int listenSocket = -1;
+	int connectionCount = 0;
+};
+
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+// Completes a job with what a coroutine method returned: a number, a
+// logical, a text, or an empty optional when it failed. Numbers keep
+// their size and sign, like the variables of WOOPSA_PROPERTY.
+template<typename T> requires std::is_arithmetic_v<T> void WoopsaJobCompleteWith(WoopsaJob* job, T value) {
+	if constexpr (std::is_same_v<T, bool>) {
+		WoopsaUInt8 logical = value;
+		WoopsaJobCompleteStored(job, WOOPSA_STORAGE_BOOL, &logical);
+	} else if constexpr (std::is_same_v<T, float>) {
+		WoopsaJobCompleteStored(job, WOOPSA_STORAGE_FLOAT, &value);
+	} else if constexpr (std::is_floating_point_v<T>) {
+		double real = value;
+		WoopsaJobCompleteStored(job, WOOPSA_STORAGE_DOUBLE, &real);
+	} else {
+		WoopsaJobCompleteStored(job, WOOPSA_INTEGER_STORAGE(sizeof(T), std::is_signed_v<T> ? WOOPSA_STORAGE_INT8 : WOOPSA_STORAGE_UINT8), &value);
+	}
+}
+inline void WoopsaJobCompleteWith(WoopsaJob* job, const char* value) { WoopsaJobComplete(job, value); }
+inline void WoopsaJobCompleteWith(WoopsaJob* job, const std::string& value) { WoopsaJobComplete(job, value.c_str()); }
+template<typename T> void WoopsaJobCompleteWith(WoopsaJob* job, const std::optional<T>& value) {
+	if (value)
+		WoopsaJobCompleteWith(job, *value);
+	else
+		WoopsaJobFail(job);
+}
+
+template<typename T> WoopsaDetached WoopsaRunJob(WoopsaJob* job, WoopsaTask<T> task) {
+	if constexpr (std::is_void_v<T>) {
+		co_await task;
+		WoopsaJobComplete(job, NULL);
+	} else {
+		WoopsaJobCompleteWith(job, co_await task);
+	}
+}
+
+// The asynchronous method given to the server for a coroutine method
+template<auto method> void WoopsaCoroutineMethod(WoopsaJob* job) {
+	WoopsaRunJob(job, method());
+}
+
+// Publishes a coroutine WoopsaTask<T> method() as an asynchronous method
+// (see WOOPSA_METHOD_ASYNC): the job is completed when the coroutine
+// returns, whatever it awaited in between
+#define WOOPSA_METHOD_COROUTINE(method, returnType) \
+{#method, { (void*)&WoopsaCoroutineMethod<method> }, returnType, 0, WOOPSA_ASYNC_METHOD, 0, 0, 0 WOOPSA_STRUCT_TABLES_INIT },
+
+#define WOOPSA_METHOD_COROUTINE_VOID(method) \
+	WOOPSA_METHOD_COROUTINE(method, WOOPSA_TYPE_NULL)
+#endif
+
+#endif
@@ -0,0 +1,960 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/io_uring.h>
+#include "woopsa-host-server.h"
+
+#define DEFAULT_PORT 80
+#define DEFAULT_MAX_CONNECTIONS 256
+#define DEFAULT_POLL_INTERVAL_MS 100
+#define LISTEN_BACKLOG SOMAXCONN
+#define NO_CONNECTION -1
+
+// Answer to the clients over the limits, sent without waiting
+#define REJECT_RESPONSE "HTTP/1.1 503 Service unavailable\r\nContent-Length: 0\r\nConnection: close\r\nRetry-After: 1\r\n\r\n"
+
+#define EPOLL_EVENTS 256
+// epoll data of the listening socket, the others carry their connection index
+#define EPOLL_LISTEN_TAG 0xFFFFFFFFu
+
+#define URING_ENTRIES 1024
+// io_uring user data: the operation in the low byte, the connection above
+#define URING_ACCEPT 1
+#define URING_RECEIVE 2
+#define URING_SEND 3
+#define URING_TIMEOUT 4
+#define URING_USER_DATA(operation, index) (((__u64)(index) << 8) | (operation))
+#define URING_OPERATION(userData) ((int)((userData) & 0xFF))
+#define URING_INDEX(userData) ((int)((userData) >> 8))
+#define URING_BUFFER_GROUP 0
+
+struct WoopsaHostConnection {
+	WoopsaConnection connection;
+	// -1 when the connection is free
+	int socket;
+	// IPv4 address of the client, in network order
+	WoopsaUInt32 address;
+	// Next free connection, while this one is free
+	int nextFree;
+	// Received bytes the connection could not take yet
+	WoopsaChar8 backlog[WOOPSA_HOST_BACKLOG_SIZE];
+	WoopsaBufferSize backlogLength;
+	// Responses gathered for sending, of which sendOffset bytes are sent
+	WoopsaChar8* send;
+	int sendLength;
+	int sendOffset;
+	// The socket is being closed
+	WoopsaUInt8 closing;
+	// io_uring operations in flight
+	WoopsaUInt8 receiving;
+	WoopsaUInt8 sending;
+	// Events epoll waits for
+	WoopsaUInt32 events;
+};
+
+typedef struct {
+	int ring;
+	// Submission queue, shared with the kernel
+	unsigned* sqHead;
+	unsigned* sqTail;
+	unsigned sqMask;
+	unsigned sqEntries;
+	struct io_uring_sqe* sqes;
+	// Entries filled but not submitted yet
+	unsigned sqPending;
+	// Completion queue, shared with the kernel
+	unsigned* cqHead;
+	unsigned* cqTail;
+	unsigned cqMask;
+	struct io_uring_cqe* cqes;
+	void* sqRing;
+	size_t sqRingSize;
+	void* cqRing;
+	size_t cqRingSize;
+	size_t sqesSize;
+	// Provided buffers the kernel receives into, and their ring
+	struct io_uring_buf_ring* bufferRing;
+	size_t bufferRingSize;
+	WoopsaChar8* receiveBuffers;
+	unsigned short bufferTail;
+	// Features found at run time, older kernels lack some of them
+	WoopsaUInt8 hasFixedBuffers;
+	WoopsaUInt8 hasMultishotAccept;
+	WoopsaUInt8 hasMultishotReceive;
+	WoopsaUInt8 acceptPending;
+	struct __kernel_timespec pollInterval;
+} UringState;
+
+// Connections from one client address. Entries with no connection are
+// free, the table has room for twice maxConnections addresses.
+struct WoopsaHostAddress {
+	WoopsaUInt32 address;
+	int count;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Client addresses                                                          //
+///////////////////////////////////////////////////////////////////////////////
+// Open addressing with linear probing: an address is in the first entry
+// from its hash that holds it or is free, so that counting a connection
+// is a hash and a few comparisons however many clients there are.
+
+WoopsaUInt32 HashAddress(WoopsaUInt32 address) {
+	address ^= address >> 16;
+	address *= 0x45D9F3Bu;
+	address ^= address >> 16;
+	return address;
+}
+
+// Returns the entry of address, or the free entry where it would go
+WoopsaHostAddress* FindAddress(WoopsaHost* host, WoopsaUInt32 address) {
+	WoopsaUInt32 i = HashAddress(address) & host->addressMask;
+	while (host->addresses[i].count != 0 && host->addresses[i].address != address)
+		i = (i + 1) & host->addressMask;
+	return &host->addresses[i];
+}
+
+// Frees the entry at i, moving back the entries after it that could not
+// take their own place, so that no search stops short of them
+void RemoveAddress(WoopsaHost* host, WoopsaUInt32 i) {
+	WoopsaUInt32 j = i, home;
+	for (;;) {
+		j = (j + 1) & host->addressMask;
+		if (host->addresses[j].count == 0)
+			break;
+		home = HashAddress(host->addresses[j].address) & host->addressMask;
+		// Entries between their home and i stay where they are
+		if (((j - home) & host->addressMask) < ((j - i) & host->addressMask))
+			continue;
+		host->addresses[i] = host->addresses[j];
+		i = j;
+	}
+	host->addresses[i].count = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Connections shared by the backends                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+// Takes the client of socket if the limits allow it: otherwise it is
+// answered 503 and closed at once, without waiting for it to read
+// Returns its connection, or NULL if it was turned away
+WoopsaHostConnection* OpenConnection(WoopsaHost* host, int socket) {
+	WoopsaHostConnection* connection;
+	WoopsaHostAddress* entry = NULL;
+	struct sockaddr_in peer;
+	socklen_t peerLength = sizeof(peer);
+	int one = 1;
+	if (host->freeConnection != NO_CONNECTION && host->addresses != NULL) {
+		if (getpeername(socket, (struct sockaddr*)&peer, &peerLength) == 0 && peer.sin_family == AF_INET) {
+			entry = FindAddress(host, peer.sin_addr.s_addr);
+			if (entry->count >= host->options.maxConnectionsPerAddress)
+				entry = NULL;
+			else
+				entry->address = peer.sin_addr.s_addr;
+		}
+	}
+	if (host->freeConnection == NO_CONNECTION || (host->addresses != NULL && entry == NULL)) {
+		send(socket, REJECT_RESPONSE, sizeof(REJECT_RESPONSE) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+		close(socket);
+		return NULL;
+	}
+	connection = &host->connections[host->freeConnection];
+	if (entry != NULL) {
+		entry->count++;
+		connection->address = entry->address;
+	}
+	host->freeConnection = connection->nextFree;
+	host->connectionCount++;
+	// Responses are written at once, there is no point in delaying them
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	WoopsaConnectionInit(&connection->connection, host->server);
+	connection->socket = socket;
+	connection->backlogLength = 0;
+	connection->sendLength = 0;
+	connection->sendOffset = 0;
+	connection->closing = 0;
+	connection->receiving = 0;
+	connection->sending = 0;
+	connection->events = 0;
+	return connection;
+}
+
+// Closes the socket and makes the connection available again
+void ReleaseConnection(WoopsaHost* host, WoopsaHostConnection* connection) {
+	WoopsaHostAddress* entry;
+	WoopsaConnectionClose(&connection->connection);
+	if (host->addresses != NULL) {
+		entry = FindAddress(host, connection->address);
+		if (--entry->count == 0)
+			RemoveAddress(host, (WoopsaUInt32)(entry - host->addresses));
+	}
+	close(connection->socket);
+	connection->socket = -1;
+	connection->nextFree = host->freeConnection;
+	host->freeConnection = (int)(connection - host->connections);
+	host->connectionCount--;
+}
+
+// Moves what can be moved through the connection: the received bytes
+// it can take go in, and its responses are gathered in the send buffer.
+// With sendsDirectly, a response that nothing precedes or follows is
+// left in the connection, to be sent from there without a copy.
+void PumpConnection(WoopsaHostConnection* connection, WoopsaUInt8 sendsDirectly) {
+	const WoopsaChar8* output;
+	WoopsaBufferSize length;
+	WoopsaUInt8 progress = 1;
+	while (progress && !connection->closing) {
+		progress = 0;
+		if (connection->backlogLength > 0) {
+			length = WoopsaConnectionFeed(&connection->connection, connection->backlog, connection->backlogLength);
+			if (length > 0) {
+				connection->backlogLength -= length;
+				memmove(connection->backlog, connection->backlog + length, connection->backlogLength);
+				progress = 1;
+			}
+		}
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+		// There is no control loop to keep responsive here
+		if (WoopsaConnectionStep(&connection->connection) != 0)
+			progress = 1;
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+		// The properties are only used by this thread, so the next request
+		// can already read what the previous one wrote
+		WoopsaApplyPendingWrites(connection->connection.server);
+#endif
+		length = WoopsaConnectionPollOutput(&connection->connection, &output);
+		if (length > 0 && sendsDirectly && connection->sendLength == 0 && connection->backlogLength == 0 && connection->connection.inputLength == 0)
+			break;
+		if (length > WOOPSA_HOST_SEND_SIZE - connection->sendLength)
+			length = WOOPSA_HOST_SEND_SIZE - connection->sendLength;
+		if (length > 0) {
+			memcpy(connection->send + connection->sendLength, output, length);
+			connection->sendLength += length;
+			// Consuming the response lets the next pipelined request be handled
+			WoopsaConnectionConsumed(&connection->connection, length);
+			progress = 1;
+		}
+	}
+}
+
+// Keeps the bytes that are still to be sent at the start of the send
+// buffer, to make room for the next responses
+void CompactSendBuffer(WoopsaHostConnection* connection) {
+	connection->sendLength -= connection->sendOffset;
+	memmove(connection->send, connection->send + connection->sendOffset, connection->sendLength);
+	connection->sendOffset = 0;
+}
+
+// Returns 1 once everything was sent and the connection asks to be
+// closed, or once the client is too slow to take the rest
+WoopsaUInt8 ConnectionIsDone(WoopsaHostConnection* connection) {
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	if (WoopsaConnectionExpired(&connection->connection))
+		return 1;
+#endif
+	return connection->sendOffset == connection->sendLength && WoopsaConnectionIsClosed(&connection->connection);
+}
+
+// Monotonic clock of the poll interval
+WoopsaUInt32 HostMilliseconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (WoopsaUInt32)now.tv_sec * 1000 + (WoopsaUInt32)(now.tv_nsec / 1000000);
+}
+
+// Returns a non-blocking socket listening on port, or -1
+int OpenListenSocket(WoopsaUInt16 port) {
+	struct sockaddr_in address;
+	int one = 1;
+	int listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenSocket < 0)
+		return -1;
+	setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if (bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, LISTEN_BACKLOG) != 0) {
+		close(listenSocket);
+		return -1;
+	}
+	return listenSocket;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// epoll backend                                                             //
+///////////////////////////////////////////////////////////////////////////////
+
+// Waits for what the connection needs: input while its backlog has room,
+// and output while responses could not be sent entirely
+void UpdateEpollEvents(WoopsaHost* host, WoopsaHostConnection* connection) {
+	struct epoll_event event;
+	WoopsaUInt32 events = 0;
+	if (connection->backlogLength < WOOPSA_HOST_BACKLOG_SIZE)
+		events |= EPOLLIN;
+	if (connection->sendOffset < connection->sendLength || connection->connection.outputSent < connection->connection.outputLength)
+		events |= EPOLLOUT;
+	if (events == connection->events)
+		return;
+	connection->events = events;
+	event.events = events;
+	event.data.u32 = (WoopsaUInt32)(connection - host->connections);
+	epoll_ctl(*(int*)host->backendState, EPOLL_CTL_MOD, connection->socket, &event);
+}
+
+// Sends the gathered responses, and gathers the next ones, until
+// the socket would block. A response alone is sent from the connection.
+// Returns 0, or -1 if the client went away
+int SendEpoll(WoopsaHostConnection* connection) {
+	const WoopsaChar8* output;
+	WoopsaBufferSize length;
+	ssize_t sentBytes;
+	for (;;) {
+		PumpConnection(connection, 1);
+		if (connection->sendOffset < connection->sendLength) {
+			sentBytes = send(connection->socket, connection->send + connection->sendOffset,
+				connection->sendLength - connection->sendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if (sentBytes < 0)
+				return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+			connection->sendOffset += (int)sentBytes;
+			CompactSendBuffer(connection);
+		} else {
+			length = WoopsaConnectionPollOutput(&connection->connection, &output);
+			if (length == 0)
+				return 0;
+			sentBytes = send(connection->socket, output, length, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if (sentBytes < 0)
+				return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+			WoopsaConnectionConsumed(&connection->connection, (WoopsaBufferSize)sentBytes);
+		}
+	}
+}
+
+// Receives once, the socket is level-triggered. While the backlog is
+// empty, the bytes go straight in the connection, and the backlog only
+// takes those it has no room for.
+// Returns 0, or -1 if the client went away
+int ReceiveEpoll(WoopsaHostConnection* connection) {
+	struct iovec buffers[2];
+	WoopsaBufferSize space = 0;
+	ssize_t readBytes;
+	buffers[0].iov_base = NULL;
+	if (connection->backlogLength == 0)
+		buffers[0].iov_base = WoopsaConnectionInput(&connection->connection, &space);
+	buffers[0].iov_len = space;
+	buffers[1].iov_base = connection->backlog + connection->backlogLength;
+	buffers[1].iov_len = WOOPSA_HOST_BACKLOG_SIZE - connection->backlogLength;
+	readBytes = readv(connection->socket, space > 0 ? buffers : buffers + 1, space > 0 ? 2 : 1);
+	if (readBytes < 0)
+		return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+	if (readBytes == 0)
+		return -1;
+	if (readBytes > (ssize_t)space) {
+		connection->backlogLength += (WoopsaBufferSize)(readBytes - (ssize_t)space);
+		readBytes = (ssize_t)space;
+	}
+	if (readBytes > 0)
+		WoopsaConnectionReceived(&connection->connection, (WoopsaBufferSize)readBytes);
+	return 0;
+}
+
+void AcceptEpoll(WoopsaHost* host) {
+	WoopsaHostConnection* connection;
+	struct epoll_event event;
+	int clientSocket;
+	while ((clientSocket = accept4(host->listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+		connection = OpenConnection(host, clientSocket);
+		if (connection == NULL)
+			continue;
+		connection->events = EPOLLIN;
+		event.events = EPOLLIN;
+		event.data.u32 = (WoopsaUInt32)(connection - host->connections);
+		if (epoll_ctl(*(int*)host->backendState, EPOLL_CTL_ADD, clientSocket, &event) != 0)
+			ReleaseConnection(host, connection);
+	}
+}
+
+// Handles what happened on a connection, and closes it when it is done
+void ServeEpoll(WoopsaHost* host, WoopsaHostConnection* connection, WoopsaUInt32 events) {
+	int result = 0;
+	if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+		result = ReceiveEpoll(connection);
+	if (result == 0)
+		result = SendEpoll(connection);
+	if (result != 0 || ConnectionIsDone(connection))
+		ReleaseConnection(host, connection);
+	else
+		UpdateEpollEvents(host, connection);
+}
+
+int OpenEpoll(WoopsaHost* host) {
+	struct epoll_event event;
+	int* epoll = (int*)malloc(sizeof(int));
+	if (epoll == NULL)
+		return -1;
+	*epoll = epoll_create1(EPOLL_CLOEXEC);
+	event.events = EPOLLIN;
+	event.data.u32 = EPOLL_LISTEN_TAG;
+	if (*epoll < 0 || epoll_ctl(*epoll, EPOLL_CTL_ADD, host->listenSocket, &event) != 0) {
+		if (*epoll >= 0)
+			close(*epoll);
+		free(epoll);
+		return -1;
+	}
+	host->backendState = epoll;
+	return 0;
+}
+
+int RunEpoll(WoopsaHost* host) {
+	struct epoll_event events[EPOLL_EVENTS];
+	WoopsaUInt32 interval = (WoopsaUInt32)host->options.pollIntervalMs;
+	WoopsaUInt32 lastSweep = HostMilliseconds(), elapsed;
+	int count, i;
+	while (!host->stop) {
+		elapsed = HostMilliseconds() - lastSweep;
+		count = epoll_wait(*(int*)host->backendState, events, EPOLL_EVENTS, elapsed < interval ? (int)(interval - elapsed) : 0);
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		for (i = 0; i < count; i++) {
+			if (events[i].data.u32 == EPOLL_LISTEN_TAG)
+				AcceptEpoll(host);
+			else if (host->connections[events[i].data.u32].socket >= 0)
+				ServeEpoll(host, &host->connections[events[i].data.u32], events[i].events);
+		}
+		// The other work is done once per poll interval, however many
+		// events woke the loop up in between
+		if (HostMilliseconds() - lastSweep < interval)
+			continue;
+		lastSweep = HostMilliseconds();
+		if (host->options.tick != NULL)
+			host->options.tick();
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+		WoopsaServerExpireConnections(host->server);
+#endif
+		// Event streams produce output without receiving anything, and
+		// expired connections are answered or closed
+		for (i = 0; i < host->options.maxConnections; i++)
+			if (host->connections[i].socket >= 0)
+				ServeEpoll(host, &host->connections[i], 0);
+	}
+	return 0;
+}
+
+void CloseEpoll(WoopsaHost* host) {
+	close(*(int*)host->backendState);
+	free(host->backendState);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// io_uring backend                                                          //
+///////////////////////////////////////////////////////////////////////////////
+// liburing is not needed, the three system calls are used directly.
+// Clients are accepted by one multishot accept, each one has a multishot
+// receive into buffers provided to the kernel, and the responses gathered
+// while handling completions are sent by the same io_uring_enter call
+// that waits for the next ones, as writes from registered buffers.
+
+int UringSetup(unsigned entries, struct io_uring_params* params) {
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+int UringEnter(int ring, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+	return (int)syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, NULL, 0);
+}
+
+int UringRegister(int ring, unsigned opcode, void* argument, unsigned count) {
+	return (int)syscall(__NR_io_uring_register, ring, opcode, argument, count);
+}
+
+// Submits the filled entries without waiting
+void UringSubmit(UringState* uring) {
+	int submitted;
+	while (uring->sqPending > 0) {
+		submitted = UringEnter(uring->ring, uring->sqPending, 0, 0);
+		if (submitted < 0) {
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+		uring->sqPending -= submitted;
+		// The completion queue is full, the entries are submitted once it is read
+		if (submitted == 0)
+			return;
+	}
+}
+
+// Returns a cleared submission entry, submitting the previous ones
+// if the queue is full
+struct io_uring_sqe* UringGetEntry(UringState* uring) {
+	struct io_uring_sqe* entry;
+	unsigned tail = *uring->sqTail;
+	if (tail - __atomic_load_n(uring->sqHead, __ATOMIC_ACQUIRE) >= uring->sqEntries) {
+		UringSubmit(uring);
+		if (tail - __atomic_load_n(uring->sqHead, __ATOMIC_ACQUIRE) >= uring->sqEntries)
+			return NULL;
+	}
+	entry = &uring->sqes[tail & uring->sqMask];
+	memset(entry, 0, sizeof(struct io_uring_sqe));
+	// The array maps every slot to the entry of the same index, only the tail moves
+	__atomic_store_n(uring->sqTail, tail + 1, __ATOMIC_RELEASE);
+	uring->sqPending++;
+	return entry;
+}
+
+// Gives a receive buffer back to the kernel
+void UringProvideBuffer(UringState* uring, unsigned short bufferId) {
+	struct io_uring_buf* buffer = &uring->bufferRing->bufs[uring->bufferTail & (WOOPSA_HOST_RECEIVE_BUFFERS - 1)];
+	buffer->addr = (__u64)(unsigned long)(uring->receiveBuffers + (size_t)bufferId * WOOPSA_HOST_RECEIVE_SIZE);
+	buffer->len = WOOPSA_HOST_RECEIVE_SIZE;
+	buffer->bid = bufferId;
+	uring->bufferTail++;
+	__atomic_store_n(&uring->bufferRing->tail, uring->bufferTail, __ATOMIC_RELEASE);
+}
+
+void UringAccept(WoopsaHost* host, UringState* uring) {
+	struct io_uring_sqe* entry = UringGetEntry(uring);
+	if (entry == NULL)
+		return;
+	entry->opcode = IORING_OP_ACCEPT;
+	entry->fd = host->listenSocket;
+	entry->accept_flags = SOCK_CLOEXEC;
+	if (uring->hasMultishotAccept)
+		entry->ioprio = IORING_ACCEPT_MULTISHOT;
+	entry->user_data = URING_USER_DATA(URING_ACCEPT, 0);
+	uring->acceptPending = 1;
+}
+
+void UringReceive(WoopsaHost* host, UringState* uring, WoopsaHostConnection* connection) {
+	struct io_uring_sqe* entry = UringGetEntry(uring);
+	if (entry == NULL)
+		return;
+	entry->opcode = IORING_OP_RECV;
+	entry->fd = connection->socket;
+	// The kernel picks a buffer of the group when data arrives
+	entry->flags = IOSQE_BUFFER_SELECT;
+	entry->buf_group = URING_BUFFER_GROUP;
+	if (uring->hasMultishotReceive)
+		entry->ioprio = IORING_RECV_MULTISHOT;
+	entry->user_data = URING_USER_DATA(URING_RECEIVE, connection - host->connections);
+	connection->receiving = 1;
+}
+
+// Sends the gathered responses, unless a send is already in flight
+void UringSend(WoopsaHost* host, UringState* uring, WoopsaHostConnection* connection) {
+	struct io_uring_sqe* entry;
+	if (connection->sending || connection->closing || connection->sendOffset == connection->sendLength)
+		return;
+	entry = UringGetEntry(uring);
+	if (entry == NULL)
+		return;
+	entry->fd = connection->socket;
+	entry->addr = (__u64)(unsigned long)(connection->send + connection->sendOffset);
+	entry->len = connection->sendLength - connection->sendOffset;
+	if (uring->hasFixedBuffers) {
+		// The send buffers of all the connections are registered as buffer 0
+		entry->opcode = IORING_OP_WRITE_FIXED;
+		entry->buf_index = 0;
+		entry->off = (__u64)-1;
+	} else {
+		entry->opcode = IORING_OP_SEND;
+		entry->msg_flags = MSG_NOSIGNAL;
+	}
+	entry->user_data = URING_USER_DATA(URING_SEND, connection - host->connections);
+	connection->sending = 1;
+}
+
+void UringTimeout(UringState* uring) {
+	struct io_uring_sqe* entry = UringGetEntry(uring);
+	if (entry == NULL)
+		return;
+	entry->opcode = IORING_OP_TIMEOUT;
+	entry->addr = (__u64)(unsigned long)&uring->pollInterval;
+	entry->len = 1;
+	entry->user_data = URING_USER_DATA(URING_TIMEOUT, 0);
+}
+
+// Shuts the socket down, which ends its receive. The connection is
+// released once no operation uses it anymore.
+void UringClose(WoopsaHost* host, WoopsaHostConnection* connection) {
+	if (!connection->closing) {
+		connection->closing = 1;
+		shutdown(connection->socket, SHUT_RDWR);
+	}
+	if (!connection->receiving && !connection->sending)
+		ReleaseConnection(host, connection);
+}
+
+// Gathers the responses of the connection and sends them, or closes
+// the connection when it is done
+void UringServe(WoopsaHost* host, UringState* uring, WoopsaHostConnection* connection) {
+	if (!connection->closing) {
+		if (!connection->sending && connection->sendOffset > 0)
+			CompactSendBuffer(connection);
+		PumpConnection(connection, 0);
+		if (ConnectionIsDone(connection))
+			UringClose(host, connection);
+		else
+			UringSend(host, uring, connection);
+	} else {
+		UringClose(host, connection);
+	}
+}
+
+void UringAccepted(WoopsaHost* host, UringState* uring, struct io_uring_cqe* completion) {
+	WoopsaHostConnection* connection;
+	if (!(completion->flags & IORING_CQE_F_MORE)) {
+		uring->acceptPending = 0;
+		// Kernels before 5.19 do not know multishot accepts
+		if (completion->res == -EINVAL && uring->hasMultishotAccept)
+			uring->hasMultishotAccept = 0;
+	}
+	if (completion->res >= 0) {
+		connection = OpenConnection(host, completion->res);
+		if (connection != NULL)
+			UringReceive(host, uring, connection);
+	}
+	if (!uring->acceptPending && !host->stop)
+		UringAccept(host, uring);
+}
+
+void UringReceived(WoopsaHost* host, UringState* uring, WoopsaHostConnection* connection, struct io_uring_cqe* completion) {
+	const WoopsaChar8* data;
+	WoopsaBufferSize length, taken;
+	unsigned short bufferId;
+	WoopsaUInt8 isReceiving = (completion->flags & IORING_CQE_F_MORE) != 0;
+	if (!isReceiving)
+		connection->receiving = 0;
+	if (completion->flags & IORING_CQE_F_BUFFER) {
+		bufferId = (unsigned short)(completion->flags >> IORING_CQE_BUFFER_SHIFT);
+		if (completion->res > 0 && !connection->closing) {
+			data = uring->receiveBuffers + (size_t)bufferId * WOOPSA_HOST_RECEIVE_SIZE;
+			length = (WoopsaBufferSize)completion->res;
+			// While nothing waits before them, the bytes go straight to the connection
+			if (connection->backlogLength == 0) {
+				taken = WoopsaConnectionFeed(&connection->connection, data, length);
+				data += taken;
+				length -= taken;
+			}
+			// Make room for the rest, by giving the backlog to the connection
+			if (length > WOOPSA_HOST_BACKLOG_SIZE - connection->backlogLength)
+				PumpConnection(connection, 0);
+			// A client that sends more than that without reading its responses is cut
+			if (length > WOOPSA_HOST_BACKLOG_SIZE - connection->backlogLength) {
+				completion->res = -ENOSPC;
+			} else {
+				memcpy(connection->backlog + connection->backlogLength, data, length);
+				connection->backlogLength += length;
+			}
+		}
+		UringProvideBuffer(uring, bufferId);
+	}
+	if (completion->res == -EINVAL && uring->hasMultishotReceive && !isReceiving) {
+		// Multishot receives came with Linux 6.0
+		uring->hasMultishotReceive = 0;
+		completion->res = -ENOBUFS;
+	}
+	if (completion->res > 0 || completion->res == -ENOBUFS) {
+		// Out of buffers: the ones just given back are used for the next try
+		if (!connection->receiving && !connection->closing)
+			UringReceive(host, uring, connection);
+		UringServe(host, uring, connection);
+	} else {
+		UringClose(host, connection);
+	}
+}
+
+void UringSent(WoopsaHost* host, UringState* uring, WoopsaHostConnection* connection, struct io_uring_cqe* completion) {
+	connection->sending = 0;
+	if (completion->res < 0) {
+		UringClose(host, connection);
+		return;
+	}
+	connection->sendOffset += completion->res;
+	UringServe(host, uring, connection);
+}
+
+void UringComplete(WoopsaHost* host, UringState* uring, struct io_uring_cqe* completion) {
+	int i;
+	switch (URING_OPERATION(completion->user_data)) {
+	case URING_ACCEPT:
+		UringAccepted(host, uring, completion);
+		break;
+	case URING_RECEIVE:
+		UringReceived(host, uring, &host->connections[URING_INDEX(completion->user_data)], completion);
+		break;
+	case URING_SEND:
+		UringSent(host, uring, &host->connections[URING_INDEX(completion->user_data)], completion);
+		break;
+	case URING_TIMEOUT:
+		if (host->options.tick != NULL)
+			host->options.tick();
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+		WoopsaServerExpireConnections(host->server);
+#endif
+		// Event streams produce output without receiving anything, and
+		// expired connections are answered or closed
+		for (i = 0; i < host->options.maxConnections; i++)
+			if (host->connections[i].socket >= 0)
+				UringServe(host, uring, &host->connections[i]);
+		if (!host->stop)
+			UringTimeout(uring);
+		break;
+	}
+}
+
+void UringFree(UringState* uring) {
+	if (uring->bufferRing != NULL)
+		munmap(uring->bufferRing, uring->bufferRingSize);
+	free(uring->receiveBuffers);
+	if (uring->sqes != NULL)
+		munmap(uring->sqes, uring->sqesSize);
+	if (uring->cqRing != NULL && uring->cqRing != uring->sqRing)
+		munmap(uring->cqRing, uring->cqRingSize);
+	if (uring->sqRing != NULL)
+		munmap(uring->sqRing, uring->sqRingSize);
+	if (uring->ring >= 0)
+		close(uring->ring);
+	free(uring);
+}
+
+// Maps the rings of a new io_uring instance
+// Returns 0, or -1 if io_uring is not available
+int UringMapRings(UringState* uring) {
+	struct io_uring_params params;
+	unsigned* array;
+	unsigned i;
+	memset(&params, 0, sizeof(params));
+	uring->ring = UringSetup(URING_ENTRIES, &params);
+	if (uring->ring < 0)
+		return -1;
+	uring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	uring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (uring->cqRingSize > uring->sqRingSize)
+			uring->sqRingSize = uring->cqRingSize;
+		uring->cqRingSize = uring->sqRingSize;
+	}
+	uring->sqRing = mmap(NULL, uring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring, IORING_OFF_SQ_RING);
+	if (uring->sqRing == MAP_FAILED) {
+		uring->sqRing = NULL;
+		return -1;
+	}
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		uring->cqRing = uring->sqRing;
+	} else {
+		uring->cqRing = mmap(NULL, uring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring, IORING_OFF_CQ_RING);
+		if (uring->cqRing == MAP_FAILED) {
+			uring->cqRing = NULL;
+			return -1;
+		}
+	}
+	uring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	uring->sqes = (struct io_uring_sqe*)mmap(NULL, uring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring, IORING_OFF_SQES);
+	if (uring->sqes == MAP_FAILED) {
+		uring->sqes = NULL;
+		return -1;
+	}
+	uring->sqHead = (unsigned*)((char*)uring->sqRing + params.sq_off.head);
+	uring->sqTail = (unsigned*)((char*)uring->sqRing + params.sq_off.tail);
+	uring->sqMask = *(unsigned*)((char*)uring->sqRing + params.sq_off.ring_mask);
+	uring->sqEntries = params.sq_entries;
+	array = (unsigned*)((char*)uring->sqRing + params.sq_off.array);
+	for (i = 0; i < params.sq_entries; i++)
+		array[i] = i;
+	uring->cqHead = (unsigned*)((char*)uring->cqRing + params.cq_off.head);
+	uring->cqTail = (unsigned*)((char*)uring->cqRing + params.cq_off.tail);
+	uring->cqMask = *(unsigned*)((char*)uring->cqRing + params.cq_off.ring_mask);
+	uring->cqes = (struct io_uring_cqe*)((char*)uring->cqRing + params.cq_off.cqes);
+	return 0;
+}
+
+// Provides the receive buffers to the kernel, through a ring of them
+// Returns 0, or -1 before Linux 5.19
+int UringProvideBuffers(UringState* uring) {
+	struct io_uring_buf_reg registration;
+	unsigned short i;
+	uring->bufferRingSize = WOOPSA_HOST_RECEIVE_BUFFERS * sizeof(struct io_uring_buf);
+	uring->bufferRing = (struct io_uring_buf_ring*)mmap(NULL, uring->bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (uring->bufferRing == MAP_FAILED) {
+		uring->bufferRing = NULL;
+		return -1;
+	}
+	uring->receiveBuffers = (WoopsaChar8*)malloc((size_t)WOOPSA_HOST_RECEIVE_BUFFERS * WOOPSA_HOST_RECEIVE_SIZE);
+	if (uring->receiveBuffers == NULL)
+		return -1;
+	memset(&registration, 0, sizeof(registration));
+	registration.ring_addr = (__u64)(unsigned long)uring->bufferRing;
+	registration.ring_entries = WOOPSA_HOST_RECEIVE_BUFFERS;
+	registration.bgid = URING_BUFFER_GROUP;
+	if (UringRegister(uring->ring, IORING_REGISTER_PBUF_RING, &registration, 1) != 0)
+		return -1;
+	for (i = 0; i < WOOPSA_HOST_RECEIVE_BUFFERS; i++)
+		UringProvideBuffer(uring, i);
+	return 0;
+}
+
+int OpenUring(WoopsaHost* host) {
+	struct iovec sendBuffers;
+	struct sigaction pipeAction;
+	UringState* uring = (UringState*)calloc(1, sizeof(UringState));
+	if (uring == NULL)
+		return -1;
+	uring->ring = -1;
+	if (UringMapRings(uring) != 0 || UringProvideBuffers(uring) != 0) {
+		UringFree(uring);
+		return -1;
+	}
+	// Registering pins the pages once, instead of on every send. It
+	// counts against RLIMIT_MEMLOCK, plain sends are used if it is too low.
+	// Writes cannot take MSG_NOSIGNAL either: a client that went away would
+	// kill the process, unless the caller already ignores SIGPIPE.
+	sendBuffers.iov_base = host->sendBuffers;
+	sendBuffers.iov_len = (size_t)host->options.maxConnections * WOOPSA_HOST_SEND_SIZE;
+	if (sigaction(SIGPIPE, NULL, &pipeAction) == 0 && pipeAction.sa_handler == SIG_IGN)
+		uring->hasFixedBuffers = UringRegister(uring->ring, IORING_REGISTER_BUFFERS, &sendBuffers, 1) == 0;
+	uring->hasMultishotAccept = 1;
+	uring->hasMultishotReceive = 1;
+	uring->pollInterval.tv_sec = host->options.pollIntervalMs / 1000;
+	uring->pollInterval.tv_nsec = (long long)(host->options.pollIntervalMs % 1000) * 1000000;
+	host->backendState = uring;
+	return 0;
+}
+
+int RunUring(WoopsaHost* host) {
+	UringState* uring = (UringState*)host->backendState;
+	struct io_uring_cqe* completion;
+	unsigned head, tail;
+	int submitted;
+	UringAccept(host, uring);
+	UringTimeout(uring);
+	while (!host->stop) {
+		// Submits everything queued while handling the previous completions,
+		// and waits for the next ones, in one system call
+		submitted = UringEnter(uring->ring, uring->sqPending, 1, IORING_ENTER_GETEVENTS);
+		if (submitted < 0) {
+			if (errno == EINTR || errno == EBUSY || errno == EAGAIN)
+				continue;
+			return -1;
+		}
+		uring->sqPending -= submitted;
+		head = *uring->cqHead;
+		tail = __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE);
+		while (head != tail) {
+			completion = &uring->cqes[head & uring->cqMask];
+			UringComplete(host, uring, completion);
+			head++;
+			// Release the entry early, handling it may submit and fill the queue
+			__atomic_store_n(uring->cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+	return 0;
+}
+
+void CloseUring(WoopsaHost* host) {
+	UringFree((UringState*)host->backendState);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                     BEGIN PUBLIC WOOPSA HOST IMPLEMENTATION               //
+///////////////////////////////////////////////////////////////////////////////
+
+void WoopsaHostOptionsInit(WoopsaHostOptions* options) {
+	options->port = DEFAULT_PORT;
+	options->backend = WOOPSA_HOST_BACKEND_AUTO;
+	options->maxConnections = DEFAULT_MAX_CONNECTIONS;
+	options->maxConnectionsPerAddress = 0;
+	options->pollIntervalMs = DEFAULT_POLL_INTERVAL_MS;
+	options->tick = NULL;
+}
+
+int WoopsaHostOpen(WoopsaHost* host, WoopsaServer* server, const WoopsaHostOptions* options) {
+	int i, error, result = -1;
+	memset(host, 0, sizeof(WoopsaHost));
+	host->server = server;
+	host->options = *options;
+	host->connections = (WoopsaHostConnection*)calloc(options->maxConnections, sizeof(WoopsaHostConnection));
+	// Socket 0 is a valid descriptor: no connection must look open to
+	// WoopsaHostClose if the host cannot be opened
+	if (host->connections != NULL)
+		for (i = 0; i < options->maxConnections; i++)
+			host->connections[i].socket = -1;
+	host->sendBuffers = (WoopsaChar8*)malloc((size_t)options->maxConnections * WOOPSA_HOST_SEND_SIZE);
+	if (options->maxConnectionsPerAddress > 0) {
+		for (host->addressMask = 1; host->addressMask < (WoopsaUInt32)options->maxConnections * 2; host->addressMask *= 2);
+		host->addresses = (WoopsaHostAddress*)calloc(host->addressMask, sizeof(WoopsaHostAddress));
+		host->addressMask--;
+	}
+	host->listenSocket = OpenListenSocket(options->port);
+	if (host->connections == NULL || host->sendBuffers == NULL || (options->maxConnectionsPerAddress > 0 && host->addresses == NULL) || host->listenSocket < 0) {
+		// The caller gets the errno of the failure, not of the cleanup
+		error = errno;
+		WoopsaHostClose(host);
+		errno = error;
+		return -1;
+	}
+	for (i = 0; i < options->maxConnections; i++) {
+		host->connections[i].nextFree = i + 1 < options->maxConnections ? i + 1 : NO_CONNECTION;
+		host->connections[i].send = host->sendBuffers + (size_t)i * WOOPSA_HOST_SEND_SIZE;
+	}
+	host->freeConnection = 0;
+
+	if (options->backend != WOOPSA_HOST_BACKEND_EPOLL && (result = OpenUring(host)) == 0)
+		host->backend = WOOPSA_HOST_BACKEND_IO_URING;
+	else if (options->backend != WOOPSA_HOST_BACKEND_IO_URING && (result = OpenEpoll(host)) == 0)
+		host->backend = WOOPSA_HOST_BACKEND_EPOLL;
+	if (result != 0) {
+		error = errno;
+		WoopsaHostClose(host);
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+int WoopsaHostRun(WoopsaHost* host) {
+	if (host->backend == WOOPSA_HOST_BACKEND_IO_URING)
+		return RunUring(host);
+	return RunEpoll(host);
+}
+
+void WoopsaHostClose(WoopsaHost* host) {
+	int i;
+	if (host->connections != NULL)
+		for (i = 0; i < host->options.maxConnections; i++)
+			if (host->connections[i].socket >= 0)
+				ReleaseConnection(host, &host->connections[i]);
+	// The rings go after the sockets, which the kernel may still use
+	if (host->backendState != NULL) {
+		if (host->backend == WOOPSA_HOST_BACKEND_IO_URING)
+			CloseUring(host);
+		else
+			CloseEpoll(host);
+	}
+	if (host->listenSocket >= 0)
+		close(host->listenSocket);
+	free(host->connections);
+	free(host->sendBuffers);
+	free(host->addresses);
+	memset(host, 0, sizeof(WoopsaHost));
+	host->listenSocket = -1;
+}
+
+const char* WoopsaHostBackendName(WoopsaUInt8 backend) {
+	return backend == WOOPSA_HOST_BACKEND_IO_URING ? "io_uring" : "epoll";
+}
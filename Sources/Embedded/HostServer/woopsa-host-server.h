@@ -0,0 +1,107 @@
+#ifndef __WOOPSA_HOST_SERVER_H_
+#define __WOOPSA_HOST_SERVER_H_
+
+// Event-driven Woopsa server for Linux hosts (gateways, PCs) serving many
+// clients from one thread, on top of the WoopsaConnection state machine.
+// It uses io_uring (Linux 5.19 and later) when the kernel allows it, and
+// epoll otherwise. Clients over the limits are answered 503 and closed
+// before any connection is taken for them, and with WOOPSA_ENABLE_TIMEOUTS
+// the slow ones are closed by their deadlines. Build it along the
+// embedded server, with the features it uses enabled, for example:
+//   gcc -O2 -I../Server -DWOOPSA_ENABLE_CONNECTIONS -DWOOPSA_ENABLE_TIMEOUTS HostDemoServer.c woopsa-host-server.c ../Server/woopsa-server.c
+
+#include "woopsa-server.h"
+
+#ifndef WOOPSA_ENABLE_CONNECTIONS
+#error "The host server needs WOOPSA_ENABLE_CONNECTIONS in woopsa-config.h"
+#endif
+
+// Backends: AUTO tries io_uring and falls back to epoll
+#define WOOPSA_HOST_BACKEND_AUTO 0
+#define WOOPSA_HOST_BACKEND_EPOLL 1
+#define WOOPSA_HOST_BACKEND_IO_URING 2
+
+// Received bytes a connection holds while its previous responses are sent
+#ifndef WOOPSA_HOST_BACKLOG_SIZE
+#define WOOPSA_HOST_BACKLOG_SIZE 8192
+#endif
+// Responses of pipelined requests are gathered in a buffer of this size
+// per connection, and sent together
+#ifndef WOOPSA_HOST_SEND_SIZE
+#define WOOPSA_HOST_SEND_SIZE 16384
+#endif
+// Buffers the io_uring backend gives the kernel to receive into, shared
+// by all connections. The count must be a power of 2.
+#ifndef WOOPSA_HOST_RECEIVE_SIZE
+#define WOOPSA_HOST_RECEIVE_SIZE 2048
+#endif
+#ifndef WOOPSA_HOST_RECEIVE_BUFFERS
+#define WOOPSA_HOST_RECEIVE_BUFFERS 1024
+#endif
+
+// Work of the application done by the thread serving the clients
+typedef void (*WoopsaHostTick)(void);
+
+typedef struct {
+	WoopsaUInt16 port;
+	WoopsaUInt8 backend;
+	// Clients served at the same time, the next ones are turned away
+	int maxConnections;
+	// Clients served at the same time from one IPv4 address, 0 for no
+	// limit. Clients behind a NAT share an address.
+	int maxConnectionsPerAddress;
+	// How often the event streams are polled and the deadlines checked
+	int pollIntervalMs;
+	// Called with the event streams, every pollIntervalMs. NULL by default.
+	WoopsaHostTick tick;
+} WoopsaHostOptions;
+
+typedef struct WoopsaHostConnection WoopsaHostConnection;
+typedef struct WoopsaHostAddress WoopsaHostAddress;
+
+typedef struct {
+	WoopsaServer* server;
+	WoopsaHostOptions options;
+	// The backend in use, never WOOPSA_HOST_BACKEND_AUTO
+	WoopsaUInt8 backend;
+	int listenSocket;
+	WoopsaHostConnection* connections;
+	// Responses waiting to be sent, WOOPSA_HOST_SEND_SIZE per connection
+	WoopsaChar8* sendBuffers;
+	// First unused connection, -1 if all are used
+	int freeConnection;
+	int connectionCount;
+	// Connections by client address, a hash table of addressMask + 1
+	// entries when maxConnectionsPerAddress is set
+	WoopsaHostAddress* addresses;
+	WoopsaUInt32 addressMask;
+	// Set it (from a signal handler for instance) to return from WoopsaHostRun
+	volatile int stop;
+	// The rings of io_uring, or the epoll descriptor
+	void* backendState;
+} WoopsaHost;
+
+// Fills options with the defaults: port 80, AUTO backend, 256
+// connections, no limit per address, event streams polled every 100 ms,
+// no tick
+void WoopsaHostOptionsInit(WoopsaHostOptions* options);
+
+// Listens on options->port with the requested backend. An explicit
+// backend that is unavailable is an error, AUTO falls back to epoll.
+// The process keeps its handler of SIGPIPE: io_uring sends from
+// registered buffers only if SIGPIPE is ignored (signal(SIGPIPE, SIG_IGN)
+// before this call), as their writes can raise it.
+// Returns 0, or -1 with errno set
+int WoopsaHostOpen(WoopsaHost* host, WoopsaServer* server, const WoopsaHostOptions* options);
+
+// Serves clients until host->stop is set
+// Returns 0, or -1 with errno set
+int WoopsaHostRun(WoopsaHost* host);
+
+// Closes the connections and the listening socket
+void WoopsaHostClose(WoopsaHost* host);
+
+// Returns "epoll" or "io_uring"
+const char* WoopsaHostBackendName(WoopsaUInt8 backend);
+
+#endif
@@ -0,0 +1,222 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// Stand-in collector for devices pushing their values, to try push mode
+// on a PC. It accepts the POST requests of WoopsaPushPrepare on any path
+// and prints one line per push, the path then the JSON content, or with
+// -q a summary every second. -f answers 503 to a share of the pushes, in
+// percent, to see the devices back off. A device that pushes changes
+// before its first snapshot since the collector started gets 205, as a
+// real collector that lost its state would answer.
+//   gcc -O2 -o PushCollector PushCollector.c
+//   ./PushCollector [-p port] [-f failurePercent] [-q]
+
+#define DEFAULT_PORT 9100
+#define MAX_CONNECTIONS 1024
+#define MAX_DEVICES 1024
+#define RECEIVE_SIZE 16384
+#define PATH_SIZE 64
+
+#define RESPONSE_OK "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"
+#define RESPONSE_RESET "HTTP/1.1 205 Reset Content\r\nContent-Length: 0\r\n\r\n"
+#define RESPONSE_UNAVAILABLE "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n"
+#define RESPONSE_BAD_REQUEST "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+
+typedef struct {
+	char buffer[RECEIVE_SIZE + 1];
+	int received;
+} Connection;
+
+// The devices seen since the collector started, by path
+typedef struct {
+	char path[PATH_SIZE];
+	int synced;
+} Device;
+
+Connection connections[MAX_CONNECTIONS];
+struct pollfd sockets[MAX_CONNECTIONS + 1];
+Device devices[MAX_DEVICES];
+int deviceCount = 0;
+int failurePercent = 0, quiet = 0;
+volatile int stop = 0;
+long pushes = 0, changePushes = 0, failures = 0, resets = 0, bytes = 0;
+
+void Stop(int signalNumber) {
+	stop = 1;
+}
+
+Device* FindDevice(const char* path) {
+	int i;
+	for (i = 0; i < deviceCount; i++) {
+		if (strcmp(devices[i].path, path) == 0)
+			return &devices[i];
+	}
+	if (deviceCount == MAX_DEVICES)
+		return NULL;
+	snprintf(devices[deviceCount].path, PATH_SIZE, "%s", path);
+	devices[deviceCount].synced = 0;
+	return &devices[deviceCount++];
+}
+
+// Answers the push of path with content
+const char* HandlePush(const char* path, const char* content, int contentLength) {
+	Device* device = FindDevice(path);
+	int changes = strncmp(content, "{\"Changes\"", 10) == 0;
+	if (failurePercent != 0 && rand() % 100 < failurePercent) {
+		failures++;
+		return RESPONSE_UNAVAILABLE;
+	}
+	if (device != NULL && changes && !device->synced) {
+		resets++;
+		return RESPONSE_RESET;
+	}
+	if (device != NULL && !changes)
+		device->synced = 1;
+	pushes++;
+	changePushes += changes;
+	bytes += contentLength;
+	if (!quiet)
+		printf("%s %.*s\n", path, contentLength, content);
+	return RESPONSE_OK;
+}
+
+// Handles the complete requests a connection received
+// Returns 0, or -1 if the connection must be closed
+int HandleRequests(int socket, Connection* connection) {
+	char path[PATH_SIZE];
+	char *end, *header;
+	const char* response;
+	int headerLength, contentLength, length;
+	while ((end = strstr(connection->buffer, "\r\n\r\n")) != NULL) {
+		headerLength = (int)(end - connection->buffer) + 4;
+		if (sscanf(connection->buffer, "POST %63s HTTP/1.", path) != 1) {
+			send(socket, RESPONSE_BAD_REQUEST, strlen(RESPONSE_BAD_REQUEST), MSG_NOSIGNAL);
+			return -1;
+		}
+		contentLength = 0;
+		*end = '\0';
+		if ((header = strcasestr(connection->buffer, "\r\nContent-Length:")) != NULL)
+			contentLength = atoi(header + 17);
+		*end = '\r';
+		if (contentLength < 0 || headerLength + contentLength > RECEIVE_SIZE) {
+			send(socket, RESPONSE_BAD_REQUEST, strlen(RESPONSE_BAD_REQUEST), MSG_NOSIGNAL);
+			return -1;
+		}
+		// Wait for the rest of the content
+		if (connection->received < headerLength + contentLength)
+			return 0;
+		response = HandlePush(path, connection->buffer + headerLength, contentLength);
+		if (send(socket, response, strlen(response), MSG_NOSIGNAL) != (ssize_t)strlen(response))
+			return -1;
+		length = headerLength + contentLength;
+		memmove(connection->buffer, connection->buffer + length, connection->received - length);
+		connection->received -= length;
+		connection->buffer[connection->received] = '\0';
+	}
+	// Headers that do not fit
+	return connection->received == RECEIVE_SIZE ? -1 : 0;
+}
+
+void PrintSummary(void) {
+	printf("%d devices, %ld pushes (%ld of changes), %ld bytes, %ld failed on purpose, %ld resets\n",
+		deviceCount, pushes, changePushes, bytes, failures, resets);
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+	struct sockaddr_in address;
+	int port = DEFAULT_PORT, option, listenSocket, client, i, count, one = 1;
+	ssize_t received;
+	time_t summaryAt = time(NULL);
+
+	while ((option = getopt(argc, argv, "p:f:q")) != -1) {
+		switch (option) {
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'f':
+			failurePercent = atoi(optarg);
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		default:
+			printf("Usage: %s [-p port] [-f failurePercent] [-q]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+	setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = INADDR_ANY;
+	address.sin_port = htons((unsigned short)port);
+	if (bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, 128) != 0) {
+		perror("Error listening");
+		return 1;
+	}
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+	printf("Collector listening on port %d\n", port);
+	fflush(stdout);
+
+	// sockets[0] listens, sockets[i + 1] is connections[i]
+	sockets[0].fd = listenSocket;
+	sockets[0].events = POLLIN;
+	for (i = 1; i <= MAX_CONNECTIONS; i++) {
+		sockets[i].fd = -1;
+		sockets[i].events = POLLIN;
+	}
+	while (!stop) {
+		count = poll(sockets, MAX_CONNECTIONS + 1, 1000);
+		if (count < 0 && errno != EINTR) {
+			perror("Error waiting for pushes");
+			break;
+		}
+		if (quiet && time(NULL) != summaryAt) {
+			summaryAt = time(NULL);
+			PrintSummary();
+		}
+		if (count <= 0)
+			continue;
+		if (sockets[0].revents & POLLIN) {
+			if ((client = accept(listenSocket, NULL, NULL)) >= 0) {
+				for (i = 1; i <= MAX_CONNECTIONS && sockets[i].fd != -1; i++)
+					;
+				if (i > MAX_CONNECTIONS) {
+					close(client);
+				} else {
+					sockets[i].fd = client;
+					connections[i - 1].received = 0;
+				}
+			}
+		}
+		for (i = 1; i <= MAX_CONNECTIONS; i++) {
+			if (sockets[i].fd == -1 || sockets[i].revents == 0)
+				continue;
+			received = recv(sockets[i].fd, connections[i - 1].buffer + connections[i - 1].received, RECEIVE_SIZE - connections[i - 1].received, 0);
+			if (received > 0) {
+				connections[i - 1].received += (int)received;
+				connections[i - 1].buffer[connections[i - 1].received] = '\0';
+			}
+			if (received <= 0 || HandleRequests(sockets[i].fd, &connections[i - 1]) != 0) {
+				close(sockets[i].fd);
+				sockets[i].fd = -1;
+			}
+		}
+	}
+	PrintSummary();
+	close(listenSocket);
+	return 0;
+}
@@ -0,0 +1,290 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "woopsa-server.h"
+
+// Simulated devices pushing their values to a collector (PushCollector
+// for instance) from one thread, each on its own connection, which is
+// kept open between pushes. The devices share one table of struct fields,
+// each server publishing its own struct.
+//   FLAGS="-DWOOPSA_ENABLE_PUSH -DWOOPSA_ENABLE_GROUP_READS -DWOOPSA_ENABLE_STRUCT_TABLES -DWOOPSA_ENABLE_DIRTY_BITS -DWOOPSA_ENABLE_CHANGE_JOURNAL"
+//   gcc -O2 -I../Server $FLAGS -o PushDevice PushDevice.c ../Server/woopsa-server.c -lm
+//   ./PushDevice [-n devices] [-a address] [-p port] [-i intervalMs] [-c]
+// -c pushes the changes of the journal instead of snapshots.
+
+#ifndef WOOPSA_ENABLE_PUSH
+#error "PushDevice needs WOOPSA_ENABLE_PUSH in woopsa-config.h"
+#endif
+#ifndef WOOPSA_ENABLE_STRUCT_TABLES
+#error "PushDevice needs WOOPSA_ENABLE_STRUCT_TABLES in woopsa-config.h"
+#endif
+
+#define DEFAULT_DEVICES 1
+#define MAX_DEVICES 1024
+#define DEFAULT_ADDRESS "127.0.0.1"
+#define DEFAULT_PORT 9100
+#define DEFAULT_INTERVAL_MS 1000
+#define SIMULATION_INTERVAL_MS 100
+// A push without response by then has failed
+#define RESPONSE_TIMEOUT_MS 5000
+#define REQUEST_SIZE 4096
+#define RESPONSE_SIZE 1024
+#define NAME_SIZE 32
+
+#define MACHINE_FIELDS(X) \
+	X(float, Temperature, WOOPSA_TYPE_REAL) \
+	X(float, Setpoint, WOOPSA_TYPE_REAL) \
+	X(char, Running, WOOPSA_TYPE_LOGICAL) \
+	X(int, Counter, WOOPSA_TYPE_INTEGER)
+#define MACHINE_MEMBER(ctype, field, type) ctype field;
+#define MACHINE_ENTRY(ctype, field, type) WOOPSA_FIELD(Machine, field, type)
+typedef struct { MACHINE_FIELDS(MACHINE_MEMBER) } Machine;
+
+WOOPSA_BEGIN(machineEntries)
+MACHINE_FIELDS(MACHINE_ENTRY)
+WOOPSA_END;
+
+#define ENTRY_COUNT (sizeof(machineEntries) / sizeof(machineEntries[0]))
+
+typedef struct {
+	WoopsaServer server;
+	WoopsaPush push;
+	Machine machine;
+	WoopsaUInt32 hashes[ENTRY_COUNT];
+	char path[NAME_SIZE];
+	// -1 while closed, and whether the connection is being established
+	int socket;
+	int connecting;
+	// The push on its way, 0 long when there is none
+	char request[REQUEST_SIZE];
+	int requestLength;
+	int requestSent;
+	char response[RESPONSE_SIZE + 1];
+	int responseLength;
+	long long sentAtMs;
+} Device;
+
+Device devices[MAX_DEVICES];
+struct pollfd sockets[MAX_DEVICES];
+int deviceCount = DEFAULT_DEVICES;
+struct sockaddr_in collector;
+char collectorHost[NAME_SIZE];
+volatile int stop = 0;
+long pushes = 0, failures = 0;
+
+void Stop(int signalNumber) {
+	stop = 1;
+}
+
+long long NowMs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// The temperature follows the setpoint, with some noise that differs from
+// one device to the other
+void Simulate(Device* device, int index) {
+	Machine* machine = &device->machine;
+	double seconds = NowMs() / 1000.0;
+	machine->Temperature += (machine->Setpoint - machine->Temperature) * 0.01f;
+	machine->Temperature += 0.05f * (float)sin(seconds + index);
+	if (machine->Running)
+		machine->Counter++;
+}
+
+// Closes the connection, and reports the push on its way as failed
+void FailPush(Device* device) {
+	if (device->socket != -1) {
+		close(device->socket);
+		device->socket = -1;
+	}
+	if (device->requestLength != 0) {
+		device->requestLength = 0;
+		failures++;
+		WoopsaPushResponse(&device->push, NULL, 0);
+	}
+}
+
+// Starts the next push of a device when it is due, on its connection or
+// on a new one
+void StartPush(Device* device) {
+	WoopsaBufferSize length;
+	if (device->requestLength != 0)
+		return;
+	if ((length = WoopsaPushPrepare(&device->server, &device->push, device->request, REQUEST_SIZE)) == 0)
+		return;
+	device->requestLength = length;
+	device->requestSent = 0;
+	device->responseLength = 0;
+	device->sentAtMs = NowMs();
+	pushes++;
+	if (device->socket != -1)
+		return;
+	device->socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	device->connecting = 1;
+	if (device->socket == -1 || (connect(device->socket, (struct sockaddr*)&collector, sizeof(collector)) != 0 && errno != EINPROGRESS))
+		FailPush(device);
+}
+
+// Hands the response over to the push once it is complete
+void ReceiveResponse(Device* device) {
+	char *end, *header;
+	int contentLength = 0, headerLength;
+	if ((end = strstr(device->response, "\r\n\r\n")) == NULL)
+		return;
+	headerLength = (int)(end - device->response) + 4;
+	*end = '\0';
+	if ((header = strcasestr(device->response, "\r\nContent-Length:")) != NULL)
+		contentLength = atoi(header + 17);
+	*end = '\r';
+	if (device->responseLength < headerLength + contentLength)
+		return;
+	if (device->response[9] != '2')
+		failures++;
+	device->requestLength = 0;
+	WoopsaPushResponse(&device->push, device->response, device->responseLength);
+}
+
+// Sends the rest of the request, and reads the response
+void ServeConnection(Device* device, short events) {
+	int error = 0;
+	socklen_t errorLength = sizeof(error);
+	ssize_t count;
+	if (events & POLLOUT) {
+		if (device->connecting) {
+			getsockopt(device->socket, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+			if (error != 0) {
+				FailPush(device);
+				return;
+			}
+			device->connecting = 0;
+		}
+		count = send(device->socket, device->request + device->requestSent, device->requestLength - device->requestSent, MSG_NOSIGNAL);
+		if (count < 0 && errno != EAGAIN) {
+			FailPush(device);
+			return;
+		}
+		if (count > 0)
+			device->requestSent += (int)count;
+	}
+	if (events & (POLLIN | POLLERR | POLLHUP)) {
+		count = recv(device->socket, device->response + device->responseLength, RESPONSE_SIZE - device->responseLength, 0);
+		if (count <= 0) {
+			// The collector closed the connection, which is only a failure
+			// if a push was on its way
+			FailPush(device);
+			return;
+		}
+		device->responseLength += (int)count;
+		device->response[device->responseLength] = '\0';
+		ReceiveResponse(device);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	const char* address = DEFAULT_ADDRESS;
+	int port = DEFAULT_PORT, intervalMs = DEFAULT_INTERVAL_MS, changesOnly = 0, option, i;
+	long long now, simulatedAt = 0;
+	Device* device;
+
+	while ((option = getopt(argc, argv, "n:a:p:i:c")) != -1) {
+		switch (option) {
+		case 'n':
+			deviceCount = atoi(optarg);
+			break;
+		case 'a':
+			address = optarg;
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'i':
+			intervalMs = atoi(optarg);
+			break;
+		case 'c':
+			changesOnly = 1;
+			break;
+		default:
+			printf("Usage: %s [-n devices] [-a address] [-p port] [-i intervalMs] [-c]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (deviceCount < 1 || deviceCount > MAX_DEVICES) {
+		printf("Between 1 and %d devices can be simulated\n", MAX_DEVICES);
+		return 1;
+	}
+	memset(&collector, 0, sizeof(collector));
+	collector.sin_family = AF_INET;
+	collector.sin_port = htons((unsigned short)port);
+	if (inet_pton(AF_INET, address, &collector.sin_addr) != 1) {
+		printf("Invalid collector address %s\n", address);
+		return 1;
+	}
+	snprintf(collectorHost, NAME_SIZE, "%s:%d", address, port);
+
+	for (i = 0; i < deviceCount; i++) {
+		device = &devices[i];
+		device->machine.Temperature = 20.0f;
+		device->machine.Setpoint = 21.0f + i % 5;
+		device->machine.Running = 1;
+		device->socket = -1;
+		snprintf(device->path, NAME_SIZE, "/push/Device%02d", i);
+		WoopsaServerInit(&device->server, "/woopsa/", machineEntries, NULL);
+		WoopsaServerSetInstance(&device->server, &device->machine, NULL, sizeof(Machine));
+		WoopsaPushInit(&device->push, collectorHost, device->path, "*", intervalMs);
+		device->push.changesOnly = changesOnly;
+		// Spread the pushes of the devices over the interval
+		device->push.dueAt += (WoopsaUInt32)((long long)intervalMs * i / deviceCount);
+	}
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+	printf("%d devices pushing %s to %s every %d ms\n", deviceCount, changesOnly ? "changes" : "snapshots", collectorHost, intervalMs);
+	fflush(stdout);
+
+	while (!stop) {
+		now = NowMs();
+		if (now - simulatedAt >= SIMULATION_INTERVAL_MS) {
+			simulatedAt = now;
+			for (i = 0; i < deviceCount; i++) {
+				Simulate(&devices[i], i);
+				// The values change behind the server's back
+				if (changesOnly)
+					WoopsaServerDetectChanges(&devices[i].server, devices[i].hashes);
+			}
+		}
+		for (i = 0; i < deviceCount; i++) {
+			device = &devices[i];
+			if (device->requestLength != 0 && now - device->sentAtMs > RESPONSE_TIMEOUT_MS)
+				FailPush(device);
+			StartPush(device);
+			sockets[i].fd = device->socket;
+			sockets[i].events = POLLIN;
+			if (device->connecting || device->requestSent < device->requestLength)
+				sockets[i].events |= POLLOUT;
+			sockets[i].revents = 0;
+		}
+		if (poll(sockets, deviceCount, 10) < 0 && errno != EINTR) {
+			perror("Error waiting for the collector");
+			break;
+		}
+		for (i = 0; i < deviceCount; i++) {
+			if (sockets[i].fd != -1 && sockets[i].revents != 0)
+				ServeConnection(&devices[i], sockets[i].revents);
+		}
+	}
+	printf("%ld pushes, %ld failed\n", pushes, failures);
+	for (i = 0; i < deviceCount; i++)
+		FailPush(&devices[i]);
+	return 0;
+}
@@ -13,6 +13,9 @@
 #define WOOPSA_LOCK				// disable interrupts
 #define WOOPSA_UNLOCK			// enable interrupts
 
+// The sizes guarded by #ifndef in this file can be raised on the command
+// line by hosts serving large tables, such as the gateway.
+
 // If you are on a system with very low memory, you can reduce the
 // buffer size that the Woopsa server uses internally.
 // This value changes the maximum length of URLs you can parse.
@@ -27,18 +30,252 @@
 #define WOOPSA_ENABLE_STRINGS
 #define WOOPSA_ENABLE_METHODS
 
+// The features below are off by default, so that a device only pays the
+// code and RAM of those it uses. Enable them by uncommenting them here, or
+// on the command line (-DWOOPSA_ENABLE_CONNECTIONS) as the host programs do.
+// Tools/woopsa-ram-report.py tells what each one costs.
+
+// Computed properties are backed by getter/setter functions instead
+// of variables. They take a few more bytes per entry.
+//#define WOOPSA_ENABLE_ACCESSORS
+
+// Properties can be the fields of a struct, located by their offset
+// (WOOPSA_FIELD), so that one table serves any instance of the struct.
+// The server can read them from a snapshot of the whole struct, copied
+// once per cycle instead of property by property.
+//#define WOOPSA_ENABLE_STRUCT_TABLES
+
+// Properties can record their values in history ring buffers, which
+// clients read in bulk. WOOPSA_HISTORY_VALUE_SIZE is the largest value
+// a sample can hold.
+//#define WOOPSA_ENABLE_HISTORY
+#define WOOPSA_HISTORY_VALUE_SIZE 8
+
+// Clients can open text/event-stream connections (events verb) that push
+// the changes of up to WOOPSA_EVENT_STREAM_PROPERTIES properties.
+// WOOPSA_MAX_EVENT_STREAMS streams can be open at the same time.
+//#define WOOPSA_ENABLE_EVENT_STREAMS
+#ifndef WOOPSA_MAX_EVENT_STREAMS
+#define WOOPSA_MAX_EVENT_STREAMS 2
+#endif
+#define WOOPSA_EVENT_STREAM_PROPERTIES 8
+
+// Reads of a pattern such as read/Digital* or read/*In* return every
+// matching property in one JSON object. Groups too large for the output
+// buffer are answered 503: read them with narrower patterns.
+//#define WOOPSA_ENABLE_GROUP_READS
+
+// meta takes prefix, offset and limit in its query, for instance
+// meta?prefix=Digital&offset=20&limit=10, and tells the TotalCount of
+// entries starting with prefix, so that clients of large tables fetch
+// the part they need page by page. Pages too large for the output
+// buffer are answered 503: ask for a smaller limit.
+//#define WOOPSA_ENABLE_PAGED_META
+
+// Entries whose name holds slashes (Boiler1/Temperature) are published in
+// subobjects: meta describes Root and lists its subobjects in Items,
+// meta/Boiler1 describes Boiler1. Reads, writes and invokes take the full
+// name. Each meta is answered at once, 503 if it does not fit in the
+// output buffer.
+//#define WOOPSA_ENABLE_SUBOBJECTS
+
+// These features look names up in an index of up to WOOPSA_NAME_INDEX_SIZE
+// entries sorted by name, which also turns reads, writes and invokes by
+// name into binary searches. The index is part of the WoopsaServer (one
+// byte per entry, two above 255): make it at least as large as the table.
+// Larger tables are not indexed at all, and every group read, meta page
+// and lookup by name then goes through the whole table.
+#ifndef WOOPSA_NAME_INDEX_SIZE
+#define WOOPSA_NAME_INDEX_SIZE 64
+#endif
+
+// Writes are decoded into a queue of WOOPSA_WRITE_QUEUE_SIZE values (a
+// power of 2) instead of being stored under WOOPSA_LOCK, so that parsing
+// never disables interrupts. Texts written must be shorter than
+// WOOPSA_WRITE_VALUE_SIZE. The application must then drain the queue with
+// WoopsaApplyPendingWrites at a safe point of its loop: until it does,
+// written properties keep their old value, and writes are answered 503
+// once the queue is full.
+//#define WOOPSA_ENABLE_WRITE_QUEUE
+#ifndef WOOPSA_WRITE_QUEUE_SIZE
+#define WOOPSA_WRITE_QUEUE_SIZE 4
+#endif
+#ifndef WOOPSA_WRITE_VALUE_SIZE
+#define WOOPSA_WRITE_VALUE_SIZE 24
+#endif
+
+// A write without a property name, such as POST write with the content
+// Kp=1.2&Ki=0.5&Kd=0.01, changes up to WOOPSA_TRANSACTION_SIZE properties
+// together: every value is decoded and checked first, then they are all
+// stored in one WOOPSA_LOCK section, or none of them if one is wrong or
+// read-only.
+// With the write queue, they are queued at once and must fit in it.
+//#define WOOPSA_ENABLE_TRANSACTIONS
+#define WOOPSA_TRANSACTION_SIZE 8
+
+// The application is told of every property written by a client once
+// its new value is stored, to save settings or pass the value on.
+//#define WOOPSA_ENABLE_WRITE_HOOK
+
+// The server keeps a dirty bit per entry, set when a client writes the
+// property or when the application calls WoopsaMarkChanged. Changes are
+// then found by scanning the bits a word at a time instead of comparing
+// every value. Entries after the first WOOPSA_DIRTY_ENTRIES are not tracked.
+//#define WOOPSA_ENABLE_DIRTY_BITS
+#ifndef WOOPSA_DIRTY_ENTRIES
+#define WOOPSA_DIRTY_ENTRIES 64
+#endif
+
+// The dirty bits are recorded in a journal of the last WOOPSA_JOURNAL_SIZE
+// changes, numbered in sequence. Clients that reconnect or poll slowly get
+// the changes after the last sequence number they saw with the changes
+// verb, or are told to read everything again once the journal wrapped.
+// Values larger than WOOPSA_JOURNAL_VALUE_SIZE are sent as they are now.
+//#define WOOPSA_ENABLE_CHANGE_JOURNAL
+#ifndef WOOPSA_JOURNAL_SIZE
+#define WOOPSA_JOURNAL_SIZE 16
+#endif
+#define WOOPSA_JOURNAL_VALUE_SIZE 8
+
+// The properties matching a group read pattern can be pushed to a
+// collector with periodic HTTP POST requests, for devices that cannot be
+// polled from the outside (behind NAT). The application sends the
+// requests prepared by WoopsaPushPrepare on a connection of its own.
+//#define WOOPSA_ENABLE_PUSH
+
+// Servers of other entry tables (motion, I/O, diagnostics...) can be
+// mounted on a server with WoopsaServerMount, each under its own prefix,
+// to serve them all on one listener. Requests are routed by the longest
+// prefix of their path with one pass over a trie of WOOPSA_MOUNT_NODES
+// characters, prefixes sharing the nodes of their common start.
+//#define WOOPSA_ENABLE_MOUNTS
+#ifndef WOOPSA_MAX_MOUNTS
+#define WOOPSA_MAX_MOUNTS 4
+#endif
+#ifndef WOOPSA_MOUNT_NODES
+#define WOOPSA_MOUNT_NODES 48
+#endif
+
+// Methods published with WOOPSA_METHOD_ASYNC return at once with a job
+// id: the work goes on in the application's loop, which hands the result
+// over with WoopsaJobComplete. Clients poll the job verb for it, and
+// WebSockets get it as soon as it is there. WOOPSA_MAX_JOBS can run at
+// the same time. A result nobody asked for is dropped after
+// WOOPSA_JOB_KEEP_MS, texts are cut to WOOPSA_JOB_TEXT_SIZE - 1.
+//#define WOOPSA_ENABLE_ASYNC_METHODS
+#ifndef WOOPSA_MAX_JOBS
+#define WOOPSA_MAX_JOBS 4
+#endif
+#define WOOPSA_JOB_TEXT_SIZE 16
+#define WOOPSA_JOB_KEEP_MS 60000
+
+// Orders memory accesses between the server and the consumer of the
+// write queue (an interrupt or another thread)
+#if defined(__AVR__)
+#define WOOPSA_MEMORY_BARRIER()										__asm__ __volatile__("" ::: "memory")
+#elif defined(__GNUC__)
+#define WOOPSA_MEMORY_BARRIER()										__sync_synchronize()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define WOOPSA_MEMORY_BARRIER()										_ReadWriteBarrier()
+#else
+#define WOOPSA_MEMORY_BARRIER()
+#endif
+
+// Woopsa paths can be upgraded to WebSockets, which carry reads, writes,
+// invokes and subscriptions without per-request HTTP headers.
+//#define WOOPSA_ENABLE_WEBSOCKETS
+
+// meta and read responses carry an ETag. Clients sending it back in
+// If-None-Match get a 304 Not Modified without content when nothing changed.
+//#define WOOPSA_ENABLE_ETAGS
+
+// Static files (HTML, scripts...) can be embedded as gzipped arrays with
+// Tools/woopsa-assets.py and served by the server itself.
+//#define WOOPSA_ENABLE_STATIC_ASSETS
+
+// Entry tables, type names and the texts of responses (JSON, HTTP headers)
+// are kept in flash instead of being copied to RAM at startup, which is
+// what limits Woopsa on small AVRs. Entry names are then stored in the
+// entries, and must be shorter than WOOPSA_ENTRY_NAME_SIZE. AVR only.
+//#define WOOPSA_ENABLE_FLASH_TABLES
+#define WOOPSA_ENTRY_NAME_SIZE 24
+
+// On AVR, flash is not in the data address space: assets and flash
+// tables must be read with the _P functions
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define WOOPSA_PROGMEM												PROGMEM
+#define WOOPSA_FLASH_COPY(destination, source, length)				memcpy_P(destination, source, length)
+#define WOOPSA_FLASH_TEXT(literal)									PSTR(literal)
+#define WOOPSA_FLASH_READ_BYTE(address)								pgm_read_byte(address)
+#endif
+
+// WoopsaConnection handles the buffering, keep-alive and pipelining of
+// a client connection, for any event loop or network stack. Requests
+// longer than WOOPSA_CONNECTION_INPUT_SIZE are refused, responses (other
+// than assets and events) must fit in WOOPSA_CONNECTION_OUTPUT_SIZE.
+//#define WOOPSA_ENABLE_CONNECTIONS
+#define WOOPSA_CONNECTION_INPUT_SIZE 512
+#ifndef WOOPSA_CONNECTION_OUTPUT_SIZE
+#define WOOPSA_CONNECTION_OUTPUT_SIZE 2048
+#endif
+
+// Connections only move on when WoopsaConnectionStep is called, one piece
+// of work at a time: a request, WOOPSA_STEP_ENTRIES entries of meta or a
+// chunk of output. A control loop calling it once per cycle keeps its
+// cycle time however large the responses are. Needs the connections.
+//#define WOOPSA_ENABLE_TIME_SLICING
+#define WOOPSA_STEP_ENTRIES 8
+
+// Connections are closed when a client takes longer than
+// WOOPSA_HEADER_TIMEOUT_MS to send the headers of a request (it gets a
+// 408), WOOPSA_BODY_TIMEOUT_MS for their content, or stays idle longer
+// than WOOPSA_IDLE_TIMEOUT_MS, so that slow or silent clients do not hold
+// the few sockets of a device. The deadlines are kept in a hashed wheel of
+// WOOPSA_TIMER_SLOTS slots of WOOPSA_TIMER_TICK_MS, checked by
+// WoopsaServerExpireConnections. Needs the connections.
+//#define WOOPSA_ENABLE_TIMEOUTS
+#ifndef WOOPSA_HEADER_TIMEOUT_MS
+#define WOOPSA_HEADER_TIMEOUT_MS 5000
+#endif
+#ifndef WOOPSA_BODY_TIMEOUT_MS
+#define WOOPSA_BODY_TIMEOUT_MS 10000
+#endif
+#ifndef WOOPSA_IDLE_TIMEOUT_MS
+#define WOOPSA_IDLE_TIMEOUT_MS 30000
+#endif
+#define WOOPSA_TIMER_SLOTS 16
+#define WOOPSA_TIMER_TICK_MS 250
+
+// Millisecond tick used to expire cached values, and microsecond tick
+// used to time the steps of connections. Only differences between two
+// ticks are used, so they are allowed to wrap around.
+// When left undefined, Woopsa uses the system's monotonic clock.
+#ifdef ARDUINO
+#include <Arduino.h>
+#define WOOPSA_MILLISECONDS()										millis()
+#define WOOPSA_MICROSECONDS()										micros()
+#endif
+
 // 99% of systems will have the standard C library but in case 
 // you end up in the 1%, you can always re-define these functions
 // to work for you.
 #define WOOPSA_INTEGER_TO_PADDED_STRING(value, string, padding)		sprintf(string, "%" #padding "d", value)
 #define WOOPSA_INTEGER_TO_STRING(value, string, max_length)			snprintf(string, max_length-1, "%d", value)
 #define WOOPSA_REAL_TO_STRING(value, string, max_length)			snprintf(string, max_length-1, "%f", value)
+#define WOOPSA_UNSIGNED_TO_STRING(value, string, max_length)		snprintf(string, max_length-1, "%lu", (unsigned long)(value))
 
 #define WOOPSA_STRING_TO_INTEGER(value, string)						(value = atoi(string))
 #define WOOPSA_STRING_TO_FLOAT(value, string)						(value = (float)atof(string))
+#define WOOPSA_STRING_TO_DOUBLE(value, string)						(value = atof(string))
+#define WOOPSA_STRING_TO_REAL(value, string, end)					(value = strtod(string, end))
+#define WOOPSA_STRING_TO_UNSIGNED(value, string)					(value = strtoul(string, NULL, 10))
 
 #define WOOPSA_STRING_POSITION(haystack, needle)					strstr(haystack, needle)
 #define WOOPSA_STRING_EQUAL(string1, string2)						(strcmp(string1, string2) == 0)
+#define WOOPSA_STRING_COMPARE(string1, string2)						strcmp(string1, string2)
+#define WOOPSA_STRING_N_COMPARE(string1, string2, n)				strncmp(string1, string2, n)
 #define WOOPSA_STRING_LENGTH(string)								strlen(string)
 #define WOOPSA_CHAR_TO_LOWER(character)								(WoopsaChar8)tolower(character)
 #define WOOPSA_STRING_COPY(destination, source)						strcpy(destination, source)
@@ -3,11 +3,16 @@
 
 #include "woopsa-config.h"
 
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+#include <stddef.h>
+#endif
+
 typedef long WoopsaBufferSize;
 typedef short			WoopsaInt16;
 typedef unsigned short	WoopsaUInt16;
 typedef char			WoopsaChar8;
 typedef unsigned char	WoopsaUInt8;
+typedef unsigned long	WoopsaUInt32;
 typedef void *			WoopsaVoidPtr;
 
 typedef WoopsaChar8		WoopsaBuffer[WOOPSA_BUFFER_SIZE];
@@ -19,6 +24,26 @@ typedef WoopsaChar8		WoopsaBuffer[WOOPSA_BUFFER_SIZE];
 	typedef float(*ptrMethodRetReal)(void);
 #endif
 
+#ifdef WOOPSA_ENABLE_ACCESSORS
+	// A getter writes the current value of a computed property into value,
+	// a setter receives the value decoded from a client write
+	typedef void(*WoopsaGetter)(void* value);
+	typedef void(*WoopsaSetter)(const void* value);
+
+	typedef struct {
+		// Holds the last value returned by the getter
+		void* value;
+		WoopsaGetter getter;
+		// NULL for computed properties that can only be read
+		WoopsaSetter setter;
+		// Milliseconds during which value is served without calling
+		// the getter again. 0 calls the getter on every read.
+		WoopsaUInt32 cacheTtl;
+		WoopsaUInt32 cachedAt;
+		WoopsaUInt8 cacheValid;
+	} WoopsaAccessor;
+#endif
+
 // JsonData is not supported in Woopsa-C
 typedef enum {
 	WOOPSA_TYPE_NULL,
@@ -34,23 +59,379 @@ typedef enum {
 #endif
 } WoopsaType;
 
+// How the value of a property is laid out in memory. The property macros
+// derive it from the type and the size of the variable, so that int16_t,
+// int64_t, double or bool variables are published as they are. Unsigned
+// integers are published with WOOPSA_PROPERTY_UNSIGNED.
+typedef enum {
+	WOOPSA_STORAGE_BOOL,
+	WOOPSA_STORAGE_INT8,
+	WOOPSA_STORAGE_INT16,
+	WOOPSA_STORAGE_INT32,
+	WOOPSA_STORAGE_INT64,
+	WOOPSA_STORAGE_UINT8,
+	WOOPSA_STORAGE_UINT16,
+	WOOPSA_STORAGE_UINT32,
+	WOOPSA_STORAGE_UINT64,
+	WOOPSA_STORAGE_FLOAT,
+	WOOPSA_STORAGE_DOUBLE,
+	// NUL-terminated, the size of the variable is the room for the text
+	WOOPSA_STORAGE_TEXT
+} WoopsaStorage;
+
+// The storage of an integer of size bytes, from WOOPSA_STORAGE_INT8
+// or WOOPSA_STORAGE_UINT8
+#define WOOPSA_INTEGER_STORAGE(size, first) \
+	((first) + ((size) == 1 ? 0 : (size) == 2 ? 1 : (size) == 4 ? 2 : 3))
+
+#define WOOPSA_DEFAULT_STORAGE(type, size) \
+	((type) == WOOPSA_TYPE_LOGICAL ? WOOPSA_STORAGE_BOOL : \
+	(type) == WOOPSA_TYPE_INTEGER ? WOOPSA_INTEGER_STORAGE(size, WOOPSA_STORAGE_INT8) : \
+	(type) == WOOPSA_TYPE_REAL || (type) == WOOPSA_TYPE_TIME_SPAN ? ((size) == sizeof(float) ? WOOPSA_STORAGE_FLOAT : WOOPSA_STORAGE_DOUBLE) : \
+	WOOPSA_STORAGE_TEXT)
+
+// Constant data can be kept in flash with WOOPSA_PROGMEM and read back with
+// WOOPSA_FLASH_COPY, which is a plain memcpy on targets where flash is
+// mapped in the data address space
+#ifndef WOOPSA_PROGMEM
+	#define WOOPSA_PROGMEM
+	#define WOOPSA_FLASH_COPY(destination, source, length)		memcpy(destination, source, length)
+#endif
+
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+	#ifndef WOOPSA_FLASH_TEXT
+		#define WOOPSA_FLASH_TEXT(literal)						(literal)
+		#define WOOPSA_FLASH_READ_BYTE(address)					(*(const WoopsaUInt8*)(address))
+	#endif
+	#define WOOPSA_TABLE_PROGMEM WOOPSA_PROGMEM
+#else
+	#define WOOPSA_TABLE_PROGMEM
+#endif
+
 typedef struct {
+#ifdef WOOPSA_ENABLE_FLASH_TABLES
+	// Stored in the entry, so that it is in flash with it
+	WoopsaChar8 name[WOOPSA_ENTRY_NAME_SIZE];
+#else
 	const WoopsaChar8 *	name;
+#endif
 	union 
 	{
 		void* data;
 		ptrMethodVoid function;
+#ifdef WOOPSA_ENABLE_ACCESSORS
+		WoopsaAccessor* accessor;
+#endif
 	} address;
 	WoopsaUInt8 type;
 	WoopsaChar8 readOnly;
 	WoopsaChar8 isMethod;
 	WoopsaUInt8 size;
+	// One of WoopsaStorage, unused by methods
+	WoopsaUInt8 storage;
+	WoopsaChar8 isComputed;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	// address.data is then the offset of the field in the instance
+	WoopsaChar8 isField;
+#endif
 } WoopsaEntry;
 
+#ifdef WOOPSA_ENABLE_HISTORY
+	typedef struct {
+		WoopsaUInt32 sequence;
+		WoopsaUInt32 timestamp;
+		union {
+			WoopsaUInt8 bytes[WOOPSA_HISTORY_VALUE_SIZE];
+			double alignment;
+		} value;
+	} WoopsaHistorySample;
+
+	// A fixed-size ring buffer of timestamped samples of one property.
+	// Clients read all samples since a sequence number or a time with
+	// the history verb instead of polling the value.
+	typedef struct WoopsaHistory {
+		// Name of the recorded property
+		const WoopsaChar8* name;
+		WoopsaHistorySample* samples;
+		WoopsaUInt16 capacity;
+		WoopsaUInt16 head;
+		WoopsaUInt16 count;
+		// Sequence number given to the next recorded sample
+		WoopsaUInt32 nextSequence;
+		// Set by WoopsaServerAddHistory
+		const WoopsaEntry* entry;
+		struct WoopsaHistory* next;
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+		// Holds the instance of the fields recorded
+		const struct WoopsaServer* server;
+#endif
+	} WoopsaHistory;
+#endif
+
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	typedef struct {
+		const WoopsaEntry* entry;
+		// Last value sent to the client. Texts are compared by hash.
+		union {
+			double number;
+			WoopsaUInt32 hash;
+		} lastSent;
+	} WoopsaEventStreamProperty;
+
+	// A text/event-stream connection pushing the changes of a few properties
+	typedef struct {
+		WoopsaUInt8 open;
+		WoopsaUInt8 propertyCount;
+		// Numbers must change by more than this to be sent again
+		float deadband;
+		WoopsaEventStreamProperty properties[WOOPSA_EVENT_STREAM_PROPERTIES];
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+		// Streams of fields only are not scanned again until a snapshot
+		// changed: the sequence of the last one scanned
+		WoopsaUInt8 fieldsOnly;
+		WoopsaUInt16 snapshotSequence;
+#endif
+	} WoopsaEventStream;
+#endif
+
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	// A file embedded in the firmware, usually gzipped by
+	// Tools/woopsa-assets.py. data can live in flash (WOOPSA_PROGMEM).
+	typedef struct {
+		const WoopsaChar8* path;
+		const WoopsaChar8* contentType;
+		// Strong ETag, quotes included
+		const WoopsaChar8* etag;
+		const WoopsaUInt8* data;
+		WoopsaUInt32 length;
+		WoopsaUInt8 isGzipped;
+	} WoopsaStaticAsset;
+#endif
+
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+	// The counters of the queue are single bytes, which even 8-bit
+	// MCUs read and write atomically
+	#if WOOPSA_WRITE_QUEUE_SIZE > 128 || (WOOPSA_WRITE_QUEUE_SIZE & (WOOPSA_WRITE_QUEUE_SIZE - 1)) != 0
+	#error "WOOPSA_WRITE_QUEUE_SIZE must be a power of 2, up to 128"
+	#endif
+
+	// A write decoded by the server, waiting for WoopsaApplyPendingWrites
+	typedef struct {
+		// Index of the property in the entry table
+		WoopsaUInt16 entry;
+		union {
+			WoopsaUInt8 bytes[WOOPSA_WRITE_VALUE_SIZE];
+			double alignment;
+		} value;
+	} WoopsaPendingWrite;
+#endif
+
+#if defined(WOOPSA_ENABLE_GROUP_READS) || defined(WOOPSA_ENABLE_PAGED_META) || defined(WOOPSA_ENABLE_SUBOBJECTS)
+	#define WOOPSA_NAME_INDEX
+	// Position of an entry in the table
+	#if WOOPSA_NAME_INDEX_SIZE > 255
+	typedef WoopsaUInt16 WoopsaIndexEntry;
+	#else
+	typedef WoopsaUInt8 WoopsaIndexEntry;
+	#endif
+#endif
+
 typedef WoopsaBufferSize (*WoopsaRequestHandler)(WoopsaChar8*, WoopsaUInt8, WoopsaChar8*, WoopsaBufferSize);
 
+#ifdef WOOPSA_ENABLE_WRITE_HOOK
+	// Called with the entry (in the table given to WoopsaServerInit) of a
+	// property written by a client, once its new value is stored
+	typedef void (*WoopsaWriteHook)(const WoopsaEntry* entry);
+#endif
+
+#ifdef WOOPSA_ENABLE_DIRTY_BITS
+	// Dirty bits are scanned a word at a time
+	typedef WoopsaUInt32 WoopsaDirtyWord;
+	#define WOOPSA_DIRTY_WORD_BITS 32
+	#define WOOPSA_DIRTY_WORDS ((WOOPSA_DIRTY_ENTRIES + WOOPSA_DIRTY_WORD_BITS - 1) / WOOPSA_DIRTY_WORD_BITS)
+#endif
+
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+	#ifndef WOOPSA_ENABLE_DIRTY_BITS
+	#error "WOOPSA_ENABLE_CHANGE_JOURNAL needs WOOPSA_ENABLE_DIRTY_BITS"
+	#endif
+
+	// A change of a property, as recorded in the journal of the server
+	typedef struct {
+		WoopsaUInt32 sequence;
+		// Index of the property in the entry table
+		WoopsaUInt16 entry;
+		union {
+			WoopsaUInt8 bytes[WOOPSA_JOURNAL_VALUE_SIZE];
+			double alignment;
+		} value;
+	} WoopsaJournalRecord;
+#endif
+
+#ifdef WOOPSA_ENABLE_PUSH
+	#ifndef WOOPSA_ENABLE_GROUP_READS
+	#error "WOOPSA_ENABLE_PUSH needs WOOPSA_ENABLE_GROUP_READS"
+	#endif
+
+	// Default delays before pushing again after a failure
+	#define WOOPSA_PUSH_RETRY_MS 1000
+	#define WOOPSA_PUSH_MAX_RETRY_MS 60000
+
+	// Uploads of properties to a collector, set up by WoopsaPushInit
+	typedef struct {
+		// Host header and path of the collector's URL
+		const WoopsaChar8* host;
+		const WoopsaChar8* path;
+		// Group read pattern of the properties pushed, "*" for all of them
+		const WoopsaChar8* pattern;
+		// Pushes are at least intervalMs apart, the changes made in
+		// between are sent together
+		WoopsaUInt32 intervalMs;
+		// After a failure, the next push waits up to retryMs, doubled on
+		// every failure until maxRetryMs
+		WoopsaUInt32 retryMs;
+		WoopsaUInt32 maxRetryMs;
+		// Failures since the collector last accepted a push
+		WoopsaUInt16 failures;
+		WoopsaUInt8 inFlight;
+		WoopsaUInt32 dueAt;
+		WoopsaUInt32 backoffMs;
+	#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+		// 1 to push the changes of the journal instead of every property
+		WoopsaUInt8 changesOnly;
+		// The collector got a snapshot, then the changes up to pushedSequence
+		WoopsaUInt8 synced;
+		WoopsaUInt32 pushedSequence;
+		// Last change of the push on its way, and whether more are waiting
+		WoopsaUInt32 sentSequence;
+		WoopsaUInt8 morePending;
+	#endif
+	} WoopsaPush;
+#endif
+
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+	#ifndef WOOPSA_ENABLE_METHODS
+	#error "WOOPSA_ENABLE_ASYNC_METHODS needs WOOPSA_ENABLE_METHODS"
+	#endif
+	// The room for texts also holds the numbers
+	#if WOOPSA_JOB_TEXT_SIZE < 8
+	#error "WOOPSA_JOB_TEXT_SIZE must be at least 8"
+	#endif
+
+	// isMethod of the entries of asynchronous methods
+	#define WOOPSA_ASYNC_METHOD 2
 
+	// States of a WoopsaJob
+	#define WOOPSA_JOB_FREE 0
+	#define WOOPSA_JOB_RUNNING 1
+	#define WOOPSA_JOB_DONE 2
+	#define WOOPSA_JOB_FAILED 3
+
+	// A slot of the server for a call of an asynchronous method, from
+	// the invoke until a client got its result
+	typedef struct {
+		// Given to the client by the invoke, never 0
+		WoopsaUInt16 id;
+		volatile WoopsaUInt8 state;
+		// Return type of the method
+		WoopsaUInt8 type;
+		// One of WoopsaStorage, how the result is laid out
+		WoopsaUInt8 storage;
+		WoopsaUInt32 finishedAt;
+		union {
+			WoopsaUInt8 bytes[WOOPSA_JOB_TEXT_SIZE];
+			double alignment;
+		} result;
+	} WoopsaJob;
+
+	// An asynchronous method starts the work of its job and returns
+	typedef void(*ptrMethodAsync)(WoopsaJob* job);
+#endif
+
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	#ifndef WOOPSA_ENABLE_CONNECTIONS
+	#error "WOOPSA_ENABLE_TIMEOUTS needs WOOPSA_ENABLE_CONNECTIONS"
+	#endif
+	#if (WOOPSA_TIMER_SLOTS & (WOOPSA_TIMER_SLOTS - 1)) != 0
+	#error "WOOPSA_TIMER_SLOTS must be a power of 2"
+	#endif
+
+	// Deadlines of a connection
+	#define WOOPSA_DEADLINE_NONE 0
+	#define WOOPSA_DEADLINE_HEADER 1
+	#define WOOPSA_DEADLINE_BODY 2
+	#define WOOPSA_DEADLINE_IDLE 3
+
+	// A deadline in the list of its slot of a timer wheel
+	typedef struct WoopsaTimer {
+		struct WoopsaTimer* next;
+		// The pointer to this timer, in the slot or in the previous
+		// timer, NULL while it is not armed
+		struct WoopsaTimer** link;
+		WoopsaUInt32 armedAt;
+		WoopsaUInt32 duration;
+	} WoopsaTimer;
+
+	// Timers are put in the slot of the tick they expire at, so that
+	// arming and cancelling them takes the same time however many there
+	// are. Timers further than one turn of the wheel stay in their slot
+	// until their time comes.
+	typedef struct {
+		WoopsaTimer* slots[WOOPSA_TIMER_SLOTS];
+		// Slot of the last tick checked, and when it started
+		WoopsaUInt32 tick;
+		WoopsaUInt32 tickStart;
+	} WoopsaTimerWheel;
+#endif
+
+#ifdef WOOPSA_ENABLE_MOUNTS
+	#if WOOPSA_MOUNT_NODES > 255 || WOOPSA_MAX_MOUNTS > 255
+	#error "WOOPSA_MOUNT_NODES and WOOPSA_MAX_MOUNTS must be up to 255"
+	#endif
+
+	#define WOOPSA_NO_MOUNT 0xFF
+
+	// A character of the prefix trie of the mounts. The first node is
+	// the empty prefix, the children of a node are linked by sibling.
+	typedef struct {
+		WoopsaChar8 character;
+		// First child and next sibling, 0 when there is none
+		WoopsaUInt8 child;
+		WoopsaUInt8 sibling;
+		// Mount whose prefix ends here, or WOOPSA_NO_MOUNT
+		WoopsaUInt8 mount;
+	} WoopsaMountNode;
+#endif
+
+// Progress through the entry table of a meta document, which connections
+// serialize a few entries at a time with WOOPSA_ENABLE_TIME_SLICING
 typedef struct {
+	WoopsaUInt8 pass;
+	// Next entry of the table, and entries listed in this pass
+	WoopsaUInt16 entry;
+	WoopsaUInt16 listed;
+	// Where the content length goes once the document is complete
+	WoopsaBufferSize contentLengthPosition;
+	WoopsaBufferSize headersLength;
+	WoopsaBufferSize contentLength;
+} WoopsaMetaCursor;
+
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+	#ifndef WOOPSA_ENABLE_CONNECTIONS
+	#error "WOOPSA_ENABLE_TIME_SLICING needs WOOPSA_ENABLE_CONNECTIONS"
+	#endif
+
+	// Work done by a step of WoopsaConnectionStep
+	#define WOOPSA_STEP_REQUEST 1
+	#define WOOPSA_STEP_META 2
+	#define WOOPSA_STEP_OUTPUT 3
+
+	// Called after every step that did some work, with how long it took
+	typedef void (*WoopsaStepHook)(WoopsaUInt8 step, WoopsaUInt32 microseconds);
+#endif
+
+
+typedef struct WoopsaServer {
 	// The prefix for all Woopsa routes. Any client request 
 	// made without this prefix will pass the request to
 	// the handleRequest function, if it exists
@@ -63,20 +444,172 @@ typedef struct {
 	// a 404 Not Found error.
 	WoopsaRequestHandler requestHandler;
 	// A list of entries to be published by Woopsa
-	WoopsaEntry*	entries;
+	const WoopsaEntry*	entries;
+#ifdef WOOPSA_NAME_INDEX
+	// The entries of the table sorted by name, built by WoopsaServerInit.
+	// Empty when they do not fit.
+	WoopsaIndexEntry nameIndex[WOOPSA_NAME_INDEX_SIZE];
+	WoopsaUInt16 nameIndexLength;
+#endif
+#ifdef WOOPSA_ENABLE_HISTORY
+	// Histories added with WoopsaServerAddHistory
+	WoopsaHistory* histories;
+#endif
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+	WoopsaEventStream eventStreams[WOOPSA_MAX_EVENT_STREAMS];
+	// Index of the stream opened by the last request that
+	// returned WOOPSA_EVENT_STREAM
+	WoopsaUInt8 openedEventStream;
+#endif
+#ifdef WOOPSA_ENABLE_ETAGS
+	// Hash of the meta document, computed by WoopsaServerInit
+	WoopsaUInt32 metaETag;
+#endif
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	// Assets served before the request handler is called
+	const WoopsaStaticAsset* assets;
+	// Asset of the last request that returned WOOPSA_STATIC_ASSET
+	const WoopsaStaticAsset* servedAsset;
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+	// Single-producer single-consumer ring of decoded writes: only the
+	// server moves writeHead, only WoopsaApplyPendingWrites moves writeTail
+	WoopsaPendingWrite pendingWrites[WOOPSA_WRITE_QUEUE_SIZE];
+	volatile WoopsaUInt8 writeHead;
+	volatile WoopsaUInt8 writeTail;
+#endif
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+	// Set by connections while they handle a request: a meta response
+	// then only gets its headers, the entries are serialized by the
+	// next steps from this cursor
+	WoopsaMetaCursor* metaCursor;
+	WoopsaStepHook stepHook;
+#endif
+#ifdef WOOPSA_ENABLE_WRITE_HOOK
+	WoopsaWriteHook writeHook;
+#endif
+#ifdef WOOPSA_ENABLE_DIRTY_BITS
+	// One bit per entry of the table, set when the property changed
+	WoopsaDirtyWord dirty[WOOPSA_DIRTY_WORDS];
+#endif
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+	// Ring of the last changes, filled by WoopsaServerRecordChanges
+	WoopsaJournalRecord journal[WOOPSA_JOURNAL_SIZE];
+	WoopsaUInt16 journalHead;
+	WoopsaUInt16 journalCount;
+	// Sequence number given to the next recorded change
+	WoopsaUInt32 journalSequence;
+#endif
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	// Set by WoopsaServerSetInstance. Fields are read from the snapshot
+	// when there is one, and written to the instance.
+	WoopsaUInt8* instance;
+	WoopsaUInt8* snapshot;
+	WoopsaUInt16 instanceSize;
+	// Counts the snapshots that changed
+	WoopsaUInt16 snapshotSequence;
+#endif
+#ifdef WOOPSA_ENABLE_MOUNTS
+	// Servers added by WoopsaServerMount, this one first, and the trie
+	// of their prefixes
+	struct WoopsaServer* mounts[WOOPSA_MAX_MOUNTS];
+	WoopsaUInt8 mountCount;
+	WoopsaMountNode mountNodes[WOOPSA_MOUNT_NODES];
+	WoopsaUInt8 mountNodeCount;
+	// Server that handled the last request, this one or a mounted one
+	struct WoopsaServer* routedServer;
+#endif
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+	WoopsaJob jobs[WOOPSA_MAX_JOBS];
+	// Id given to the next job, and the job started by the last request
+	WoopsaUInt16 nextJobId;
+	WoopsaUInt16 startedJob;
+#endif
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+	// Deadlines of the connections of this server
+	WoopsaTimerWheel timers;
+#endif
 	// A small buffer string used in various places in the server
 	WoopsaBuffer buffer;
 } WoopsaServer;
 
+#ifdef WOOPSA_ENABLE_CONNECTIONS
+	// Life cycle of a WoopsaConnection
+	#define WOOPSA_CONNECTION_HTTP 0
+	#define WOOPSA_CONNECTION_WEBSOCKET 1
+	// The last response is being sent, then the connection is closed
+	#define WOOPSA_CONNECTION_CLOSING 2
+	#define WOOPSA_CONNECTION_CLOSED 3
+
+	// The state of one client connection, independent of the network stack:
+	// received bytes go in, responses come out. Requests are handled one
+	// at a time, in order, so clients can pipeline them.
+	typedef struct {
+		WoopsaServer* server;
+#ifdef WOOPSA_ENABLE_MOUNTS
+		// Server mounted on it that handled the last request, to which the
+		// event stream, meta document and WebSocket frames then belong
+		WoopsaServer* mounted;
+#endif
+		WoopsaUInt8 state;
+		// The current response does not close the connection
+		WoopsaUInt8 keepAlive;
+		// Received bytes not handled yet, NUL-terminated
+		WoopsaChar8 input[WOOPSA_CONNECTION_INPUT_SIZE + 1];
+		WoopsaBufferSize inputLength;
+		// Response being sent, of which outputSent bytes were consumed
+		WoopsaChar8 output[WOOPSA_CONNECTION_OUTPUT_SIZE];
+		WoopsaBufferSize outputLength;
+		WoopsaBufferSize outputSent;
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+		WoopsaUInt8 hasEventStream;
+		WoopsaUInt8 eventStream;
+#endif
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+		// Asset being streamed after the response headers
+		const WoopsaStaticAsset* asset;
+		WoopsaUInt32 assetOffset;
+#endif
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+		// Meta document being serialized, sent once it is complete
+		WoopsaMetaCursor meta;
+#endif
+#if defined(WOOPSA_ENABLE_ASYNC_METHODS) && defined(WOOPSA_ENABLE_WEBSOCKETS)
+		// Job invoked by a WebSocket message, whose result is sent once
+		// it finished. 0 when there is none.
+		WoopsaUInt16 job;
+#endif
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+		// One of WOOPSA_DEADLINE_, and its timer in the wheel of the server
+		WoopsaUInt8 deadline;
+		WoopsaTimer timer;
+		// Closed because the client was too slow
+		WoopsaUInt8 expired;
+#endif
+	} WoopsaConnection;
+#endif
+
+// Completes the initializers of entries and histories with the members
+// that struct tables add, so that the macros below set every member
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	#define WOOPSA_STRUCT_TABLES_INIT , 0
+#else
+	#define WOOPSA_STRUCT_TABLES_INIT
+#endif
+
+// Entry tables are constant, and kept in flash with WOOPSA_ENABLE_FLASH_TABLES
 #define WOOPSA_BEGIN(woopsaDictionaryName) \
-	WoopsaEntry woopsaDictionaryName[] = \
+	const WoopsaEntry woopsaDictionaryName[] WOOPSA_TABLE_PROGMEM = \
 	{
 
 #define WOOPSA_END \
-	{ (WoopsaChar8 *)NULL, { (void*)NULL }, 0, 0, 0, 0 }};
+	{ "", { (void*)NULL }, 0, 0, 0, 0, 0, 0 WOOPSA_STRUCT_TABLES_INIT }};
+
+#define WOOPSA_PROPERTY_STORED(variable, type, storage, readonly) \
+	{ #variable, { &variable }, type, readonly, 0, sizeof variable, storage, 0 WOOPSA_STRUCT_TABLES_INIT },
 
 #define WOOPSA_PROPERTY_CUSTOM(variable, type, readonly) \
-	{ #variable, { &variable }, type, readonly, 0, sizeof variable },
+	WOOPSA_PROPERTY_STORED(variable, type, WOOPSA_DEFAULT_STORAGE(type, sizeof variable), readonly)
 
 #define WOOPSA_PROPERTY_READONLY(variable, type) \
 	WOOPSA_PROPERTY_CUSTOM(variable, type, 1)
@@ -84,14 +617,110 @@ typedef struct {
 #define WOOPSA_PROPERTY(variable, type) \
 	WOOPSA_PROPERTY_CUSTOM(variable, type, 0)
 
+// Publishes an unsigned integer variable (uint8_t to uint64_t)
+#define WOOPSA_PROPERTY_UNSIGNED_CUSTOM(variable, readonly) \
+	WOOPSA_PROPERTY_STORED(variable, WOOPSA_TYPE_INTEGER, WOOPSA_INTEGER_STORAGE(sizeof variable, WOOPSA_STORAGE_UINT8), readonly)
+
+#define WOOPSA_PROPERTY_UNSIGNED_READONLY(variable) \
+	WOOPSA_PROPERTY_UNSIGNED_CUSTOM(variable, 1)
+
+#define WOOPSA_PROPERTY_UNSIGNED(variable) \
+	WOOPSA_PROPERTY_UNSIGNED_CUSTOM(variable, 0)
+
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+	// Publishes a field of a struct. The table holds its offset, the
+	// instance is given to the server by WoopsaServerSetInstance. Field
+	// lists kept as X-macros declare the struct and its table at once:
+	//   #define PUMP_FIELDS(X) X(float, Flow, , WOOPSA_TYPE_REAL) X(char, Mode, [16], WOOPSA_TYPE_TEXT)
+	//   #define PUMP_MEMBER(ctype, field, array, type) ctype field array;
+	//   #define PUMP_ENTRY(ctype, field, array, type) WOOPSA_FIELD(Pump, field, type)
+	//   typedef struct { PUMP_FIELDS(PUMP_MEMBER) } Pump;
+	//   WOOPSA_BEGIN(pumpEntries) PUMP_FIELDS(PUMP_ENTRY) WOOPSA_END;
+	#define WOOPSA_FIELD_STORED(structType, field, type, storage, readonly) \
+		{ #field, { (void*)offsetof(structType, field) }, type, readonly, 0, sizeof(((structType*)0)->field), storage, 0, 1 },
+
+	#define WOOPSA_FIELD_CUSTOM(structType, field, type, readonly) \
+		WOOPSA_FIELD_STORED(structType, field, type, WOOPSA_DEFAULT_STORAGE(type, sizeof(((structType*)0)->field)), readonly)
+
+	#define WOOPSA_FIELD_READONLY(structType, field, type) \
+		WOOPSA_FIELD_CUSTOM(structType, field, type, 1)
+
+	#define WOOPSA_FIELD(structType, field, type) \
+		WOOPSA_FIELD_CUSTOM(structType, field, type, 0)
+
+	#define WOOPSA_FIELD_UNSIGNED_CUSTOM(structType, field, readonly) \
+		WOOPSA_FIELD_STORED(structType, field, WOOPSA_TYPE_INTEGER, WOOPSA_INTEGER_STORAGE(sizeof(((structType*)0)->field), WOOPSA_STORAGE_UINT8), readonly)
+
+	#define WOOPSA_FIELD_UNSIGNED_READONLY(structType, field) \
+		WOOPSA_FIELD_UNSIGNED_CUSTOM(structType, field, 1)
+
+	#define WOOPSA_FIELD_UNSIGNED(structType, field) \
+		WOOPSA_FIELD_UNSIGNED_CUSTOM(structType, field, 0)
+#endif
+
+#ifdef WOOPSA_ENABLE_ACCESSORS
+	// Declares the accessor of a computed property. The variable receives
+	// the values returned by the getter and must be declared before.
+	#define WOOPSA_ACCESSOR(variable, getter, setter, cacheTtl) \
+		WoopsaAccessor variable##Accessor = { &variable, getter, setter, cacheTtl, 0, 0 };
+
+	#define WOOPSA_PROPERTY_COMPUTED_CUSTOM(variable, type, readonly) \
+		{ #variable, { &variable##Accessor }, type, readonly, 0, sizeof variable, WOOPSA_DEFAULT_STORAGE(type, sizeof variable), 1 WOOPSA_STRUCT_TABLES_INIT },
+
+	#define WOOPSA_PROPERTY_COMPUTED_READONLY(variable, type) \
+		WOOPSA_PROPERTY_COMPUTED_CUSTOM(variable, type, 1)
+
+	#define WOOPSA_PROPERTY_COMPUTED(variable, type) \
+		WOOPSA_PROPERTY_COMPUTED_CUSTOM(variable, type, 0)
+#endif
+
+#ifdef WOOPSA_ENABLE_HISTORY
+	// Declares a history of capacity samples for a published variable
+	#define WOOPSA_HISTORY(variable, capacity) \
+		WoopsaHistorySample variable##HistorySamples[capacity]; \
+		WoopsaHistory variable##History = { #variable, variable##HistorySamples, capacity, 0, 0, 1, NULL, NULL WOOPSA_STRUCT_TABLES_INIT };
+#endif
+
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+	#define WOOPSA_ASSETS_BEGIN(woopsaAssetsName) \
+		const WoopsaStaticAsset woopsaAssetsName[] = \
+		{
+
+	#define WOOPSA_ASSETS_END \
+		{ NULL, NULL, NULL, NULL, 0, 0 }};
+
+	#define WOOPSA_ASSET_CUSTOM(path, contentType, etag, data, isGzipped) \
+		{ path, contentType, etag, data, sizeof data, isGzipped },
+
+	#define WOOPSA_ASSET(path, contentType, etag, data) \
+		WOOPSA_ASSET_CUSTOM(path, contentType, etag, data, 0)
+
+	#define WOOPSA_ASSET_GZIP(path, contentType, etag, data) \
+		WOOPSA_ASSET_CUSTOM(path, contentType, etag, data, 1)
+#endif
+
 #ifdef WOOPSA_ENABLE_METHODS
 	#define WOOPSA_METHOD(method, returnType) \
-{#method, { (void*)method }, returnType, 0, 1, 0 },
+{#method, { (void*)method }, returnType, 0, 1, 0, 0, 0 WOOPSA_STRUCT_TABLES_INIT },
 
 	#define WOOPSA_METHOD_VOID(method) \
 		WOOPSA_METHOD(method, WOOPSA_TYPE_NULL)
 #endif
 
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+	// Publishes a method that starts a job, void method(WoopsaJob* job),
+	// completed later with WoopsaJobComplete. An invoke answers at once
+	// with {"Job":7,"State":"Running"}, job/7 then gives the state, and
+	// once the job finished "State":"Done","Result":{"Value":..,"Type":..}
+	// (or "State":"Failed"). A finished job is freed once its result was
+	// sent. 503 is answered when WOOPSA_MAX_JOBS are running.
+	#define WOOPSA_METHOD_ASYNC(method, returnType) \
+{#method, { (void*)method }, returnType, 0, WOOPSA_ASYNC_METHOD, 0, 0, 0 WOOPSA_STRUCT_TABLES_INIT },
+
+	#define WOOPSA_METHOD_ASYNC_VOID(method) \
+		WOOPSA_METHOD_ASYNC(method, WOOPSA_TYPE_NULL)
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -101,7 +730,47 @@ extern "C"
 
 // Creates a new Woopsa server using the specified prefix 
 // and a list of entries to publish
-	void WoopsaServerInit(WoopsaServer* server, const WoopsaChar8* prefix, WoopsaEntry entries[], WoopsaRequestHandler requestHandler);
+	void WoopsaServerInit(WoopsaServer* server, const WoopsaChar8* prefix, const WoopsaEntry entries[], WoopsaRequestHandler requestHandler);
+
+// Takes into account the entries added at the end of the table since
+// WoopsaServerInit, by tables built at run time. The table must not have
+// moved, nor its entries changed.
+void WoopsaServerRefreshTable(WoopsaServer* server);
+
+#ifdef WOOPSA_ENABLE_ASYNC_METHODS
+// Completes the job of an asynchronous method with what it returns:
+// value points to an int for Integer and Logical methods, to a float for
+// Real and TimeSpan ones, to a text for the others, and is NULL for
+// methods without return value. It can be called from the method itself,
+// or later from the application's loop or an interrupt. The job must not
+// be used afterwards.
+void WoopsaJobComplete(WoopsaJob* job, const void* value);
+
+// Completes the job with a value laid out as storage (one of
+// WoopsaStorage), like the variables of WOOPSA_PROPERTY_STORED: value
+// points to an int64_t for WOOPSA_STORAGE_INT64, to a double for
+// WOOPSA_STORAGE_DOUBLE... and is NULL for methods without return value.
+void WoopsaJobCompleteStored(WoopsaJob* job, WoopsaUInt8 storage, const void* value);
+
+// Ends a job that could not be done, clients get the Failed state
+void WoopsaJobFail(WoopsaJob* job);
+#endif
+
+#ifdef WOOPSA_ENABLE_MOUNTS
+// Mounts another initialized server on this one, so that requests
+// handled by this one also reach the entries of the other:
+//   WoopsaServerInit(&motion, "/motion/", motionEntries, NULL);
+//   WoopsaServerMount(&server, &motion);
+// A request goes to the server with the longest prefix of its path, or
+// to the request handler of this one. Mounted servers keep their own
+// name index, meta ETag, event streams, histories, write queue and
+// journal; their request handler, assets and step hook are not used.
+// WoopsaApplyPendingWrites and WoopsaServerTakeSnapshot also handle the
+// servers mounted on the one they are given.
+// Returns WOOPSA_SUCCESS, or WOOPSA_OTHER_ERROR if the prefix is already
+// mounted or WOOPSA_MAX_MOUNTS or WOOPSA_MOUNT_NODES is reached
+WoopsaUInt8 WoopsaServerMount(WoopsaServer* server, WoopsaServer* mounted);
+#endif
 
 // Checks if the request contained in inputBuffer
 // is finished. This is useful in the case where
@@ -117,14 +786,250 @@ WoopsaUInt8	WoopsaCheckRequestComplete(WoopsaServer* server, WoopsaChar8* inputB
 //  WOOPSA_SUCCESS (0) = success
 //  WOOPSA_CLIENT_REQUEST_ERROR (1) = the client made a bad request
 //  WOPOSA_OTHER_ERROR (2) = something wrong happened inside Woopsa (it's our fault)
+//  WOOPSA_OTHER_RESPONSE (3) = the request was served by the requestHandler
+//  WOOPSA_EVENT_STREAM (4) = an event stream was opened, server->openedEventStream
+//    tells which. Keep the connection open and call WoopsaEventStreamPoll.
+//  WOOPSA_WEBSOCKET (5) = the connection was upgraded to a WebSocket, pass
+//    the next received bytes to WoopsaWebSocketHandleFrame
+//  WOOPSA_WEBSOCKET_CLOSED (6) = the WebSocket was closed by the client
+//  WOOPSA_STATIC_ASSET (7) = outputBuffer holds the headers of the asset in
+//    server->servedAsset, send its content with WoopsaStaticAssetRead
 #define WOOPSA_SUCCESS 0
 #define WOOPSA_CLIENT_REQUEST_ERROR 1
 #define WOOPSA_OTHER_ERROR 2
 #define WOOPSA_OTHER_RESPONSE 3
+#define WOOPSA_EVENT_STREAM 4
+#define WOOPSA_WEBSOCKET 5
+#define WOOPSA_WEBSOCKET_CLOSED 6
+#define WOOPSA_STATIC_ASSET 7
 
 WoopsaUInt8	WoopsaHandleRequest(WoopsaServer* server, const WoopsaChar8* inputBuffer, WoopsaBufferSize inputBufferLength, WoopsaChar8* outputBuffer, 
 	WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength);
 
+#ifdef WOOPSA_ENABLE_CONNECTIONS
+// Prepares a connection for a new client of the server
+void WoopsaConnectionInit(WoopsaConnection* connection, WoopsaServer* server);
+
+// Returns where received bytes can be written directly, and how many
+// fit in space. Call WoopsaConnectionReceived once they are written.
+WoopsaChar8* WoopsaConnectionInput(WoopsaConnection* connection, WoopsaBufferSize* space);
+
+// Handles the length bytes written at WoopsaConnectionInput. Partial
+// requests are kept until the rest is received. With time slicing, they
+// are only handled by the next calls of WoopsaConnectionStep.
+void WoopsaConnectionReceived(WoopsaConnection* connection, WoopsaBufferSize length);
+
+// Copies received bytes in the connection and handles them
+// Returns the number of bytes accepted. When it is less than length, feed
+// the rest again once the pending output was consumed.
+WoopsaBufferSize WoopsaConnectionFeed(WoopsaConnection* connection, const WoopsaChar8* data, WoopsaBufferSize length);
+
+// Gives the bytes to send next, and produces them if needed (chunks of
+// assets, events), which WoopsaConnectionStep does with time slicing.
+// The bytes stay valid until WoopsaConnectionConsumed.
+// Returns their length, 0 if there is nothing to send for now
+WoopsaBufferSize WoopsaConnectionPollOutput(WoopsaConnection* connection, const WoopsaChar8** output);
+
+// Tells that length bytes of the output were sent. Once a response is
+// entirely sent, the next pipelined request is handled.
+void WoopsaConnectionConsumed(WoopsaConnection* connection, WoopsaBufferSize length);
+
+// Returns 1 once the socket must be closed: the client asked for it,
+// or made an error, or the response cannot be followed by another one
+WoopsaUInt8 WoopsaConnectionIsClosed(WoopsaConnection* connection);
+
+// Releases what the connection holds (event stream, deadline), to be
+// called when its socket is closed, whatever the reason, and before the
+// connection is initialized again
+void WoopsaConnectionClose(WoopsaConnection* connection);
+#endif
+
+#ifdef WOOPSA_ENABLE_TIMEOUTS
+// Closes the connections of the server whose deadline passed: those still
+// sending a request get a 408 response first, the others are closed at
+// once. Call it at least every WOOPSA_TIMER_TICK_MS, then check the
+// connections as usual with WoopsaConnectionPollOutput and
+// WoopsaConnectionIsClosed. The connections of a server must all be
+// served by the thread calling it.
+void WoopsaServerExpireConnections(WoopsaServer* server);
+
+// Returns 1 once the connection was closed by a deadline. A closed
+// connection still gets WOOPSA_IDLE_TIMEOUT_MS to send the last response
+// the application holds, after which it expires: close the socket without
+// sending the rest.
+WoopsaUInt8 WoopsaConnectionExpired(WoopsaConnection* connection);
+#endif
+
+#ifdef WOOPSA_ENABLE_TIME_SLICING
+// Does the next piece of work of a connection, and no more: handles one
+// request, serializes WOOPSA_STEP_ENTRIES entries of a meta response, or
+// produces the next chunk of output. Call it on every cycle of the
+// control loop, the work is spread over the following cycles.
+// Returns the WOOPSA_STEP_ done, 0 when there was nothing to do
+WoopsaUInt8 WoopsaConnectionStep(WoopsaConnection* connection);
+
+// Calls hook after every step that did some work, with its duration in
+// WOOPSA_MICROSECONDS, to find the worst-case cost of a step. NULL to stop.
+void WoopsaServerSetStepHook(WoopsaServer* server, WoopsaStepHook hook);
+#endif
+
+#ifdef WOOPSA_ENABLE_STATIC_ASSETS
+// Serves a table of assets (declared with WOOPSA_ASSETS_BEGIN) at their
+// paths. Gzipped assets are only served to clients that accept them, and
+// requests carrying their ETag in If-None-Match get a 304 Not Modified.
+void WoopsaServerSetAssets(WoopsaServer* server, const WoopsaStaticAsset assets[]);
+
+// Copies the content of an asset, starting at offset, in chunks of at most
+// outputBufferLength bytes. Returns the length copied, 0 at the end.
+WoopsaBufferSize WoopsaStaticAssetRead(const WoopsaStaticAsset* asset, WoopsaUInt32 offset, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength);
+#endif
+
+#ifdef WOOPSA_ENABLE_WRITE_QUEUE
+// Stores the values written by clients since the last call in their
+// properties (or hands them to their setters), in the order they were
+// written. Call it where the properties can safely change, between two
+// cycles of the control loop for instance, or from an interrupt: it
+// never waits for the server, which never waits for it. Writes are
+// answered with 503 Service Unavailable while the queue is full. The
+// properties of a transaction are always applied by the same call.
+// The queues of the mounted servers are emptied too.
+// Returns the number of writes applied
+WoopsaUInt8 WoopsaApplyPendingWrites(WoopsaServer* server);
+#endif
+
+#ifdef WOOPSA_ENABLE_WRITE_HOOK
+// Calls hook after each property written by a client, NULL to stop. With
+// the write queue, it is called by WoopsaApplyPendingWrites.
+void WoopsaServerSetWriteHook(WoopsaServer* server, WoopsaWriteHook hook);
+#endif
+
+#ifdef WOOPSA_ENABLE_DIRTY_BITS
+// Marks a property of the table given to WoopsaServerInit as changed by
+// the application. Can be called from an interrupt.
+void WoopsaMarkChanged(WoopsaServer* server, const WoopsaEntry* entry);
+
+// Hashes every property and marks those whose hash differs from the one
+// in hashes[], which holds one hash per entry of the table and is updated.
+// It costs a pass over the whole table: call it periodically to catch the
+// changes the application does not mark itself. The first call, with
+// hashes[] cleared, marks every property.
+// Returns the number of properties marked
+WoopsaUInt16 WoopsaServerDetectChanges(WoopsaServer* server, WoopsaUInt32 hashes[]);
+
+// Finds the first changed entry at or after index from, and clears its
+// dirty bit. Words without a change are skipped at once, so going through
+// the changes costs their number rather than the size of the table:
+//   for (i = WoopsaServerNextChanged(server, 0); i != -1; i = WoopsaServerNextChanged(server, i + 1))
+// Returns the index of the entry in the table, or -1 if none changed
+WoopsaInt16 WoopsaServerNextChanged(WoopsaServer* server, WoopsaUInt16 from);
+#endif
+
+#ifdef WOOPSA_ENABLE_CHANGE_JOURNAL
+// Records the properties whose dirty bit is set in the journal, with their
+// current value, and clears their bit: the journal takes the place of the
+// application as the consumer of the dirty bits. The changes verb calls it
+// before answering, call it as well where changes should be numbered in
+// the order they happen, after WoopsaServerDetectChanges for instance.
+// A client reads the changes after sequence number N with
+//   GET /woopsa/changes?since=N
+//   {"Changes":[{"Sequence":N+1,"Name":"Altitude","Value":431}],"Last":N+1,"Resync":false}
+// and asks for those after Last next time. Resync is true when changes
+// after N were overwritten, or N comes from before a restart: the client
+// must read every property again, then ask for the changes after Last.
+// Without since, only Last is returned.
+void WoopsaServerRecordChanges(WoopsaServer* server);
+#endif
+
+#ifdef WOOPSA_ENABLE_PUSH
+// Sets up pushes of the properties matching pattern (up to 47 characters,
+// with at least one *) to http://host/path every intervalMs milliseconds,
+// the first one right away. Set changesOnly afterwards to push changes.
+void WoopsaPushInit(WoopsaPush* push, const WoopsaChar8* host, const WoopsaChar8* path, const WoopsaChar8* pattern, WoopsaUInt32 intervalMs);
+
+// Prepares the POST request of the next push in outputBuffer, when it is
+// due and the previous one was answered. The content is JSON:
+//   {"Values":{"Altitude":{"Value":431,"Type":"Integer"}}}
+// with the properties as a group read returns them, or with changesOnly:
+//   {"Changes":[{"Sequence":8,"Name":"Altitude","Value":431}],"Last":8}
+// Changes are only pushed once the collector got a snapshot, which then
+// holds "Last" too, and while the journal holds all the changes it did
+// not get; changes that do not fit are pushed next.
+// Returns the length of the request to send, 0 if there is none
+WoopsaBufferSize WoopsaPushPrepare(WoopsaServer* server, WoopsaPush* push, WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength);
+
+// Gives the start of the collector's response to the last push (at least
+// its status line), or NULL if the request could not be sent or was not
+// answered in time. Pushes are accepted with a 2xx status; a collector
+// that lost its state answers 205 to get a snapshot next.
+void WoopsaPushResponse(WoopsaPush* push, const WoopsaChar8* response, WoopsaBufferSize length);
+#endif
+
+#ifdef WOOPSA_ENABLE_STRUCT_TABLES
+// Gives the struct of size bytes holding the fields of the table. With a
+// snapshot buffer of the same size, clients read the copy made by the
+// last WoopsaServerTakeSnapshot, so that all the fields they read come
+// from the same cycle; their writes still go to the instance. snapshot
+// can be NULL.
+void WoopsaServerSetInstance(WoopsaServer* server, void* instance, void* snapshot, WoopsaUInt16 size);
+
+// Copies the instance in the snapshot with one memcpy under WOOPSA_LOCK.
+// Call it where the struct is consistent, at the end of a control cycle
+// for instance. Event streams of fields are only scanned again once a
+// snapshot changed. The mounted servers take their snapshot too.
+// Returns 1 if an instance changed since the last snapshot
+WoopsaUInt8 WoopsaServerTakeSnapshot(WoopsaServer* server);
+#endif
+
+#ifdef WOOPSA_ENABLE_HISTORY
+// Attaches a history (declared with WOOPSA_HISTORY) to the property of
+// the same name. Text properties cannot be recorded.
+// Returns WOOPSA_SUCCESS, or WOOPSA_OTHER_ERROR if the property
+// does not exist or its values do not fit in a sample
+WoopsaUInt8 WoopsaServerAddHistory(WoopsaServer* server, WoopsaHistory* history);
+
+// Records the current value of the property, overwriting the oldest
+// sample when the history is full. Can be called from a sampling tick.
+void WoopsaHistoryRecord(WoopsaHistory* history);
+
+// Records the current value of every history added to the server
+void WoopsaServerRecordHistories(WoopsaServer* server);
+#endif
+
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+// Prepares the events of the properties that changed since they were last
+// sent on this stream. responseLength is 0 when nothing changed.
+// Events that do not fit in the output buffer are sent on the next poll.
+WoopsaUInt8 WoopsaEventStreamPoll(WoopsaServer* server, WoopsaUInt8 stream, WoopsaChar8* outputBuffer,
+	WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength);
+
+// Frees the stream slot once its connection was closed
+void WoopsaEventStreamClose(WoopsaServer* server, WoopsaUInt8 stream);
+#endif
+
+#ifdef WOOPSA_ENABLE_WEBSOCKETS
+// Handles one WebSocket frame received on an upgraded connection.
+// Text messages are a Woopsa path followed, for writes, by a space and the
+// value: "read/Temperature", "write/Altitude 431", "invoke/GetWeather",
+// "meta". The reply frame holds the same JSON as the HTTP response, or
+// {"Error":"..."}. "events?properties=A,B" subscribes the WebSocket to
+// property changes like an event stream: the result is WOOPSA_EVENT_STREAM,
+// then WoopsaWebSocketPollEvents sends JSON arrays of changes.
+// consumed is the length of the handled frame, 0 if it is not complete yet.
+// Returns:
+//  WOOPSA_SUCCESS (0) = the frame was handled, send the response (if any)
+//  WOOPSA_CLIENT_REQUEST_ERROR (1) = protocol error, close the connection
+//  WOOPSA_EVENT_STREAM (4) = a subscription was opened in server->openedEventStream
+//  WOOPSA_WEBSOCKET_CLOSED (6) = send the response, then close the connection
+WoopsaUInt8 WoopsaWebSocketHandleFrame(WoopsaServer* server, const WoopsaChar8* inputBuffer, WoopsaBufferSize inputBufferLength, WoopsaBufferSize* consumed,
+	WoopsaChar8* outputBuffer, WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength);
+
+#ifdef WOOPSA_ENABLE_EVENT_STREAMS
+// Same as WoopsaEventStreamPoll, for subscriptions made over a WebSocket
+WoopsaUInt8 WoopsaWebSocketPollEvents(WoopsaServer* server, WoopsaUInt8 stream, WoopsaChar8* outputBuffer,
+	WoopsaBufferSize outputBufferLength, WoopsaBufferSize* responseLength);
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Embeds static files in a C header served by the Woopsa embedded server.
+
+Every file is gzipped and written as a const array placed in flash
+(WOOPSA_PROGMEM), followed by a WOOPSA_ASSETS_BEGIN table to pass to
+WoopsaServerSetAssets. The ETag of each asset is a hash of its compressed
+content, so it only changes when the file does.
+
+Usage:
+  python woopsa-assets.py -o assets.h index.html [more files...]
+
+Files are served at /<file name>, and index.html also at /.
+Run it again whenever one of the files changes.
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+
+CONTENT_TYPES = {
+	".html": "text/html",
+	".htm": "text/html",
+	".js": "application/javascript",
+	".css": "text/css",
+	".json": "application/json",
+	".svg": "image/svg+xml",
+	".png": "image/png",
+	".ico": "image/x-icon",
+	".txt": "text/plain",
+}
+
+BYTES_PER_LINE = 16
+
+
+def variable_name(file_name):
+	parts = re.split(r"[^0-9A-Za-z]+", file_name)
+	return "".join(part[:1].upper() + part[1:] for part in parts if part) + "Asset"
+
+
+def format_array(data):
+	lines = []
+	for i in range(0, len(data), BYTES_PER_LINE):
+		lines.append("\t" + ", ".join("0x%02x" % byte for byte in data[i:i + BYTES_PER_LINE]) + ",")
+	return "\n".join(lines)
+
+
+def main():
+	parser = argparse.ArgumentParser(description="Embeds gzipped static files for the Woopsa embedded server")
+	parser.add_argument("files", nargs="+", help="files to embed")
+	parser.add_argument("-o", "--output", required=True, help="header to generate")
+	parser.add_argument("-n", "--name", default="woopsaAssets", help="name of the asset table")
+	arguments = parser.parse_args()
+
+	guard = "__" + re.sub(r"[^0-9A-Za-z]", "_", os.path.basename(arguments.output)).upper() + "_"
+	arrays = []
+	entries = []
+	for path in arguments.files:
+		file_name = os.path.basename(path)
+		with open(path, "rb") as file:
+			content = file.read()
+		# mtime=0 keeps the output (and the ETag) identical between builds
+		compressed = gzip.compress(content, compresslevel=9, mtime=0)
+		etag = '"\\"%s\\""' % hashlib.sha1(compressed).hexdigest()[:16]
+		content_type = CONTENT_TYPES.get(os.path.splitext(file_name)[1].lower(), "application/octet-stream")
+		name = variable_name(file_name)
+		arrays.append("// %s, %d bytes (%d uncompressed)\nstatic const WoopsaUInt8 %s[] WOOPSA_PROGMEM = {\n%s\n};\n"
+			% (file_name, len(compressed), len(content), name, format_array(compressed)))
+		entries.append('\tWOOPSA_ASSET_GZIP("/%s", "%s", %s, %s)' % (file_name, content_type, etag, name))
+
+	with open(arguments.output, "w", newline="\n") as output:
+		output.write("// Generated by woopsa-assets.py from %s, do not edit.\n" % ", ".join(os.path.basename(path) for path in arguments.files))
+		output.write("#ifndef %s\n#define %s\n\n#include \"woopsa-server.h\"\n\n" % (guard, guard))
+		output.write("\n".join(arrays))
+		output.write("\nWOOPSA_ASSETS_BEGIN(%s)\n%s\nWOOPSA_ASSETS_END\n\n#endif\n" % (arguments.name, "\n".join(entries)))
+
+
+if __name__ == "__main__":
+	main()
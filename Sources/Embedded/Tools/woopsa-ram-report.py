@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+Reports the memory used by the Woopsa embedded server in each configuration.
+
+The server is compiled with a sample table of 7 entries with every optional
+feature disabled, with each feature alone, and with the features of
+woopsa-config.h, without then with flash tables. For each configuration:
+  flash       code and constants of the server (text + data)
+  static      RAM of the server's globals and constants (data + bss)
+  table       RAM of the sample entry table
+  server      sizeof(WoopsaServer)
+  connection  sizeof(WoopsaConnection), for each client
+
+Usage:
+  python woopsa-ram-report.py
+  python woopsa-ram-report.py --cc avr-gcc --cflags "-mmcu=atmega328p -Os"
+  python woopsa-ram-report.py --config ../ArduinoDemoServer/woopsa-config.h
+
+Host compilers map constants from flash, so their static and table columns
+only count writable data. On AVR, every constant that is not in flash is
+copied to RAM at startup: compare the configurations with a cross compiler.
+"""
+
+import argparse
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import tempfile
+
+SERVER_DIRECTORY = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Server")
+SERVER_FILES = ["woopsa-server.c", "woopsa-server.h"]
+CONFIG_FILE = "woopsa-config.h"
+# The server does not compile without these
+REQUIRED_FEATURES = ["WOOPSA_ENABLE_STRINGS", "WOOPSA_ENABLE_METHODS"]
+# Features that do not compile without others
+FEATURE_DEPENDENCIES = {
+	"WOOPSA_ENABLE_TIME_SLICING": ["WOOPSA_ENABLE_CONNECTIONS"],
+	"WOOPSA_ENABLE_TIMEOUTS": ["WOOPSA_ENABLE_CONNECTIONS"],
+	"WOOPSA_ENABLE_CHANGE_JOURNAL": ["WOOPSA_ENABLE_DIRTY_BITS"],
+	"WOOPSA_ENABLE_PUSH": ["WOOPSA_ENABLE_GROUP_READS"],
+}
+FLASH_TABLES = "WOOPSA_ENABLE_FLASH_TABLES"
+# nm symbol types of data in RAM
+RAM_SYMBOL_TYPES = "BbCDdGgSs"
+
+PROBE = """#include "woopsa-server.h"
+
+float Temperature;
+char IsRaining;
+int Altitude;
+float Sensitivity;
+char City[20];
+float TimeSinceLastRain;
+
+char* GetWeather(void) {
+	return City;
+}
+
+WOOPSA_BEGIN(woopsaEntries)
+WOOPSA_PROPERTY_READONLY(Temperature, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(IsRaining, WOOPSA_TYPE_LOGICAL)
+WOOPSA_PROPERTY(Altitude, WOOPSA_TYPE_INTEGER)
+WOOPSA_PROPERTY(Sensitivity, WOOPSA_TYPE_REAL)
+WOOPSA_PROPERTY(City, WOOPSA_TYPE_TEXT)
+WOOPSA_PROPERTY(TimeSinceLastRain, WOOPSA_TYPE_TIME_SPAN)
+WOOPSA_METHOD(GetWeather, WOOPSA_TYPE_TEXT)
+WOOPSA_END;
+
+// Only their symbol sizes are used
+char woopsaServerSize[sizeof(WoopsaServer)];
+#ifdef WOOPSA_ENABLE_CONNECTIONS
+char woopsaConnectionSize[sizeof(WoopsaConnection)];
+#endif
+"""
+
+
+def binutil(compiler, name):
+	# avr-gcc comes with avr-size and avr-nm
+	if compiler.endswith("gcc"):
+		return compiler[:-len("gcc")] + name
+	return name
+
+
+# Returns the optional features of the configuration, and those it enables
+def optional_features(config):
+	features = re.findall(r"^(//\s*)?#define (WOOPSA_ENABLE_\w+)\s*$", config, re.MULTILINE)
+	features = [(comment, feature) for comment, feature in features if feature not in REQUIRED_FEATURES]
+	return [feature for comment, feature in features], [feature for comment, feature in features if not comment]
+
+
+def write_config(config, directory, enabled):
+	config = re.sub(r"^(//\s*)?#define (WOOPSA_ENABLE_\w+)\s*$",
+		lambda match: match.group(0) if match.group(2) in REQUIRED_FEATURES
+			else ("#define %s" if match.group(2) in enabled else "// #define %s") % match.group(2),
+		config, flags=re.MULTILINE)
+	with open(os.path.join(directory, CONFIG_FILE), "w", newline="\n") as file:
+		file.write(config)
+
+
+def compile_source(arguments, directory, source, defines):
+	command = [arguments.cc] + shlex.split(arguments.cflags) + defines + ["-I", directory, "-c", source, "-o", source[:-2] + ".o"]
+	result = subprocess.run(command, cwd=directory, capture_output=True, text=True)
+	if result.returncode != 0:
+		errors = [line for line in result.stderr.splitlines() if "error" in line]
+		raise RuntimeError(errors[0] if errors else "%s failed" % arguments.cc)
+	return os.path.join(directory, source[:-2] + ".o")
+
+
+def object_sizes(arguments, path):
+	output = subprocess.run([arguments.size, path], capture_output=True, text=True, check=True).stdout
+	text, data, bss = (int(value) for value in output.strip().splitlines()[-1].split()[:3])
+	return text, data, bss
+
+
+def symbol_sizes(arguments, path):
+	output = subprocess.run([arguments.nm, "-S", path], capture_output=True, text=True, check=True).stdout
+	symbols = {}
+	for line in output.splitlines():
+		fields = line.split()
+		if len(fields) == 4:
+			symbols[fields[3]] = (int(fields[1], 16), fields[2])
+	return symbols
+
+
+def measure(arguments, config, enabled, defines):
+	directory = tempfile.mkdtemp(prefix="woopsa-ram-")
+	try:
+		for name in SERVER_FILES:
+			shutil.copy(os.path.join(SERVER_DIRECTORY, name), directory)
+		write_config(config, directory, enabled)
+		with open(os.path.join(directory, "probe.c"), "w", newline="\n") as file:
+			file.write(PROBE)
+		text, data, bss = object_sizes(arguments, compile_source(arguments, directory, "woopsa-server.c", defines))
+		symbols = symbol_sizes(arguments, compile_source(arguments, directory, "probe.c", defines))
+	finally:
+		shutil.rmtree(directory)
+	table_size, table_type = symbols["woopsaEntries"]
+	return {
+		"flash": text + data,
+		"static": data + bss,
+		"table": table_size if table_type in RAM_SYMBOL_TYPES else 0,
+		"server": symbols["woopsaServerSize"][0],
+		"connection": symbols["woopsaConnectionSize"][0] if "woopsaConnectionSize" in symbols else None,
+	}
+
+
+def main():
+	parser = argparse.ArgumentParser(description="Reports the memory used by the Woopsa embedded server in each configuration")
+	parser.add_argument("--cc", default="gcc", help="C compiler, avr-gcc for instance")
+	parser.add_argument("--cflags", default="-Os", help="compiler flags, such as -mmcu=atmega328p -Os")
+	parser.add_argument("--size", help="size tool, derived from the compiler by default")
+	parser.add_argument("--nm", help="nm tool, derived from the compiler by default")
+	parser.add_argument("--config", default=os.path.join(SERVER_DIRECTORY, CONFIG_FILE),
+		help="configuration to report, ../Server/woopsa-config.h by default")
+	arguments = parser.parse_args()
+	arguments.size = arguments.size or binutil(arguments.cc, "size")
+	arguments.nm = arguments.nm or binutil(arguments.cc, "nm")
+
+	with open(arguments.config) as file:
+		config = file.read()
+	features, configured = optional_features(config)
+	configured = [feature for feature in configured if feature != FLASH_TABLES]
+	# Flash tables may be enabled for AVR only, the define is moved to
+	# the command line to enable them everywhere
+	configurations = [("minimal", [], [])]
+	for feature in features:
+		name = "+" + feature[len("WOOPSA_ENABLE_"):].lower()
+		if feature == FLASH_TABLES:
+			configurations.append((name, [], ["-D%s=" % FLASH_TABLES]))
+		else:
+			configurations.append((name, [feature] + FEATURE_DEPENDENCIES.get(feature, []), []))
+	configurations.append(("woopsa-config.h", configured, []))
+	configurations.append(("woopsa-config.h+flash", configured, ["-D%s=" % FLASH_TABLES]))
+
+	print("%s %s, sample table of 7 entries, sizes in bytes" % (arguments.cc, arguments.cflags))
+	print("%-24s %8s %8s %8s %8s %11s" % ("configuration", "flash", "static", "table", "server", "connection"))
+	for name, enabled, defines in configurations:
+		try:
+			sizes = measure(arguments, config, enabled, defines)
+		except (RuntimeError, KeyError, ValueError, subprocess.CalledProcessError) as error:
+			print("%-24s does not build: %s" % (name, error))
+			continue
+		print("%-24s %8d %8d %8d %8d %11s" % (name, sizes["flash"], sizes["static"], sizes["table"], sizes["server"],
+			"-" if sizes["connection"] is None else sizes["connection"]))
+	print("RAM of a server = static + table + server (+ connection per client), besides the stack")
+
+
+if __name__ == "__main__":
+	main()